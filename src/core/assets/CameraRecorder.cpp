@@ -11,6 +11,7 @@
 
 
 #include <fstream>
+#include <future>
 #include "core/assets/CameraRecorder.hpp"
 #include "core/assets/InputCamera.hpp"
 #include <opencv2/imgcodecs.hpp>
@@ -366,8 +367,11 @@ namespace sibr
 	}
 
 	void CameraRecorder::recordOfflinePath(const std::string& outPathDir, ViewBase::Ptr view, const std::string& prefix) {
-		sibr::ImageRGBA32F::Ptr outImage;
-		outImage.reset(new ImageRGBA32F(_ow, _oh));
+		// Two images, so that a frame is written to disk while the next one is rendered.
+		sibr::ImageRGBA32F::Ptr outImages[2];
+		outImages[0].reset(new ImageRGBA32F(_ow, _oh));
+		outImages[1].reset(new ImageRGBA32F(_ow, _oh));
+		std::future<void> writing;
 		std::string outpathd = outPathDir;
 
 		sibr::RenderTargetRGBA32F::Ptr outFrame;
@@ -397,8 +401,18 @@ namespace sibr
 			std::ostringstream ssZeroPad;
 			ssZeroPad << std::setw(8) << std::setfill('0') << i;
 			outFileName = outpathd + "/" +  ssZeroPad.str() + ".png";
+			sibr::ImageRGBA32F::Ptr outImage = outImages[i % 2];
 			outFrame->readBack(*outImage);
-			outImage->save(outFileName, false);
+			// The previous frame used the other image.
+			if (writing.valid()) {
+				writing.get();
+			}
+			writing = std::async(std::launch::async, [outImage, outFileName]() {
+				outImage->save(outFileName, false);
+			});
+		}
+		if (writing.valid()) {
+			writing.get();
 		}
 
 		std::cout << "Done rendering path. " << std::endl;
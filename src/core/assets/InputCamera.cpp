@@ -14,6 +14,7 @@
 
 #include "core/assets/ActiveImageFile.hpp"
 #include "core/assets/InputCamera.hpp"
+#include "core/graphics/ImageInfo.hpp"
 #include <boost/algorithm/string.hpp>
 #include <map>
 #include "core/system/String.hpp"
@@ -911,16 +912,15 @@ namespace sibr
 			pad_stream << std::setfill('0') << std::setw(10) << i - 2 << ".png";
 			std::string     image_path = sibr::parentDirectory(bundlerPath) + "/" + listImagePath + pad_stream.str();
 
-			sibr::Vector2u resolution(2, 2);
-			sibr::ImageRGB temp;
-			if (!temp.load(image_path)) {
+			// Only the image header is needed to get the resolution.
+			sibr::Vector2i resolution = sibr::readImageSize(image_path);
+			if (resolution.x() == 0) {
 
 				pad_stream.str("");
 				pad_stream << std::setfill('0') << std::setw(8) << i << ".jpg";
 				image_path = sibr::parentDirectory(bundlerPath) + "/" + listImagePath + pad_stream.str();
-				temp.load(image_path);
+				resolution = sibr::readImageSize(image_path);
 			}
-			resolution = temp.size();
 
 			if (resolution.x() < 0 || resolution.y() < 0)
 			{
@@ -15,6 +15,8 @@
 #include <core/graphics/Utils.hpp>
 #include "xatlas.h"
 
+#include <thread>
+
 int printCallback(const char * format, ...) {
 	va_list args;
 	va_start(args, format);
@@ -98,39 +100,175 @@ void rasterizeTriangle(uint8_t *dest, int destWidth, const int *t0, const int *t
 
 using namespace sibr;
 
-UVUnwrapper::UVUnwrapper(const sibr::Mesh& mesh, unsigned int res) : _mesh(mesh) {
+namespace {
+
+	/** Recursively split a set of triangles at the median of their centroids, along the longest axis, until each part is small enough. */
+	void splitSpatially(const sibr::Mesh & mesh, std::vector<uint> & triangles, size_t maxTriangles, std::vector<std::vector<uint> > & parts) {
+		if (triangles.size() <= maxTriangles) {
+			parts.emplace_back();
+			parts.back().swap(triangles);
+			return;
+		}
+		const auto & vertices = mesh.vertices();
+		const auto & tris = mesh.triangles();
+		auto centroid = [&](uint t) -> sibr::Vector3f {
+			return vertices[tris[t][0]] + vertices[tris[t][1]] + vertices[tris[t][2]];
+		};
+		Eigen::AlignedBox3f box;
+		for (uint t : triangles) {
+			box.extend(centroid(t));
+		}
+		int axis;
+		box.diagonal().maxCoeff(&axis);
+		const auto middle = triangles.begin() + triangles.size() / 2;
+		std::nth_element(triangles.begin(), middle, triangles.end(), [&](uint t0, uint t1) {
+			return centroid(t0)[axis] < centroid(t1)[axis];
+		});
+		std::vector<uint> left(triangles.begin(), middle);
+		std::vector<uint> right(middle, triangles.end());
+		triangles.clear();
+		triangles.shrink_to_fit();
+		splitSpatially(mesh, left, maxTriangles, parts);
+		splitSpatially(mesh, right, maxTriangles, parts);
+	}
+
+	/** Group the triangles of a mesh in clusters of similar sizes, made of connected components (large components being split spatially). */
+	std::vector<std::vector<uint> > splitInClusters(const sibr::Mesh & mesh, size_t clusterCount) {
+		const auto & tris = mesh.triangles();
+		const std::vector<std::vector<int> > components = mesh.removeDisconnectedComponents();
+		std::vector<uint> vertexComponent(mesh.vertices().size(), 0);
+		for (size_t c = 0; c < components.size(); ++c) {
+			for (int v : components[c]) {
+				vertexComponent[v] = uint(c);
+			}
+		}
+		std::vector<std::vector<uint> > componentTriangles(components.size());
+		for (size_t t = 0; t < tris.size(); ++t) {
+			componentTriangles[vertexComponent[tris[t][0]]].push_back(uint(t));
+		}
+
+		// Avoid clusters too small to be worth the overhead.
+		const size_t maxTriangles = std::max<size_t>(10000, (tris.size() + clusterCount - 1) / clusterCount);
+		std::vector<std::vector<uint> > parts;
+		for (auto & triangles : componentTriangles) {
+			if (!triangles.empty()) {
+				splitSpatially(mesh, triangles, maxTriangles, parts);
+			}
+		}
+		SIBR_LOG << "[UVMapper] Found " << components.size() << " connected components, split in " << parts.size() << " parts." << std::endl;
+
+		// Assign the largest parts first, each to the least loaded cluster.
+		std::sort(parts.begin(), parts.end(), [](const std::vector<uint> & p0, const std::vector<uint> & p1) {
+			return p0.size() > p1.size();
+		});
+		std::vector<std::vector<uint> > clusters(std::min(clusterCount, parts.size()));
+		for (auto & part : parts) {
+			auto & cluster = *std::min_element(clusters.begin(), clusters.end(), [](const std::vector<uint> & c0, const std::vector<uint> & c1) {
+				return c0.size() < c1.size();
+			});
+			cluster.insert(cluster.end(), part.begin(), part.end());
+		}
+		return clusters;
+	}
+
+	/** Geometry of a cluster, must stay alive until xatlas::AddMeshJoin returns. */
+	struct ClusterData {
+		std::vector<sibr::Vector3f> positions;
+		std::vector<sibr::Vector3f> normals;
+		std::vector<sibr::Vector2f> uvs;
+		std::vector<uint32_t> indices;
+	};
+
+	void addMesh(xatlas::Atlas * atlas, uint32_t vertexCount, const void * positions, const void * normals, const void * uvs, uint32_t indexCount, const void * indices) {
+		xatlas::MeshDecl meshDecl;
+		meshDecl.vertexCount = vertexCount;
+		meshDecl.vertexPositionData = positions;
+		meshDecl.vertexPositionStride = sizeof(sibr::Vector3f);
+		if (normals) {
+			meshDecl.vertexNormalData = normals;
+			meshDecl.vertexNormalStride = sizeof(sibr::Vector3f);
+		}
+		// UV can be used as a hint.
+		if (uvs) {
+			meshDecl.vertexUvData = uvs;
+			meshDecl.vertexUvStride = sizeof(sibr::Vector2f);
+		}
+		meshDecl.indexCount = indexCount;
+		meshDecl.indexData = indices;
+		meshDecl.indexFormat = xatlas::IndexFormat::UInt32;
+		const xatlas::AddMeshError error = xatlas::AddMesh(atlas, meshDecl, 1);
+		if (error != xatlas::AddMeshError::Success) {
+			xatlas::Destroy(atlas);
+			SIBR_ERR << "\r[UVMapper] Error adding mesh: " << xatlas::StringForEnum(error) << std::endl;
+		}
+	}
+}
+
+UVUnwrapper::UVUnwrapper(const sibr::Mesh& mesh, unsigned int res, unsigned int threads) : _mesh(mesh) {
 	_size = res;
+	_threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
 	// Create empty atlas.
 	xatlas::SetPrint(printCallback, false);
 	_atlas = xatlas::Create();
 	xatlas::SetProgressCallback(_atlas, progressCallback, nullptr);
 
-	// Add the mesh to the atlas.
-	SIBR_LOG << "[UVMapper] Adding one mesh with " << mesh.vertices().size() << " vertices and " << mesh.triangles().size() << " triangles." << std::endl;
-	// For now consider everything as one mesh. Splitting in components *might* help.
-	xatlas::MeshDecl meshDecl;
-	meshDecl.vertexCount = uint32_t(mesh.vertices().size());
-	meshDecl.vertexPositionData = mesh.vertexArray();
-	meshDecl.vertexPositionStride = sizeof(sibr::Vector3f);
-	if (mesh.hasNormals()) {
-		meshDecl.vertexNormalData = mesh.normalArray();
-		meshDecl.vertexNormalStride = sizeof(sibr::Vector3f);
+	Timer timer;
+	timer.tic();
+	// xatlas charts each mesh in a separate task: split the mesh in a few clusters per thread to balance the load.
+	std::vector<std::vector<uint> > clusterTriangles;
+	if (_threads > 1) {
+		clusterTriangles = splitInClusters(mesh, 4 * size_t(_threads));
 	}
-	// UV can be used as a hint.
-	if (mesh.hasTexCoords()) {
-		meshDecl.vertexUvData = mesh.texCoordArray();
-		meshDecl.vertexUvStride = sizeof(sibr::Vector2f);
+
+	std::vector<ClusterData> clusters(clusterTriangles.size());
+	if (clusterTriangles.size() <= 1) {
+		// Add the mesh to the atlas.
+		SIBR_LOG << "[UVMapper] Adding one mesh with " << mesh.vertices().size() << " vertices and " << mesh.triangles().size() << " triangles." << std::endl;
+		addMesh(_atlas, uint32_t(mesh.vertices().size()), mesh.vertexArray(),
+			mesh.hasNormals() ? mesh.normalArray() : nullptr, mesh.hasTexCoords() ? mesh.texCoordArray() : nullptr,
+			uint32_t(mesh.triangles().size() * 3), mesh.triangleArray());
 	}
-	meshDecl.indexCount = uint32_t(mesh.triangles().size() * 3);
-	meshDecl.indexData = mesh.triangleArray();
-	meshDecl.indexFormat = xatlas::IndexFormat::UInt32;
-	const xatlas::AddMeshError error = xatlas::AddMesh(_atlas, meshDecl, 1);
-	if (error != xatlas::AddMeshError::Success) {
-		xatlas::Destroy(_atlas);
-		SIBR_ERR << "\r[UVMapper] Error adding mesh: " << xatlas::StringForEnum(error) << std::endl;
+	else {
+		SIBR_LOG << "[UVMapper] Adding " << clusters.size() << " clusters, from a mesh with " << mesh.vertices().size() << " vertices and " << mesh.triangles().size() << " triangles." << std::endl;
+		_clusterVertices.resize(clusters.size());
+		const auto & tris = mesh.triangles();
+#pragma omp parallel for num_threads(int(_threads))
+		for (int c = 0; c < int(clusters.size()); ++c) {
+			// Reindex the vertices used by the cluster.
+			std::vector<uint> & vertices = _clusterVertices[c];
+			for (uint t : clusterTriangles[c]) {
+				vertices.insert(vertices.end(), tris[t].data(), tris[t].data() + 3);
+			}
+			std::sort(vertices.begin(), vertices.end());
+			vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+			ClusterData & cluster = clusters[c];
+			cluster.positions.reserve(vertices.size());
+			for (uint v : vertices) {
+				cluster.positions.push_back(mesh.vertices()[v]);
+				if (mesh.hasNormals()) {
+					cluster.normals.push_back(mesh.normals()[v]);
+				}
+				if (mesh.hasTexCoords()) {
+					cluster.uvs.push_back(mesh.texCoords()[v]);
+				}
+			}
+			cluster.indices.reserve(clusterTriangles[c].size() * 3);
+			for (uint t : clusterTriangles[c]) {
+				for (int k = 0; k < 3; ++k) {
+					cluster.indices.push_back(uint32_t(std::lower_bound(vertices.begin(), vertices.end(), tris[t][k]) - vertices.begin()));
+				}
+			}
+		}
+		for (const ClusterData & cluster : clusters) {
+			addMesh(_atlas, uint32_t(cluster.positions.size()), cluster.positions.data(),
+				cluster.normals.empty() ? nullptr : cluster.normals.data(), cluster.uvs.empty() ? nullptr : cluster.uvs.data(),
+				uint32_t(cluster.indices.size()), cluster.indices.data());
+		}
 	}
-	// Not necessary. Only called here so geometry totals are printed after the AddMesh progress indicator
+	// Wait for all meshes to be processed, cluster data is referenced until then.
 	xatlas::AddMeshJoin(_atlas);
+	SIBR_LOG << "[UVMapper] Adding geometry took: " << timer.deltaTimeFromLastTic<Timer::milli>() / 1000.0 << "s." << std::endl;
 }
 
 	
@@ -154,49 +292,51 @@ sibr::Mesh::Ptr UVUnwrapper::unwrap() {
 		SIBR_LOG << "[UVMapper] \tAtlas " << i << ": utilisation: " << _atlas->utilization[i] * 100.0f << "%" << std::endl;
 	}
 
-
-	uint32_t totalVertices = 0;
-	uint32_t totalFaces = 0;
+	// Offsets of each mesh in the output.
+	std::vector<uint32_t> firstVertices(_atlas->meshCount + 1, 0);
+	std::vector<uint32_t> firstFaces(_atlas->meshCount + 1, 0);
 	for (uint32_t i = 0; i < _atlas->meshCount; i++) {
 		const xatlas::Mesh& xmesh = _atlas->meshes[i];
-		totalVertices += xmesh.vertexCount;
-		totalFaces += xmesh.indexCount / 3;
+		firstVertices[i + 1] = firstVertices[i] + xmesh.vertexCount;
+		firstFaces[i + 1] = firstFaces[i] + xmesh.indexCount / 3;
 	}
+	const uint32_t totalVertices = firstVertices.back();
+	const uint32_t totalFaces = firstFaces.back();
 	SIBR_LOG << "[UVMapper] Output geometry data: " << totalVertices << " vertices, " << totalFaces << " triangles." << std::endl;
 	// Write meshes.
-	uint32_t firstVertex = 0;
-	std::vector<sibr::Vector3f> positions;
-	std::vector<sibr::Vector3f> normals;
-	std::vector<sibr::Vector2f> texcoords;
-	std::vector<sibr::Vector3f> colors;
-	std::vector<sibr::Vector3u> triangles;
+	std::vector<sibr::Vector3f> positions(totalVertices);
+	std::vector<sibr::Vector3f> normals(_mesh.hasNormals() ? totalVertices : 0);
+	std::vector<sibr::Vector2f> texcoords(totalVertices);
+	std::vector<sibr::Vector3f> colors(_mesh.hasColors() ? totalVertices : 0);
+	std::vector<sibr::Vector3u> triangles(totalFaces);
+	_mapping.resize(totalVertices);
 	
-	// We could preallocate and paraellize if needed.
-	for (uint32_t i = 0; i < _atlas->meshCount; i++) {
+#pragma omp parallel for num_threads(int(_threads))
+	for (int i = 0; i < int(_atlas->meshCount); i++) {
 		const xatlas::Mesh& xmesh = _atlas->meshes[i];
+		const uint32_t firstVertex = firstVertices[i];
 		for (uint32_t v = 0; v < xmesh.vertexCount; v++) {
 			const xatlas::Vertex& vertex = xmesh.vertexArray[v];
-			const sibr::Vector3f& pos = _mesh.vertices()[vertex.xref];
-			positions.emplace_back(pos);
+			// Clusters reference a subset of the input vertices.
+			const uint inputId = _clusterVertices.empty() ? vertex.xref : _clusterVertices[i][vertex.xref];
+			const uint32_t outputId = firstVertex + v;
+			positions[outputId] = _mesh.vertices()[inputId];
 			if (_mesh.hasNormals()) {
-				const sibr::Vector3f& n = _mesh.normals()[vertex.xref];
-				normals.emplace_back(n);
+				normals[outputId] = _mesh.normals()[inputId];
 			}
 			if (_mesh.hasColors()) {
-				const sibr::Vector3f& c = _mesh.colors()[vertex.xref];
-				colors.emplace_back(c);
+				colors[outputId] = _mesh.colors()[inputId];
 			}
 			
-			_mapping.emplace_back(vertex.xref);
-			texcoords.emplace_back(vertex.uv[0] / float(_atlas->width), vertex.uv[1] / float(_atlas->height));
+			_mapping[outputId] = inputId;
+			texcoords[outputId] = sibr::Vector2f(vertex.uv[0] / float(_atlas->width), vertex.uv[1] / float(_atlas->height));
 		}
 		for (uint32_t f = 0; f < xmesh.indexCount; f += 3) {
 			const uint32_t i0 = firstVertex + xmesh.indexArray[f + 0];
 			const uint32_t i1 = firstVertex + xmesh.indexArray[f + 1];
 			const uint32_t i2 = firstVertex + xmesh.indexArray[f + 2];
-			triangles.emplace_back(i0, i1, i2);
+			triangles[firstFaces[i] + f / 3] = sibr::Vector3u(i0, i1, i2);
 		}
-		firstVertex += xmesh.vertexCount;
 	}
 	Mesh::Ptr finalMesh(new Mesh(false));
 	finalMesh->vertices(positions);
@@ -252,8 +392,8 @@ std::vector<ImageRGB::Ptr> UVUnwrapper::atlasVisualization() const {
 	}
 	
 	// Convert raw vectors to images.
-	std::vector<ImageRGB::Ptr> views(_atlas->meshCount);
-	for (uint32_t i = 0; i < _atlas->meshCount; i++) {
+	std::vector<ImageRGB::Ptr> views(_atlas->atlasCount);
+	for (uint32_t i = 0; i < _atlas->atlasCount; i++) {
 		views[i].reset(new ImageRGB(_atlas->width, _atlas->height));
 		uint8_t *imageData = &outputChartsImage[i * imageDataSize];
 #pragma omp parallel for
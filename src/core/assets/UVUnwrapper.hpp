@@ -28,11 +28,13 @@ namespace sibr
 	class SIBR_ASSETS_EXPORT UVUnwrapper {
 	public:
 
-		/** Constructor.
+		/** Constructor. To chart large meshes in parallel, the mesh is split in clusters of connected components,
+		 * large components being split spatially, that are unwrapped concurrently and packed in the same atlas.
 		 *\param mesh the mesh to unwrap, if UVs are already present they will be used as a guide
 		 *\param res the target texture width, will determine UV accuracy
+		 *\param threads number of threads, determines the number of clusters (0 to use all cores, 1 to unwrap the mesh as a whole)
 		 */
-		UVUnwrapper(const sibr::Mesh& mesh, unsigned int res);
+		UVUnwrapper(const sibr::Mesh& mesh, unsigned int res, unsigned int threads = 0);
 
 		/** Unwrap the mesh, return a copy with UV coordinates. Note that some vertices might be duplicated if they are assigned different UVs in two faces.
 		 * \return the unwrapped mesh
@@ -58,6 +60,8 @@ namespace sibr
 		unsigned int _size; ///< Width of the atlas, detemrine the accuracy of the estimated UVs.
 		xatlas::Atlas* _atlas; ///< Atlas object.
 		std::vector<uint> _mapping; ///< Mapping from the new vertices to the old (some might be duplicated with different UV values).
+		std::vector<std::vector<uint> > _clusterVertices; ///< For each mesh in the atlas, the input index of its vertices (empty if the mesh was not split).
+		unsigned int _threads; ///< Number of threads.
 		
 	};
 }
@@ -77,7 +77,26 @@ namespace sibr
 		_planes[RIGHT].buildFrom( normal, nc + X*nw );
 	}
 
-	Frustum::TestResult	Frustum::testSphere(const Vector3f& p, float radius)
+	Frustum::Frustum(const Matrix4f& viewproj)
+	{
+		// Each clip plane is a combination of the last row and one of the other rows.
+		const Vector4f rows[4] = { viewproj.row(0).transpose(), viewproj.row(1).transpose(), viewproj.row(2).transpose(), viewproj.row(3).transpose() };
+		const Vector4f planes[COUNT] = {
+			rows[3] - rows[1], rows[3] + rows[1],
+			rows[3] + rows[0], rows[3] - rows[0],
+			rows[3] + rows[2], rows[3] - rows[2]
+		};
+		for (int i = 0; i < COUNT; ++i) {
+			const float norm = planes[i].head<3>().norm();
+			const Vector4f plane = norm > 0.0f ? Vector4f(planes[i] / norm) : planes[i];
+			_planes[i].A = plane.x();
+			_planes[i].B = plane.y();
+			_planes[i].C = plane.z();
+			_planes[i].D = plane.w();
+		}
+	}
+
+	Frustum::TestResult	Frustum::testSphere(const Vector3f& p, float radius) const
 	{
 		float distance;
 		TestResult result = INSIDE;
@@ -92,7 +111,24 @@ namespace sibr
 		return result;
 	}
 
-	float	Frustum::Plane::distanceWithPoint(const Vector3f& p)
+	Frustum::TestResult	Frustum::testBox(const Eigen::AlignedBox3f& box) const
+	{
+		TestResult result = INSIDE;
+
+		for (int i = 0; i < 6; i++) {
+			const Plane & plane = _planes[i];
+			// Corners of the box the furthest along and against the plane normal.
+			const Vector3f pmax(plane.A >= 0.0f ? box.max().x() : box.min().x(), plane.B >= 0.0f ? box.max().y() : box.min().y(), plane.C >= 0.0f ? box.max().z() : box.min().z());
+			const Vector3f pmin(plane.A >= 0.0f ? box.min().x() : box.max().x(), plane.B >= 0.0f ? box.min().y() : box.max().y(), plane.C >= 0.0f ? box.min().z() : box.max().z());
+			if (plane.distanceWithPoint(pmax) < 0.0f)
+				return OUTSIDE;
+			else if (plane.distanceWithPoint(pmin) < 0.0f)
+				result = INTERSECT;
+		}
+		return result;
+	}
+
+	float	Frustum::Plane::distanceWithPoint(const Vector3f& p) const
 	{
 		// dist = A*rx + B*ry + C*rz + D = n . r  + D
 		return A*p.x() + B*p.y() + C*p.z() + D;
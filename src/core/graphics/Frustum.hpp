@@ -48,7 +48,7 @@ namespace sibr
 			\param p 3D point
 			\return distance
 			*/
-			float	distanceWithPoint(const Vector3f& p);
+			float	distanceWithPoint(const Vector3f& p) const;
 
 			/** Build a plane from a normal and a point.
 			\param normal the normal
@@ -64,12 +64,24 @@ namespace sibr
 		*/
 		Frustum(const Camera& cam);
 
+		/** Construct the frustum from a projection matrix, also valid for orthographic and off-axis cameras.
+		\param viewproj the view-projection matrix (OpenGL convention)
+		*/
+		Frustum(const Matrix4f& viewproj);
+
 		/** Test if a sphere intersects the frustum or is contained in it.
 		\param sphere sphere center
 		\param radius sphere radis
 		\return if the sphere is inside, intersecting or outside the frustum
 		*/
-		TestResult	testSphere(const Vector3f& sphere, float radius);
+		TestResult	testSphere(const Vector3f& sphere, float radius) const;
+
+		/** Test if an axis-aligned box intersects the frustum or is contained in it.
+		\param box the box
+		\return if the box is inside, intersecting or outside the frustum
+		\note The test is conservative: some boxes close to the frustum corners are reported as intersecting.
+		*/
+		TestResult	testBox(const Eigen::AlignedBox3f& box) const;
 
 	private:
 
@@ -15,6 +15,7 @@
 # include "core/graphics/Config.hpp"
 # include "core/system/Vector.hpp"
 # include "core/system/ByteStream.hpp"
+# include "core/system/MemoryTracker.hpp"
 
 # pragma warning(push, 0)
 #  include <opencv2/core/core.hpp>
@@ -514,7 +515,13 @@ namespace sibr
 		*/
 		static Eigen::Matrix<float, T_NumComp, 1, Eigen::DontAlign> monoCubic(float t, const Eigen::Matrix<float, T_NumComp, 4, Eigen::DontAlign>& colors);
 
+		/** Update the size registered in the MemoryTracker after the pixels have been reallocated. 
+		Pixels reallocated externally through toOpenCVnonConst() are accounted for at the next update.
+		*/
+		void			updateAllocation(void) { _allocation.resize(_pixels.total() * _pixels.elemSize()); }
+
 		cv::Mat			_pixels; ///< Pixels stored in RGB format
+		MemoryTracker::Allocation _allocation { MemoryTracker::Category::Images }; ///< Memory accounting of the pixels.
 	};
 
 	/** Provides a wrapper around a pointer to an image. 
@@ -731,11 +738,15 @@ namespace sibr
 
 	template<typename T_Type, unsigned int T_NumComp>
 	Image<T_Type, T_NumComp>::Image(uint width, uint height) :
-		_pixels(height, width, opencvType()) { }
+		_pixels(height, width, opencvType()) {
+		updateAllocation();
+	}
 
 	template<typename T_Type, unsigned int T_NumComp>
 	Image<T_Type, T_NumComp>::Image(uint width, uint height, const T_Type& init) :
-		_pixels(height, width, opencvType(), init) { }
+		_pixels(height, width, opencvType(), init) {
+		updateAllocation();
+	}
 
 	template<typename T_Type, unsigned int T_NumComp>
 	Image<T_Type, T_NumComp>::Image(uint width, uint height, const Pixel& init)
@@ -745,7 +756,7 @@ namespace sibr
 			scal(i) = init(i);
 
 		_pixels = cv::Mat(height, width, opencvType(), scal);
-
+		updateAllocation();
 	}
 
 	template<typename T_Type, unsigned int T_NumComp>
@@ -756,6 +767,7 @@ namespace sibr
 	template<typename T_Type, unsigned int T_NumComp>
 	Image<T_Type, T_NumComp>& Image<T_Type, T_NumComp>::operator=(Image<T_Type, T_NumComp>&& other) noexcept {
 		_pixels = std::move(other._pixels);
+		_allocation = std::move(other._allocation);
 		return *this;
 	}
 
@@ -825,12 +837,14 @@ namespace sibr
 		}
 		else
 			_pixels = img;
+		updateAllocation();
 	}
 
 	template<typename T_Type, unsigned int T_NumComp>
 	Image<T_Type, T_NumComp>		Image<T_Type, T_NumComp>::clone(void) const {
 		Image<T_Type, T_NumComp> img;
 		img._pixels = _pixels.clone();
+		img.updateAllocation();
 		return img;
 	}
 
@@ -838,6 +852,7 @@ namespace sibr
 	ImagePtr<T_Type, T_NumComp>		Image<T_Type, T_NumComp>::clonePtr(void) const {
 		ImagePtr<T_Type, T_NumComp> img(new Image<T_Type, T_NumComp>());
 		img->_pixels = _pixels.clone();
+		img->updateAllocation();
 		return img;
 	}
 
@@ -882,6 +897,7 @@ namespace sibr
 		bs >> wIm >> hIm;
 
 		_pixels = cv::Mat(hIm, wIm, opencvType());
+		updateAllocation();
 		for (int y = 0; y < hIm; ++y)
 		{
 			for (int x = 0; x < wIm; ++x)
@@ -1111,6 +1127,7 @@ namespace sibr
 			return clone();
 		Image dst;
 		cv::resize(toOpenCV(), dst._pixels, cv::Size(width, height), 0, 0, cv_interpolation_method);
+		dst.updateAllocation();
 		return dst;
 	}
 
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include <fstream>
+#include <cstring>
+
+#include "core/graphics/ImageInfo.hpp"
+#include "core/graphics/Image.hpp"
+
+namespace sibr
+{
+	namespace
+	{
+		/** Read bytes at the current position, returns false if the file is too short. */
+		bool readBytes(std::ifstream & file, uint8_t * dst, size_t count)
+		{
+			file.read(reinterpret_cast<char*>(dst), std::streamsize(count));
+			return size_t(file.gcount()) == count;
+		}
+
+		uint32_t readBE(const uint8_t * p, size_t count)
+		{
+			uint32_t v = 0;
+			for (size_t i = 0; i < count; ++i) {
+				v = (v << 8) | p[i];
+			}
+			return v;
+		}
+
+		uint32_t readLE(const uint8_t * p, size_t count)
+		{
+			uint32_t v = 0;
+			for (size_t i = count; i > 0; --i) {
+				v = (v << 8) | p[i - 1];
+			}
+			return v;
+		}
+
+		bool readPNGInfo(std::ifstream & file, ImageInfo & info)
+		{
+			// Signature (8), IHDR length (4) and tag (4), then the IHDR content.
+			uint8_t header[29];
+			if (!readBytes(file, header, sizeof(header)) || std::memcmp(header + 12, "IHDR", 4) != 0) {
+				return false;
+			}
+			info.width = readBE(header + 16, 4);
+			info.height = readBE(header + 20, 4);
+			info.bitDepth = header[24];
+			switch (header[25]) {
+			case 0: info.channels = 1; break; // Grey
+			case 2: info.channels = 3; break; // RGB
+			case 3: info.channels = 3; info.bitDepth = 8; break; // Palette, expanded to RGB
+			case 4: info.channels = 2; break; // Grey + alpha
+			case 6: info.channels = 4; break; // RGBA
+			default: return false;
+			}
+			return true;
+		}
+
+		bool readJPEGInfo(std::ifstream & file, ImageInfo & info)
+		{
+			file.seekg(2, std::ios::beg);
+			uint8_t marker[2];
+			while (readBytes(file, marker, 2)) {
+				if (marker[0] != 0xFF) {
+					return false;
+				}
+				// Skip fill bytes.
+				while (marker[1] == 0xFF) {
+					if (!readBytes(file, marker + 1, 1)) {
+						return false;
+					}
+				}
+				const uint8_t type = marker[1];
+				// Standalone markers, without payload.
+				if (type == 0x01 || (type >= 0xD0 && type <= 0xD8)) {
+					continue;
+				}
+				// End of image or start of scan reached without a frame header.
+				if (type == 0xD9 || type == 0xDA) {
+					return false;
+				}
+				uint8_t lengthBytes[2];
+				if (!readBytes(file, lengthBytes, 2)) {
+					return false;
+				}
+				const uint32_t length = readBE(lengthBytes, 2);
+				if (length < 2) {
+					return false;
+				}
+				// Start of frame markers (all but DHT, JPG and DAC in the C0-CF range).
+				if (type >= 0xC0 && type <= 0xCF && type != 0xC4 && type != 0xC8 && type != 0xCC) {
+					uint8_t frame[6];
+					if (!readBytes(file, frame, sizeof(frame))) {
+						return false;
+					}
+					info.bitDepth = frame[0];
+					info.height = readBE(frame + 1, 2);
+					info.width = readBE(frame + 3, 2);
+					info.channels = frame[5];
+					return info.width > 0 && info.height > 0;
+				}
+				file.seekg(length - 2, std::ios::cur);
+			}
+			return false;
+		}
+
+		bool readEXRInfo(std::ifstream & file, ImageInfo & info)
+		{
+			// Magic number (4) and version/flags (4), then a list of attributes
+			// (name, type, size, value) terminated by an empty name.
+			file.seekg(8, std::ios::beg);
+			bool hasWindow = false;
+			info.channels = 0;
+			while (true) {
+				std::string name, type;
+				if (!std::getline(file, name, '\0')) {
+					return false;
+				}
+				if (name.empty()) {
+					break;
+				}
+				uint8_t sizeBytes[4];
+				if (!std::getline(file, type, '\0') || !readBytes(file, sizeBytes, 4)) {
+					return false;
+				}
+				const uint32_t size = readLE(sizeBytes, 4);
+				if (name == "dataWindow" && type == "box2i" && size == 16) {
+					uint8_t box[16];
+					if (!readBytes(file, box, sizeof(box))) {
+						return false;
+					}
+					const int32_t xMin = int32_t(readLE(box, 4)), yMin = int32_t(readLE(box + 4, 4));
+					const int32_t xMax = int32_t(readLE(box + 8, 4)), yMax = int32_t(readLE(box + 12, 4));
+					info.width = uint(xMax - xMin + 1);
+					info.height = uint(yMax - yMin + 1);
+					hasWindow = true;
+				}
+				else if (name == "channels" && type == "chlist") {
+					std::vector<uint8_t> list(size);
+					if (!readBytes(file, list.data(), size)) {
+						return false;
+					}
+					// Each channel: name, pixel type (4), pLinear + reserved (4), x and y sampling (8).
+					size_t pos = 0;
+					while (pos < list.size() && list[pos] != 0) {
+						while (pos < list.size() && list[pos] != 0) {
+							++pos;
+						}
+						pos += 1;
+						if (pos + 16 > list.size()) {
+							return false;
+						}
+						const uint32_t pixelType = readLE(&list[pos], 4);
+						info.bitDepth = std::max(info.bitDepth, pixelType == 1 ? 16u : 32u);
+						info.isFloat = info.isFloat || pixelType != 0;
+						++info.channels;
+						pos += 16;
+					}
+				}
+				else {
+					file.seekg(size, std::ios::cur);
+				}
+			}
+			return hasWindow && info.channels > 0;
+		}
+
+		bool readTIFFInfo(std::ifstream & file, const uint8_t * header, ImageInfo & info)
+		{
+			const bool little = header[0] == 'I';
+			auto read = [little](const uint8_t * p, size_t count) {
+				return little ? readLE(p, count) : readBE(p, count);
+			};
+			if (read(header + 2, 2) != 42) {
+				// BigTIFF and other variants are not handled.
+				return false;
+			}
+			file.seekg(read(header + 4, 4), std::ios::beg);
+			uint8_t countBytes[2];
+			if (!readBytes(file, countBytes, 2)) {
+				return false;
+			}
+			const uint32_t entryCount = read(countBytes, 2);
+			std::vector<uint8_t> entries(entryCount * 12);
+			if (!readBytes(file, entries.data(), entries.size())) {
+				return false;
+			}
+
+			info.channels = 1;
+			info.bitDepth = 1;
+			uint32_t bitsOffset = 0;
+			for (uint32_t e = 0; e < entryCount; ++e) {
+				const uint8_t * entry = &entries[e * 12];
+				const uint32_t tag = read(entry, 2);
+				const uint32_t type = read(entry + 2, 2);
+				const uint32_t count = read(entry + 4, 4);
+				// SHORT values are stored in the first bytes of the value field.
+				const uint32_t value = type == 3 ? read(entry + 8, 2) : read(entry + 8, 4);
+				switch (tag) {
+				case 256: info.width = value; break;
+				case 257: info.height = value; break;
+				case 258:
+					// Per-channel bits, stored at an offset when they don't fit in 4 bytes.
+					if (count * 2 > 4) {
+						bitsOffset = read(entry + 8, 4);
+					}
+					else {
+						info.bitDepth = value;
+					}
+					break;
+				case 277: info.channels = value; break;
+				case 339: info.isFloat = value == 3; break;
+				default: break;
+				}
+			}
+			if (bitsOffset != 0) {
+				uint8_t bits[2];
+				file.clear();
+				file.seekg(bitsOffset, std::ios::beg);
+				if (!readBytes(file, bits, 2)) {
+					return false;
+				}
+				info.bitDepth = read(bits, 2);
+			}
+			return info.width > 0 && info.height > 0;
+		}
+	}
+
+	bool readImageInfo(const std::string & filename, ImageInfo & info)
+	{
+		info = ImageInfo();
+		std::ifstream file(filename, std::ios::in | std::ios::binary);
+		if (!file) {
+			return false;
+		}
+		uint8_t magic[8];
+		if (!readBytes(file, magic, sizeof(magic))) {
+			return false;
+		}
+		file.seekg(0, std::ios::beg);
+
+		static const uint8_t pngMagic[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		if (std::memcmp(magic, pngMagic, 8) == 0) {
+			return readPNGInfo(file, info);
+		}
+		if (magic[0] == 0xFF && magic[1] == 0xD8) {
+			return readJPEGInfo(file, info);
+		}
+		if (magic[0] == 0x76 && magic[1] == 0x2F && magic[2] == 0x31 && magic[3] == 0x01) {
+			return readEXRInfo(file, info);
+		}
+		if ((magic[0] == 'I' && magic[1] == 'I') || (magic[0] == 'M' && magic[1] == 'M')) {
+			return readTIFFInfo(file, magic, info);
+		}
+		return false;
+	}
+
+	Vector2i readImageSize(const std::string & filename)
+	{
+		ImageInfo info;
+		if (readImageInfo(filename, info)) {
+			return info.size();
+		}
+		ImageRGB img;
+		if (!img.load(filename, false)) {
+			return Vector2i(0, 0);
+		}
+		return img.size().cast<int>();
+	}
+
+} // namespace sibr
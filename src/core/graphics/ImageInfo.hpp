@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+# include <string>
+
+# include "core/graphics/Config.hpp"
+# include "core/system/Vector.hpp"
+
+namespace sibr
+{
+	/** Image properties that can be read from a file header, without decoding pixels.
+	 * Values match what Image::load (with cv::IMREAD_UNCHANGED) would produce.
+	 * \ingroup sibr_graphics
+	 */
+	struct SIBR_GRAPHICS_EXPORT ImageInfo
+	{
+		uint width = 0; ///< Width in pixels.
+		uint height = 0; ///< Height in pixels.
+		uint channels = 0; ///< Number of channels stored in the file.
+		uint bitDepth = 0; ///< Bits per channel.
+		bool isFloat = false; ///< Are channels stored as floating point values.
+
+		/** \return the image size */
+		Vector2i size() const { return Vector2i(int(width), int(height)); }
+	};
+
+	/** Read the dimensions and format of an image from its header, without decoding it.
+	 * Supports JPEG, PNG, OpenEXR and TIFF files, other formats will fail.
+	 * \param filename the image path
+	 * \param info will contain the image properties
+	 * \return true if the header could be parsed
+	 * \ingroup sibr_graphics
+	 */
+	SIBR_GRAPHICS_EXPORT bool readImageInfo(const std::string & filename, ImageInfo & info);
+
+	/** Get the size of an image, reading only its header if possible
+	 * and falling back to a full load for unsupported formats.
+	 * \param filename the image path
+	 * \return the image size, or (0,0) if the image can't be read
+	 * \ingroup sibr_graphics
+	 */
+	SIBR_GRAPHICS_EXPORT Vector2i readImageSize(const std::string & filename);
+
+} // namespace sibr
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/graphics/ImagePyramid.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+namespace sibr
+{
+	namespace
+	{
+		const uint32_t cacheMagic = 0x52595053; ///< "SPYR", identifies pyramid cache files.
+	}
+
+	Vector2u IImagePyramid::size(int im, int level) const
+	{
+		return Vector2u(levelDimension(_sizes[im][0], level), levelDimension(_sizes[im][1], level));
+	}
+
+	Vector2u IImagePyramid::levelSize(int level) const
+	{
+		Vector2u maxSize(0, 0);
+		for (const Vector2u & imSize : _sizes) {
+			maxSize = maxSize.cwiseMax(imSize);
+		}
+		return Vector2u(levelDimension(maxSize[0], level), levelDimension(maxSize[1], level));
+	}
+
+	void IImagePyramid::evictOthers(int level)
+	{
+		for (int l = 0; l < _levels; ++l) {
+			if (l != level) {
+				evict(l);
+			}
+		}
+	}
+
+	uint IImagePyramid::levelDimension(uint dim, int level)
+	{
+		const uint scale = 1u << level;
+		return std::max(1u, (dim + scale - 1) / scale);
+	}
+
+	int IImagePyramid::levelCount(const Vector2u & size, uint minSize)
+	{
+		int levels = 1;
+		uint dim = size.maxCoeff();
+		while (dim / 2 >= minSize) {
+			dim = levelDimension(dim, 1);
+			++levels;
+		}
+		return levels;
+	}
+
+	void IImagePyramid::setup(int levels)
+	{
+		const int maxLevels = levelCount(levelSize(0), 1);
+		_levels = levels > 0 ? std::min(levels, maxLevels) : levelCount(levelSize(0));
+	}
+
+	std::string IImagePyramid::cachePath(int im, int level) const
+	{
+		const std::string & source = _sources[im];
+		const std::string absolute = boost::filesystem::absolute(source).string();
+		std::stringstream path;
+		path << _cacheDir << "/" << boost::filesystem::path(source).stem().string() << "_"
+			<< std::hex << std::hash<std::string>()(absolute) << std::dec << "_" << level << ".pyr";
+		return path.str();
+	}
+
+	bool IImagePyramid::cacheValid(int im, int level) const
+	{
+		const std::string path = cachePath(im, level);
+		boost::system::error_code ec;
+		if (!boost::filesystem::exists(path, ec)) {
+			return false;
+		}
+		const std::time_t sourceTime = boost::filesystem::last_write_time(_sources[im], ec);
+		if (ec) {
+			return false;
+		}
+		return boost::filesystem::last_write_time(path, ec) >= sourceTime && !ec;
+	}
+
+	bool IImagePyramid::writeCache(const std::string & path, const cv::Mat & mat)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+		const int32_t header[4] = { int32_t(cacheMagic), mat.cols, mat.rows, mat.type() };
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		const size_t rowBytes = size_t(mat.cols) * mat.elemSize();
+		for (int y = 0; y < mat.rows; ++y) {
+			file.write(reinterpret_cast<const char*>(mat.ptr(y)), rowBytes);
+		}
+		return bool(file);
+	}
+
+	bool IImagePyramid::readCache(const std::string & path, int type, cv::Mat & mat)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			return false;
+		}
+		int32_t header[4] = { 0, 0, 0, 0 };
+		file.read(reinterpret_cast<char*>(header), sizeof(header));
+		if (!file || header[0] != int32_t(cacheMagic) || header[3] != type || header[1] <= 0 || header[2] <= 0) {
+			return false;
+		}
+		mat.create(header[2], header[1], type);
+		file.read(reinterpret_cast<char*>(mat.data), std::streamsize(mat.total() * mat.elemSize()));
+		return bool(file);
+	}
+
+} // namespace sibr
@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/graphics/Config.hpp"
+#include "core/graphics/Image.hpp"
+#include "core/graphics/ImageInfo.hpp"
+#include "core/system/Utils.hpp"
+
+#include <string>
+#include <vector>
+
+namespace sibr
+{
+
+	/** Type independent part of an image pyramid: level sizes and disk cache handling.
+	 * Level l of an image of size (w,h) has size (ceil(w/2^l), ceil(h/2^l)).
+	 * \ingroup sibr_graphics
+	 */
+	class SIBR_GRAPHICS_EXPORT IImagePyramid
+	{
+	public:
+		SIBR_CLASS_PTR(IImagePyramid);
+
+		/// Destructor.
+		virtual ~IImagePyramid(void) = default;
+
+		/** \return the number of images */
+		int count(void) const { return int(_sizes.size()); }
+
+		/** \return the number of levels, the first one being the full resolution */
+		int levels(void) const { return _levels; }
+
+		/** \return the size of an image at a given level
+		 * \param im the image index
+		 * \param level the level
+		 */
+		Vector2u size(int im, int level) const;
+
+		/** \return the largest image size at a given level
+		 * \param level the level
+		 */
+		Vector2u levelSize(int level) const;
+
+		/** \return true if an image is currently loaded in memory at a given level
+		 * \param im the image index
+		 * \param level the level
+		 */
+		virtual bool resident(int im, int level) const = 0;
+
+		/** Make sure a set of images is loaded at a given level. Missing images are loaded in parallel.
+		 * \param ims the image indices
+		 * \param level the level
+		 */
+		virtual void load(const std::vector<int> & ims, int level) = 0;
+
+		/** Release images of a given level from memory. Images passed at construction are never released.
+		 * \param level the level
+		 * \param keep the image indices to keep loaded
+		 */
+		virtual void evict(int level, const std::vector<int> & keep = {}) = 0;
+
+		/** Release all images from memory, except those of a given level.
+		 * \param level the level to keep
+		 */
+		void evictOthers(int level);
+
+		/** Size of a dimension at a given level.
+		 * \param dim the full resolution size
+		 * \param level the level
+		 * \return the downscaled size, at least 1
+		 */
+		static uint levelDimension(uint dim, int level);
+
+		/** Number of levels needed to reach a given minimal size.
+		 * \param size the largest full resolution size
+		 * \param minSize the size under which no level is added
+		 * \return the number of levels, at least 1
+		 */
+		static int levelCount(const Vector2u & size, uint minSize = 16);
+
+	protected:
+
+		/** Compute the level count once image sizes are known.
+		 * \param levels the requested level count, 0 to go down to 16 pixels
+		 */
+		void setup(int levels);
+
+		/** \return the cache file of an image level
+		 * \param im the image index
+		 * \param level the level, above 0
+		 */
+		std::string cachePath(int im, int level) const;
+
+		/** \return true if the cache file of an image level exists and is more recent than the source image
+		 * \param im the image index
+		 * \param level the level, above 0
+		 */
+		bool cacheValid(int im, int level) const;
+
+		/** Write raw pixels to a cache file.
+		 * \param path the destination file
+		 * \param mat the pixels
+		 * \return false if the file could not be written
+		 */
+		static bool writeCache(const std::string & path, const cv::Mat & mat);
+
+		/** Read raw pixels from a cache file.
+		 * \param path the source file
+		 * \param type the expected OpenCV type
+		 * \param mat will contain the pixels
+		 * \return false if the file is missing or has another type
+		 */
+		static bool readCache(const std::string & path, int type, cv::Mat & mat);
+
+		std::vector<std::string> _sources; ///< Source image files, empty for in-memory pyramids.
+		std::vector<Vector2u> _sizes; ///< Full resolution size of each image.
+		std::string _cacheDir; ///< Directory of the cached levels, empty if no disk cache is used.
+		int _levels = 1; ///< Number of levels.
+		int _interpolation = cv::INTER_AREA; ///< OpenCV interpolation used to downscale.
+	};
+
+	/** Multi-resolution version of a set of images, each level being half the size of the previous one.
+	 * Images are only loaded in memory at the levels that are requested, and can be released afterwards.
+	 * - Built from images already in memory, the full resolution images are shared (not copied)
+	 * and coarser levels are computed from them when needed.
+	 * - Built from image files, all coarser levels are computed once in parallel and stored
+	 * in a disk cache, that is reused as long as it is more recent than the source images.
+	 *
+	 * Code example:
+	 *
+	 *		ImagePyramid<uchar, 3>::Ptr pyramid(new ImagePyramid<uchar, 3>(paths));
+	 *		pyramid->load({ 0, 1, 2 }, 3);
+	 *		const ImageRGB & thumbnail = pyramid->image(0, 3);
+	 *		pyramid->evictOthers(3);
+	 *
+	 * \ingroup sibr_graphics
+	 */
+	template<typename T_Type, unsigned int T_NumComp>
+	class ImagePyramid : public IImagePyramid
+	{
+	public:
+		typedef Image<T_Type, T_NumComp> ImageType;
+		typedef std::shared_ptr<ImagePyramid<T_Type, T_NumComp>> Ptr;
+
+		/** Constructor from images already loaded, that are shared by the pyramid.
+		 * \param images the full resolution images
+		 * \param levels the number of levels, 0 to go down to 16 pixels
+		 * \param interpolation the OpenCV interpolation used to downscale
+		 */
+		ImagePyramid(const std::vector<typename ImageType::Ptr> & images, int levels = 0, int interpolation = cv::INTER_AREA);
+
+		/** Constructor from image files. Missing or outdated cache levels are generated in parallel.
+		 * \param paths the image files
+		 * \param levels the number of levels, 0 to go down to 16 pixels
+		 * \param cacheDir where to store the levels, by default a "pyramids" directory next to the first image
+		 * \param interpolation the OpenCV interpolation used to downscale
+		 */
+		ImagePyramid(const std::vector<std::string> & paths, int levels = 0, const std::string & cacheDir = "", int interpolation = cv::INTER_AREA);
+
+		/** Access an image level, loading it if needed.
+		 * \param im the image index
+		 * \param level the level
+		 * \return the image
+		 */
+		const ImageType & image(int im, int level);
+
+		/** \copydoc IImagePyramid::resident */
+		bool resident(int im, int level) const override;
+
+		/** \copydoc IImagePyramid::load */
+		void load(const std::vector<int> & ims, int level) override;
+
+		/** \copydoc IImagePyramid::evict */
+		void evict(int level, const std::vector<int> & keep = {}) override;
+
+		/** \return the images of a level, with empty pointers for the images not loaded
+		 * \param level the level
+		 */
+		const std::vector<typename ImageType::Ptr> & loaded(int level) const { return _images[level]; }
+
+	private:
+
+		/** Downscale an image to the next level.
+		 * \param img the source image
+		 * \return the image at half resolution
+		 */
+		ImageType downscale(const ImageType & img) const;
+
+		/** Produce an image at a given level, from the cache or from the closest finer level available.
+		 * \param im the image index
+		 * \param level the level
+		 * \return the image
+		 */
+		typename ImageType::Ptr fetch(int im, int level) const;
+
+		/** Generate the missing cache levels of an image.
+		 * \param im the image index
+		 */
+		void buildCache(int im);
+
+		std::vector<std::vector<typename ImageType::Ptr>> _images; ///< Loaded images, per level then per image.
+		bool _pinned = false; ///< Are the full resolution images owned by the caller.
+	};
+
+	template<typename T_Type, unsigned int T_NumComp>
+	ImagePyramid<T_Type, T_NumComp>::ImagePyramid(const std::vector<typename ImageType::Ptr> & images, int levels, int interpolation)
+	{
+		_interpolation = interpolation;
+		_pinned = true;
+		_sizes.resize(images.size());
+		for (size_t im = 0; im < images.size(); ++im) {
+			_sizes[im] = Vector2u(images[im]->w(), images[im]->h());
+		}
+		setup(levels);
+		_images.resize(_levels, std::vector<typename ImageType::Ptr>(images.size()));
+		_images[0] = images;
+	}
+
+	template<typename T_Type, unsigned int T_NumComp>
+	ImagePyramid<T_Type, T_NumComp>::ImagePyramid(const std::vector<std::string> & paths, int levels, const std::string & cacheDir, int interpolation)
+	{
+		_interpolation = interpolation;
+		_sources = paths;
+		_cacheDir = cacheDir;
+		if (_cacheDir.empty() && !paths.empty()) {
+			_cacheDir = boost::filesystem::path(paths[0]).parent_path().string() + "/pyramids";
+		}
+		_sizes.resize(paths.size());
+#pragma omp parallel for
+		for (int im = 0; im < int(paths.size()); ++im) {
+			_sizes[im] = readImageSize(paths[im]).cast<uint>();
+		}
+		setup(levels);
+		_images.resize(_levels, std::vector<typename ImageType::Ptr>(paths.size()));
+
+		makeDirectory(_cacheDir);
+		SIBR_LOG << "[ImagePyramid] Checking " << _levels << " levels of " << paths.size() << " images in " << _cacheDir << "." << std::endl;
+#pragma omp parallel for schedule(dynamic)
+		for (int im = 0; im < int(paths.size()); ++im) {
+			buildCache(im);
+		}
+	}
+
+	template<typename T_Type, unsigned int T_NumComp>
+	const typename ImagePyramid<T_Type, T_NumComp>::ImageType & ImagePyramid<T_Type, T_NumComp>::image(int im, int level)
+	{
+		if (!_images[level][im]) {
+			_images[level][im] = fetch(im, level);
+		}
+		return *_images[level][im];
+	}
+
+	template<typename T_Type, unsigned int T_NumComp>
+	bool ImagePyramid<T_Type, T_NumComp>::resident(int im, int level) const
+	{
+		return bool(_images[level][im]);
+	}
+
+	template<typename T_Type, unsigned int T_NumComp>
+	void ImagePyramid<T_Type, T_NumComp>::load(const std::vector<int> & ims, int level)
+	{
+		std::vector<int> missing;
+		for (int im : ims) {
+			if (!_images[level][im]) {
+				missing.push_back(im);
+			}
+		}
+#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < int(missing.size()); ++i) {
+			_images[level][missing[i]] = fetch(missing[i], level);
+		}
+	}
+
+	template<typename T_Type, unsigned int T_NumComp>
+	void ImagePyramid<T_Type, T_NumComp>::evict(int level, const std::vector<int> & keep)
+	{
+		if (level == 0 && _pinned) {
+			return;
+		}
+		std::vector<bool> kept(_images[level].size(), false);
+		for (int im : keep) {
+			kept[im] = true;
+		}
+		for (size_t im = 0; im < _images[level].size(); ++im) {
+			if (!kept[im]) {
+				_images[level][im] = typename ImageType::Ptr();
+			}
+		}
+	}
+
+	template<typename T_Type, unsigned int T_NumComp>
+	typename ImagePyramid<T_Type, T_NumComp>::ImageType ImagePyramid<T_Type, T_NumComp>::downscale(const ImageType & img) const
+	{
+		return img.resized(int(levelDimension(img.w(), 1)), int(levelDimension(img.h(), 1)), _interpolation);
+	}
+
+	template<typename T_Type, unsigned int T_NumComp>
+	typename ImagePyramid<T_Type, T_NumComp>::ImageType::Ptr ImagePyramid<T_Type, T_NumComp>::fetch(int im, int level) const
+	{
+		typename ImageType::Ptr img(new ImageType());
+		if (!_sources.empty()) {
+			if (level == 0) {
+				img->load(_sources[im], false);
+				return img;
+			}
+			cv::Mat pixels;
+			if (readCache(cachePath(im, level), img->opencvType(), pixels)) {
+				img->fromOpenCV(pixels);
+				return img;
+			}
+		}
+		// Start from the closest finer level already in memory.
+		int source = level - 1;
+		while (source > 0 && !_images[source][im]) {
+			--source;
+		}
+		ImageType current = _images[source][im] ? _images[source][im]->clone() : fetch(im, source)->clone();
+		for (int l = source + 1; l <= level; ++l) {
+			current = downscale(current);
+		}
+		*img = std::move(current);
+		return img;
+	}
+
+	template<typename T_Type, unsigned int T_NumComp>
+	void ImagePyramid<T_Type, T_NumComp>::buildCache(int im)
+	{
+		int firstInvalid = 1;
+		while (firstInvalid < _levels && cacheValid(im, firstInvalid)) {
+			++firstInvalid;
+		}
+		if (firstInvalid == _levels) {
+			return;
+		}
+		ImageType current;
+		if (!current.load(_sources[im], false)) {
+			return;
+		}
+		for (int level = 1; level < _levels; ++level) {
+			current = downscale(current);
+			if (level >= firstInvalid && !writeCache(cachePath(im, level), current.toOpenCV())) {
+				SIBR_WRG << "[ImagePyramid] Unable to write " << cachePath(im, level) << "." << std::endl;
+			}
+		}
+	}
+
+} // namespace sibr
@@ -23,6 +23,7 @@
 
 #include "core/system/ByteStream.hpp"
 #include "core/graphics/MaterialMesh.hpp"
+#include "core/graphics/MeshReader.hpp"
 #include "core/system/Transform3.hpp"
 #include "boost/filesystem.hpp"
 #include "core/system/XMLTree.h"
@@ -36,6 +37,52 @@ namespace sibr
 	{
 
 		srand(static_cast <unsigned> (time(0)));
+
+		// PLY and OBJ files are parsed in parallel by the built-in reader, with one vertex set per material.
+		// Assimp handles other formats and unsupported features.
+		MeshReader::Data data;
+		if (MeshReader::read(filename, data, true) == MeshReader::Status::Success) {
+			_vertices.swap(data.vertices);
+			_normals.swap(data.normals);
+			_colors.swap(data.colors);
+			_texcoords.swap(data.texcoords);
+			_triangles.swap(data.triangles);
+			_matIds.swap(data.matIds);
+			_matId2Name.swap(data.materials);
+			_meshIds.swap(data.vertexMatIds);
+			_matIdsVertices.resize(_vertices.size());
+			_maxMeshId = size_t(int(_matId2Name.size()) - 1);
+
+			SIBR_LOG << "Mesh contains: colors: " << hasColors()
+				<< ", normals: " << hasNormals()
+				<< ", texcoords: " << hasTexCoords() << std::endl;
+
+			bool randomUV = true;
+			for (const Vector2f & uv : _texcoords) {
+				if (uv.x() != 0.f || uv.y() != 0.f) {
+					randomUV = false;
+					break;
+				}
+			}
+			if (randomUV) {
+				SIBR_LOG << "using random UVs." << std::endl;
+				_texcoords.resize(_vertices.size());
+				for (Vector2f & uv : _texcoords) {
+					float u = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+					float v = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+					uv = Vector2f(u * 5.f, v * 5.f);
+				}
+			}
+
+			SIBR_LOG << "Mesh '" << filename << " successfully loaded. " << _matId2Name.size() << " materials were loaded with a total of "
+				<< " (" << _triangles.size() << ") faces and "
+				<< " (" << _vertices.size() << ") vertices detected." << std::endl;
+			SIBR_LOG << "Init material part complete." << std::endl;
+
+			_gl.dirtyBufferGL = true;
+			return true;
+		}
+
 		Assimp::Importer	importer;
 		importer.SetPropertyBool(AI_CONFIG_PP_FD_REMOVE, true);
 		// cause Assimp to remove all degenerated faces as soon as they are detected
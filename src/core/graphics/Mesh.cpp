@@ -14,6 +14,7 @@
 #include <memory>
 #include <map>
 #include <queue>
+#include <algorithm>
 
 #include <assimp/Importer.hpp> // C++ importer interface
 #include <assimp/scene.h> // Output data structure
@@ -23,6 +24,8 @@
 
 #include "core/system/ByteStream.hpp"
 #include "core/graphics/Mesh.hpp"
+#include "core/graphics/MeshReader.hpp"
+#include "core/graphics/MeshWriter.hpp"
 
 #include "boost/filesystem.hpp"
 #include "core/system/XMLTree.h"
@@ -32,6 +35,151 @@
 
 namespace sibr
 {
+	namespace
+	{
+		/** Look for a mesh texture in the RealityCapture folder of a dataset and sample it at some vertices UVs.
+		\param dataset_path the dataset root
+		\param textureName the texture file name
+		\param uvs the vertices texture coordinates
+		\param offset the first vertex to sample
+		\param count the number of vertices to sample
+		\param colors will be resized if needed and receive the sampled colors
+		\return true if the texture was found
+		*/
+		bool sampleTextureColors(const std::string& dataset_path, const std::string& textureName, const Mesh::UVs& uvs, size_t offset, size_t count, Mesh::Colors& colors)
+		{
+			// TODO: make a clean function
+			std::string texFileName = dataset_path + "/capreal/" + textureName;
+			if (!fileExists(texFileName))
+				texFileName = parentDirectory(parentDirectory(dataset_path)) + "/capreal/" + textureName;
+			if (!fileExists(texFileName))
+				texFileName = parentDirectory(dataset_path) + "/capreal/" + textureName;
+			if (!fileExists(texFileName))
+				return false;
+
+			// Sample the texture
+			sibr::ImageRGB texImg;
+			texImg.load(texFileName);
+			std::cout << "Computing vertex colors ..";
+			colors.resize(offset + count);
+			for (size_t ci = 0; ci < count; ++ci)
+			{
+				Vector2f uv = uvs[offset + ci];
+				Vector3ub col = texImg((uv[0] * texImg.w()), uint((1 - uv[1]) * texImg.h()));
+				colors[offset + ci] = Vector3f(float(col[0]) / 255.0, float(col[1]) / 255.0, float(col[2]) / 255.0);
+			}
+			SIBR_WRG << "Done." << std::endl;
+			return true;
+		}
+
+		/** Order triangles for a vertex cache, using Tipsify (Sander et al., 2007): triangles are emitted
+		in fans around vertices, the next fan vertex being a recently used vertex that will still be in the cache.
+		\param tris the triangles
+		\param vertexCount the number of vertices
+		\param cacheSize the vertex cache size
+		\param clusterStarts will contain the position of the first triangle of each cluster in the new order; clusters can be reordered without hurting the cache much
+		\return the new triangle order
+		*/
+		std::vector<uint> tipsify(const Mesh::Triangles& tris, size_t vertexCount, uint cacheSize, std::vector<size_t>& clusterStarts)
+		{
+			// Triangles around each vertex.
+			std::vector<uint> offsets(vertexCount + 1, 0);
+			for (const Vector3u& t : tris) {
+				++offsets[t[0] + 1]; ++offsets[t[1] + 1]; ++offsets[t[2] + 1];
+			}
+			for (size_t v = 0; v < vertexCount; ++v) {
+				offsets[v + 1] += offsets[v];
+			}
+			std::vector<uint> adjacency(offsets.back());
+			std::vector<uint> fill(offsets.begin(), offsets.end() - 1);
+			for (uint t = 0; t < uint(tris.size()); ++t) {
+				for (int k = 0; k < 3; ++k) {
+					adjacency[fill[tris[t][k]]++] = t;
+				}
+			}
+
+			std::vector<int> live(vertexCount);
+			for (size_t v = 0; v < vertexCount; ++v) {
+				live[v] = int(offsets[v + 1] - offsets[v]);
+			}
+			std::vector<int> cacheTime(vertexCount, 0);
+			std::vector<bool> emitted(tris.size(), false);
+			std::vector<uint> deadEnd, candidates;
+			std::vector<uint> order;
+			order.reserve(tris.size());
+
+			// Clusters are split when the cache is cold anyway, or when they get large (at the cost of a cache refill).
+			const size_t maxClusterSize = 16 * size_t(cacheSize);
+			clusterStarts.assign(1, 0);
+
+			const int cache = int(cacheSize);
+			int time = cache + 1;
+			size_t cursor = 0;
+			int fan = vertexCount > 0 ? 0 : -1;
+			while (fan >= 0) {
+				candidates.clear();
+				for (uint i = offsets[fan]; i < offsets[fan + 1]; ++i) {
+					const uint t = adjacency[i];
+					if (emitted[t]) {
+						continue;
+					}
+					emitted[t] = true;
+					order.push_back(t);
+					for (int k = 0; k < 3; ++k) {
+						const uint v = tris[t][k];
+						deadEnd.push_back(v);
+						candidates.push_back(v);
+						--live[v];
+						if (time - cacheTime[v] > cache) {
+							cacheTime[v] = time++;
+						}
+					}
+				}
+
+				// Prefer the oldest candidate that will still be in the cache after its fan is emitted.
+				int next = -1;
+				int bestPriority = -1;
+				for (const uint v : candidates) {
+					if (live[v] <= 0) {
+						continue;
+					}
+					int priority = 0;
+					if (time - cacheTime[v] + 2 * live[v] <= cache) {
+						priority = time - cacheTime[v];
+					}
+					if (priority > bestPriority) {
+						bestPriority = priority;
+						next = int(v);
+					}
+				}
+				bool jumped = false;
+				if (next < 0) {
+					jumped = true;
+					while (next < 0 && !deadEnd.empty()) {
+						const uint v = deadEnd.back();
+						deadEnd.pop_back();
+						if (live[v] > 0) {
+							next = int(v);
+						}
+					}
+					while (next < 0 && cursor < vertexCount) {
+						if (live[cursor] > 0) {
+							next = int(cursor);
+						}
+						else {
+							++cursor;
+						}
+					}
+				}
+
+				if (next >= 0 && order.size() > clusterStarts.back() && (jumped || order.size() - clusterStarts.back() >= maxClusterSize)) {
+					clusterStarts.push_back(order.size());
+				}
+				fan = next;
+			}
+			return order;
+		}
+	}
 
 	Mesh::Mesh(bool withGraphics) : _meshPath("") {
 		if (withGraphics) {
@@ -44,87 +192,16 @@ namespace sibr
 
 	bool		Mesh::saveToObj(const std::string& filename)  const
 	{
-		aiScene scene;
-		scene.mRootNode = new aiNode();
-
-		scene.mMaterials = new aiMaterial * [1];
-		scene.mMaterials[0] = nullptr;
-		scene.mNumMaterials = 1;
-
-		scene.mMaterials[0] = new aiMaterial();
-
-		scene.mMeshes = new aiMesh * [1];
-		scene.mNumMeshes = 1;
-
-		scene.mMeshes[0] = new aiMesh();
-		scene.mMeshes[0]->mMaterialIndex = 0;
-
-		scene.mRootNode->mMeshes = new unsigned int[1];
-		scene.mRootNode->mMeshes[0] = 0;
-		scene.mRootNode->mNumMeshes = 1;
-
-		auto pMesh = scene.mMeshes[0];
-
-		const auto& vVertices = _vertices;
-
-		pMesh->mVertices = new aiVector3D[vVertices.size()];
-		pMesh->mNumVertices = static_cast<unsigned int>(vVertices.size());
-
-		if (hasNormals()) {
-			pMesh->mNormals = new aiVector3D[vVertices.size()];
-		}
-		else {
-			pMesh->mNormals = nullptr;
-		}
-
-		if (hasTexCoords()) {
-			pMesh->mTextureCoords[0] = new aiVector3D[vVertices.size()];
-			pMesh->mNumUVComponents[0] = 2;
-		}
-		else {
-			pMesh->mTextureCoords[0] = nullptr;
-			pMesh->mNumUVComponents[0] = 0;
-		}
-
-		int j = 0;
-		for (auto itr = vVertices.begin(); itr != vVertices.end(); ++itr)
-		{
-			pMesh->mVertices[itr - vVertices.begin()] = aiVector3D(vVertices[j].x(), vVertices[j].y(), vVertices[j].z());
-			if (hasNormals())
-				pMesh->mNormals[itr - vVertices.begin()] = aiVector3D(_normals[j].x(), _normals[j].y(), _normals[j].z());
-			if (hasTexCoords())
-				pMesh->mTextureCoords[0][itr - vVertices.begin()] = aiVector3D(_texcoords[j][0], _texcoords[j][1], 0);
-			j++;
-		}
-
-		pMesh->mFaces = new aiFace[_triangles.size()];
-		pMesh->mNumFaces = (unsigned int)(_triangles.size());
-
-		for (uint i = 0; i < _triangles.size(); ++i)
-		{
-			const Vector3u& tri = _triangles[i];
-			aiFace& face = pMesh->mFaces[i];
-			face.mIndices = new unsigned int[3];
-			face.mNumIndices = 3;
-
-			face.mIndices[0] = tri[0];
-			face.mIndices[1] = tri[1];
-			face.mIndices[2] = tri[2];
+		SIBR_LOG << "Saving '" << filename << "'..." << std::endl;
+		if (!MeshWriter::writeOBJ(*this, filename)) {
+			return false;
 		}
-		Assimp::Exporter mAiExporter;
-		const aiScene* s = (const aiScene*)&(scene);
-
-		SIBR_LOG << "Saving (via ASSIMP) " << filename << "'..." << std::endl;
-		mAiExporter.Export(s, "obj", filename);
-
-		// mesh and scene destructors free memory
-
-
+		SIBR_LOG << "Saving '" << filename << "'... done" << std::endl;
 		return true;
 	}
 
 
-	bool		Mesh::saveToBinaryPLY(const std::string& filename, bool universal, const std::string& textureName)  const
+	bool		Mesh::saveToBinaryPLY(const std::string& filename, bool universal, const std::string& textureName, bool littleEndian)  const
 	{
 		assert(_vertices.size());
 
@@ -136,239 +213,63 @@ namespace sibr
 		// In addition, at this time there is no control/ExportProperties.
 		// Thus I just do it myself.
 
-		std::ofstream	file(filename.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
-
-		if (file)
-		{
-			file << "ply" << std::endl;
-			file << "format binary_big_endian 1.0" << std::endl;
-			file << "comment Created by SIBR project" << std::endl;
-			if (hasTexCoords())
-			{
-				file << "comment TextureFile " << textureName << std::endl;
-			}
-			file << "element vertex " << _vertices.size() << std::endl;
-			file << "property float x" << std::endl;
-			file << "property float y" << std::endl;
-			file << "property float z" << std::endl;
-			if (hasColors())
-			{
-				if (universal)
-				{
-					file << "property uchar red" << std::endl;
-					file << "property uchar green" << std::endl;
-					file << "property uchar blue" << std::endl;
-				}
-				else
-				{
-					file << "property ushort red" << std::endl;
-					file << "property ushort green" << std::endl;
-					file << "property ushort blue" << std::endl;
-				}
-
-			}
-			if (hasNormals())
-			{
-				file << "property float nx" << std::endl;
-				file << "property float ny" << std::endl;
-				file << "property float nz" << std::endl;
-			}
-			if (hasTexCoords())
-			{
-				file << "property float texture_u" << std::endl;
-				file << "property float texture_v" << std::endl;
-			}
-
-			file << "element face " << _triangles.size() << std::endl;
-			file << "property list uchar uint vertex_indices" << std::endl;
-			file << "end_header" << std::endl;
-
-			/// BINARY version /////
-			ByteStream	bytes;
-
-			for (uint i = 0; i < _vertices.size(); ++i)
-			{
-				const Vector3f& v = _vertices[i];
-
-				bytes << float(v[0]) << float(v[1]) << float(v[2]);
-
-				if (hasColors())
-				{
-					const Vector3f& c = _colors[i];
-					if (universal)
-						bytes
-						<< uint8(c[0] * (UINT8_MAX - 1))
-						<< uint8(c[1] * (UINT8_MAX - 1))
-						<< uint8(c[2] * (UINT8_MAX - 1)); // ! converting colors explicitly
-					else
-						bytes
-						<< uint16(c[0] * (UINT16_MAX - 1))
-						<< uint16(c[1] * (UINT16_MAX - 1))
-						<< uint16(c[2] * (UINT16_MAX - 1)); // ! converting colors explicitly
-				}
-
-				if (hasNormals())
-				{
-					const Vector3f& n = _normals[i];
-
-					bytes << float(n[0]) << float(n[1]) << float(n[2]);
-				}
-
-				if (hasTexCoords())
-				{
-					const Vector2f& uv = _texcoords[i];
-
-					bytes << float(uv[0]) << float(uv[1]);
-				}
-			}
-
-			for (uint i = 0; i < _triangles.size(); ++i)
-			{
-				const Vector3u& tri = _triangles[i];
-
-				bytes << uint8(3);
-				for (uint j = 0; j < 3; ++j)
-					bytes << uint32(tri[j]);
-			}
-
-			file.write(reinterpret_cast<const char*>(bytes.buffer()), bytes.bufferSize());
-			file.close();
-			SIBR_LOG << "Saving '" << filename << "'... done" << std::endl;
-			return true;
+		const MeshWriter::Encoding encoding = littleEndian ? MeshWriter::Encoding::BinaryLittleEndian : MeshWriter::Encoding::BinaryBigEndian;
+		if (!MeshWriter::writePLY(*this, filename, encoding, universal, textureName)) {
+			return false;
 		}
-		SIBR_LOG << "error: cannot write to file '" << filename << "'." << std::endl;
-		return false;
-
+		SIBR_LOG << "Saving '" << filename << "'... done" << std::endl;
+		return true;
 	}
 
 	bool		Mesh::saveToASCIIPLY(const std::string& filename, bool universal, const std::string& textureName) const
 	{
 		assert(_vertices.size());
 
-		// Note that Assimp supports also export for some formats. However,
-		// when I tried with the current Assimp version (3.0) it failed to
-		// do a good export for .ply (using binary version).
-		// In addition, at this time there is no control/ExportProperties.
-		// Thus I just do it myself.
-
-		std::ofstream	file(filename.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
-
-		if (file)
-		{
-			file << "ply" << std::endl;
-			file << "format ascii 1.0" << std::endl;
-			file << "comment Created by SIBR project" << std::endl;
-			if (hasTexCoords())
-			{
-				file << "comment TextureFile " << textureName << std::endl;
-			}
-			file << "element vertex " << _vertices.size() << std::endl;
-			file << "property float x" << std::endl;
-			file << "property float y" << std::endl;
-			file << "property float z" << std::endl;
-
-			if (hasColors())
-			{
-				if (universal)
-				{
-					file << "property uchar red" << std::endl;
-					file << "property uchar green" << std::endl;
-					file << "property uchar blue" << std::endl;
-				}
-				else
-				{
-					file << "property ushort red" << std::endl;
-					file << "property ushort green" << std::endl;
-					file << "property ushort blue" << std::endl;
-				}
-			}
+		if (!MeshWriter::writePLY(*this, filename, MeshWriter::Encoding::ASCII, universal, textureName)) {
+			return false;
+		}
+		SIBR_LOG << "'" << filename << "' saved." << std::endl;
+		return true;
+	}
 
-			if (hasNormals())
-			{
-				file << "property float nx" << std::endl;
-				file << "property float ny" << std::endl;
-				file << "property float nz" << std::endl;
-			}
+	bool	Mesh::load(const std::string& filename, const std::string& dataset_path )
+	{
+		// Does the file exists?
+		if (!sibr::fileExists(filename)) {
+			SIBR_LOG << "Error: can't load mesh '" << filename << "." << std::endl;
+			return false;
+		}
 
-			if (hasTexCoords())
-			{
-				file << "property float texture_u" << std::endl;
-				file << "property float texture_v" << std::endl;
+		// PLY and OBJ files are parsed in parallel by the built-in reader, Assimp handles other formats and unsupported features.
+		MeshReader::Data data;
+		if (MeshReader::read(filename, data) == MeshReader::Status::Success) {
+			_vertices.swap(data.vertices);
+			_normals.swap(data.normals);
+			_colors.swap(data.colors);
+			_texcoords.swap(data.texcoords);
+			_triangles.swap(data.triangles);
+			_textureImageFileName = data.textureFile;
+			if (!_textureImageFileName.empty()) {
+				std::cerr << "Texture name " << _textureImageFileName << std::endl;
 			}
 
-			file << "element face " << _triangles.size() << std::endl;
-			file << "property list uchar uint vertex_indices" << std::endl;
-			file << "end_header" << std::endl;
-
-			/////// ASCII version /////
+			SIBR_LOG << "Mesh contains: colors: " << hasColors()
+				<< ", normals: " << hasNormals()
+				<< ", texcoords: " << hasTexCoords() << std::endl;
 
-			for (uint i = 0; i < _vertices.size(); ++i)
-			{
-				const Vector3f& v = _vertices[i];
-
-				file << v[0] << " " << v[1] << " " << v[2] << " ";
-
-				if (hasColors())
-				{
-					const Vector3f& c = _colors[i];
-
-					if (universal)
-					{
-						file << int(c[0] * (UINT8_MAX - 1)) << " "
-							<< int(c[1] * (UINT8_MAX - 1)) << " "
-							<< int(c[2] * (UINT8_MAX - 1)) << " ";
-					}
-					else
-					{
-						file << int(c[0] * (UINT16_MAX - 1)) << " "
-							<< int(c[1] * (UINT16_MAX - 1)) << " "
-							<< int(c[2] * (UINT16_MAX - 1)) << " ";
-					}
-				}
-
-				if (hasNormals())
-				{
-					const Vector3f& n = _normals[i];
-
-					file << n[0] << " " << n[1] << " " << n[2] << " ";
-				}
-
-				if (hasTexCoords())
-				{
-					const Vector2f& uv = _texcoords[i];
-
-					file << uv[0] << " " << uv[1] << " ";
-				}
-
-				file << std::endl;
+			if (hasTexCoords() && !hasColors()) {
+				sampleTextureColors(dataset_path, _textureImageFileName, _texcoords, 0, _vertices.size(), _colors);
 			}
 
-			for (uint i = 0; i < _triangles.size(); ++i)
-			{
-				const Vector3u& tri = _triangles[i];
-
-				file << 3;
-				for (uint j = 0; j < 3; ++j)
-					file << " " << tri[j];
-				file << std::endl;
-			}
+			_meshPath = filename;
+			SIBR_LOG << "Mesh '" << filename << " successfully loaded with a total of "
+				<< " (" << _triangles.size() << ") faces and "
+				<< " (" << _vertices.size() << ") vertices detected." << std::endl;
 
-			file.close();
-			SIBR_LOG << "'" << filename << "' saved." << std::endl;
+			_gl.dirtyBufferGL = true;
 			return true;
 		}
-		SIBR_LOG << "error: cannot write to file '" << filename << "'." << std::endl;
-		return false;
-
-	}
 
-	bool	Mesh::load(const std::string& filename, const std::string& dataset_path )
-	{
-		// Does the file exists?
-		if (!sibr::fileExists(filename)) {
-			SIBR_LOG << "Error: can't load mesh '" << filename << "." << std::endl;
-			return false;
-		}
 		Assimp::Importer	importer;
 		//importer.SetPropertyBool(AI_CONFIG_PP_FD_REMOVE, true); // cause Assimp to remove all degenerated faces as soon as they are detected
 		const aiScene* scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_FindDegenerates);
@@ -446,26 +347,8 @@ namespace sibr
 				_texcoords.resize(offsetVertices + mesh->mNumVertices);
 				for (uint i = 0; i < mesh->mNumVertices; ++i)
 					_texcoords[offsetVertices + i] = convertVec(mesh->mTextureCoords[0][i]).xy();
-				// TODO: make a clean function
-				std::string texFileName = dataset_path + "/capreal/" + _textureImageFileName;
-				if( !fileExists(texFileName))
-					texFileName = parentDirectory(parentDirectory(dataset_path)) + "/capreal/" + _textureImageFileName;
-				if( !fileExists(texFileName))
-					texFileName = parentDirectory(dataset_path) + "/capreal/" + _textureImageFileName;
-
-				if (!mesh->HasVertexColors(0) && fileExists(texFileName)) {
-					// Sample the texture
-					sibr::ImageRGB texImg;
-					texImg.load(texFileName);
-					std::cout << "Computing vertex colors ..";
-					_colors.resize(offsetVertices + mesh->mNumVertices);
-					for (uint ci = 0; ci < mesh->mNumVertices; ++ci)
-					{
-						Vector2f uv = _texcoords[offsetVertices + ci];
-						Vector3ub col = texImg((uv[0]*texImg.w()), uint((1-uv[1])*texImg.h()));
-						_colors[offsetVertices + ci] = Vector3f(float(col[0]) / 255.0, float(col[1]) / 255.0, float(col[2]) / 255.0);
-					}
-					SIBR_WRG << "Done." << std::endl;
+				if (!mesh->HasVertexColors(0)) {
+					sampleTextureColors(dataset_path, _textureImageFileName, _texcoords, offsetVertices, mesh->mNumVertices, _colors);
 				}
 			}
 			if (meshId == 0) {
@@ -1242,6 +1125,42 @@ namespace sibr
 		_gl.bufferGL->build(*this, adjacency);
 	}
 
+	void	Mesh::updateBufferGL(bool adjacency) const
+	{
+		if (!_gl.dirtyBufferGL) {
+			return;
+		}
+		if (_uploadBudget > 0 && !adjacency) {
+			_gl.dirtyBufferGL = false;
+			_gl.bufferGL->beginUpload(*this, _uploadBudget);
+		}
+		else {
+			forceBufferGLUpdate(adjacency);
+		}
+	}
+
+	bool	Mesh::isUploading(void) const
+	{
+		return _gl.bufferGL && _gl.bufferGL->isUploading();
+	}
+
+	void	Mesh::vertexFormat(MeshBufferGL::VertexFormat format)
+	{
+		if (format != _vertexFormat) {
+			_vertexFormat = format;
+			_gl.dirtyBufferGL = true;
+		}
+	}
+
+	Matrix4f	Mesh::positionDecodeMatrix(void) const
+	{
+		if (_vertexFormat == MeshBufferGL::VertexFormat::FULL || !_gl.bufferGL) {
+			return Matrix4f::Identity();
+		}
+		updateBufferGL(_renderingOptions.adjacency);
+		return _gl.bufferGL->positionDecode();
+	}
+
 	void	Mesh::freeBufferGLUpdate(void) const
 	{
 		_gl.dirtyBufferGL = false;
@@ -1265,8 +1184,9 @@ namespace sibr
 		_renderingOptions.invertDepthTest = invertDepthTest;
 		_renderingOptions.tessellation = tessellation;
 
-		if (_gl.dirtyBufferGL)
-			forceBufferGLUpdate(adjacency);
+		updateBufferGL(adjacency);
+		if (_gl.bufferGL->isUploading())
+			_gl.bufferGL->uploadStep();
 
 		if (depthTest)
 			glEnable(GL_DEPTH_TEST);
@@ -1330,7 +1250,8 @@ namespace sibr
 		bool invertDepthTest
 	) const {
 		if (!_gl.bufferGL) { SIBR_ERR << "Tried to render a non OpenGL Mesh" << std::endl; return; }
-		if (_gl.dirtyBufferGL)
+		// Ranges can refer to data not uploaded yet.
+		if (_gl.dirtyBufferGL || _gl.bufferGL->isUploading())
 			forceBufferGLUpdate();
 
 		if (depthTest)
@@ -2063,6 +1984,139 @@ namespace sibr
 		return (float)(sumSizes / (3 * triangles().size()));
 	}
 
+	void Mesh::optimizeForRendering(uint cacheSize, bool reduceOverdraw)
+	{
+		if (_triangles.empty()) {
+			return;
+		}
+		const float acmrBefore = computeACMR(cacheSize);
+
+		std::vector<size_t> clusterStarts;
+		const std::vector<uint> order = tipsify(_triangles, _vertices.size(), cacheSize, clusterStarts);
+		clusterStarts.push_back(order.size());
+		const int clusterCount = int(clusterStarts.size()) - 1;
+
+		// Draw clusters facing away from the mesh center first, they are more likely to occlude the others.
+		std::vector<int> clusters(clusterCount);
+		for (int c = 0; c < clusterCount; ++c) {
+			clusters[c] = c;
+		}
+		if (reduceOverdraw && clusterCount > 1) {
+			std::vector<Vector3f> clusterCenters(clusterCount), clusterNormals(clusterCount);
+			std::vector<float> clusterAreas(clusterCount);
+#pragma omp parallel for
+			for (int c = 0; c < clusterCount; ++c) {
+				Vector3f center(0.0f, 0.0f, 0.0f), normal(0.0f, 0.0f, 0.0f);
+				float area = 0.0f;
+				for (size_t i = clusterStarts[c]; i < clusterStarts[c + 1]; ++i) {
+					const Vector3u& t = _triangles[order[i]];
+					const Vector3f n = (_vertices[t[1]] - _vertices[t[0]]).cross(_vertices[t[2]] - _vertices[t[0]]);
+					const float triangleArea = 0.5f * n.norm();
+					center += triangleArea * (_vertices[t[0]] + _vertices[t[1]] + _vertices[t[2]]) / 3.0f;
+					normal += n;
+					area += triangleArea;
+				}
+				clusterCenters[c] = area > 0.0f ? Vector3f(center / area) : _vertices[_triangles[order[clusterStarts[c]]][0]];
+				clusterNormals[c] = normal.normalized();
+				clusterAreas[c] = area;
+			}
+			Vector3f meshCenter(0.0f, 0.0f, 0.0f);
+			float meshArea = 0.0f;
+			for (int c = 0; c < clusterCount; ++c) {
+				meshCenter += clusterAreas[c] * clusterCenters[c];
+				meshArea += clusterAreas[c];
+			}
+			if (meshArea > 0.0f) {
+				meshCenter /= meshArea;
+			}
+			std::vector<float> occlusion(clusterCount);
+			for (int c = 0; c < clusterCount; ++c) {
+				occlusion[c] = (clusterCenters[c] - meshCenter).dot(clusterNormals[c]);
+			}
+			std::stable_sort(clusters.begin(), clusters.end(), [&occlusion](int c0, int c1) {
+				return occlusion[c0] > occlusion[c1];
+			});
+		}
+
+		// Renumber vertices by first use, unused vertices are kept at the end.
+		const uint unused = uint(-1);
+		std::vector<uint> newIds(_vertices.size(), unused);
+		std::vector<uint> oldIds;
+		oldIds.reserve(_vertices.size());
+		Triangles newTriangles;
+		newTriangles.reserve(_triangles.size());
+		for (const int c : clusters) {
+			for (size_t i = clusterStarts[c]; i < clusterStarts[c + 1]; ++i) {
+				Vector3u t = _triangles[order[i]];
+				for (int k = 0; k < 3; ++k) {
+					if (newIds[t[k]] == unused) {
+						newIds[t[k]] = uint(oldIds.size());
+						oldIds.push_back(t[k]);
+					}
+					t[k] = newIds[t[k]];
+				}
+				newTriangles.push_back(t);
+			}
+		}
+		for (uint v = 0; v < uint(_vertices.size()); ++v) {
+			if (newIds[v] == unused) {
+				oldIds.push_back(v);
+			}
+		}
+
+		Vertices newVertices(_vertices.size());
+		Normals newNormals(hasNormals() ? _vertices.size() : 0);
+		Colors newColors(hasColors() ? _vertices.size() : 0);
+		UVs newTexCoords(hasTexCoords() ? _vertices.size() : 0);
+#pragma omp parallel for
+		for (int v = 0; v < int(oldIds.size()); ++v) {
+			newVertices[v] = _vertices[oldIds[v]];
+			if (!newNormals.empty()) {
+				newNormals[v] = _normals[oldIds[v]];
+			}
+			if (!newColors.empty()) {
+				newColors[v] = _colors[oldIds[v]];
+			}
+			if (!newTexCoords.empty()) {
+				newTexCoords[v] = _texcoords[oldIds[v]];
+			}
+		}
+		vertices(newVertices);
+		triangles(newTriangles);
+		if (hasNormals()) {
+			normals(newNormals);
+		}
+		if (hasColors()) {
+			colors(newColors);
+		}
+		if (hasTexCoords()) {
+			texCoords(newTexCoords);
+		}
+
+		SIBR_LOG << "[Mesh] Optimized triangle order, ACMR " << acmrBefore << " -> " << computeACMR(cacheSize)
+			<< " (" << clusterCount << " clusters)." << std::endl;
+	}
+
+	float Mesh::computeACMR(uint cacheSize) const
+	{
+		if (_triangles.empty()) {
+			return 0.0f;
+		}
+		// FIFO cache: a vertex is evicted after cacheSize misses.
+		const size_t notCached = std::numeric_limits<size_t>::max();
+		std::vector<size_t> insertTime(_vertices.size(), notCached);
+		size_t misses = 0;
+		for (const Vector3u& t : _triangles) {
+			for (int k = 0; k < 3; ++k) {
+				size_t& inserted = insertTime[t[k]];
+				if (inserted == notCached || misses - inserted >= cacheSize) {
+					inserted = misses++;
+				}
+			}
+		}
+		return float(misses) / float(_triangles.size());
+	}
+
 	Mesh::Ptr Mesh::clone() const
 	{
 		auto outMesh = std::make_shared<sibr::Mesh>(_gl.bufferGL != nullptr);
@@ -2080,6 +2134,8 @@ namespace sibr
 		if (hasTexCoords()) {
 			outMesh->texCoords(texCoords());
 		}
+		outMesh->vertexFormat(vertexFormat());
+		outMesh->uploadBudget(uploadBudget());
 
 		return outMesh;
 	}
@@ -2210,7 +2266,7 @@ namespace sibr
 		vertices(newVerts);
 	}
 
-	std::vector<std::vector<int> > Mesh::removeDisconnectedComponents()
+	std::vector<std::vector<int> > Mesh::removeDisconnectedComponents() const
 	{
 		std::vector<std::vector<int> > allComponents;
 
@@ -256,8 +256,9 @@ namespace sibr
 		 \param filename the file path
 		 \param universal indicates if you want this mesh to be readable by most 3d viewer application (e.g. MeshLab). In this other case, the mesh will be saved with higher-precision custom PLY attributes.
 		 \param textureName name of a texture to reference in the file (Meshlab compatible) 
+		 \param littleEndian write a little endian file instead of the default big endian one (faster on most hosts)
 		*/
-		bool		saveToBinaryPLY( const std::string& filename, bool universal=false, const std::string& textureName = "TEXTURE_NAME_TO_PUT_IN_THE_FILE") const;
+		bool		saveToBinaryPLY( const std::string& filename, bool universal=false, const std::string& textureName = "TEXTURE_NAME_TO_PUT_IN_THE_FILE", bool littleEndian=false) const;
 		
 		/** Save the mesh to .ply file (using the ASCII version).
 		 \param filename the file path
@@ -269,6 +270,7 @@ namespace sibr
 
 		/** Save the mesh to .obj file.
 		 \param filename the file path
+		 \note a material library with a default material is written next to the file.
 		 \warning the vertex colros won't be saved
 		*/
 		bool		saveToObj( const std::string& filename) const;
@@ -321,6 +323,36 @@ namespace sibr
 			bool invertDepthTest = false
 		) const;
 
+		/** Select how vertex attributes are stored on the GPU. The compact format uses less than half the memory,
+		but shaders have to decode positions with positionDecodeMatrix() and octahedral normals
+		(vertex shaders can #include "compact_vertex.glsl" for this).
+		\param format the new format
+		\sa MeshBufferGL::compactError
+		*/
+		void	vertexFormat( MeshBufferGL::VertexFormat format );
+
+		/** \return how vertex attributes are stored on the GPU */
+		MeshBufferGL::VertexFormat	vertexFormat( void ) const { return _vertexFormat; }
+
+		/** \return the transformation to apply to vertex positions in shaders, identity unless the compact format is used.
+		\note GPU data will be updated if needed.
+		*/
+		Matrix4f	positionDecodeMatrix( void ) const;
+
+		/** Upload GPU data progressively when it changes, to avoid stalling the rendering of large meshes.
+		A worker thread prepares the data and each render() call copies a bounded part of it to the GPU,
+		only drawing the triangles already available. Other rendering functions and forceBufferGLUpdate()
+		still upload everything at once.
+		\param bytesPerFrame maximum size copied by each render() call, 0 to upload everything at once (default)
+		*/
+		void	uploadBudget( size_t bytesPerFrame ) { _uploadBudget = bytesPerFrame; }
+
+		/** \return the maximum size copied to the GPU by each render() call, 0 if uploads are not progressive */
+		size_t	uploadBudget( void ) const { return _uploadBudget; }
+
+		/** \return true if a progressive upload is not complete yet */
+		bool	isUploading( void ) const;
+
 		/** Force upload of data to the GPU.
 		\param adjacency should we give adjacent triangles info in buffer
 		*/
@@ -405,10 +437,26 @@ namespace sibr
 		/** \return the mean edge size computed over all triangles. */
 		float meanEdgeSize() const;
 
+		/** Reorder triangles and vertices for faster rendering, using Tipsify (Sander et al., 2007).
+		Triangles are ordered for the GPU post-transform vertex cache, then clusters of triangles are
+		sorted so that outward facing parts of the mesh are drawn first, reducing overdraw. Vertices are
+		finally renumbered in order of first use, for vertex fetch locality. The ACMR before and after is logged.
+		\param cacheSize the simulated vertex cache size
+		\param reduceOverdraw sort clusters of triangles to reduce overdraw
+		\warning Vertex indices change, per-triangle or per-vertex data stored outside of the mesh won't match anymore.
+		*/
+		void optimizeForRendering(uint cacheSize = 16, bool reduceOverdraw = true);
+
+		/** Compute the average cache miss ratio of the mesh triangle order, for a FIFO vertex cache.
+		\param cacheSize the simulated vertex cache size
+		\return the number of vertices transformed per triangle, between 0.5 (best) and 3 (worst)
+		*/
+		float computeACMR(uint cacheSize = 16) const;
+
 		/** Split a mesh in its connected components. 
 		\return a list of list of vertex indices, each list defining a component
 		*/
-		std::vector<std::vector<int> > removeDisconnectedComponents();
+		std::vector<std::vector<int> > removeDisconnectedComponents() const;
 
 		/** Generate a simple cube with normals.
 		\param withGraphics should the mesh be on the GPU
@@ -481,6 +529,13 @@ namespace sibr
 		std::string _meshPath; ///< Source path, can be used to reload the mesh with/without graphics option in constructor
 		std::string _textureImageFileName; // filename of texture image
 		mutable RenderingOptions _renderingOptions; // Keeps last rendering options
+		MeshBufferGL::VertexFormat _vertexFormat = MeshBufferGL::VertexFormat::FULL; ///< GPU storage of vertex attributes.
+		size_t _uploadBudget = 0; ///< Maximum size of each progressive upload step, 0 to upload at once.
+
+		/** Upload GPU data if needed, progressively if enabled.
+		\param adjacency should we give adjacent triangles info in buffer
+		*/
+		void	updateBufferGL( bool adjacency ) const;
 	};
 
 	///// DEFINITION /////
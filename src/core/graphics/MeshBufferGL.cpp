@@ -15,6 +15,10 @@
 #include "core/graphics/MeshBufferGL.hpp"
 
 #include <unordered_map>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
 
 namespace sibr
 {
@@ -64,6 +68,136 @@ namespace sibr
 	{
 		return (uint)(sizeof(T)*v.size());
 	}
+
+	/** Convert a float to a half float, rounding to nearest even. */
+	static uint16_t		floatToHalf( float value )
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(float));
+		const uint32_t sign = (bits >> 16) & 0x8000;
+		const uint32_t floatExponent = (bits >> 23) & 0xFF;
+		uint32_t mantissa = bits & 0x7FFFFF;
+		if (floatExponent == 0xFF) {
+			// Infinity or NaN.
+			return uint16_t(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+		}
+		const int exponent = int(floatExponent) - 127 + 15;
+		if (exponent >= 31) {
+			return uint16_t(sign | 0x7C00);
+		}
+		uint32_t shift = 13;
+		uint32_t half = sign | (uint32_t(std::max(exponent, 0)) << 10);
+		if (exponent <= 0) {
+			// Denormal half.
+			if (exponent < -10) {
+				return uint16_t(sign);
+			}
+			mantissa |= 0x800000;
+			shift = uint32_t(14 - exponent);
+		}
+		half |= mantissa >> shift;
+		const uint32_t remainder = mantissa & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1))) {
+			// Can carry into the exponent, which is the expected rounding.
+			++half;
+		}
+		return uint16_t(half);
+	}
+
+	/** Convert a half float to a float. */
+	static float		halfToFloat( uint16_t half )
+	{
+		const uint32_t sign = uint32_t(half & 0x8000) << 16;
+		uint32_t exponent = (half >> 10) & 0x1F;
+		uint32_t mantissa = half & 0x3FF;
+		uint32_t bits;
+		if (exponent == 0x1F) {
+			bits = sign | 0x7F800000 | (mantissa << 13);
+		} else if (exponent != 0) {
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		} else if (mantissa == 0) {
+			bits = sign;
+		} else {
+			exponent = 113;
+			while ((mantissa & 0x400) == 0) {
+				mantissa <<= 1;
+				--exponent;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+		}
+		float value;
+		std::memcpy(&value, &bits, sizeof(float));
+		return value;
+	}
+
+	/** Quantize a value in [-1,1] as a normalized signed short, the inverse of the GL conversion. */
+	static int16_t		toSnorm16( float value )
+	{
+		return int16_t(std::round(std::max(-1.0f, std::min(1.0f, value)) * 32767.0f));
+	}
+
+	/** Map a unit vector to the octahedron unfolded on the [-1,1] square, as two normalized signed shorts. */
+	static std::array<int16_t, 2>	octEncode( const Vector3f& n )
+	{
+		const float l1 = std::abs(n.x()) + std::abs(n.y()) + std::abs(n.z());
+		if (l1 <= 0.0f) {
+			return { 0, 0 };
+		}
+		float x = n.x() / l1;
+		float y = n.y() / l1;
+		if (n.z() < 0.0f) {
+			const float fx = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			const float fy = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = fx;
+			y = fy;
+		}
+		return { toSnorm16(x), toSnorm16(y) };
+	}
+
+	/** Inverse of octEncode, matching the GLSL decoding in shaders. */
+	static Vector3f		octDecode( const std::array<int16_t, 2>& e )
+	{
+		const float x = std::max(float(e[0]) / 32767.0f, -1.0f);
+		const float y = std::max(float(e[1]) / 32767.0f, -1.0f);
+		Vector3f n(x, y, 1.0f - std::abs(x) - std::abs(y));
+		const float t = std::max(-n.z(), 0.0f);
+		n.x() += n.x() >= 0.0f ? -t : t;
+		n.y() += n.y() >= 0.0f ? -t : t;
+		return n.normalized();
+	}
+
+	/** Bounding box used to quantize positions, with a non-null extent on each axis. */
+	static void			positionQuantization( const Mesh& mesh, Vector3f& offset, Vector3f& scale )
+	{
+		const Eigen::AlignedBox<float, 3> box = mesh.getBoundingBox();
+		if (box.isEmpty()) {
+			offset = Vector3f(0.0f, 0.0f, 0.0f);
+			scale = Vector3f(1.0f, 1.0f, 1.0f);
+			return;
+		}
+		offset = box.min();
+		scale = box.diagonal().cwiseMax(1e-20f);
+	}
+
+	/** Transformation from the stored positions of a mesh to its positions, for a given storage format. */
+	static Matrix4f		positionDecoding( const Mesh& mesh, VertexFormat format )
+	{
+		Matrix4f decode = Matrix4f::Identity();
+		if (format != VertexFormat::FULL) {
+			Vector3f offset, scale;
+			positionQuantization(mesh, offset, scale);
+			decode.block<3, 3>(0, 0) = scale.asDiagonal();
+			decode.block<3, 1>(0, 3) = offset;
+		}
+		return decode;
+	}
+
+	/** Quantize a position in [offset, offset+scale] as a normalized unsigned short. */
+	static uint16_t		toUnorm16( float value, float offset, float scale )
+	{
+		return uint16_t(std::round(std::max(0.0f, std::min(1.0f, (value - offset) / scale)) * 65535.0f));
+	}
 	//===========================================================================
 
 	MeshBufferGL::MeshBufferGL( void )
@@ -82,17 +216,28 @@ namespace sibr
 		_bufferIds			(std::move(other._bufferIds)),
 		_indexCount			(std::move(other._indexCount)),
 		_adjacentIndexCount	(std::move(other._adjacentIndexCount)),
-		_vertexCount		(std::move(other._vertexCount))
+		_vertexCount		(std::move(other._vertexCount)),
+		_vertexFormat		(other._vertexFormat),
+		_positionDecode		(other._positionDecode),
+		_vertexBytes		(other._vertexBytes),
+		_upload				(std::move(other._upload)),
+		_allocation			(std::move(other._allocation))
 	{
 	}
 
 	MeshBufferGL& MeshBufferGL::operator =( MeshBufferGL&& other )
 	{
+		stopUpload();
 		_vaoId				= std::move(other._vaoId);
 		_bufferIds			= std::move(other._bufferIds);
 		_indexCount			= std::move(other._indexCount);
 		_adjacentIndexCount	= std::move(other._adjacentIndexCount);
 		_vertexCount		= std::move(other._vertexCount);
+		_vertexFormat		= other._vertexFormat;
+		_positionDecode		= other._positionDecode;
+		_vertexBytes		= other._vertexBytes;
+		_upload				= std::move(other._upload);
+		_allocation			= std::move(other._allocation);
 
 		return *this;
 	}
@@ -166,6 +311,8 @@ namespace sibr
 
 	void 	MeshBufferGL::build( const Mesh& mesh, bool adjacency )
 	{
+		stopUpload();
+
 		if (!_vaoId)
 		{
 			glGenVertexArrays(1, &_vaoId);
@@ -181,49 +328,21 @@ namespace sibr
 		if(adjacency)
 			fetchIndices(mesh, true);
 
-		uint numVertices = (uint)mesh.vertices().size();
-		_vertexCount = numVertices;
-		//SIBR_DEBUG(mesh.triangles().size());
-		std::vector<GLfloat> vertices = prepareVertexData<GLfloat>(
-			mesh.vertices(), numVertices);
-		std::vector<GLfloat> colors = prepareVertexData<GLfloat>(
-			mesh.colors(), numVertices);
-		std::vector<GLfloat> texcoords = prepareVertexData<GLfloat>(
-			mesh.texCoords(), numVertices);
-		std::vector<GLfloat> normals = prepareVertexData<GLfloat>(
-			mesh.normals(), numVertices);
-
-		// Following this order:
-		//VertexAttribLocation		= 0,
-		//ColorAttribLocation		= 1,
-		//TexCoordAttribLocation	= 2,
-		//NormalAttribLocation		= 3,
+		_vertexCount = (uint)mesh.vertices().size();
+		_vertexFormat = mesh.vertexFormat();
 
 		// Every data (from different types) are all put together into vertexData
-		std::vector<uint8> 	vertexData;
-		vertexData.reserve(
-			getVectorDataSize(vertices)	+
-			getVectorDataSize(colors)	+
-			getVectorDataSize(texcoords)+
-			getVectorDataSize(normals));
-
-		appendVertexData(vertexData, vertices);
-		appendVertexData(vertexData, colors);
-		appendVertexData(vertexData, texcoords);
-		appendVertexData(vertexData, normals);
+		const VertexLayout layout = vertexLayout(mesh, _vertexFormat);
+		std::vector<uint8> 	vertexData(layout.size);
+		packVertices(mesh, _vertexFormat, layout, vertexData.data(), _positionDecode);
 
 		glBindBuffer(GL_ARRAY_BUFFER, _bufferIds[BUFVERTEX]);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(uint8)*vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
+		_vertexBytes = vertexData.size();
+		_allocation.resize(_vertexBytes + sizeof(GLuint) * (size_t(_indexCount) + _adjacentIndexCount));
 		CHECK_GL_ERROR;
 
-		glVertexAttribPointer(VertexAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, (uint8_t*)(0));
-		glEnableVertexAttribArray(VertexAttribLocation);
-		glVertexAttribPointer(ColorAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, (uint8_t*)(0) + getVectorDataSize(vertices));
-		glEnableVertexAttribArray(ColorAttribLocation);
-		glVertexAttribPointer(TexCoordAttribLocation, 2, GL_FLOAT, GL_FALSE, 0, (uint8_t*)(0) + getVectorDataSize(vertices) + getVectorDataSize(colors));
-		glEnableVertexAttribArray(TexCoordAttribLocation);
-		glVertexAttribPointer(NormalAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, (uint8_t*)(0) + getVectorDataSize(vertices) + getVectorDataSize(colors) + getVectorDataSize(texcoords));
-		glEnableVertexAttribArray(NormalAttribLocation);
+		setupAttributes(layout, _vertexFormat);
 
 		/// \todo TODO:
 		/// We could ignore attrib that are empty (where mesh.colors().empty() == true, don't do anything with this).
@@ -232,12 +351,372 @@ namespace sibr
 		glBindVertexArray(0);
 	}
 
+	MeshBufferGL::VertexLayout	MeshBufferGL::vertexLayout( const Mesh& mesh, VertexFormat format )
+	{
+		const size_t numVertices = mesh.vertices().size();
+		const bool compact = format == VertexFormat::COMPACT;
+		// Following the AttribLocation order. Compact positions are padded to 8 bytes to keep attributes aligned.
+		const std::array<size_t, AttribLocationCount> sizes = {
+			numVertices * (compact ? 4 * sizeof(uint16_t) : 3 * sizeof(float)),
+			mesh.hasColors() ? numVertices * (compact ? 4 * sizeof(uint8) : 3 * sizeof(float)) : 0,
+			mesh.hasTexCoords() ? numVertices * (compact ? 2 * sizeof(uint16_t) : 2 * sizeof(float)) : 0,
+			mesh.hasNormals() ? numVertices * (compact ? 2 * sizeof(int16_t) : 3 * sizeof(float)) : 0
+		};
+
+		VertexLayout layout;
+		for (int a = 0; a < AttribLocationCount; ++a) {
+			layout.offsets[a] = layout.size;
+			layout.size += sizes[a];
+		}
+		return layout;
+	}
+
+	void	MeshBufferGL::packVertices( const Mesh& mesh, VertexFormat format, const VertexLayout& layout, uint8* dst, Matrix4f& positionDecode )
+	{
+		const int numVertices = int(mesh.vertices().size());
+		const bool hasColors = mesh.hasColors();
+		const bool hasTexCoords = mesh.hasTexCoords();
+		const bool hasNormals = mesh.hasNormals();
+
+		positionDecode = positionDecoding(mesh, format);
+		if (format == VertexFormat::FULL) {
+			std::memcpy(dst + layout.offsets[VertexAttribLocation], mesh.vertexArray(), numVertices * sizeof(Vector3f));
+			if (hasColors) {
+				std::memcpy(dst + layout.offsets[ColorAttribLocation], mesh.colorArray(), numVertices * sizeof(Vector3f));
+			}
+			if (hasTexCoords) {
+				std::memcpy(dst + layout.offsets[TexCoordAttribLocation], mesh.texCoordArray(), numVertices * sizeof(Vector2f));
+			}
+			if (hasNormals) {
+				std::memcpy(dst + layout.offsets[NormalAttribLocation], mesh.normalArray(), numVertices * sizeof(Vector3f));
+			}
+			return;
+		}
+
+		const Vector3f offset = positionDecode.block<3, 1>(0, 3);
+		const Vector3f scale = positionDecode.block<3, 3>(0, 0).diagonal();
+
+		uint16_t* positions = reinterpret_cast<uint16_t*>(dst + layout.offsets[VertexAttribLocation]);
+		uint8* colors = dst + layout.offsets[ColorAttribLocation];
+		uint16_t* texCoords = reinterpret_cast<uint16_t*>(dst + layout.offsets[TexCoordAttribLocation]);
+		int16_t* normals = reinterpret_cast<int16_t*>(dst + layout.offsets[NormalAttribLocation]);
+
+#pragma omp parallel for
+		for (int v = 0; v < numVertices; ++v) {
+			const Vector3f& p = mesh.vertices()[v];
+			for (int c = 0; c < 3; ++c) {
+				positions[4 * v + c] = toUnorm16(p[c], offset[c], scale[c]);
+			}
+			positions[4 * v + 3] = 0;
+			if (hasColors) {
+				const Vector3f& color = mesh.colors()[v];
+				for (int c = 0; c < 3; ++c) {
+					colors[4 * v + c] = uint8(std::round(std::max(0.0f, std::min(1.0f, color[c])) * 255.0f));
+				}
+				colors[4 * v + 3] = 255;
+			}
+			if (hasTexCoords) {
+				texCoords[2 * v] = floatToHalf(mesh.texCoords()[v].x());
+				texCoords[2 * v + 1] = floatToHalf(mesh.texCoords()[v].y());
+			}
+			if (hasNormals) {
+				const std::array<int16_t, 2> n = octEncode(mesh.normals()[v]);
+				normals[2 * v] = n[0];
+				normals[2 * v + 1] = n[1];
+			}
+		}
+
+		const size_t fullSize = vertexLayout(mesh, VertexFormat::FULL).size;
+		SIBR_LOG << "[MeshBufferGL] Compact vertex data: " << float(layout.size) / (1024.0f * 1024.0f) << "MB instead of "
+			<< float(fullSize) / (1024.0f * 1024.0f) << "MB for " << numVertices << " vertices." << std::endl;
+	}
+
+	void	MeshBufferGL::setupAttributes( const VertexLayout& layout, VertexFormat format )
+	{
+		const std::array<size_t, AttribLocationCount>& offsets = layout.offsets;
+		if (format == VertexFormat::COMPACT) {
+			glVertexAttribPointer(VertexAttribLocation, 3, GL_UNSIGNED_SHORT, GL_TRUE, 4 * sizeof(uint16_t), (uint8_t*)(0) + offsets[VertexAttribLocation]);
+			glVertexAttribPointer(ColorAttribLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (uint8_t*)(0) + offsets[ColorAttribLocation]);
+			glVertexAttribPointer(TexCoordAttribLocation, 2, GL_HALF_FLOAT, GL_FALSE, 0, (uint8_t*)(0) + offsets[TexCoordAttribLocation]);
+			glVertexAttribPointer(NormalAttribLocation, 2, GL_SHORT, GL_TRUE, 0, (uint8_t*)(0) + offsets[NormalAttribLocation]);
+		}
+		else {
+			glVertexAttribPointer(VertexAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, (uint8_t*)(0) + offsets[VertexAttribLocation]);
+			glVertexAttribPointer(ColorAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, (uint8_t*)(0) + offsets[ColorAttribLocation]);
+			glVertexAttribPointer(TexCoordAttribLocation, 2, GL_FLOAT, GL_FALSE, 0, (uint8_t*)(0) + offsets[TexCoordAttribLocation]);
+			glVertexAttribPointer(NormalAttribLocation, 3, GL_FLOAT, GL_FALSE, 0, (uint8_t*)(0) + offsets[NormalAttribLocation]);
+		}
+		for (int a = 0; a < AttribLocationCount; ++a) {
+			glEnableVertexAttribArray(a);
+		}
+	}
+
+	struct MeshBufferGL::Upload
+	{
+		/** Staging slots go through these states, in a ring. */
+		enum class SlotState { FREE, FILLED, COPYING };
+
+		/** Part of the staging buffer. */
+		struct Slot
+		{
+			SlotState state = SlotState::FREE; ///< Current state.
+			uint target = BUFVERTEX; ///< Destination buffer.
+			size_t offset = 0; ///< Destination offset, in bytes.
+			size_t size = 0; ///< Size of the data.
+			GLsync fence = nullptr; ///< Signaled once the GPU is done copying.
+		};
+
+		/** Worker thread: pack the data and fill the staging slots in order. */
+		void run( void )
+		{
+			std::vector<uint8> vertexData(layout.size);
+			// The position decoding was already published by beginUpload.
+			Matrix4f decode;
+			packVertices(mesh, mesh.vertexFormat(), layout, vertexData.data(), decode);
+
+			const std::array<const uint8*, 2> sources = { vertexData.data(), reinterpret_cast<const uint8*>(mesh.triangleArray()) };
+			const std::array<uint, 2> targets = { BUFVERTEX, BUFINDEX };
+			const std::array<size_t, 2> sizes = { layout.size, indexBytes };
+			size_t slotId = 0;
+			for (int part = 0; part < 2; ++part) {
+				for (size_t offset = 0; offset < sizes[part]; offset += slotSize) {
+					Slot& slot = slots[slotId];
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						slotFreed.wait(lock, [&] { return cancelled || slot.state == SlotState::FREE; });
+						if (cancelled) {
+							return;
+						}
+					}
+					const size_t size = std::min(slotSize, sizes[part] - offset);
+					std::memcpy(mapped + slotId * slotSize, sources[part] + offset, size);
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						slot.target = targets[part];
+						slot.offset = offset;
+						slot.size = size;
+						slot.state = SlotState::FILLED;
+					}
+					slotId = (slotId + 1) % slots.size();
+				}
+			}
+		}
+
+		Mesh mesh { false }; ///< Copy of the geometry.
+		VertexLayout layout; ///< Vertex attributes layout.
+		size_t indexBytes = 0; ///< Size of the index data.
+		size_t slotSize = 0; ///< Size of each staging slot, which is also the copy budget.
+		GLuint staging = 0; ///< Staging buffer.
+		uint8* mapped = nullptr; ///< Persistent mapping of the staging buffer.
+		std::array<Slot, 3> slots; ///< Staging slots.
+		size_t nextCopy = 0; ///< Next slot to copy to the GPU.
+		size_t vertexCopied = 0; ///< Vertex data copied to the GPU.
+		size_t indexCopied = 0; ///< Index data copied to the GPU.
+		bool cancelled = false; ///< Should the worker stop.
+		std::mutex mutex; ///< Protects the slots and cancelled.
+		std::condition_variable slotFreed; ///< Wakes the worker up when a slot is free or the upload cancelled.
+		std::thread worker; ///< Worker thread.
+	};
+
+	void	MeshBufferGL::beginUpload( const Mesh& mesh, size_t budget )
+	{
+		stopUpload();
+
+		if (!_vaoId)
+		{
+			glGenVertexArrays(1, &_vaoId);
+			glGenBuffers(BUFCOUNT, &_bufferIds[0]);
+		}
+
+		_upload.reset(new Upload());
+		Upload& upload = *_upload;
+		upload.mesh.vertices(mesh.vertices());
+		upload.mesh.triangles(mesh.triangles());
+		if (mesh.hasColors()) {
+			upload.mesh.colors(mesh.colors());
+		}
+		if (mesh.hasTexCoords()) {
+			upload.mesh.texCoords(mesh.texCoords());
+		}
+		if (mesh.hasNormals()) {
+			upload.mesh.normals(mesh.normals());
+		}
+		upload.mesh.vertexFormat(mesh.vertexFormat());
+		upload.layout = vertexLayout(mesh, mesh.vertexFormat());
+		upload.indexBytes = mesh.triangles().size() * 3 * sizeof(GLuint);
+		// Keep copies large enough for their cost to be dominated by the transfer.
+		upload.slotSize = std::max(budget, size_t(64 * 1024));
+
+		// Nothing is drawn until the first copies are done, but the position decoding is known
+		// beforehand so that callers querying it before drawing never use a stale one.
+		_vertexFormat = mesh.vertexFormat();
+		_vertexCount = 0;
+		_indexCount = 0;
+		_adjacentIndexCount = 0;
+		_positionDecode = positionDecoding(mesh, _vertexFormat);
+		_vertexBytes = upload.layout.size;
+
+		glBindVertexArray(_vaoId);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _bufferIds[BUFINDEX]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, upload.indexBytes, nullptr, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, _bufferIds[BUFVERTEX]);
+		glBufferData(GL_ARRAY_BUFFER, upload.layout.size, nullptr, GL_STATIC_DRAW);
+		_allocation.resize(upload.indexBytes + upload.layout.size);
+		setupAttributes(upload.layout, _vertexFormat);
+		glBindVertexArray(0);
+
+		// The worker thread writes to the persistent mapping without any GL call.
+		const size_t stagingSize = upload.slotSize * upload.slots.size();
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &upload.staging);
+		glBindBuffer(GL_COPY_READ_BUFFER, upload.staging);
+		glBufferStorage(GL_COPY_READ_BUFFER, stagingSize, nullptr, flags);
+		upload.mapped = static_cast<uint8*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, stagingSize, flags));
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		CHECK_GL_ERROR;
+
+		if (!upload.mapped) {
+			SIBR_WRG << "[MeshBufferGL] Unable to map staging buffer, uploading the mesh at once." << std::endl;
+			build(mesh);
+			return;
+		}
+		upload.worker = std::thread(&Upload::run, &upload);
+	}
+
+	bool	MeshBufferGL::uploadStep( void )
+	{
+		if (!_upload) {
+			return true;
+		}
+		Upload& upload = *_upload;
+
+		// Only expose data copied by previous steps.
+		if (upload.vertexCopied == upload.layout.size) {
+			_vertexCount = uint(upload.mesh.vertices().size());
+			_indexCount = uint(upload.indexCopied / (3 * sizeof(GLuint))) * 3;
+		}
+		if (upload.vertexCopied == upload.layout.size && upload.indexCopied == upload.indexBytes) {
+			stopUpload();
+			return true;
+		}
+
+		bool freed = false;
+		{
+			std::lock_guard<std::mutex> lock(upload.mutex);
+			// Slots can be refilled once the GPU is done reading them.
+			for (Upload::Slot& slot : upload.slots) {
+				if (slot.state == Upload::SlotState::COPYING && glClientWaitSync(slot.fence, 0, 0) != GL_TIMEOUT_EXPIRED) {
+					glDeleteSync(slot.fence);
+					slot.fence = nullptr;
+					slot.state = Upload::SlotState::FREE;
+					freed = true;
+				}
+			}
+
+			size_t copied = 0;
+			glBindBuffer(GL_COPY_READ_BUFFER, upload.staging);
+			while (copied < upload.slotSize) {
+				Upload::Slot& slot = upload.slots[upload.nextCopy];
+				if (slot.state != Upload::SlotState::FILLED) {
+					break;
+				}
+				glBindBuffer(GL_COPY_WRITE_BUFFER, _bufferIds[slot.target]);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GLintptr(upload.nextCopy * upload.slotSize), GLintptr(slot.offset), GLsizeiptr(slot.size));
+				slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				slot.state = Upload::SlotState::COPYING;
+				(slot.target == BUFVERTEX ? upload.vertexCopied : upload.indexCopied) += slot.size;
+				copied += slot.size;
+				upload.nextCopy = (upload.nextCopy + 1) % upload.slots.size();
+			}
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			CHECK_GL_ERROR;
+		}
+		if (freed) {
+			upload.slotFreed.notify_one();
+		}
+		return false;
+	}
+
+	void	MeshBufferGL::stopUpload( void )
+	{
+		if (!_upload) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_upload->mutex);
+			_upload->cancelled = true;
+		}
+		_upload->slotFreed.notify_one();
+		if (_upload->worker.joinable()) {
+			_upload->worker.join();
+		}
+		for (Upload::Slot& slot : _upload->slots) {
+			if (slot.fence) {
+				glDeleteSync(slot.fence);
+			}
+		}
+		// Deleting the buffer also unmaps it, pending copies still complete.
+		glDeleteBuffers(1, &_upload->staging);
+		_upload.reset();
+	}
+
+	MeshBufferGL::CompactError MeshBufferGL::compactError( const Mesh& mesh )
+	{
+		Vector3f offset, scale;
+		positionQuantization(mesh, offset, scale);
+		const int numVertices = int(mesh.vertices().size());
+		const bool hasColors = mesh.hasColors();
+		const bool hasTexCoords = mesh.hasTexCoords();
+		const bool hasNormals = mesh.hasNormals();
+
+		std::vector<CompactError> errors(numVertices);
+#pragma omp parallel for
+		for (int v = 0; v < numVertices; ++v) {
+			CompactError& error = errors[v];
+			const Vector3f& p = mesh.vertices()[v];
+			Vector3f decoded;
+			for (int c = 0; c < 3; ++c) {
+				decoded[c] = offset[c] + scale[c] * (float(toUnorm16(p[c], offset[c], scale[c])) / 65535.0f);
+			}
+			error.position = (decoded - p).norm();
+			if (hasColors) {
+				const Vector3f& color = mesh.colors()[v];
+				for (int c = 0; c < 3; ++c) {
+					const float quantized = std::round(std::max(0.0f, std::min(1.0f, color[c])) * 255.0f) / 255.0f;
+					error.color = std::max(error.color, std::abs(quantized - color[c]));
+				}
+			}
+			if (hasTexCoords) {
+				const Vector2f& uv = mesh.texCoords()[v];
+				error.texCoord = std::max(std::abs(halfToFloat(floatToHalf(uv.x())) - uv.x()), std::abs(halfToFloat(floatToHalf(uv.y())) - uv.y()));
+			}
+			if (hasNormals) {
+				const Vector3f n = mesh.normals()[v].normalized();
+				const float cosAngle = std::max(-1.0f, std::min(1.0f, octDecode(octEncode(n)).dot(n)));
+				error.normal = std::acos(cosAngle) * 180.0f / float(M_PI);
+			}
+		}
+
+		CompactError maxError;
+		for (const CompactError& error : errors) {
+			maxError.position = std::max(maxError.position, error.position);
+			maxError.normal = std::max(maxError.normal, error.normal);
+			maxError.color = std::max(maxError.color, error.color);
+			maxError.texCoord = std::max(maxError.texCoord, error.texCoord);
+		}
+		return maxError;
+	}
+
 	void	MeshBufferGL::free(void)
 	{
+		stopUpload();
+
 		if (_bufferIds[0] && _bufferIds[1] && _bufferIds[2])
 		{
 			glDeleteBuffers(3, _bufferIds.data());
 			_bufferIds.fill(0);
+			_allocation.resize(0);
 		}
 
 		if (_vaoId)
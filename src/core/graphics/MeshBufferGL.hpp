@@ -13,8 +13,11 @@
 #pragma once
 
 # include <array>
+# include <memory>
 # include <vector>
 # include "core/graphics/Config.hpp"
+# include "core/system/Matrix.hpp"
+# include "core/system/MemoryTracker.hpp"
 
 
 namespace sibr
@@ -51,6 +54,22 @@ namespace sibr
 			AttribLocationCount
 		};
 		
+		/** Storage of the vertex attributes on the GPU. */
+		enum class VertexFormat
+		{
+			FULL, ///< 32-bit floats for all attributes.
+			COMPACT ///< 16-bit positions normalized in the bounding box, octahedral 16-bit normals, RGBA8 colors and half float UVs.
+		};
+
+		/** Maximum error introduced by the compact vertex format, for each attribute. */
+		struct CompactError
+		{
+			float position = 0.0f; ///< Position error, in mesh units.
+			float normal = 0.0f; ///< Normal angular error, in degrees.
+			float color = 0.0f; ///< Color error.
+			float texCoord = 0.0f; ///< UV error.
+		};
+
 		/** Predefined buffer location. */
 		enum
 		{
@@ -100,6 +119,38 @@ namespace sibr
 		*/
 		void	build( const Mesh& mesh, bool adjacency = false );
 
+		/** Start uploading a mesh progressively. A worker thread packs the vertex and index data
+		* in persistent-mapped staging buffers, and each uploadStep() copies a bounded part of it to
+		* the GPU buffers. Triangles are drawn as soon as all vertices and their indices are available.
+		* \param mesh the mesh to upload, its geometry is copied so that it can be edited meanwhile
+		* \param budget maximum number of bytes copied by each uploadStep()
+		* \note Adjacency indices are not supported, use build() for them.
+		*/
+		void	beginUpload( const Mesh& mesh, size_t budget );
+
+		/** Copy the next part of the data prepared by the worker thread to the GPU.
+		* \return true once the upload is complete
+		*/
+		bool	uploadStep( void );
+
+		/** \return true if a progressive upload is in progress */
+		bool	isUploading( void ) const { return _upload != nullptr; }
+
+		/** Measure the precision lost by storing a mesh in the compact vertex format.
+		* \param mesh the mesh to evaluate
+		* \return the maximum error of each attribute
+		*/
+		static CompactError compactError(const Mesh& mesh);
+
+		/** \return the vertex format of the uploaded data */
+		VertexFormat vertexFormat(void) const { return _vertexFormat; }
+
+		/** \return the transformation from stored positions to mesh positions, to apply in vertex shaders (identity for full precision) */
+		const Matrix4f& positionDecode(void) const { return _positionDecode; }
+
+		/** \return the size of the uploaded vertex data, in bytes */
+		size_t vertexBytes(void) const { return _vertexBytes; }
+
 		/** Delete the GPU buffer, freeing memory. */
 		void	free(void);
 
@@ -146,12 +197,52 @@ namespace sibr
 		MeshBufferGL& operator =(const MeshBufferGL&) = delete;
 
 	private:
+
+		/** Offsets of the attributes in the vertex buffer, in bytes. */
+		struct VertexLayout
+		{
+			std::array<size_t, AttribLocationCount> offsets; ///< Offset of each attribute, following AttribLocation order.
+			size_t size = 0; ///< Size of the vertex data.
+		};
+
+		/** State of a progressive upload, shared with its worker thread. */
+		struct Upload;
+
+		/** Compute where attributes are stored in the vertex buffer.
+		* \param mesh the mesh to upload
+		* \param format the storage format
+		* \return the attributes layout
+		*/
+		static VertexLayout	vertexLayout( const Mesh& mesh, VertexFormat format );
+
+		/** Convert vertex attributes to their GPU storage.
+		* \param mesh the mesh to upload
+		* \param format the storage format
+		* \param layout the attributes layout
+		* \param dst destination of the layout size
+		* \param positionDecode will contain the transformation from stored positions to mesh positions
+		*/
+		static void	packVertices( const Mesh& mesh, VertexFormat format, const VertexLayout& layout, uint8* dst, Matrix4f& positionDecode );
+
+		/** Set the vertex attributes pointers of the bound vertex array and vertex buffer.
+		* \param layout the attributes layout
+		* \param format the storage format
+		*/
+		static void	setupAttributes( const VertexLayout& layout, VertexFormat format );
+
+		/** Stop the progressive upload if any, and release its staging buffers. */
+		void	stopUpload( void );
 		
 		GLuint 							_vaoId; ///< Vertex array object ID.
 		std::array<GLuint, BUFCOUNT>	_bufferIds; ///< Buffers IDs.
 		uint 							_indexCount; ///< Number of elements in the index buffer.
 		uint							_adjacentIndexCount; ///< Number of elements in the triangles_adjacency index buffer.
 		uint							_vertexCount; ///< Number of elements in the vertex buffer.
+		VertexFormat					_vertexFormat = VertexFormat::FULL; ///< Format of the vertex buffer.
+		Matrix4f						_positionDecode = Matrix4f::Identity(); ///< Transformation from stored positions to mesh positions.
+		size_t							_vertexBytes = 0; ///< Size of the vertex buffer.
+		std::unique_ptr<Upload>			_upload; ///< Progressive upload in progress.
+		MemoryTracker::Allocation		_allocation { MemoryTracker::Category::MeshBuffers }; ///< Memory accounting of the GPU buffers.
 
 		bool initVertexBuffer = false,
 			 initIndexBuffer = false,
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/graphics/MeshLOD.hpp"
+#include "core/graphics/MeshSimplifier.hpp"
+#include "core/graphics/Camera.hpp"
+#include "core/system/SimpleTimer.hpp"
+
+#include <sstream>
+
+namespace sibr
+{
+	MeshLOD::MeshLOD(const Mesh::Ptr & base, float ratio, size_t minTriangles, uint maxLevels)
+	{
+		_levels.push_back({ base, 0.0f });
+		_bbox = base->getBoundingBox();
+
+		Timer timer;
+		timer.tic();
+		while (_levels.size() < maxLevels) {
+			const Level & previous = _levels.back();
+			const size_t triangleCount = previous.mesh->triangles().size();
+			const size_t target = size_t(ratio * float(triangleCount));
+			if (target < minTriangles) {
+				break;
+			}
+			float error = 0.0f;
+			Mesh::Ptr simplified = MeshSimplifier::simplify(*previous.mesh, target, std::numeric_limits<float>::max(), &error);
+			// Locked boundaries can prevent any further progress.
+			if (simplified->triangles().size() > size_t(0.9f * float(triangleCount))) {
+				break;
+			}
+			// Errors are measured against the previous level, bound the error against the base mesh.
+			_levels.push_back({ simplified, previous.error + error });
+		}
+
+		std::stringstream levels;
+		for (const Level & level : _levels) {
+			levels << " " << level.mesh->triangles().size() << " (" << level.error << ")";
+		}
+		SIBR_LOG << "[MeshLOD] Built " << _levels.size() << " levels in " << timer.deltaTimeFromLastTic<Timer::milli>() << "ms:" << levels.str() << std::endl;
+	}
+
+	uint MeshLOD::selectLevel(const Camera & cam, float pixelHeight, float maxPixelError) const
+	{
+		if (maxPixelError <= 0.0f || _levels.size() < 2) {
+			return 0;
+		}
+
+		// Size of a mesh unit in pixels, at the closest point of the mesh.
+		float pixelsPerUnit;
+		if (cam.ortho()) {
+			pixelsPerUnit = pixelHeight / (2.0f * cam.orthoTop());
+		}
+		else {
+			const float distance = std::max(_bbox.exteriorDistance(cam.position()), cam.znear());
+			pixelsPerUnit = pixelHeight / (2.0f * distance * std::tan(0.5f * cam.fovy()));
+		}
+
+		uint selected = 0;
+		for (uint i = 1; i < uint(_levels.size()); ++i) {
+			if (_levels[i].error * pixelsPerUnit > maxPixelError) {
+				break;
+			}
+			selected = i;
+		}
+		return selected;
+	}
+
+} // namespace sibr
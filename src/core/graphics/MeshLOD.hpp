@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/graphics/Config.hpp"
+#include "core/graphics/Mesh.hpp"
+
+namespace sibr
+{
+	class Camera;
+
+	/** Chain of simplified versions of a mesh, from the mesh itself (level 0) to the coarsest level.
+	 * Each level stores its geometric error, used to pick the coarsest level that is accurate
+	 * enough for a given view.
+	 * \sa MeshSimplifier
+	 * \ingroup sibr_graphics
+	 */
+	class SIBR_GRAPHICS_EXPORT MeshLOD
+	{
+		SIBR_CLASS_PTR(MeshLOD);
+
+	public:
+
+		/** Build the chain, each level being simplified from the previous one.
+		 * \param base the full resolution mesh
+		 * \param ratio the triangle count ratio between two successive levels
+		 * \param minTriangles no level is simplified below this triangle count
+		 * \param maxLevels maximum number of levels, including the base mesh
+		 */
+		MeshLOD(const Mesh::Ptr & base, float ratio = 0.25f, size_t minTriangles = 5000, uint maxLevels = 6);
+
+		/** \return the number of levels */
+		uint levelCount() const { return uint(_levels.size()); }
+
+		/** \param i the level, 0 being the full resolution mesh
+		 * \return the mesh of the level
+		 */
+		const Mesh & level(uint i) const { return *_levels[i].mesh; }
+
+		/** \param i the level, 0 being the full resolution mesh
+		 * \return the mesh of the level
+		 */
+		const Mesh::Ptr & levelPtr(uint i) const { return _levels[i].mesh; }
+
+		/** \param i the level
+		 * \return the maximum distance between the level and the full resolution mesh, in mesh units
+		 */
+		float levelError(uint i) const { return _levels[i].error; }
+
+		/** Select the coarsest level whose error, projected in a view, stays below a threshold.
+		 * \param cam the viewpoint
+		 * \param pixelHeight the height of the view, in pixels
+		 * \param maxPixelError the maximum screen-space error allowed, in pixels; 0 always selects the full resolution
+		 * \return the level index
+		 */
+		uint selectLevel(const Camera & cam, float pixelHeight, float maxPixelError) const;
+
+	private:
+
+		/** Simplified mesh. */
+		struct Level
+		{
+			Mesh::Ptr mesh; ///< The mesh.
+			float error; ///< Accumulated simplification error.
+		};
+
+		std::vector<Level> _levels; ///< Levels, from finest to coarsest.
+		Eigen::AlignedBox<float, 3> _bbox; ///< Bounding box of the base mesh.
+	};
+
+} // namespace sibr
@@ -0,0 +1,1012 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+
+#include "core/graphics/MeshReader.hpp"
+#include "boost/filesystem.hpp"
+
+namespace sibr
+{
+	namespace
+	{
+		/// Size of the chunks text files are split into for parallel parsing.
+		const size_t textChunkSize = size_t(4) << 20;
+
+		/// Name given to faces without material, consistent with Assimp.
+		const char* defaultMaterialName = "DefaultMaterial";
+
+		/** Load a whole file in memory, adding a null terminator. */
+		bool loadFile(const std::string & filename, std::vector<char> & buffer)
+		{
+			std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
+			if (!file) {
+				return false;
+			}
+			const std::streamsize size = file.tellg();
+			file.seekg(0, std::ios::beg);
+			buffer.resize(size_t(size) + 1);
+			if (size > 0 && !file.read(buffer.data(), size)) {
+				return false;
+			}
+			buffer[size_t(size)] = '\0';
+			return true;
+		}
+
+		inline bool hostIsBigEndian()
+		{
+			const uint16_t one = 1;
+			return *(const uint8_t*)&one == 0;
+		}
+
+		inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+		inline const char* skipBlanks(const char* p) {
+			while (isBlank(*p)) { ++p; }
+			return p;
+		}
+
+		inline const char* nextLine(const char* p, const char* end) {
+			const char* eol = (const char*)std::memchr(p, '\n', end - p);
+			return eol ? eol + 1 : end;
+		}
+
+		/** Split a text buffer in chunks of complete lines. */
+		std::vector<std::pair<const char*, const char*>> splitLines(const char* begin, const char* end)
+		{
+			std::vector<std::pair<const char*, const char*>> chunks;
+			const char* start = begin;
+			while (start < end) {
+				const char* stop = start + std::min(textChunkSize, size_t(end - start));
+				if (stop < end) {
+					stop = nextLine(stop, end);
+				}
+				chunks.emplace_back(start, stop);
+				start = stop;
+			}
+			return chunks;
+		}
+
+		/** Remove triangles with repeated or invalid indices, keeping per-triangle data in sync. */
+		void cleanTriangles(MeshReader::Data & data)
+		{
+			const size_t numVertices = data.vertices.size();
+			const bool withMat = data.matIds.size() == data.triangles.size();
+			size_t dst = 0;
+			size_t invalid = 0;
+			for (size_t tId = 0; tId < data.triangles.size(); ++tId) {
+				const Vector3u & tri = data.triangles[tId];
+				if (tri[0] >= numVertices || tri[1] >= numVertices || tri[2] >= numVertices) {
+					++invalid;
+					continue;
+				}
+				if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+					continue;
+				}
+				data.triangles[dst] = tri;
+				if (withMat) {
+					data.matIds[dst] = data.matIds[tId];
+				}
+				++dst;
+			}
+			if (invalid > 0) {
+				SIBR_WRG << invalid << " faces contain invalid vertex id(s)" << std::endl;
+			}
+			data.triangles.resize(dst);
+			if (withMat) {
+				data.matIds.resize(dst);
+			}
+		}
+
+		/** Assign all geometry to a single default material. */
+		void setDefaultMaterial(MeshReader::Data & data)
+		{
+			data.materials = { defaultMaterialName };
+			data.matIds.assign(data.triangles.size(), 0);
+			data.vertexMatIds.assign(data.vertices.size(), 0);
+		}
+
+		///// PLY /////
+
+		enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64, Invalid };
+
+		PlyType plyTypeFromString(const std::string & name)
+		{
+			if (name == "char" || name == "int8") return PlyType::Int8;
+			if (name == "uchar" || name == "uint8") return PlyType::UInt8;
+			if (name == "short" || name == "int16") return PlyType::Int16;
+			if (name == "ushort" || name == "uint16") return PlyType::UInt16;
+			if (name == "int" || name == "int32") return PlyType::Int32;
+			if (name == "uint" || name == "uint32") return PlyType::UInt32;
+			if (name == "float" || name == "float32") return PlyType::Float32;
+			if (name == "double" || name == "float64") return PlyType::Float64;
+			return PlyType::Invalid;
+		}
+
+		size_t plyTypeSize(PlyType type)
+		{
+			switch (type) {
+			case PlyType::Int8: case PlyType::UInt8: return 1;
+			case PlyType::Int16: case PlyType::UInt16: return 2;
+			case PlyType::Int32: case PlyType::UInt32: case PlyType::Float32: return 4;
+			case PlyType::Float64: return 8;
+			default: return 0;
+			}
+		}
+
+		/// Scale to apply to integer colors to bring them in [0,1].
+		float plyColorScale(PlyType type)
+		{
+			switch (type) {
+			case PlyType::Int8: case PlyType::UInt8: return 1.0f / 255.0f;
+			case PlyType::Int16: case PlyType::UInt16: return 1.0f / 65535.0f;
+			default: return 1.0f;
+			}
+		}
+
+		template<typename T>
+		inline T loadBinary(const char* p, bool swap)
+		{
+			T value;
+			if (!swap) {
+				std::memcpy(&value, p, sizeof(T));
+			} else {
+				char bytes[sizeof(T)];
+				for (size_t b = 0; b < sizeof(T); ++b) {
+					bytes[b] = p[sizeof(T) - 1 - b];
+				}
+				std::memcpy(&value, bytes, sizeof(T));
+			}
+			return value;
+		}
+
+		inline double loadBinary(const char* p, PlyType type, bool swap)
+		{
+			switch (type) {
+			case PlyType::Int8: return double(*(const int8_t*)p);
+			case PlyType::UInt8: return double(*(const uint8_t*)p);
+			case PlyType::Int16: return double(loadBinary<int16_t>(p, swap));
+			case PlyType::UInt16: return double(loadBinary<uint16_t>(p, swap));
+			case PlyType::Int32: return double(loadBinary<int32_t>(p, swap));
+			case PlyType::UInt32: return double(loadBinary<uint32_t>(p, swap));
+			case PlyType::Float32: return double(loadBinary<float>(p, swap));
+			case PlyType::Float64: return loadBinary<double>(p, swap);
+			default: return 0.0;
+			}
+		}
+
+		inline uint loadBinaryIndex(const char* p, PlyType type, bool swap)
+		{
+			switch (type) {
+			case PlyType::Int8: case PlyType::UInt8: return uint(*(const uint8_t*)p);
+			case PlyType::Int16: case PlyType::UInt16: return uint(loadBinary<uint16_t>(p, swap));
+			case PlyType::Int32: case PlyType::UInt32: return uint(loadBinary<uint32_t>(p, swap));
+			default: return uint(loadBinary(p, type, swap));
+			}
+		}
+
+		/** Destination of a vertex property. */
+		enum class PlySlot { None, X, Y, Z, NX, NY, NZ, R, G, B, U, V };
+
+		struct PlyProperty {
+			std::string name;
+			PlyType type = PlyType::Invalid;
+			bool isList = false;
+			PlyType countType = PlyType::Invalid;
+			PlySlot slot = PlySlot::None;
+			size_t offset = 0; ///< Offset in a fixed-size binary record.
+		};
+
+		struct PlyElement {
+			std::string name;
+			size_t count = 0;
+			std::vector<PlyProperty> props;
+
+			bool hasList() const {
+				for (const auto & prop : props) {
+					if (prop.isList) return true;
+				}
+				return false;
+			}
+
+			/// Record size for elements without lists.
+			size_t recordSize() const {
+				size_t size = 0;
+				for (const auto & prop : props) {
+					size += plyTypeSize(prop.type);
+				}
+				return size;
+			}
+		};
+
+		PlySlot plySlotFromName(const std::string & name)
+		{
+			static const std::map<std::string, PlySlot> slots = {
+				{ "x", PlySlot::X }, { "y", PlySlot::Y }, { "z", PlySlot::Z },
+				{ "nx", PlySlot::NX }, { "ny", PlySlot::NY }, { "nz", PlySlot::NZ },
+				{ "red", PlySlot::R }, { "green", PlySlot::G }, { "blue", PlySlot::B },
+				{ "diffuse_red", PlySlot::R }, { "diffuse_green", PlySlot::G }, { "diffuse_blue", PlySlot::B },
+				{ "u", PlySlot::U }, { "v", PlySlot::V }, { "s", PlySlot::U }, { "t", PlySlot::V },
+				{ "texture_u", PlySlot::U }, { "texture_v", PlySlot::V },
+				{ "texture_s", PlySlot::U }, { "texture_t", PlySlot::V }
+			};
+			const auto slot = slots.find(name);
+			return slot == slots.end() ? PlySlot::None : slot->second;
+		}
+
+		/** Vertex attributes layout and storage helper. */
+		struct PlyVertexWriter {
+			bool hasNormals = false, hasColors = false, hasUVs = false;
+			float colorScale[3] = { 1.0f, 1.0f, 1.0f };
+
+			void setup(const PlyElement & element, MeshReader::Data & data) {
+				int found[12] = { 0 };
+				for (const auto & prop : element.props) {
+					found[int(prop.slot)] = 1;
+					if (prop.slot == PlySlot::R || prop.slot == PlySlot::G || prop.slot == PlySlot::B) {
+						colorScale[int(prop.slot) - int(PlySlot::R)] = plyColorScale(prop.type);
+					}
+				}
+				hasNormals = found[int(PlySlot::NX)] && found[int(PlySlot::NY)] && found[int(PlySlot::NZ)];
+				hasColors = found[int(PlySlot::R)] && found[int(PlySlot::G)] && found[int(PlySlot::B)];
+				hasUVs = found[int(PlySlot::U)] && found[int(PlySlot::V)];
+				data.vertices.resize(element.count);
+				data.normals.resize(hasNormals ? element.count : 0);
+				data.colors.resize(hasColors ? element.count : 0);
+				data.texcoords.resize(hasUVs ? element.count : 0);
+			}
+
+			inline void set(MeshReader::Data & data, size_t vId, PlySlot slot, double value) const {
+				switch (slot) {
+				case PlySlot::X: data.vertices[vId][0] = float(value); break;
+				case PlySlot::Y: data.vertices[vId][1] = float(value); break;
+				case PlySlot::Z: data.vertices[vId][2] = float(value); break;
+				case PlySlot::NX: if (hasNormals) data.normals[vId][0] = float(value); break;
+				case PlySlot::NY: if (hasNormals) data.normals[vId][1] = float(value); break;
+				case PlySlot::NZ: if (hasNormals) data.normals[vId][2] = float(value); break;
+				case PlySlot::R: if (hasColors) data.colors[vId][0] = float(value) * colorScale[0]; break;
+				case PlySlot::G: if (hasColors) data.colors[vId][1] = float(value) * colorScale[1]; break;
+				case PlySlot::B: if (hasColors) data.colors[vId][2] = float(value) * colorScale[2]; break;
+				case PlySlot::U: if (hasUVs) data.texcoords[vId][0] = float(value); break;
+				case PlySlot::V: if (hasUVs) data.texcoords[vId][1] = float(value); break;
+				default: break;
+				}
+			}
+		};
+
+		/** Find the face indices list property, and check that the others can be ignored. */
+		bool setupPlyFaces(const PlyElement & element, int & indicesProp)
+		{
+			indicesProp = -1;
+			for (int pId = 0; pId < int(element.props.size()); ++pId) {
+				const PlyProperty & prop = element.props[pId];
+				if (prop.isList && (prop.name == "vertex_indices" || prop.name == "vertex_index")) {
+					indicesProp = pId;
+				} else if (prop.isList && (prop.name == "texcoord" || prop.name == "texcoords")) {
+					// Per-wedge UVs require splitting vertices.
+					return false;
+				}
+			}
+			return indicesProp >= 0;
+		}
+
+		/** Add the fan triangulation of a polygon. */
+		template<typename IndexFunc>
+		inline void addPolygon(std::vector<Vector3u> & triangles, size_t & dst, uint count, const IndexFunc & index)
+		{
+			if (count < 3) {
+				return;
+			}
+			const uint first = index(0);
+			uint prev = index(1);
+			for (uint c = 2; c < count; ++c) {
+				const uint current = index(c);
+				triangles[dst++] = Vector3u(first, prev, current);
+				prev = current;
+			}
+		}
+
+		/** Read a binary element, returns the end of its data or nullptr on error. */
+		const char* readPlyBinaryElement(const PlyElement & element, const char* p, const char* end, bool swap, MeshReader::Data & data, bool & supported)
+		{
+			if (element.name == "vertex") {
+				if (element.hasList()) {
+					supported = false;
+					return nullptr;
+				}
+				const size_t recordSize = element.recordSize();
+				if (size_t(end - p) < recordSize * element.count) {
+					return nullptr;
+				}
+				PlyVertexWriter writer;
+				writer.setup(element, data);
+				const int64_t count = int64_t(element.count);
+#pragma omp parallel for
+				for (int64_t vId = 0; vId < count; ++vId) {
+					const char* record = p + size_t(vId) * recordSize;
+					for (const auto & prop : element.props) {
+						if (prop.slot != PlySlot::None) {
+							writer.set(data, size_t(vId), prop.slot, loadBinary(record + prop.offset, prop.type, swap));
+						}
+					}
+				}
+				return p + recordSize * element.count;
+			}
+
+			if (element.name == "face") {
+				int indicesProp;
+				if (!setupPlyFaces(element, indicesProp)) {
+					supported = false;
+					return nullptr;
+				}
+				const PlyProperty & indices = element.props[indicesProp];
+				const size_t countSize = plyTypeSize(indices.countType);
+				const size_t indexSize = plyTypeSize(indices.type);
+
+				// Fast path: faces only made of triangles have a fixed size, which can be checked and read in parallel.
+				if (element.props.size() == 1) {
+					const size_t recordSize = countSize + 3 * indexSize;
+					if (size_t(end - p) >= recordSize * element.count) {
+						const int64_t count = int64_t(element.count);
+						bool allTriangles = true;
+#pragma omp parallel for reduction(&&:allTriangles)
+						for (int64_t fId = 0; fId < count; ++fId) {
+							allTriangles = allTriangles && (loadBinaryIndex(p + size_t(fId) * recordSize, indices.countType, swap) == 3);
+						}
+						if (allTriangles) {
+							data.triangles.resize(element.count);
+#pragma omp parallel for
+							for (int64_t fId = 0; fId < count; ++fId) {
+								const char* record = p + size_t(fId) * recordSize + countSize;
+								for (int c = 0; c < 3; ++c) {
+									data.triangles[size_t(fId)][c] = loadBinaryIndex(record + c * indexSize, indices.type, swap);
+								}
+							}
+							return p + recordSize * element.count;
+						}
+					}
+				}
+
+				// Generic path: polygons and additional properties.
+				data.triangles.clear();
+				data.triangles.reserve(element.count);
+				for (size_t fId = 0; fId < element.count; ++fId) {
+					for (int pId = 0; pId < int(element.props.size()); ++pId) {
+						const PlyProperty & prop = element.props[pId];
+						if (!prop.isList) {
+							p += plyTypeSize(prop.type);
+							continue;
+						}
+						if (p + plyTypeSize(prop.countType) > end) {
+							return nullptr;
+						}
+						const uint count = loadBinaryIndex(p, prop.countType, swap);
+						p += plyTypeSize(prop.countType);
+						const size_t itemSize = plyTypeSize(prop.type);
+						if (p + count * itemSize > end) {
+							return nullptr;
+						}
+						if (pId == indicesProp && count >= 3) {
+							size_t dst = data.triangles.size();
+							data.triangles.resize(dst + count - 2);
+							addPolygon(data.triangles, dst, count, [&](uint c) { return loadBinaryIndex(p + c * itemSize, prop.type, swap); });
+						}
+						p += count * itemSize;
+					}
+				}
+				return p;
+			}
+
+			// Other elements are skipped.
+			if (!element.hasList()) {
+				const size_t size = element.recordSize() * element.count;
+				return size_t(end - p) >= size ? p + size : nullptr;
+			}
+			for (size_t eId = 0; eId < element.count; ++eId) {
+				for (const auto & prop : element.props) {
+					if (!prop.isList) {
+						p += plyTypeSize(prop.type);
+						continue;
+					}
+					if (p + plyTypeSize(prop.countType) > end) {
+						return nullptr;
+					}
+					const uint count = loadBinaryIndex(p, prop.countType, swap);
+					p += plyTypeSize(prop.countType) + count * plyTypeSize(prop.type);
+				}
+				if (p > end) {
+					return nullptr;
+				}
+			}
+			return p;
+		}
+
+		/** Read ASCII elements, one record per line. */
+		bool readPlyASCII(const std::vector<PlyElement> & elements, const char* p, const char* end, MeshReader::Data & data, bool & supported)
+		{
+			// Locate all non-empty lines.
+			std::vector<const char*> lines;
+			while (p < end) {
+				const char* start = skipBlanks(p);
+				if (*start != '\n' && start < end) {
+					lines.push_back(start);
+				}
+				p = nextLine(p, end);
+			}
+
+			size_t firstLine = 0;
+			for (const auto & element : elements) {
+				if (lines.size() < firstLine + element.count) {
+					return false;
+				}
+				const char* const* elementLines = lines.data() + firstLine;
+				const int64_t count = int64_t(element.count);
+				firstLine += element.count;
+
+				if (element.name == "vertex") {
+					if (element.hasList()) {
+						supported = false;
+						return false;
+					}
+					PlyVertexWriter writer;
+					writer.setup(element, data);
+#pragma omp parallel for
+					for (int64_t vId = 0; vId < count; ++vId) {
+						const char* cursor = elementLines[vId];
+						for (const auto & prop : element.props) {
+							char* next;
+							const double value = std::strtod(cursor, &next);
+							cursor = next;
+							writer.set(data, size_t(vId), prop.slot, value);
+						}
+					}
+				}
+				else if (element.name == "face") {
+					int indicesProp;
+					if (!setupPlyFaces(element, indicesProp)) {
+						supported = false;
+						return false;
+					}
+					/// Triangles generated by each face, then first triangle of each face.
+					std::vector<size_t> offsets(element.count + 1, 0);
+					std::vector<const char*> listStarts(element.count);
+#pragma omp parallel for
+					for (int64_t fId = 0; fId < count; ++fId) {
+						const char* cursor = elementLines[fId];
+						char* next;
+						for (int pId = 0; pId < indicesProp; ++pId) {
+							const PlyProperty & prop = element.props[pId];
+							const long items = prop.isList ? std::strtol(cursor, &next, 10) : 0;
+							if (prop.isList) {
+								cursor = next;
+							}
+							for (long i = 0; i < (prop.isList ? items : 1); ++i) {
+								std::strtod(cursor, &next);
+								cursor = next;
+							}
+						}
+						listStarts[size_t(fId)] = cursor;
+						const long numIds = std::strtol(cursor, &next, 10);
+						offsets[size_t(fId) + 1] = numIds >= 3 ? size_t(numIds - 2) : 0;
+					}
+					for (size_t fId = 0; fId < element.count; ++fId) {
+						offsets[fId + 1] += offsets[fId];
+					}
+					data.triangles.resize(offsets.back());
+#pragma omp parallel for
+					for (int64_t fId = 0; fId < count; ++fId) {
+						const size_t numTris = offsets[size_t(fId) + 1] - offsets[size_t(fId)];
+						if (numTris == 0) {
+							continue;
+						}
+						char* next;
+						const char* cursor = listStarts[size_t(fId)];
+						std::strtol(cursor, &next, 10);
+						cursor = next;
+						std::vector<uint> ids(numTris + 2);
+						for (uint & id : ids) {
+							id = uint(std::strtoul(cursor, &next, 10));
+							cursor = next;
+						}
+						size_t dst = offsets[size_t(fId)];
+						addPolygon(data.triangles, dst, uint(ids.size()), [&ids](uint c) { return ids[c]; });
+					}
+				}
+			}
+			return true;
+		}
+
+		///// OBJ /////
+
+		/** Parsed content of an OBJ chunk. Indices are global and 0-based, -1 when absent. */
+		struct ObjChunk {
+			size_t numPositions = 0, numUVs = 0, numNormals = 0; ///< Counts, used to resolve relative indices.
+			size_t firstPosition = 0, firstUV = 0, firstNormal = 0; ///< Global index of the first element of each kind.
+			std::vector<Vector3f> positions, normals, colors;
+			std::vector<Vector2f> uvs;
+			std::vector<Vector3i> corners; ///< Position, UV and normal indices of each face corner.
+			std::vector<uint> faceSizes; ///< Number of corners of each face.
+			std::vector<int> faceMaterials; ///< Local material of each face, -1 to inherit the previous one.
+			std::vector<std::string> materials; ///< Materials used in this chunk.
+			std::vector<std::string> libraries; ///< Material libraries referenced in this chunk.
+			bool valid = true;
+		};
+
+		inline bool startsWithToken(const char* p, const char* token)
+		{
+			const size_t size = std::strlen(token);
+			return std::strncmp(p, token, size) == 0 && (isBlank(p[size]) || p[size] == '\n' || p[size] == '\0');
+		}
+
+		inline const char* readToken(const char* p, std::string & token)
+		{
+			p = skipBlanks(p);
+			const char* start = p;
+			while (*p && *p != '\n' && *p != '\r') {
+				++p;
+			}
+			// Trim trailing blanks.
+			const char* stop = p;
+			while (stop > start && isBlank(stop[-1])) {
+				--stop;
+			}
+			token.assign(start, stop);
+			return p;
+		}
+
+		void countObjChunk(const char* p, const char* end, ObjChunk & chunk)
+		{
+			while (p < end) {
+				p = skipBlanks(p);
+				if (p[0] == 'v') {
+					if (isBlank(p[1])) ++chunk.numPositions;
+					else if (p[1] == 't' && isBlank(p[2])) ++chunk.numUVs;
+					else if (p[1] == 'n' && isBlank(p[2])) ++chunk.numNormals;
+				}
+				p = nextLine(p, end);
+			}
+		}
+
+		void parseObjChunk(const char* p, const char* end, ObjChunk & chunk)
+		{
+			chunk.positions.reserve(chunk.numPositions);
+			chunk.uvs.reserve(chunk.numUVs);
+			chunk.normals.reserve(chunk.numNormals);
+			int currentMaterial = -1;
+			std::string token;
+
+			while (p < end) {
+				p = skipBlanks(p);
+				char* next;
+				if (p[0] == 'v' && isBlank(p[1])) {
+					const char* cursor = p + 1;
+					Vector3f pos;
+					for (int c = 0; c < 3; ++c) {
+						pos[c] = std::strtof(cursor, &next);
+						cursor = next;
+					}
+					chunk.positions.push_back(pos);
+					// Optional vertex colors extension (x y z r g b), as opposed to an homogeneous coordinate.
+					float extra[4];
+					int numExtra = 0;
+					while (numExtra < 4) {
+						extra[numExtra] = std::strtof(cursor, &next);
+						if (next == cursor) {
+							break;
+						}
+						cursor = next;
+						++numExtra;
+					}
+					if (numExtra >= 3) {
+						chunk.colors.resize(chunk.positions.size() - 1, Vector3f(0.0f, 0.0f, 0.0f));
+						chunk.colors.push_back(Vector3f(extra[0], extra[1], extra[2]));
+					}
+				}
+				else if (p[0] == 'v' && p[1] == 't' && isBlank(p[2])) {
+					const char* cursor = p + 2;
+					Vector2f uv;
+					uv[0] = std::strtof(cursor, &next);
+					uv[1] = std::strtof(next, &next);
+					chunk.uvs.push_back(uv);
+				}
+				else if (p[0] == 'v' && p[1] == 'n' && isBlank(p[2])) {
+					const char* cursor = p + 2;
+					Vector3f n;
+					for (int c = 0; c < 3; ++c) {
+						n[c] = std::strtof(cursor, &next);
+						cursor = next;
+					}
+					chunk.normals.push_back(n);
+				}
+				else if (p[0] == 'f' && isBlank(p[1])) {
+					const char* cursor = p + 1;
+					uint numCorners = 0;
+					// Counts at this point of the file, to resolve relative indices.
+					const long long posCount = (long long)(chunk.firstPosition + chunk.positions.size());
+					const long long uvCount = (long long)(chunk.firstUV + chunk.uvs.size());
+					const long long nCount = (long long)(chunk.firstNormal + chunk.normals.size());
+					const auto resolve = [](long long id, long long count) {
+						return int(id > 0 ? id - 1 : (id < 0 ? count + id : -1));
+					};
+					while (true) {
+						cursor = skipBlanks(cursor);
+						if (*cursor == '\n' || *cursor == '\0' || *cursor == '#') {
+							break;
+						}
+						Vector3i corner(-1, -1, -1);
+						corner[0] = resolve(std::strtoll(cursor, &next, 10), posCount);
+						if (next == cursor) {
+							chunk.valid = false;
+							break;
+						}
+						cursor = next;
+						if (*cursor == '/') {
+							++cursor;
+							if (*cursor != '/') {
+								corner[1] = resolve(std::strtoll(cursor, &next, 10), uvCount);
+								cursor = next;
+							}
+							if (*cursor == '/') {
+								++cursor;
+								corner[2] = resolve(std::strtoll(cursor, &next, 10), nCount);
+								cursor = next;
+							}
+						}
+						// Skip anything left in this corner.
+						while (*cursor && !isBlank(*cursor) && *cursor != '\n') {
+							++cursor;
+						}
+						chunk.corners.push_back(corner);
+						++numCorners;
+					}
+					chunk.faceSizes.push_back(numCorners);
+					chunk.faceMaterials.push_back(currentMaterial);
+				}
+				else if (startsWithToken(p, "usemtl")) {
+					readToken(p + 6, token);
+					const auto found = std::find(chunk.materials.begin(), chunk.materials.end(), token);
+					currentMaterial = int(found - chunk.materials.begin());
+					if (found == chunk.materials.end()) {
+						chunk.materials.push_back(token);
+					}
+				}
+				else if (startsWithToken(p, "mtllib")) {
+					readToken(p + 6, token);
+					chunk.libraries.push_back(token);
+				}
+				p = nextLine(p, end);
+			}
+			if (!chunk.colors.empty()) {
+				chunk.colors.resize(chunk.positions.size(), Vector3f(0.0f, 0.0f, 0.0f));
+			}
+		}
+
+		/** Find the diffuse texture of a material in a set of MTL files. */
+		std::string findDiffuseTexture(const std::string & objFile, const std::vector<std::string> & libraries, const std::string & material)
+		{
+			const boost::filesystem::path folder = boost::filesystem::path(objFile).parent_path();
+			for (const auto & library : libraries) {
+				std::ifstream file((folder / library).string());
+				std::string line, current;
+				while (std::getline(file, line)) {
+					std::string token;
+					const char* p = skipBlanks(line.c_str());
+					if (startsWithToken(p, "newmtl")) {
+						readToken(p + 6, current);
+					} else if (startsWithToken(p, "map_Kd") && current == material) {
+						readToken(p + 6, token);
+						return token;
+					}
+				}
+			}
+			return "";
+		}
+	}
+
+	MeshReader::Status MeshReader::read(const std::string & filename, Data & data, bool splitMaterials)
+	{
+		std::string ext = boost::filesystem::extension(filename);
+		std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+		if (ext == ".ply") {
+			return readPLY(filename, data);
+		}
+		if (ext == ".obj") {
+			return readOBJ(filename, data, splitMaterials);
+		}
+		return Status::Unsupported;
+	}
+
+	MeshReader::Status MeshReader::readPLY(const std::string & filename, Data & data)
+	{
+		data = Data();
+		std::vector<char> buffer;
+		if (!loadFile(filename, buffer)) {
+			SIBR_WRG << "Can't read file '" << filename << "'." << std::endl;
+			return Status::Error;
+		}
+		const char* p = buffer.data();
+		const char* end = buffer.data() + buffer.size() - 1;
+
+		// Header.
+		enum class Format { ASCII, BinaryLittle, BinaryBig, Unknown } format = Format::Unknown;
+		std::vector<PlyElement> elements;
+		bool headerEnded = false;
+		bool first = true;
+		while (p < end && !headerEnded) {
+			const char* lineEnd = nextLine(p, end);
+			std::istringstream line(std::string(p, lineEnd));
+			p = lineEnd;
+			std::string keyword;
+			line >> keyword;
+			if (first) {
+				if (keyword != "ply") {
+					SIBR_WRG << "'" << filename << "' is not a PLY file." << std::endl;
+					return Status::Error;
+				}
+				first = false;
+			} else if (keyword == "format") {
+				std::string name;
+				line >> name;
+				format = name == "ascii" ? Format::ASCII : (name == "binary_little_endian" ? Format::BinaryLittle : (name == "binary_big_endian" ? Format::BinaryBig : Format::Unknown));
+			} else if (keyword == "comment" || keyword == "obj_info") {
+				std::string name;
+				line >> name;
+				if (name == "TextureFile") {
+					line >> data.textureFile;
+				}
+			} else if (keyword == "element") {
+				PlyElement element;
+				line >> element.name >> element.count;
+				elements.push_back(element);
+			} else if (keyword == "property" && !elements.empty()) {
+				PlyProperty prop;
+				std::string type;
+				line >> type;
+				if (type == "list") {
+					std::string countType;
+					line >> countType >> type;
+					prop.isList = true;
+					prop.countType = plyTypeFromString(countType);
+				}
+				prop.type = plyTypeFromString(type);
+				line >> prop.name;
+				if (prop.type == PlyType::Invalid || (prop.isList && prop.countType == PlyType::Invalid)) {
+					return Status::Unsupported;
+				}
+				PlyElement & element = elements.back();
+				prop.slot = element.name == "vertex" ? plySlotFromName(prop.name) : PlySlot::None;
+				prop.offset = element.recordSize();
+				element.props.push_back(prop);
+			} else if (keyword == "end_header") {
+				headerEnded = true;
+			}
+		}
+		if (!headerEnded || format == Format::Unknown) {
+			SIBR_WRG << "Invalid PLY header in '" << filename << "'." << std::endl;
+			return Status::Error;
+		}
+
+		bool supported = true;
+		bool success = true;
+		if (format == Format::ASCII) {
+			success = readPlyASCII(elements, p, end, data, supported);
+		} else {
+			const bool swap = (format == Format::BinaryBig) != hostIsBigEndian();
+			for (const auto & element : elements) {
+				p = readPlyBinaryElement(element, p, end, swap, data, supported);
+				if (!p) {
+					success = false;
+					break;
+				}
+			}
+		}
+		if (!supported) {
+			return Status::Unsupported;
+		}
+		if (!success) {
+			SIBR_WRG << "Truncated or invalid PLY file '" << filename << "'." << std::endl;
+			return Status::Error;
+		}
+
+		cleanTriangles(data);
+		setDefaultMaterial(data);
+		return Status::Success;
+	}
+
+	MeshReader::Status MeshReader::readOBJ(const std::string & filename, Data & data, bool splitMaterials)
+	{
+		data = Data();
+		std::vector<char> buffer;
+		if (!loadFile(filename, buffer)) {
+			SIBR_WRG << "Can't read file '" << filename << "'." << std::endl;
+			return Status::Error;
+		}
+		const auto ranges = splitLines(buffer.data(), buffer.data() + buffer.size() - 1);
+		const int numChunks = int(ranges.size());
+		std::vector<ObjChunk> chunks(ranges.size());
+
+		// First pass: count elements in each chunk so that relative indices can be resolved in the second pass.
+#pragma omp parallel for schedule(dynamic)
+		for (int cId = 0; cId < numChunks; ++cId) {
+			countObjChunk(ranges[cId].first, ranges[cId].second, chunks[cId]);
+		}
+		for (int cId = 1; cId < numChunks; ++cId) {
+			chunks[cId].firstPosition = chunks[cId - 1].firstPosition + chunks[cId - 1].numPositions;
+			chunks[cId].firstUV = chunks[cId - 1].firstUV + chunks[cId - 1].numUVs;
+			chunks[cId].firstNormal = chunks[cId - 1].firstNormal + chunks[cId - 1].numNormals;
+		}
+#pragma omp parallel for schedule(dynamic)
+		for (int cId = 0; cId < numChunks; ++cId) {
+			parseObjChunk(ranges[cId].first, ranges[cId].second, chunks[cId]);
+		}
+
+		// Gather positions, UVs and normals.
+		std::vector<Vector3f> positions, normals, colors;
+		std::vector<Vector2f> uvs;
+		std::vector<std::string> libraries;
+		bool hasColors = true;
+		for (const auto & chunk : chunks) {
+			if (!chunk.valid) {
+				SIBR_WRG << "Invalid face in OBJ file '" << filename << "'." << std::endl;
+				return Status::Error;
+			}
+			positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+			uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+			normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+			hasColors = hasColors && (chunk.positions.empty() || !chunk.colors.empty());
+			libraries.insert(libraries.end(), chunk.libraries.begin(), chunk.libraries.end());
+		}
+		if (hasColors && !positions.empty()) {
+			for (const auto & chunk : chunks) {
+				colors.insert(colors.end(), chunk.colors.begin(), chunk.colors.end());
+			}
+		}
+
+		// Global materials, faces before any usemtl get the default material.
+		std::map<std::string, int> matName2Id;
+		std::vector<std::vector<int>> chunkMatIds(chunks.size());
+		int currentMaterial = -1;
+		for (size_t cId = 0; cId < chunks.size(); ++cId) {
+			for (const auto & name : chunks[cId].materials) {
+				const auto found = matName2Id.find(name);
+				if (found == matName2Id.end()) {
+					matName2Id[name] = int(data.materials.size());
+					chunkMatIds[cId].push_back(int(data.materials.size()));
+					data.materials.push_back(name);
+				} else {
+					chunkMatIds[cId].push_back(found->second);
+				}
+			}
+			for (int & faceMat : chunks[cId].faceMaterials) {
+				if (faceMat >= 0) {
+					currentMaterial = chunkMatIds[cId][faceMat];
+				} else if (currentMaterial < 0) {
+					currentMaterial = int(data.materials.size());
+					matName2Id[defaultMaterialName] = currentMaterial;
+					data.materials.push_back(defaultMaterialName);
+				}
+				faceMat = currentMaterial;
+			}
+		}
+
+		// Point clouds: keep all positions.
+		size_t numFaces = 0;
+		for (const auto & chunk : chunks) {
+			numFaces += chunk.faceSizes.size();
+		}
+		if (numFaces == 0) {
+			data.vertices = std::move(positions);
+			data.colors = std::move(colors);
+			setDefaultMaterial(data);
+			return Status::Success;
+		}
+
+		// Generate one vertex per unique corner. Corners sharing a position are chained to keep lookups local.
+		const bool withUVs = !uvs.empty();
+		const bool withNormals = !normals.empty();
+		std::vector<int> firstVertex(positions.size(), -1);
+		std::vector<int> nextVertex;
+		std::vector<Vector3i> vertexKeys;
+
+		const auto getVertex = [&](const Vector3i & corner, int material) -> int {
+			if (corner[0] < 0 || corner[0] >= int(positions.size())) {
+				return -1;
+			}
+			const Vector3i key(corner[0], withUVs ? corner[1] : -1, withNormals ? corner[2] : -1);
+			for (int vId = firstVertex[key[0]]; vId >= 0; vId = nextVertex[vId]) {
+				if (vertexKeys[vId] == key && (!splitMaterials || data.vertexMatIds[vId] == material)) {
+					return vId;
+				}
+			}
+			const int vId = int(vertexKeys.size());
+			vertexKeys.push_back(key);
+			nextVertex.push_back(firstVertex[key[0]]);
+			firstVertex[key[0]] = vId;
+			data.vertexMatIds.push_back(material);
+			return vId;
+		};
+
+		size_t numTriangles = 0;
+		for (const auto & chunk : chunks) {
+			for (const uint size : chunk.faceSizes) {
+				numTriangles += size >= 3 ? size - 2 : 0;
+			}
+		}
+		data.triangles.resize(numTriangles);
+		data.matIds.resize(numTriangles);
+		size_t dst = 0;
+		bool invalidIds = false;
+		for (const auto & chunk : chunks) {
+			size_t cornerId = 0;
+			for (size_t fId = 0; fId < chunk.faceSizes.size(); ++fId) {
+				const uint size = chunk.faceSizes[fId];
+				const int material = chunk.faceMaterials[fId];
+				const size_t firstTriangle = dst;
+				bool valid = true;
+				addPolygon(data.triangles, dst, size, [&](uint c) {
+					const int vId = getVertex(chunk.corners[cornerId + c], material);
+					valid = valid && vId >= 0;
+					return uint(vId);
+				});
+				if (!valid) {
+					// Drop the whole face.
+					dst = firstTriangle;
+					invalidIds = true;
+				}
+				for (size_t tId = firstTriangle; tId < dst; ++tId) {
+					data.matIds[tId] = material;
+				}
+				cornerId += size;
+			}
+		}
+		data.triangles.resize(dst);
+		data.matIds.resize(dst);
+		if (invalidIds) {
+			SIBR_WRG << "Some faces of '" << filename << "' contain invalid vertex id(s)" << std::endl;
+		}
+
+		// Fill vertex attributes.
+		const int numVertices = int(vertexKeys.size());
+		data.vertices.resize(numVertices);
+		data.texcoords.resize(withUVs ? numVertices : 0);
+		data.normals.resize(withNormals ? numVertices : 0);
+		data.colors.resize(colors.empty() ? 0 : numVertices);
+#pragma omp parallel for
+		for (int vId = 0; vId < numVertices; ++vId) {
+			const Vector3i & key = vertexKeys[vId];
+			data.vertices[vId] = positions[key[0]];
+			if (!colors.empty()) {
+				data.colors[vId] = colors[key[0]];
+			}
+			if (withUVs) {
+				data.texcoords[vId] = key[1] >= 0 && key[1] < int(uvs.size()) ? uvs[key[1]] : Vector2f(0.0f, 0.0f);
+			}
+			if (withNormals) {
+				data.normals[vId] = key[2] >= 0 && key[2] < int(normals.size()) ? normals[key[2]] : Vector3f(0.0f, 0.0f, 0.0f);
+			}
+		}
+
+		cleanTriangles(data);
+		if (data.materials.empty()) {
+			setDefaultMaterial(data);
+		} else if (!data.matIds.empty()) {
+			data.textureFile = findDiffuseTexture(filename, libraries, data.materials[data.matIds[0]]);
+		}
+		return Status::Success;
+	}
+
+} // namespace sibr
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+# include <string>
+# include <vector>
+
+# include "core/graphics/Config.hpp"
+# include "core/system/Vector.hpp"
+
+namespace sibr
+{
+	/** Built-in mesh file readers for PLY (ASCII and binary) and OBJ files.
+	Files are loaded in memory at once and parsed by chunks in parallel. Readers fill attribute
+	arrays that can be directly swapped into a Mesh. Files using features that are not supported
+	(per-face texture coordinates, list properties on vertices,...) are reported as such so that
+	the caller can fall back to Assimp.
+	\ingroup sibr_graphics
+	*/
+	class SIBR_GRAPHICS_EXPORT MeshReader
+	{
+	public:
+
+		/** Result of a read attempt. */
+		enum class Status {
+			Success, ///< The file was read.
+			Unsupported, ///< The file format or a feature of the file is not handled, use another loader.
+			Error ///< The file is invalid or can't be read.
+		};
+
+		/** Mesh content read from a file. */
+		struct Data
+		{
+			std::vector<Vector3f> vertices; ///< Vertex positions.
+			std::vector<Vector3f> normals; ///< Vertex normals (empty if not present).
+			std::vector<Vector3f> colors; ///< Vertex colors in [0,1] (empty if not present).
+			std::vector<Vector2f> texcoords; ///< Vertex UVs (empty if not present).
+			std::vector<Vector3u> triangles; ///< Triangle indices.
+			std::vector<int> matIds; ///< Per triangle material index.
+			std::vector<int> vertexMatIds; ///< Per vertex material index.
+			std::vector<std::string> materials; ///< Material names.
+			std::string textureFile; ///< Diffuse texture referenced by the file, if any.
+		};
+
+		/** Read a mesh file, picking the reader based on the extension.
+		\param filename the file path
+		\param data will contain the mesh content
+		\param splitMaterials if true, OBJ vertices shared by faces with different materials will be duplicated
+		\return the read status
+		*/
+		static Status read(const std::string & filename, Data & data, bool splitMaterials = false);
+
+		/** Read a PLY file (ASCII, binary little or big endian). Polygons are triangulated as fans.
+		\param filename the file path
+		\param data will contain the mesh content
+		\return the read status
+		*/
+		static Status readPLY(const std::string & filename, Data & data);
+
+		/** Read an OBJ file. Polygons are triangulated as fans, and each unique
+		position/texcoord/normal combination referenced by faces generates a vertex.
+		\param filename the file path
+		\param data will contain the mesh content
+		\param splitMaterials if true, vertices shared by faces with different materials will be duplicated
+		\return the read status
+		*/
+		static Status readOBJ(const std::string & filename, Data & data, bool splitMaterials = false);
+
+	};
+
+} // namespace sibr
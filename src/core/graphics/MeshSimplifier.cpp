@@ -0,0 +1,386 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/graphics/MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sibr
+{
+	namespace
+	{
+		/** Symmetric quadric, sum of squared distances to weighted planes. */
+		struct Quadric
+		{
+			float a00 = 0, a11 = 0, a22 = 0, a10 = 0, a20 = 0, a21 = 0;
+			float b0 = 0, b1 = 0, b2 = 0;
+			float c = 0;
+			float w = 0; ///< Total weight (area) of the planes.
+
+			Quadric & operator+=(const Quadric & o)
+			{
+				a00 += o.a00; a11 += o.a11; a22 += o.a22; a10 += o.a10; a20 += o.a20; a21 += o.a21;
+				b0 += o.b0; b1 += o.b1; b2 += o.b2;
+				c += o.c;
+				w += o.w;
+				return *this;
+			}
+		};
+
+		/** Quadric of the plane (n,d), n normalized, weighted by w. */
+		Quadric planeQuadric(const Vector3f & n, float d, float w)
+		{
+			Quadric q;
+			q.a00 = w * n[0] * n[0]; q.a11 = w * n[1] * n[1]; q.a22 = w * n[2] * n[2];
+			q.a10 = w * n[1] * n[0]; q.a20 = w * n[2] * n[0]; q.a21 = w * n[2] * n[1];
+			q.b0 = w * n[0] * d; q.b1 = w * n[1] * d; q.b2 = w * n[2] * d;
+			q.c = w * d * d;
+			q.w = w;
+			return q;
+		}
+
+		/** Mean squared distance of p to the planes of the sum of two quadrics. */
+		float evaluate(const Quadric & q0, const Quadric & q1, const Vector3f & p)
+		{
+			Quadric q = q0;
+			q += q1;
+			const float rx = q.a00 * p[0] + q.a10 * p[1] + q.a20 * p[2];
+			const float ry = q.a10 * p[0] + q.a11 * p[1] + q.a21 * p[2];
+			const float rz = q.a20 * p[0] + q.a21 * p[1] + q.a22 * p[2];
+			const float r = rx * p[0] + ry * p[1] + rz * p[2] + 2.0f * (q.b0 * p[0] + q.b1 * p[1] + q.b2 * p[2]) + q.c;
+			return std::abs(r) / std::max(q.w, 1e-12f);
+		}
+
+		/** Collapse of the vertex from onto the vertex to. */
+		struct Collapse
+		{
+			uint from;
+			uint to;
+			float cost;
+		};
+
+		/** Compressed list of the triangles around each vertex. */
+		struct VertexTriangles
+		{
+			std::vector<uint> offsets;
+			std::vector<uint> triangles;
+
+			void build(size_t vertexCount, const Mesh::Triangles & tris)
+			{
+				offsets.assign(vertexCount + 1, 0);
+				for (const Vector3u & t : tris) {
+					++offsets[t[0] + 1]; ++offsets[t[1] + 1]; ++offsets[t[2] + 1];
+				}
+				for (size_t v = 0; v < vertexCount; ++v) {
+					offsets[v + 1] += offsets[v];
+				}
+				triangles.resize(tris.size() * 3);
+				std::vector<uint> fill(offsets.begin(), offsets.end() - 1);
+				for (size_t t = 0; t < tris.size(); ++t) {
+					for (int k = 0; k < 3; ++k) {
+						triangles[fill[tris[t][k]]++] = uint(t);
+					}
+				}
+			}
+
+			const uint * begin(uint v) const { return triangles.data() + offsets[v]; }
+			const uint * end(uint v) const { return triangles.data() + offsets[v + 1]; }
+		};
+
+		bool hasVertex(const Vector3u & t, uint v)
+		{
+			return t[0] == v || t[1] == v || t[2] == v;
+		}
+
+		/** \return the squared length of the longest edge of a triangle. */
+		float longestEdge(const Vector3f p[3])
+		{
+			return std::max((p[1] - p[0]).squaredNorm(), std::max((p[2] - p[1]).squaredNorm(), (p[0] - p[2]).squaredNorm()));
+		}
+
+		/** Count the triangles containing the oriented edge a->b. */
+		int countEdge(uint a, uint b, const Mesh::Triangles & tris, const VertexTriangles & adjacency)
+		{
+			int count = 0;
+			for (const uint * t = adjacency.begin(a); t != adjacency.end(a); ++t) {
+				const Vector3u & tri = tris[*t];
+				for (int k = 0; k < 3; ++k) {
+					count += (tri[k] == a && tri[(k + 1) % 3] == b) ? 1 : 0;
+				}
+			}
+			return count;
+		}
+
+		/** Find vertices on boundary or non-manifold edges, an edge a-b being manifold if a->b and b->a are each used by one triangle. */
+		std::vector<char> findLockedVertices(size_t vertexCount, const Mesh::Triangles & tris, const VertexTriangles & adjacency)
+		{
+			std::vector<char> locked(vertexCount, 0);
+#pragma omp parallel for
+			for (int v = 0; v < int(vertexCount); ++v) {
+				for (const uint * t = adjacency.begin(v); t != adjacency.end(v) && !locked[v]; ++t) {
+					const Vector3u & tri = tris[*t];
+					for (int k = 0; k < 3; ++k) {
+						if (tri[k] != uint(v)) {
+							continue;
+						}
+						// Both edges of the triangle incident to v.
+						const uint next = tri[(k + 1) % 3];
+						const uint prev = tri[(k + 2) % 3];
+						if (countEdge(uint(v), next, tris, adjacency) != 1 || countEdge(next, uint(v), tris, adjacency) != 1
+							|| countEdge(prev, uint(v), tris, adjacency) != 1 || countEdge(uint(v), prev, tris, adjacency) != 1) {
+							locked[v] = 1;
+						}
+					}
+				}
+			}
+			return locked;
+		}
+
+		/** Check that collapsing from onto to doesn't flip triangles nor create non-manifold edges.
+		 * The ring vectors are scratch buffers.
+		 * \return the number of triangles removed by the collapse, 0 if it is invalid.
+		 */
+		int validateCollapse(const Collapse & collapse, const Mesh::Triangles & tris, const VertexTriangles & adjacency,
+			const std::vector<Vector3f> & positions, std::vector<uint> & fromRing, std::vector<uint> & toRing, std::vector<uint> & opposite)
+		{
+			int removed = 0;
+			fromRing.clear();
+			for (const uint * t = adjacency.begin(collapse.from); t != adjacency.end(collapse.from); ++t) {
+				const Vector3u & tri = tris[*t];
+				if (hasVertex(tri, collapse.to)) {
+					++removed;
+					continue;
+				}
+				Vector3f p[3], q[3];
+				for (int k = 0; k < 3; ++k) {
+					p[k] = positions[tri[k]];
+					q[k] = tri[k] == collapse.from ? positions[collapse.to] : p[k];
+					if (tri[k] != collapse.from) {
+						fromRing.push_back(tri[k]);
+					}
+				}
+				const Vector3f n0 = (p[1] - p[0]).cross(p[2] - p[0]);
+				const Vector3f n1 = (q[1] - q[0]).cross(q[2] - q[0]);
+				const float norms = n0.norm() * n1.norm();
+				if (norms <= 0.0f || n0.dot(n1) < 0.25f * norms) {
+					return 0;
+				}
+				// Small normal changes could add up to a flip over several collapses, so slivers are not created either.
+				const float quality0 = n0.norm() / longestEdge(p);
+				const float quality1 = n1.norm() / longestEdge(q);
+				if (quality1 < 0.02f && quality1 < quality0) {
+					return 0;
+				}
+			}
+			if (removed == 0) {
+				return 0;
+			}
+			// Link condition: the only vertices adjacent to both ends are the ones opposite to the edge.
+			toRing.clear();
+			opposite.clear();
+			for (const uint * t = adjacency.begin(collapse.to); t != adjacency.end(collapse.to); ++t) {
+				const Vector3u & tri = tris[*t];
+				const bool shared = hasVertex(tri, collapse.from);
+				for (int k = 0; k < 3; ++k) {
+					if (tri[k] != collapse.to && tri[k] != collapse.from) {
+						(shared ? opposite : toRing).push_back(tri[k]);
+					}
+				}
+			}
+			std::sort(fromRing.begin(), fromRing.end());
+			fromRing.erase(std::unique(fromRing.begin(), fromRing.end()), fromRing.end());
+			std::sort(toRing.begin(), toRing.end());
+			toRing.erase(std::unique(toRing.begin(), toRing.end()), toRing.end());
+			std::vector<uint>::const_iterator f = fromRing.begin(), t = toRing.begin();
+			while (f != fromRing.end() && t != toRing.end()) {
+				if (*f < *t) { ++f; }
+				else if (*t < *f) { ++t; }
+				else {
+					if (std::find(opposite.begin(), opposite.end(), *f) == opposite.end()) {
+						return 0;
+					}
+					++f;
+					++t;
+				}
+			}
+			return removed;
+		}
+	}
+
+	Mesh::Ptr MeshSimplifier::simplify(const Mesh & mesh, size_t targetTriangles, float maxError, float * error)
+	{
+		const Mesh::Vertices & vertices = mesh.vertices();
+		const size_t vertexCount = vertices.size();
+		Mesh::Triangles tris = mesh.triangles();
+
+		// Work in the unit cube for quadric precision.
+		const Eigen::AlignedBox<float, 3> box = mesh.getBoundingBox();
+		const float scale = box.isEmpty() ? 1.0f : std::max(box.diagonal().maxCoeff(), 1e-12f);
+		std::vector<Vector3f> positions(vertexCount);
+#pragma omp parallel for
+		for (int v = 0; v < int(vertexCount); ++v) {
+			positions[v] = (vertices[v] - box.min()) / scale;
+		}
+		const float maxCost = maxError < std::numeric_limits<float>::max() ? (maxError / scale) * (maxError / scale) : std::numeric_limits<float>::max();
+
+		VertexTriangles adjacency;
+		adjacency.build(vertexCount, tris);
+		const std::vector<char> locked = findLockedVertices(vertexCount, tris, adjacency);
+
+		// Initial quadrics, from the area-weighted planes of adjacent triangles.
+		std::vector<Quadric> triangleQuadrics(tris.size());
+#pragma omp parallel for
+		for (int t = 0; t < int(tris.size()); ++t) {
+			const Vector3f & p0 = positions[tris[t][0]];
+			const Vector3f n = (positions[tris[t][1]] - p0).cross(positions[tris[t][2]] - p0);
+			const float area = n.norm();
+			if (area > 0.0f) {
+				triangleQuadrics[t] = planeQuadric(n / area, -p0.dot(n / area), 0.5f * area);
+			}
+		}
+		std::vector<Quadric> quadrics(vertexCount);
+#pragma omp parallel for
+		for (int v = 0; v < int(vertexCount); ++v) {
+			for (const uint * t = adjacency.begin(v); t != adjacency.end(v); ++t) {
+				quadrics[v] += triangleQuadrics[*t];
+			}
+		}
+		triangleQuadrics.clear();
+		triangleQuadrics.shrink_to_fit();
+
+		float appliedCost = 0.0f;
+		std::vector<Collapse> collapses;
+		std::vector<char> touched;
+		std::vector<uint> fromRing, toRing, opposite;
+		bool firstPass = true;
+		while (tris.size() > targetTriangles) {
+			if (!firstPass) {
+				adjacency.build(vertexCount, tris);
+			}
+			firstPass = false;
+
+			// Cheapest collapse of each triangle.
+			collapses.resize(tris.size());
+#pragma omp parallel for
+			for (int t = 0; t < int(tris.size()); ++t) {
+				Collapse best = { 0, 0, std::numeric_limits<float>::max() };
+				for (int k = 0; k < 3; ++k) {
+					const uint from = tris[t][k];
+					const uint to = tris[t][(k + 1) % 3];
+					for (const Collapse & candidate : { Collapse{ from, to, 0.0f }, Collapse{ to, from, 0.0f } }) {
+						if (locked[candidate.from]) {
+							continue;
+						}
+						const float cost = evaluate(quadrics[candidate.from], quadrics[candidate.to], positions[candidate.to]);
+						if (cost < best.cost) {
+							best = { candidate.from, candidate.to, cost };
+						}
+					}
+				}
+				collapses[t] = best;
+			}
+			// Triangles with only locked vertices have no valid collapse.
+			collapses.erase(std::remove_if(collapses.begin(), collapses.end(), [maxCost](const Collapse & c) {
+				return c.from == c.to || c.cost > maxCost;
+			}), collapses.end());
+
+			// Only the cheapest collapses can be applied in this pass, each removing about two triangles.
+			const size_t toRemove = tris.size() - targetTriangles;
+			const auto byCost = [](const Collapse & c0, const Collapse & c1) { return c0.cost < c1.cost; };
+			const size_t sortedCount = std::min(collapses.size(), std::max<size_t>(1024, 2 * toRemove));
+			std::nth_element(collapses.begin(), collapses.begin() + sortedCount - (sortedCount > 0 ? 1 : 0), collapses.end(), byCost);
+			std::sort(collapses.begin(), collapses.begin() + sortedCount, byCost);
+
+			// Apply independent collapses: the triangles around a collapsed vertex can't be modified twice in a pass.
+			touched.assign(vertexCount, 0);
+			size_t removed = 0;
+			for (size_t c = 0; c < sortedCount && removed < toRemove; ++c) {
+				const Collapse & collapse = collapses[c];
+				if (touched[collapse.from] || touched[collapse.to]) {
+					continue;
+				}
+				const int collapseRemoved = validateCollapse(collapse, tris, adjacency, positions, fromRing, toRing, opposite);
+				if (collapseRemoved == 0) {
+					continue;
+				}
+				for (const uint * t = adjacency.begin(collapse.from); t != adjacency.end(collapse.from); ++t) {
+					Vector3u & tri = tris[*t];
+					for (int k = 0; k < 3; ++k) {
+						touched[tri[k]] = 1;
+						if (tri[k] == collapse.from) {
+							tri[k] = collapse.to;
+						}
+					}
+				}
+				quadrics[collapse.to] += quadrics[collapse.from];
+				appliedCost = std::max(appliedCost, collapse.cost);
+				removed += size_t(collapseRemoved);
+			}
+			if (removed == 0) {
+				break;
+			}
+			tris.erase(std::remove_if(tris.begin(), tris.end(), [](const Vector3u & t) {
+				return t[0] == t[1] || t[1] == t[2] || t[2] == t[0];
+			}), tris.end());
+		}
+
+		// Keep the used vertices, in their initial order.
+		std::vector<uint> newIndices(vertexCount, 0);
+		for (const Vector3u & t : tris) {
+			newIndices[t[0]] = newIndices[t[1]] = newIndices[t[2]] = 1;
+		}
+		uint usedCount = 0;
+		for (size_t v = 0; v < vertexCount; ++v) {
+			newIndices[v] = newIndices[v] ? usedCount++ : uint(-1);
+		}
+
+		Mesh::Vertices outVertices(usedCount);
+		Mesh::Normals outNormals(mesh.hasNormals() ? usedCount : 0);
+		Mesh::Colors outColors(mesh.hasColors() ? usedCount : 0);
+		Mesh::UVs outUVs(mesh.hasTexCoords() ? usedCount : 0);
+#pragma omp parallel for
+		for (int v = 0; v < int(vertexCount); ++v) {
+			const uint id = newIndices[v];
+			if (id == uint(-1)) {
+				continue;
+			}
+			outVertices[id] = vertices[v];
+			if (mesh.hasNormals()) {
+				outNormals[id] = mesh.normals()[v];
+			}
+			if (mesh.hasColors()) {
+				outColors[id] = mesh.colors()[v];
+			}
+			if (mesh.hasTexCoords()) {
+				outUVs[id] = mesh.texCoords()[v];
+			}
+		}
+#pragma omp parallel for
+		for (int t = 0; t < int(tris.size()); ++t) {
+			tris[t] = Vector3u(newIndices[tris[t][0]], newIndices[tris[t][1]], newIndices[tris[t][2]]);
+		}
+
+		Mesh::Ptr result(new Mesh(mesh._gl.bufferGL != nullptr));
+		result->vertices(outVertices);
+		result->normals(outNormals);
+		result->colors(outColors);
+		result->texCoords(outUVs);
+		result->triangles(tris);
+		result->vertexFormat(mesh.vertexFormat());
+		if (error) {
+			*error = std::sqrt(appliedCost) * scale;
+		}
+		return result;
+	}
+
+} // namespace sibr
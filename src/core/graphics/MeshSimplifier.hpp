@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/graphics/Config.hpp"
+#include "core/graphics/Mesh.hpp"
+
+#include <limits>
+
+namespace sibr
+{
+	/** Quadric error mesh simplification (Garland and Heckbert 1997).
+	 * Edges are collapsed onto one of their vertices, in batches of independent collapses
+	 * ordered by quadric error, so the simplified mesh uses a subset of the input vertices
+	 * and their UVs, normals and colors are preserved as is. Vertices on boundaries,
+	 * including UV seams where vertices are split, are never removed.
+	 * \ingroup sibr_graphics
+	 */
+	class SIBR_GRAPHICS_EXPORT MeshSimplifier
+	{
+	public:
+
+		/** Simplify a mesh.
+		 * \param mesh the mesh to simplify
+		 * \param targetTriangles the desired number of triangles, might not be reached if boundaries prevent it
+		 * \param maxError maximum error allowed for a collapse, as a distance in mesh units
+		 * \param error if not null, will contain the estimated geometric error of the result, in mesh units
+		 * \return the simplified mesh, with GL buffers if the input mesh has them
+		 */
+		static Mesh::Ptr simplify(const Mesh & mesh, size_t targetTriangles,
+			float maxError = std::numeric_limits<float>::max(), float * error = nullptr);
+	};
+
+} // namespace sibr
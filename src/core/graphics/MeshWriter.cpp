@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+
+#include "core/graphics/MeshWriter.hpp"
+#include "boost/filesystem.hpp"
+
+namespace sibr
+{
+	namespace
+	{
+		/// Number of elements formatted by a worker in a text chunk.
+		const size_t textChunkElements = 16384;
+
+		/// Number of text chunks formatted in parallel before being written to the file.
+		const size_t textChunksPerBatch = 64;
+
+		/// Default float precision of std streams, used by the PLY writers.
+		const std::streamsize plyPrecision = 6;
+
+		/// Digits needed for a float to be read back exactly.
+		const std::streamsize objPrecision = 9;
+
+		/// Name of the single material exported to OBJ files, consistent with Assimp.
+		const char* defaultMaterialName = "DefaultMaterial";
+
+		inline bool hostIsBigEndian()
+		{
+			const uint16_t one = 1;
+			return *(const uint8_t*)&one == 0;
+		}
+
+		/** Store a value at a (potentially unaligned) location, swapping its bytes if needed.
+		\return the location after the value
+		*/
+		template<typename T>
+		inline char* storeValue(char* dst, T value, bool swap)
+		{
+			std::memcpy(dst, &value, sizeof(T));
+			if (swap) {
+				std::reverse(dst, dst + sizeof(T));
+			}
+			return dst + sizeof(T);
+		}
+
+		/** Format elements in text chunks on worker threads and write them to the file in order.
+		Only a bounded number of chunks is kept in memory at once.
+		\param file the destination
+		\param count the number of elements
+		\param precision the float precision to use
+		\param format functor writing element i to an output stream
+		*/
+		template<typename Formatter>
+		void streamTextChunks(std::ofstream & file, size_t count, std::streamsize precision, const Formatter & format)
+		{
+			std::vector<std::string> chunks(textChunksPerBatch);
+			for (size_t batchStart = 0; batchStart < count; batchStart += textChunksPerBatch * textChunkElements) {
+				const size_t batchCount = std::min(count - batchStart, textChunksPerBatch * textChunkElements);
+				const int numChunks = int((batchCount + textChunkElements - 1) / textChunkElements);
+
+#pragma omp parallel for schedule(dynamic)
+				for (int c = 0; c < numChunks; ++c) {
+					const size_t first = batchStart + size_t(c) * textChunkElements;
+					const size_t last = std::min(first + textChunkElements, batchStart + batchCount);
+					std::ostringstream stream;
+					stream.precision(precision);
+					for (size_t i = first; i < last; ++i) {
+						format(stream, i);
+					}
+					chunks[c] = stream.str();
+				}
+
+				for (int c = 0; c < numChunks; ++c) {
+					file.write(chunks[c].data(), chunks[c].size());
+					std::string().swap(chunks[c]);
+				}
+			}
+		}
+
+		/** Generate the PLY header, identical for all encodings but the format line. */
+		std::string plyHeader(const Mesh & mesh, MeshWriter::Encoding encoding, bool universal, const std::string & textureName)
+		{
+			std::ostringstream header;
+			header << "ply" << "\n";
+			if (encoding == MeshWriter::Encoding::ASCII) {
+				header << "format ascii 1.0" << "\n";
+			}
+			else if (encoding == MeshWriter::Encoding::BinaryBigEndian) {
+				header << "format binary_big_endian 1.0" << "\n";
+			}
+			else {
+				header << "format binary_little_endian 1.0" << "\n";
+			}
+			header << "comment Created by SIBR project" << "\n";
+			if (mesh.hasTexCoords()) {
+				header << "comment TextureFile " << textureName << "\n";
+			}
+			header << "element vertex " << mesh.vertices().size() << "\n";
+			header << "property float x" << "\n";
+			header << "property float y" << "\n";
+			header << "property float z" << "\n";
+			if (mesh.hasColors()) {
+				const std::string type = universal ? "uchar" : "ushort";
+				header << "property " << type << " red" << "\n";
+				header << "property " << type << " green" << "\n";
+				header << "property " << type << " blue" << "\n";
+			}
+			if (mesh.hasNormals()) {
+				header << "property float nx" << "\n";
+				header << "property float ny" << "\n";
+				header << "property float nz" << "\n";
+			}
+			if (mesh.hasTexCoords()) {
+				header << "property float texture_u" << "\n";
+				header << "property float texture_v" << "\n";
+			}
+			header << "element face " << mesh.triangles().size() << "\n";
+			header << "property list uchar uint vertex_indices" << "\n";
+			header << "end_header" << "\n";
+			return header.str();
+		}
+
+		/** Serialize the header and the vertex and face blocks of a binary PLY in a single buffer. */
+		void serializeBinaryPLY(const Mesh & mesh, const std::string & header, bool bigEndian, bool universal, std::vector<char> & buffer)
+		{
+			const Mesh::Vertices & vertices = mesh.vertices();
+			const Mesh::Triangles & triangles = mesh.triangles();
+			const bool hasColors = mesh.hasColors();
+			const bool hasNormals = mesh.hasNormals();
+			const bool hasTexCoords = mesh.hasTexCoords();
+			const bool swap = bigEndian != hostIsBigEndian();
+
+			const size_t colorSize = hasColors ? 3 * (universal ? sizeof(uint8) : sizeof(uint16)) : 0;
+			const size_t vertexStride = 3 * sizeof(float) + colorSize
+				+ (hasNormals ? 3 * sizeof(float) : 0) + (hasTexCoords ? 2 * sizeof(float) : 0);
+			const size_t faceStride = sizeof(uint8) + 3 * sizeof(uint32);
+
+			buffer.resize(header.size() + vertices.size() * vertexStride + triangles.size() * faceStride);
+			std::memcpy(buffer.data(), header.data(), header.size());
+			char * const vertexBlock = buffer.data() + header.size();
+			char * const faceBlock = vertexBlock + vertices.size() * vertexStride;
+
+			if (!swap && vertexStride == sizeof(Vector3f)) {
+				// Positions only, in the host byte order: the array can be copied as is.
+				std::memcpy(vertexBlock, vertices.data(), vertices.size() * vertexStride);
+			}
+			else {
+#pragma omp parallel for
+				for (int i = 0; i < int(vertices.size()); ++i) {
+					char * dst = vertexBlock + size_t(i) * vertexStride;
+					const Vector3f & v = vertices[i];
+					dst = storeValue(dst, float(v[0]), swap);
+					dst = storeValue(dst, float(v[1]), swap);
+					dst = storeValue(dst, float(v[2]), swap);
+
+					if (hasColors) {
+						const Vector3f & c = mesh.colors()[i];
+						// ! converting colors explicitly
+						for (int k = 0; k < 3; ++k) {
+							if (universal) {
+								dst = storeValue(dst, uint8(c[k] * (UINT8_MAX - 1)), swap);
+							}
+							else {
+								dst = storeValue(dst, uint16(c[k] * (UINT16_MAX - 1)), swap);
+							}
+						}
+					}
+
+					if (hasNormals) {
+						const Vector3f & n = mesh.normals()[i];
+						dst = storeValue(dst, float(n[0]), swap);
+						dst = storeValue(dst, float(n[1]), swap);
+						dst = storeValue(dst, float(n[2]), swap);
+					}
+
+					if (hasTexCoords) {
+						const Vector2f & uv = mesh.texCoords()[i];
+						dst = storeValue(dst, float(uv[0]), swap);
+						dst = storeValue(dst, float(uv[1]), swap);
+					}
+				}
+			}
+
+#pragma omp parallel for
+			for (int i = 0; i < int(triangles.size()); ++i) {
+				char * dst = faceBlock + size_t(i) * faceStride;
+				const Vector3u & tri = triangles[i];
+				dst = storeValue(dst, uint8(3), swap);
+				for (int j = 0; j < 3; ++j) {
+					dst = storeValue(dst, uint32(tri[j]), swap);
+				}
+			}
+		}
+
+	}
+
+	bool MeshWriter::writePLY(const Mesh & mesh, const std::string & filename, Encoding encoding, bool universal, const std::string & textureName)
+	{
+		std::ofstream file(filename.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+		if (!file) {
+			SIBR_LOG << "error: cannot write to file '" << filename << "'." << std::endl;
+			return false;
+		}
+
+		const std::string header = plyHeader(mesh, encoding, universal, textureName);
+
+		if (encoding != Encoding::ASCII) {
+			std::vector<char> buffer;
+			serializeBinaryPLY(mesh, header, encoding == Encoding::BinaryBigEndian, universal, buffer);
+			file.write(buffer.data(), buffer.size());
+			return bool(file);
+		}
+
+		file.write(header.data(), header.size());
+
+		const bool hasColors = mesh.hasColors();
+		const bool hasNormals = mesh.hasNormals();
+		const bool hasTexCoords = mesh.hasTexCoords();
+		const int colorScale = universal ? (UINT8_MAX - 1) : (UINT16_MAX - 1);
+
+		streamTextChunks(file, mesh.vertices().size(), plyPrecision, [&](std::ostream & out, size_t i) {
+			const Vector3f & v = mesh.vertices()[i];
+			out << v[0] << " " << v[1] << " " << v[2] << " ";
+			if (hasColors) {
+				const Vector3f & c = mesh.colors()[i];
+				out << int(c[0] * colorScale) << " " << int(c[1] * colorScale) << " " << int(c[2] * colorScale) << " ";
+			}
+			if (hasNormals) {
+				const Vector3f & n = mesh.normals()[i];
+				out << n[0] << " " << n[1] << " " << n[2] << " ";
+			}
+			if (hasTexCoords) {
+				const Vector2f & uv = mesh.texCoords()[i];
+				out << uv[0] << " " << uv[1] << " ";
+			}
+			out << "\n";
+		});
+
+		streamTextChunks(file, mesh.triangles().size(), plyPrecision, [&](std::ostream & out, size_t i) {
+			const Vector3u & tri = mesh.triangles()[i];
+			out << 3 << " " << tri[0] << " " << tri[1] << " " << tri[2] << "\n";
+		});
+
+		return bool(file);
+	}
+
+	bool MeshWriter::writeOBJ(const Mesh & mesh, const std::string & filename)
+	{
+		std::ofstream file(filename.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+		if (!file) {
+			SIBR_LOG << "error: cannot write to file '" << filename << "'." << std::endl;
+			return false;
+		}
+
+		// Material library next to the OBJ, containing the single default material.
+		const boost::filesystem::path mtlPath = boost::filesystem::path(filename).replace_extension(".mtl");
+		std::ofstream mtlFile(mtlPath.string().c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+		if (mtlFile) {
+			mtlFile << "# Created by SIBR project" << "\n";
+			mtlFile << "newmtl " << defaultMaterialName << "\n";
+			mtlFile << "Kd 0.6 0.6 0.6" << "\n";
+		}
+		else {
+			SIBR_WRG << "Unable to write material library '" << mtlPath.string() << "'." << std::endl;
+		}
+
+		const bool hasNormals = mesh.hasNormals();
+		const bool hasTexCoords = mesh.hasTexCoords();
+
+		std::ostringstream header;
+		header << "# Created by SIBR project" << "\n";
+		if (mtlFile) {
+			header << "mtllib " << mtlPath.filename().string() << "\n";
+		}
+		header << "\n" << "# " << mesh.vertices().size() << " vertex positions" << "\n";
+		const std::string headerStr = header.str();
+		file.write(headerStr.data(), headerStr.size());
+
+		streamTextChunks(file, mesh.vertices().size(), objPrecision, [&](std::ostream & out, size_t i) {
+			const Vector3f & v = mesh.vertices()[i];
+			out << "v " << v[0] << " " << v[1] << " " << v[2] << "\n";
+		});
+
+		if (hasTexCoords) {
+			file << "\n" << "# " << mesh.texCoords().size() << " UV coordinates" << "\n";
+			streamTextChunks(file, mesh.texCoords().size(), objPrecision, [&](std::ostream & out, size_t i) {
+				const Vector2f & uv = mesh.texCoords()[i];
+				out << "vt " << uv[0] << " " << uv[1] << "\n";
+			});
+		}
+
+		if (hasNormals) {
+			file << "\n" << "# " << mesh.normals().size() << " vertex normals" << "\n";
+			streamTextChunks(file, mesh.normals().size(), objPrecision, [&](std::ostream & out, size_t i) {
+				const Vector3f & n = mesh.normals()[i];
+				out << "vn " << n[0] << " " << n[1] << " " << n[2] << "\n";
+			});
+		}
+
+		file << "\n" << "# " << mesh.triangles().size() << " faces" << "\n";
+		if (mtlFile) {
+			file << "usemtl " << defaultMaterialName << "\n";
+		}
+		streamTextChunks(file, mesh.triangles().size(), objPrecision, [&](std::ostream & out, size_t i) {
+			const Vector3u & tri = mesh.triangles()[i];
+			out << "f";
+			for (int j = 0; j < 3; ++j) {
+				// OBJ indices start at 1.
+				const uint id = tri[j] + 1;
+				out << " " << id;
+				if (hasTexCoords && hasNormals) {
+					out << "/" << id << "/" << id;
+				}
+				else if (hasTexCoords) {
+					out << "/" << id;
+				}
+				else if (hasNormals) {
+					out << "//" << id;
+				}
+			}
+			out << "\n";
+		});
+
+		return bool(file);
+	}
+
+} // namespace sibr
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+# include <string>
+
+# include "core/graphics/Config.hpp"
+# include "core/graphics/Mesh.hpp"
+
+namespace sibr
+{
+	/** Built-in mesh file writers for PLY (ASCII and binary) and OBJ files.
+	Binary content is serialized in parallel in a single buffer and written at once, while text
+	content is formatted by chunks on worker threads and streamed to the file in order.
+	\ingroup sibr_graphics
+	*/
+	class SIBR_GRAPHICS_EXPORT MeshWriter
+	{
+	public:
+
+		/** PLY file encoding. */
+		enum class Encoding {
+			ASCII, ///< Text file.
+			BinaryBigEndian, ///< Binary file, big endian (default SIBR output).
+			BinaryLittleEndian ///< Binary file, little endian (no byte swapping on most hosts).
+		};
+
+		/** Write a mesh to a PLY file.
+		\param mesh the mesh to save
+		\param filename the file path
+		\param encoding the PLY encoding to use
+		\param universal if true, colors are stored as uchar (readable by most tools), else as ushort
+		\param textureName name of a texture to reference in the file (Meshlab compatible)
+		\return true if the file was written
+		*/
+		static bool writePLY(const Mesh & mesh, const std::string & filename, Encoding encoding, bool universal, const std::string & textureName);
+
+		/** Write a mesh to an OBJ file, along with a material library containing a default material.
+		Floats are written with enough digits to be read back exactly.
+		\param mesh the mesh to save
+		\param filename the file path
+		\return true if the file was written
+		\warning vertex colors are not saved
+		*/
+		static bool writeOBJ(const Mesh & mesh, const std::string & filename);
+
+	};
+
+} // namespace sibr
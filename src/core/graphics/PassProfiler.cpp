@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/graphics/PassProfiler.hpp"
+
+namespace sibr
+{
+	PassProfiler::Scope::Scope(const std::string & name)
+	{
+		_started = PassProfiler::instance().begin(name);
+	}
+
+	PassProfiler::Scope::~Scope(void)
+	{
+		end();
+	}
+
+	void PassProfiler::Scope::end(void)
+	{
+		if (_started) {
+			PassProfiler::instance().end();
+			_started = false;
+		}
+	}
+
+	PassProfiler & PassProfiler::instance()
+	{
+		static PassProfiler profiler;
+		return profiler;
+	}
+
+	void PassProfiler::enabled(bool enable)
+	{
+		if (_running) {
+			end();
+		}
+		_enabled = enable;
+		_passes.clear();
+	}
+
+	bool PassProfiler::begin(const std::string & name)
+	{
+		if (!_enabled || _running) {
+			return false;
+		}
+		const size_t id = _passes.size();
+		reserve(id + 1);
+		_passes.push_back({ name, 0.0, 0.0 });
+		_running = true;
+		_timer.tic();
+		glQueryCounter(_queries[id][0], GL_TIMESTAMP);
+		return true;
+	}
+
+	void PassProfiler::reserve(size_t count)
+	{
+		while (_queries.size() < count) {
+			_queries.emplace_back();
+			glGenQueries(2, _queries.back().data());
+		}
+	}
+
+	void PassProfiler::end(void)
+	{
+		if (!_running) {
+			return;
+		}
+		glQueryCounter(_queries[_passes.size() - 1][1], GL_TIMESTAMP);
+		_passes.back().cpu = _timer.deltaTimeFromLastTic<Timer::nano>() * 1e-6;
+		_running = false;
+	}
+
+	std::vector<PassProfiler::Pass> PassProfiler::collect(void)
+	{
+		if (_running) {
+			SIBR_WRG << "[PassProfiler] Pass " << _passes.back().name << " still running, ending it first." << std::endl;
+			end();
+		}
+		std::vector<Pass> passes;
+		passes.swap(_passes);
+		for (size_t id = 0; id < passes.size(); ++id) {
+			GLuint64 start = 0, end = 0;
+			glGetQueryObjectui64v(_queries[id][0], GL_QUERY_RESULT, &start);
+			glGetQueryObjectui64v(_queries[id][1], GL_QUERY_RESULT, &end);
+			passes[id].gpu = double(end - start) * 1e-6;
+		}
+		return passes;
+	}
+
+} // namespace sibr
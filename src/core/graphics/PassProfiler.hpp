@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/graphics/Config.hpp"
+#include "core/system/SimpleTimer.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace sibr
+{
+	/** Measure the CPU and GPU durations of the rendering passes of a frame.
+	 * Renderers mark their passes with a Scope, which does nothing unless the profiler is enabled
+	 * (for instance by PathBenchmark). GPU durations are measured with pairs of GL_TIMESTAMP queries,
+	 * so passes can be measured inside a longer timed section (such as a whole frame).
+	 * Passes don't nest: a pass started while another one is running is ignored.
+	 *
+	 * Code example:
+	 *
+	 *		PassProfiler::Scope depthPass("ULR depth");
+	 *		renderProxyDepth(mesh, eye);
+	 *		depthPass.end();
+	 *		PassProfiler::Scope blendingPass("ULR blending");
+	 *		renderBlending(eye, dst);
+	 *
+	 * \ingroup sibr_graphics
+	 */
+	class SIBR_GRAPHICS_EXPORT PassProfiler
+	{
+		SIBR_DISALLOW_COPY(PassProfiler);
+	public:
+
+		/** Durations of a pass, in milliseconds. */
+		struct Pass {
+			std::string name; ///< Pass name.
+			double cpu; ///< Time spent submitting the pass on the CPU.
+			double gpu; ///< Time spent executing the pass on the GPU.
+		};
+
+		/** Mark a pass for its lifetime. */
+		class SIBR_GRAPHICS_EXPORT Scope
+		{
+		public:
+			/** Start a pass if the profiler is enabled.
+			 * \param name the pass name
+			 */
+			Scope(const std::string & name);
+
+			/** End the pass, if it was started. */
+			~Scope(void);
+
+			/** End the pass before the end of the scope. */
+			void end(void);
+
+		private:
+			bool _started; ///< Was a pass started.
+		};
+
+		/** \return the profiler shared by all renderers */
+		static PassProfiler & instance();
+
+		/// Constructor.
+		PassProfiler(void) = default;
+
+		/** Enable or disable measurements. Disabling discards the passes not collected yet.
+		 * \param enable the new state
+		 */
+		void enabled(bool enable);
+
+		/** \return true if passes are measured */
+		bool enabled(void) const { return _enabled; }
+
+		/** Create the queries of a number of passes in advance, so that no query is created while measuring.
+		 * \param count the number of passes per frame
+		 */
+		void reserve(size_t count);
+
+		/** Start a pass.
+		 * \param name the pass name
+		 * \return false if the profiler is disabled or a pass is already running
+		 */
+		bool begin(const std::string & name);
+
+		/** End the running pass. */
+		void end(void);
+
+		/** Wait for the GPU durations of the passes ended since the last call and return them.
+		 * \return the passes, in the order they were started
+		 */
+		std::vector<Pass> collect(void);
+
+	private:
+
+		bool _enabled = false; ///< Are passes measured.
+		bool _running = false; ///< Is a pass running.
+		sibr::Timer _timer; ///< CPU timer of the running pass.
+		std::vector<Pass> _passes; ///< Passes not collected yet, GPU durations pending.
+		std::vector<std::array<GLuint, 2>> _queries; ///< Start and end timestamp queries of each pass, reused from frame to frame.
+	};
+
+} // namespace sibr
@@ -18,6 +18,7 @@
 # include "core/graphics/Types.hpp"
 # include "core/system/Vector.hpp"
 # include "core/graphics/RenderUtility.hpp"
+# include "core/system/MemoryTracker.hpp"
 
 
 # define SIBR_MAX_SHADER_ATTACHMENTS (1<<3)
@@ -102,6 +103,7 @@ namespace sibr
 		bool   m_stencil = false; ///< Has a stencil buffer.
 		uint   m_W = 0; ///< Width.
 		uint   m_H = 0; ///< Height.
+		MemoryTracker::Allocation m_allocation { MemoryTracker::Category::RenderTargets }; ///< Memory accounting.
 
 	public:
 
@@ -468,6 +470,14 @@ namespace sibr
 		}
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		CHECK_GL_ERROR;
+
+		// Color attachments (with all their samples and mipmaps) and the 32 bits depth buffer.
+		const size_t samples = m_msaa ? size_t(((flags >> 7) & 0xF) << 2) : 1;
+		size_t colorBytes = size_t(w) * h * samples * sizeof(T_Type) * T_NumComp * m_numtargets;
+		if (m_autoMIPMAP) {
+			colorBytes += colorBytes / 3;
+		}
+		m_allocation.resize(colorBytes + (is_depth ? 0 : size_t(w) * h * samples * 4));
 	}
 
 	template<typename T_Type, unsigned int T_NumComp>
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/graphics/SceneBVH.hpp"
+
+#include <algorithm>
+
+namespace sibr
+{
+
+	void SceneBVH::build(const std::vector<Eigen::AlignedBox3f> & boxes, uint leafSize)
+	{
+		_nodes.clear();
+		_indices.clear();
+		_boxes = boxes;
+
+		std::vector<Vector3f> centers(boxes.size());
+		for (uint i = 0; i < uint(boxes.size()); ++i) {
+			if (!boxes[i].isEmpty()) {
+				_indices.push_back(i);
+				centers[i] = boxes[i].center();
+			}
+		}
+		if (_indices.empty()) {
+			return;
+		}
+		_nodes.reserve(2 * _indices.size() / std::max(leafSize, 1u) + 1);
+		buildNode(boxes, centers, 0, uint(_indices.size()), std::max(leafSize, 1u));
+	}
+
+	uint SceneBVH::buildNode(const std::vector<Eigen::AlignedBox3f> & boxes, const std::vector<Vector3f> & centers, uint first, uint count, uint leafSize)
+	{
+		const uint id = uint(_nodes.size());
+		_nodes.emplace_back();
+
+		Eigen::AlignedBox3f box;
+		Eigen::AlignedBox3f centerBox;
+		for (uint i = first; i < first + count; ++i) {
+			box.extend(boxes[_indices[i]]);
+			centerBox.extend(centers[_indices[i]]);
+		}
+		_nodes[id].box = box;
+		_nodes[id].first = first;
+		_nodes[id].count = count;
+
+		const Vector3f extent = centerBox.sizes();
+		int axis = 0;
+		extent.maxCoeff(&axis);
+		if (count <= leafSize || extent[axis] <= 0.0f) {
+			return id;
+		}
+
+		// Median split, each half is kept contiguous in the index list.
+		const uint half = count / 2;
+		std::nth_element(_indices.begin() + first, _indices.begin() + first + half, _indices.begin() + first + count,
+			[&centers, axis](uint a, uint b) { return centers[a][axis] < centers[b][axis]; });
+
+		buildNode(boxes, centers, first, half, leafSize);
+		const uint right = buildNode(boxes, centers, first + half, count - half, leafSize);
+		_nodes[id].right = right;
+		return id;
+	}
+
+	size_t SceneBVH::cull(const Frustum & frustum, std::vector<uint> & visible) const
+	{
+		visible.clear();
+		if (_nodes.empty()) {
+			return 0;
+		}
+
+		size_t tests = 0;
+		std::vector<uint> stack = { 0 };
+		while (!stack.empty()) {
+			const Node & node = _nodes[stack.back()];
+			const uint id = stack.back();
+			stack.pop_back();
+
+			++tests;
+			const Frustum::TestResult result = frustum.testBox(node.box);
+			if (result == Frustum::OUTSIDE) {
+				continue;
+			}
+			if (result == Frustum::INSIDE) {
+				visible.insert(visible.end(), _indices.begin() + node.first, _indices.begin() + node.first + node.count);
+				continue;
+			}
+			if (node.right == 0) {
+				for (uint i = node.first; i < node.first + node.count; ++i) {
+					++tests;
+					if (frustum.testBox(_boxes[_indices[i]]) != Frustum::OUTSIDE) {
+						visible.push_back(_indices[i]);
+					}
+				}
+				continue;
+			}
+			stack.push_back(node.right);
+			stack.push_back(id + 1);
+		}
+		return tests;
+	}
+
+} // namespace sibr
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/graphics/Config.hpp"
+#include "core/graphics/Frustum.hpp"
+
+#include <vector>
+
+namespace sibr
+{
+
+	/** Bounding volume hierarchy over the world-space boxes of the objects of a scene, used for visibility culling.
+	 * The tree is binary, split at the median of the box centers along the largest axis, and stored in a flat array.
+	 * Each node covers a contiguous range of objects, so a node entirely inside the frustum is accepted without visiting its children.
+	 * \ingroup sibr_graphics
+	 */
+	class SIBR_GRAPHICS_EXPORT SceneBVH
+	{
+	public:
+		SIBR_CLASS_PTR(SceneBVH);
+
+		/** Build the hierarchy.
+		 * \param boxes the world-space box of each object, empty boxes are never reported as visible
+		 * \param leafSize maximum number of objects in a leaf
+		 */
+		void build(const std::vector<Eigen::AlignedBox3f> & boxes, uint leafSize = 4);
+
+		/** Collect the objects whose box intersects a frustum.
+		 * \param frustum the view frustum
+		 * \param visible will contain the visible object indices, in no particular order
+		 * \return the number of box tests performed
+		 */
+		size_t cull(const Frustum & frustum, std::vector<uint> & visible) const;
+
+		/** \return the number of objects in the hierarchy */
+		size_t size(void) const { return _indices.size(); }
+
+		/** \return the box containing all objects */
+		Eigen::AlignedBox3f bounds(void) const { return _nodes.empty() ? Eigen::AlignedBox3f() : _nodes[0].box; }
+
+	private:
+
+		/** Hierarchy node. */
+		struct Node {
+			Eigen::AlignedBox3f box; ///< Box of the node objects.
+			uint first = 0; ///< First object in the index list.
+			uint count = 0; ///< Number of objects.
+			uint right = 0; ///< Second child index (the first one follows the node), 0 for leaves.
+		};
+
+		/** Build the subtree of a range of objects.
+		 * \param boxes the object boxes
+		 * \param centers the object box centers
+		 * \param first the first object in the index list
+		 * \param count the number of objects
+		 * \param leafSize maximum number of objects in a leaf
+		 * \return the node index
+		 */
+		uint buildNode(const std::vector<Eigen::AlignedBox3f> & boxes, const std::vector<Vector3f> & centers, uint first, uint count, uint leafSize);
+
+		std::vector<Node> _nodes; ///< Nodes, the root first.
+		std::vector<uint> _indices; ///< Object indices, ordered by node.
+		std::vector<Eigen::AlignedBox3f> _boxes; ///< Object boxes.
+	};
+
+} // namespace sibr
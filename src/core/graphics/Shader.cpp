@@ -14,6 +14,13 @@
 # include "core/graphics/Shader.hpp"
 # include "core/system/Matrix.hpp"
 #include "core/system/String.hpp"
+#include "core/system/SimpleTimer.hpp"
+#include "core/system/Utils.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
 
 
 # ifndef SIBR_MAXIMIZE_INLINE
@@ -100,6 +107,159 @@ namespace sibr
 		return m_Strict;
 	}
 
+	namespace
+	{
+		/// Identifies program binary cache files, bump when the layout changes.
+		const char binaryCacheMagic[8] = { 'S', 'I', 'B', 'R', 'P', 'R', 'G', '1' };
+
+		/// 64-bit FNV-1a hash, accumulated over several strings.
+		void hashString(uint64_t & hash, const std::string & str)
+		{
+			const uint64_t prime = 1099511628211ull;
+			for (const char c : str) {
+				hash ^= uint64_t(uint8_t(c));
+				hash *= prime;
+			}
+			// Separator, so that consecutive strings can't be confused.
+			hash ^= 0xffull;
+			hash *= prime;
+		}
+
+		/** Compute the cache key of a program, from all its stages and the driver identification.
+		Defines are already substituted in the sources at this point. */
+		uint64_t programCacheKey(const std::vector<std::string> & sources, uint64_t seed)
+		{
+			uint64_t hash = 14695981039346656037ull ^ seed;
+			for (const std::string & source : sources) {
+				hashString(hash, source);
+			}
+			for (const GLenum param : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION }) {
+				const GLubyte * str = glGetString(param);
+				hashString(hash, str ? std::string((const char*)str) : std::string());
+			}
+			return hash;
+		}
+
+		/** Cache file for a given key. */
+		std::string programCachePath(uint64_t key)
+		{
+			static std::string directory;
+			if (directory.empty()) {
+				directory = sibr::getAppDataDirectory() + "/shaders";
+				sibr::makeDirectory(directory);
+			}
+			char name[32];
+			snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+			return directory + "/" + name;
+		}
+
+		bool driverSupportsProgramBinary()
+		{
+			GLint count = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+			return count > 0;
+		}
+
+		/** Replace the #include "file" lines of a shader by the content of the file, looked up in the core shaders directory.
+		A #line directive after each included file keeps the compiler messages pointing at the right lines. */
+		std::string expandIncludes(const std::string & code)
+		{
+			if (code.find("#include") == std::string::npos) {
+				return code;
+			}
+			std::istringstream lines(code);
+			std::string out, line;
+			int lineNumber = 0;
+			while (std::getline(lines, line)) {
+				++lineNumber;
+				const size_t directive = line.find_first_not_of(" \t");
+				const size_t first = line.find('"');
+				const size_t last = line.rfind('"');
+				if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0 || first == last) {
+					out += line + '\n';
+					continue;
+				}
+				const std::string path = sibr::getShadersDirectory("core") + "/" + line.substr(first + 1, last - first - 1);
+				out += sibr::loadFile(path) + '\n';
+				out += "#line " + std::to_string(lineNumber + 1) + '\n';
+			}
+			return out;
+		}
+	}
+
+	bool GLShader::s_binaryCacheEnabled = true;
+	size_t GLShader::s_binaryCacheHits = 0;
+	size_t GLShader::s_binaryCacheMisses = 0;
+
+	void GLShader::setBinaryCacheEnabled(bool enabled)
+	{
+		s_binaryCacheEnabled = enabled;
+	}
+
+	bool GLShader::loadCachedBinary(uint64_t key, uint64_t check)
+	{
+		std::ifstream file(programCachePath(key), std::ios::in | std::ios::binary);
+		if (!file) {
+			return false;
+		}
+		char magic[sizeof(binaryCacheMagic)];
+		uint64_t fileCheck = 0;
+		uint32_t format = 0;
+		uint64_t length = 0;
+		file.read(magic, sizeof(magic));
+		file.read((char*)&fileCheck, sizeof(fileCheck));
+		file.read((char*)&format, sizeof(format));
+		file.read((char*)&length, sizeof(length));
+		if (!file || std::memcmp(magic, binaryCacheMagic, sizeof(magic)) != 0 || fileCheck != check || length == 0) {
+			return false;
+		}
+		std::vector<char> binary(length);
+		if (!file.read(binary.data(), length)) {
+			return false;
+		}
+
+		glProgramBinary(m_Shader, GLenum(format), binary.data(), GLsizei(length));
+		GLint linked = 0;
+		glGetProgramiv(m_Shader, GL_LINK_STATUS, &linked);
+		// A driver update can reject a previously valid binary, clear the error and recompile.
+		(void)glGetError();
+		return linked != 0;
+	}
+
+	void GLShader::saveCachedBinary(uint64_t key, uint64_t check)
+	{
+		GLint length = 0;
+		glGetProgramiv(m_Shader, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) {
+			return;
+		}
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		glGetProgramBinary(m_Shader, length, NULL, &format, binary.data());
+
+		const std::string path = programCachePath(key);
+		// Write to a temporary file first so that concurrent apps never read a partial binary.
+		const std::string tmpPath = path + ".tmp";
+		{
+			std::ofstream file(tmpPath, std::ios::out | std::ios::trunc | std::ios::binary);
+			if (!file) {
+				return;
+			}
+			const uint32_t format32 = uint32_t(format);
+			const uint64_t length64 = uint64_t(length);
+			file.write(binaryCacheMagic, sizeof(binaryCacheMagic));
+			file.write((const char*)&check, sizeof(check));
+			file.write((const char*)&format32, sizeof(format32));
+			file.write((const char*)&length64, sizeof(length64));
+			file.write(binary.data(), length);
+			if (!file) {
+				return;
+			}
+		}
+		std::remove(path.c_str());
+		std::rename(tmpPath.c_str(), path.c_str());
+	}
+
 	bool GLShader::init(std::string name,
 		std::string vp_code,
 		std::string fp_code,
@@ -113,8 +273,36 @@ namespace sibr
 		m_Name = name;
 		m_Shader = glCreateProgram();
 
+		vp_code = expandIncludes(vp_code);
+		fp_code = expandIncludes(fp_code);
+		gp_code = expandIncludes(gp_code);
+		tcs_code = expandIncludes(tcs_code);
+		tes_code = expandIncludes(tes_code);
+
 		CHECK_GL_ERROR;
 
+		sibr::Timer timer(true);
+
+		// Look for a cached binary of the same program, compiled by the same driver.
+		const bool useCache = s_binaryCacheEnabled && driverSupportsProgramBinary();
+		uint64_t cacheKey = 0, cacheCheck = 0;
+		if (useCache) {
+			const std::vector<std::string> sources = { vp_code, fp_code, gp_code, tcs_code, tes_code };
+			cacheKey = programCacheKey(sources, 0);
+			// Second hash with a different seed, stored in the file to reject key collisions.
+			cacheCheck = programCacheKey(sources, 0x9e3779b97f4a7c15ull);
+			if (loadCachedBinary(cacheKey, cacheCheck)) {
+				++s_binaryCacheHits;
+				glUseProgram(0);
+				CHECK_GL_ERROR;
+				SIBR_LOG << "Shader program " << m_Name << " loaded from cache in " << timer.deltaTimeFromLastTic() << "ms (cache hits: "
+					<< s_binaryCacheHits << ", misses: " << s_binaryCacheMisses << ")." << std::endl;
+				return true;
+			}
+			++s_binaryCacheMisses;
+			glProgramParameteri(m_Shader, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
 		GLint vp = 0, fp = 0, gp = 0, tcs = 0, tes = 0;
 
 		if (!vp_code.empty()) {
@@ -171,6 +359,11 @@ namespace sibr
 			if (exitOnError)
 				SIBR_ERR << "GLSL program failed to link" << std::endl;
 		}
+		else if (useCache) {
+			saveCachedBinary(cacheKey, cacheCheck);
+			SIBR_LOG << "Shader program " << m_Name << " compiled in " << timer.deltaTimeFromLastTic() << "ms (cache hits: "
+				<< s_binaryCacheHits << ", misses: " << s_binaryCacheMisses << ")." << std::endl;
+		}
 
 		if (vp) glDeleteShader(vp);
 		if (fp) glDeleteShader(fp);
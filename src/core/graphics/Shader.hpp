@@ -61,6 +61,9 @@ namespace sibr
 		~GLShader( void );
 
 		/** Create and compile a GPU program composed of a vertex/fragment shader (and optionally geometry/tesselation shaders).
+		If supported by the driver, the linked program binary is cached in the app data directory and reused
+		by later calls with the same sources on the same driver, skipping compilation.
+		Lines of the form #include "file" are replaced by the content of the file from the core shaders directory.
 		\param name the name of the shader (for logging)
 		\param vp_code vertex shader code string
 		\param fp_code fragment shader code string
@@ -108,6 +111,11 @@ namespace sibr
 		/** Cleanup and delete the program. */
 		void			terminate( void );
 
+		/** Enable or disable the on-disk program binary cache for all shaders (enabled by default).
+		\param enabled the new state
+		*/
+		static void		setBinaryCacheEnabled( bool enabled );
+
 		/** If set to true, uniforms that are linked but not referenced 
 		by the shader will cause an error to be raised.
 		\param s the validation level
@@ -138,6 +146,19 @@ namespace sibr
 		*/
 		GLuint	compileShader( const char* shader_code, GLuint type );
 
+		/** Load the program from the binary cache.
+		\param key the cache entry key
+		\param check a secondary hash of the program, stored in the entry to detect collisions
+		\return true if a valid binary was found and accepted by the driver
+		*/
+		bool	loadCachedBinary( uint64_t key, uint64_t check );
+
+		/** Store the linked program in the binary cache.
+		\param key the cache entry key
+		\param check a secondary hash of the program, stored in the entry to detect collisions
+		*/
+		void	saveCachedBinary( uint64_t key, uint64_t check );
+
 		/** Check if the shader is properly setup, or raise an error. */
 		SIBR_OPT_INLINE		void	authorize( void ) const;
 
@@ -145,6 +166,10 @@ namespace sibr
 		std::string m_Name; ///< Shader name.
 		bool        m_Strict; ///< Should uniforms be validated.
 		bool        m_Active; ///< Is the shader currently bound.
+
+		static bool   s_binaryCacheEnabled; ///< Should linked programs be cached on disk.
+		static size_t s_binaryCacheHits; ///< Number of programs loaded from the cache.
+		static size_t s_binaryCacheMisses; ///< Number of programs compiled from source.
 	};
 
 	// ------------------------------------------------------------------------
@@ -19,6 +19,8 @@
 # include "core/graphics/Image.hpp"
 # include "core/graphics/Types.hpp"
 # include "core/graphics/RenderTarget.hpp"
+# include "core/graphics/TextureStreamer.hpp"
+# include "core/system/MemoryTracker.hpp"
 
 namespace sibr
 {
@@ -372,6 +374,14 @@ namespace sibr
 		*/
 		void sendRTarray(const std::vector<typename PixelRT::Ptr>& RTs);
 
+		/** Upload a subset of images through the TextureStreamer, flipping and resizing them on the fly.
+		Images that can't be resized on the GPU are processed on the CPU.
+		\param images the images list
+		\param slices the indices of the images to upload, also used as layer indices
+		*/
+		template<typename ImageType>
+		void streamSlices(const std::vector<ImageType>& images, const std::vector<int>& slices);
+
 		/** Upload the images data to the GPU.
 		\param images the data to upload
 		*/
@@ -412,6 +422,7 @@ namespace sibr
 		uint    m_Flags = 0; ///< Options.
 		uint	m_Depth = 0; ///< Layers count.
 		uint	m_numLODs = 1; ///< Mipmap level count.
+		MemoryTracker::Allocation m_Allocation { MemoryTracker::Category::TextureArrays }; ///< Memory accounting, for all levels.
 	};
 
 
@@ -1031,34 +1042,29 @@ namespace sibr
 			m_Depth
 		);
 
+		// Uncompressed estimate, the driver might pad or compress.
+		size_t bytes = 0;
+		for (int lod = 0; lod < numMipMap; ++lod) {
+			bytes += size_t((std::max)(m_W >> lod, 1u)) * (std::max)(m_H >> lod, 1u) * m_Depth * sizeof(T_Type) * T_NumComp;
+		}
+		m_Allocation.resize(bytes);
+
 		CHECK_GL_ERROR;
 	}
 
 	template<typename T_Type, unsigned int T_NumComp> template<typename ImageType>
 	void Texture2DArray<T_Type, T_NumComp>::sendArray(const std::vector<ImageType>& images) {
-		using ImgTypeInfo = GLTexFormat<ImageType, T_Type, T_NumComp>;
-		glBindTexture(GL_TEXTURE_2D_ARRAY, m_Handle);
-
 		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 		glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
-		// Make sure all images have the same size.
-		std::vector<ImageType> tmp;
-		std::vector<const ImageType*> imagesPtrToSend = applyFlipAndResize(images, tmp, m_W, m_H);
-
+		// Images with another size are resized while streaming.
+		std::vector<int> slices(m_Depth);
 		for (int im = 0; im < (int)m_Depth; ++im) {
-			glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
-				0,
-				0, 0, im,
-				m_W,
-				m_H,
-				1, // one slice at a time
-				ImgTypeInfo::format,
-				ImgTypeInfo::type,
-				ImgTypeInfo::data(*imagesPtrToSend[im])
-			);
-			//CHECK_GL_ERROR;
+			slices[im] = im;
 		}
+		streamSlices(images, slices);
+
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_Handle);
 		bool autoMIPMAP = ((m_Flags & SIBR_GPU_AUTOGEN_MIPMAP) != 0);
 		if (autoMIPMAP) {
 			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
@@ -1172,6 +1178,50 @@ namespace sibr
 		CHECK_GL_ERROR;
 	}
 
+	template<typename T_Type, unsigned int T_NumComp> template<typename ImageType>
+	void Texture2DArray<T_Type, T_NumComp>::streamSlices(const std::vector<ImageType>& images, const std::vector<int>& slices) {
+		using ImgTypeInfo = GLTexFormat<ImageType, T_Type, T_NumComp>;
+
+		std::vector<TextureStreamer::Layer> layers(slices.size());
+		for (size_t i = 0; i < slices.size(); ++i) {
+			const ImageType & img = images[slices[i]];
+			layers[i] = { ImgTypeInfo::data(img), ImgTypeInfo::width(img), ImgTypeInfo::height(img), uint(slices[i]) };
+		}
+		const TextureStreamer::Format format = {
+			GLenum(GLFormat<T_Type, T_NumComp>::internal_format), GLenum(ImgTypeInfo::format), GLenum(ImgTypeInfo::type),
+			uint(sizeof(T_Type) * T_NumComp)
+		};
+		// Linear filtering, as the CPU resize.
+		const std::vector<size_t> skipped = TextureStreamer::instance().upload(m_Handle, m_W, m_H, format, layers,
+			(m_Flags & SIBR_FLIP_TEXTURE) != 0, true);
+		if (skipped.empty()) {
+			return;
+		}
+
+		std::vector<int> cpuSlices;
+		for (const size_t i : skipped) {
+			cpuSlices.push_back(slices[i]);
+		}
+		std::vector<ImageType> tmp;
+		std::vector<const ImageType*> imagesPtrToSend = applyFlipAndResize(images, tmp, m_W, m_H, cpuSlices);
+
+		glBindTexture(GL_TEXTURE_2D_ARRAY, m_Handle);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (const int im : cpuSlices) {
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+				0,
+				0, 0, im,
+				m_W,
+				m_H,
+				1, // one slice at a time
+				ImgTypeInfo::format,
+				ImgTypeInfo::type,
+				ImgTypeInfo::data(*imagesPtrToSend[im])
+			);
+		}
+		CHECK_GL_ERROR;
+	}
+
 	template<typename T_Type, unsigned int T_NumComp> template<typename ImageType>
 	void Texture2DArray<T_Type, T_NumComp>::createFromImages(const std::vector<ImageType>& images, uint flags) {
 		using ImgTypeInfo = GLTexFormat<ImageType, T_Type, T_NumComp>;
@@ -1271,27 +1321,15 @@ namespace sibr
 			m_W = maxSize[0];
 			m_H = maxSize[1];
 		}
-
-		glBindTexture(GL_TEXTURE_2D_ARRAY, m_Handle);
+		// Arrays created with a layer count only get their storage at the first update.
+		if (m_Handle == 0) {
+			createArray();
+		}
 
 		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 		glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
-		std::vector<ImageType> tmp;
-		std::vector<const ImageType*> imagesPtrToSend = applyFlipAndResize(images, tmp, m_W, m_H, slices);
-
-		for (int i = 0; i < numSlices; ++i) {
-			glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
-				0,
-				0, 0, slices[i],
-				m_W,
-				m_H,
-				1, // one slice at a time
-				ImgTypeInfo::format,
-				ImgTypeInfo::type,
-				ImgTypeInfo::data(*imagesPtrToSend[slices[i]])
-			);
-		}
+		streamSlices(images, slices);
 		CHECK_GL_ERROR;
 	}
 
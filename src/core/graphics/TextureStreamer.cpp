@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/graphics/TextureStreamer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace sibr
+{
+	namespace {
+		/** Target size of the whole ring; a single layer larger than half of it still gets one slot per half. */
+		const size_t ringBytes = size_t(64) << 20;
+		/** Maximum number of layers per batch. */
+		const uint maxSlotsPerHalf = 4;
+		/** Slot offsets alignment, enough for any pixel type. */
+		const size_t slotAlignment = 256;
+		/** Rows copied by a thread at once. */
+		const int rowsPerTask = 32;
+
+		bool isIntegerFormat(GLenum format)
+		{
+			return format == GL_RED_INTEGER || format == GL_RG_INTEGER || format == GL_RGB_INTEGER || format == GL_RGBA_INTEGER;
+		}
+	}
+
+	TextureStreamer & TextureStreamer::instance()
+	{
+		static TextureStreamer streamer;
+		return streamer;
+	}
+
+	void TextureStreamer::release(void)
+	{
+		for (uint half = 0; half < 2; ++half) {
+			if (_fences[half]) {
+				glDeleteSync(_fences[half]);
+				_fences[half] = nullptr;
+			}
+		}
+		if (_buffer) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			glDeleteBuffers(1, &_buffer);
+			_buffer = 0;
+		}
+		_mapped = nullptr;
+		_slotBytes = 0;
+		_slotsPerHalf = 0;
+
+		if (_staging) {
+			glDeleteTextures(1, &_staging);
+			_staging = 0;
+		}
+		_stagingW = _stagingH = 0;
+		_stagingFormat = 0;
+		if (_framebuffers[0]) {
+			glDeleteFramebuffers(2, _framebuffers);
+			_framebuffers[0] = _framebuffers[1] = 0;
+		}
+	}
+
+	bool TextureStreamer::reserve(size_t layerBytes)
+	{
+		const size_t slotBytes = (layerBytes + slotAlignment - 1) / slotAlignment * slotAlignment;
+		if (_mapped && slotBytes <= _slotBytes) {
+			return true;
+		}
+		release();
+
+		_slotsPerHalf = uint(std::max(size_t(1), std::min(size_t(maxSlotsPerHalf), ringBytes / (2 * slotBytes))));
+		_slotBytes = slotBytes;
+		const size_t totalBytes = 2 * _slotsPerHalf * _slotBytes;
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &_buffer);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, totalBytes, nullptr, flags);
+		_mapped = static_cast<uint8*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalBytes, flags));
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		CHECK_GL_ERROR;
+
+		if (!_mapped) {
+			SIBR_WRG << "[TextureStreamer] Unable to map pixel buffer, using synchronous uploads." << std::endl;
+			release();
+			return false;
+		}
+		return true;
+	}
+
+	void TextureStreamer::waitHalf(uint half)
+	{
+		if (!_fences[half]) {
+			return;
+		}
+		while (glClientWaitSync(_fences[half], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {
+		}
+		glDeleteSync(_fences[half]);
+		_fences[half] = nullptr;
+	}
+
+	void TextureStreamer::reserveStaging(uint w, uint h, const Format & format)
+	{
+		if (!_staging) {
+			glGenTextures(1, &_staging);
+			glGenFramebuffers(2, _framebuffers);
+		}
+		if (_stagingW == w && _stagingH == h && _stagingFormat == format.internalFormat) {
+			return;
+		}
+		_stagingW = w;
+		_stagingH = h;
+		_stagingFormat = format.internalFormat;
+		// Allocate without reading from the pixel buffer.
+		GLint unpackBuffer = 0;
+		glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, _staging);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, w, h, 0, format.format, format.type, nullptr);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+	}
+
+	std::vector<size_t> TextureStreamer::upload(GLuint texture, uint w, uint h, const Format & format,
+		const std::vector<Layer> & layers, bool flip, bool linear)
+	{
+		std::vector<size_t> skipped;
+		size_t maxBytes = 0;
+		for (const Layer & layer : layers) {
+			maxBytes = std::max(maxBytes, size_t(layer.w) * layer.h * format.pixelBytes);
+		}
+		if (layers.empty() || maxBytes == 0) {
+			return skipped;
+		}
+		if (!reserve(maxBytes)) {
+			for (size_t i = 0; i < layers.size(); ++i) {
+				skipped.push_back(i);
+			}
+			return skipped;
+		}
+
+		// Resized layers are blitted to the destination, check once that it can be rendered to.
+		const bool integer = isIntegerFormat(format.format);
+		int canBlit = -1;
+		GLint previousRead = 0, previousDraw = 0;
+		const GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+		std::vector<size_t> pending;
+		for (size_t i = 0; i < layers.size(); ++i) {
+			const Layer & layer = layers[i];
+			if (layer.w == w && layer.h == h) {
+				pending.push_back(i);
+				continue;
+			}
+			if (canBlit < 0) {
+				glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+				glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw);
+				reserveStaging(layer.w, layer.h, format);
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffers[0]);
+				glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _staging, 0);
+				glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _framebuffers[1]);
+				glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, layer.layer);
+				canBlit = glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE
+					&& glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+			}
+			if (canBlit) {
+				pending.push_back(i);
+			}
+			else {
+				skipped.push_back(i);
+			}
+		}
+		if (canBlit > 0 && scissor) {
+			glDisable(GL_SCISSOR_TEST);
+		}
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+		uint half = 0;
+		for (size_t first = 0; first < pending.size(); first += _slotsPerHalf) {
+			const size_t count = std::min(size_t(_slotsPerHalf), pending.size() - first);
+			// The other half can still be read by the GPU while this one is filled.
+			waitHalf(half);
+
+			for (size_t s = 0; s < count; ++s) {
+				const Layer & layer = layers[pending[first + s]];
+				const size_t rowBytes = size_t(layer.w) * format.pixelBytes;
+				const uint8 * src = static_cast<const uint8*>(layer.data);
+				uint8 * dst = _mapped + (half * _slotsPerHalf + s) * _slotBytes;
+				const int rows = int(layer.h);
+#pragma omp parallel for
+				for (int r0 = 0; r0 < rows; r0 += rowsPerTask) {
+					const int r1 = std::min(rows, r0 + rowsPerTask);
+					for (int r = r0; r < r1; ++r) {
+						const int srcRow = flip ? rows - 1 - r : r;
+						std::memcpy(dst + size_t(r) * rowBytes, src + size_t(srcRow) * rowBytes, rowBytes);
+					}
+				}
+			}
+
+			for (size_t s = 0; s < count; ++s) {
+				const Layer & layer = layers[pending[first + s]];
+				const void * offset = reinterpret_cast<const void*>((half * _slotsPerHalf + s) * _slotBytes);
+				if (layer.w == w && layer.h == h) {
+					glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+					glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer.layer, w, h, 1, format.format, format.type, offset);
+				}
+				else {
+					reserveStaging(layer.w, layer.h, format);
+					glBindTexture(GL_TEXTURE_2D, _staging);
+					glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, layer.w, layer.h, format.format, format.type, offset);
+					glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffers[0]);
+					glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _staging, 0);
+					glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _framebuffers[1]);
+					glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, layer.layer);
+					glBlitFramebuffer(0, 0, layer.w, layer.h, 0, 0, w, h, GL_COLOR_BUFFER_BIT,
+						linear && !integer ? GL_LINEAR : GL_NEAREST);
+				}
+			}
+			_fences[half] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			half = 1 - half;
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		if (canBlit >= 0) {
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, previousRead);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDraw);
+			if (canBlit > 0 && scissor) {
+				glEnable(GL_SCISSOR_TEST);
+			}
+		}
+		CHECK_GL_ERROR;
+		return skipped;
+	}
+
+} // namespace sibr
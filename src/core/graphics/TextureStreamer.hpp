@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/graphics/Config.hpp"
+
+#include <vector>
+
+namespace sibr
+{
+	/** Upload image data to texture array layers through a ring of persistently mapped pixel buffers.
+	 * The buffers are filled by several threads while the GPU transfers the previous batch of layers.
+	 * Flipping is done by writing the rows in reverse order while filling the buffers, and layers
+	 * with a different size than the texture are resized on the GPU by a framebuffer blit,
+	 * so no temporary image is created on the CPU.
+	 * \note All uploads must happen on the same OpenGL context (or contexts sharing objects).
+	 * \ingroup sibr_graphics
+	 */
+	class SIBR_GRAPHICS_EXPORT TextureStreamer
+	{
+		SIBR_DISALLOW_COPY(TextureStreamer);
+	public:
+
+		/** Source data of a layer. */
+		struct Layer {
+			const void * data; ///< Tightly packed rows, in image order (top row first).
+			uint w; ///< Source width.
+			uint h; ///< Source height.
+			uint layer; ///< Destination layer.
+		};
+
+		/** Format of the destination texture and of the source data. */
+		struct Format {
+			GLenum internalFormat; ///< Texture internal format.
+			GLenum format; ///< Source pixel format.
+			GLenum type; ///< Source component type.
+			uint pixelBytes; ///< Size of a source pixel.
+		};
+
+		/** \return the streamer shared by all texture arrays */
+		static TextureStreamer & instance();
+
+		/// Constructor.
+		TextureStreamer(void) = default;
+
+		/** Upload layers of the first level of a 2D texture array.
+		 * \param texture the texture array handle
+		 * \param w the texture width
+		 * \param h the texture height
+		 * \param format the texture and data format
+		 * \param layers the layers to upload
+		 * \param flip should the layers be flipped vertically
+		 * \param linear use linear filtering when resizing
+		 * \return the indices, in the layers list, of the layers that were not uploaded (resized layers
+		 * when the texture format can't be rendered to, or all layers if buffers are not available)
+		 */
+		std::vector<size_t> upload(GLuint texture, uint w, uint h, const Format & format,
+			const std::vector<Layer> & layers, bool flip, bool linear);
+
+		/** Release the buffers and the staging texture.
+		 * \note Resources are not released at destruction, as the context might not exist anymore.
+		 */
+		void release(void);
+
+	private:
+
+		/** Make sure the ring can hold layers of a given size.
+		 * \param layerBytes the size of a layer
+		 * \return false if the buffer can't be mapped
+		 */
+		bool reserve(size_t layerBytes);
+
+		/** Wait for the GPU to be done reading from one half of the ring.
+		 * \param half the half index
+		 */
+		void waitHalf(uint half);
+
+		/** Make sure the staging texture has the given size and format.
+		 * \param w width
+		 * \param h height
+		 * \param format the texture format
+		 */
+		void reserveStaging(uint w, uint h, const Format & format);
+
+		GLuint _buffer = 0; ///< Pixel buffer, split in slots.
+		uint8 * _mapped = nullptr; ///< Persistent mapping of the buffer.
+		size_t _slotBytes = 0; ///< Size of a slot.
+		uint _slotsPerHalf = 0; ///< Number of slots filled per batch.
+		GLsync _fences[2] = { nullptr, nullptr }; ///< Fence after the last upload from each half of the ring.
+
+		GLuint _staging = 0; ///< Texture used as source when resizing.
+		uint _stagingW = 0; ///< Staging texture width.
+		uint _stagingH = 0; ///< Staging texture height.
+		GLenum _stagingFormat = 0; ///< Staging texture internal format.
+		GLuint _framebuffers[2] = { 0, 0 }; ///< Read and draw framebuffers for the resizing blit.
+	};
+
+} // namespace sibr
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/graphics/TiledTexture.hpp"
+#include "core/graphics/Image.hpp"
+#include "core/graphics/ImagePyramid.hpp"
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <fstream>
+
+namespace sibr
+{
+	namespace
+	{
+		const uint32_t tiledMagic = 0x4C495453; ///< "STIL", identifies tiled texture files.
+		const uint32_t tiledVersion = 1; ///< Format version.
+
+		/** File header, followed by the offset and size of each tile, then the encoded tiles. */
+		struct TiledHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t w;
+			uint32_t h;
+			uint32_t tileSize;
+			uint32_t border;
+		};
+	}
+
+	bool TiledTexture::build(const std::string & imagePath, const std::string & tiledPath, uint tileSize, uint border)
+	{
+		ImageRGB image;
+		if (!image.load(imagePath, false)) {
+			return false;
+		}
+		SIBR_LOG << "[TiledTexture] Generating tiles of " << imagePath << " (" << image.w() << "x" << image.h() << ")." << std::endl;
+
+		TiledTexture layout;
+		layout._size = Vector2u(image.w(), image.h());
+		layout._tileSize = tileSize;
+		layout._border = border;
+		layout.setupLevels();
+
+		std::vector<std::vector<uchar>> encoded(layout.tileCount());
+		const std::vector<int> params = { cv::IMWRITE_PNG_COMPRESSION, 1 };
+		cv::Mat level = image.toOpenCV();
+		for (int l = 0; l < layout.levels(); ++l) {
+			if (l > 0) {
+				const Vector2u size = layout.levelSize(l);
+				cv::Mat next;
+				cv::resize(level, next, cv::Size(int(size[0]), int(size[1])), 0, 0, cv::INTER_AREA);
+				level = next;
+			}
+			// Pad so that every page can be cut, replicating the edges.
+			const Vector2u & tiles = layout._levelTiles[l];
+			cv::Mat padded;
+			cv::copyMakeBorder(level, padded, int(border), int(tiles[1] * tileSize - level.rows + border),
+				int(border), int(tiles[0] * tileSize - level.cols + border), cv::BORDER_REPLICATE);
+
+			const int count = int(tiles[0] * tiles[1]);
+#pragma omp parallel for schedule(dynamic)
+			for (int t = 0; t < count; ++t) {
+				const uint x = uint(t) % tiles[0];
+				const uint y = uint(t) / tiles[0];
+				const cv::Mat page = padded(cv::Rect(int(x * tileSize), int(y * tileSize), int(layout.pageSize()), int(layout.pageSize())));
+				cv::imencode(".png", page, encoded[layout.index(l, x, y)], params);
+			}
+		}
+
+		std::ofstream file(tiledPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			SIBR_WRG << "[TiledTexture] Unable to write " << tiledPath << "." << std::endl;
+			return false;
+		}
+		const TiledHeader header = { tiledMagic, tiledVersion, layout._size[0], layout._size[1], tileSize, border };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		uint64 offset = sizeof(header) + encoded.size() * (sizeof(uint64) + sizeof(uint32_t));
+		for (const auto & tile : encoded) {
+			const uint32_t size = uint32_t(tile.size());
+			file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+			file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			offset += size;
+		}
+		for (const auto & tile : encoded) {
+			file.write(reinterpret_cast<const char*>(tile.data()), std::streamsize(tile.size()));
+		}
+		return bool(file);
+	}
+
+	bool TiledTexture::upToDate(const std::string & imagePath, const std::string & tiledPath)
+	{
+		boost::system::error_code ec;
+		if (!boost::filesystem::exists(tiledPath, ec)) {
+			return false;
+		}
+		const std::time_t sourceTime = boost::filesystem::last_write_time(imagePath, ec);
+		if (ec) {
+			return false;
+		}
+		return boost::filesystem::last_write_time(tiledPath, ec) >= sourceTime && !ec;
+	}
+
+	bool TiledTexture::open(const std::string & path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			return false;
+		}
+		TiledHeader header;
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if (!file || header.magic != tiledMagic || header.version != tiledVersion || header.tileSize == 0) {
+			SIBR_WRG << "[TiledTexture] " << path << " is not a valid tiled texture." << std::endl;
+			return false;
+		}
+		_path = path;
+		_size = Vector2u(header.w, header.h);
+		_tileSize = header.tileSize;
+		_border = header.border;
+		setupLevels();
+
+		for (size_t t = 0; t < _offsets.size(); ++t) {
+			file.read(reinterpret_cast<char*>(&_offsets[t]), sizeof(uint64));
+			file.read(reinterpret_cast<char*>(&_sizes[t]), sizeof(uint32_t));
+		}
+		return bool(file);
+	}
+
+	bool TiledTexture::readTile(uint index, cv::Mat & page) const
+	{
+		std::ifstream file(_path, std::ios::binary);
+		if (!file.is_open() || index >= _offsets.size()) {
+			return false;
+		}
+		std::vector<uchar> data(_sizes[index]);
+		file.seekg(std::streamoff(_offsets[index]));
+		file.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()));
+		if (!file) {
+			return false;
+		}
+		page = cv::imdecode(data, cv::IMREAD_UNCHANGED);
+		return page.rows == int(pageSize()) && page.cols == int(pageSize()) && page.type() == CV_8UC3;
+	}
+
+	Vector2u TiledTexture::levelSize(int level) const
+	{
+		return Vector2u(IImagePyramid::levelDimension(_size[0], level), IImagePyramid::levelDimension(_size[1], level));
+	}
+
+	void TiledTexture::setupLevels()
+	{
+		_levelTiles.clear();
+		_levelOffsets.clear();
+		uint count = 0;
+		for (int l = 0; ; ++l) {
+			const Vector2u size = levelSize(l);
+			const Vector2u tiles((size[0] + _tileSize - 1) / _tileSize, (size[1] + _tileSize - 1) / _tileSize);
+			_levelTiles.push_back(tiles);
+			_levelOffsets.push_back(count);
+			count += tiles[0] * tiles[1];
+			if (tiles[0] == 1 && tiles[1] == 1) {
+				break;
+			}
+		}
+		_offsets.assign(count, 0);
+		_sizes.assign(count, 0);
+	}
+
+} // namespace sibr
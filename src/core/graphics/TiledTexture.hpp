@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/graphics/Config.hpp"
+#include "core/system/Vector.hpp"
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+#include <vector>
+
+namespace sibr
+{
+
+	/** On-disk tiled and mipmapped version of a large RGB texture, read tile by tile.
+	 * Each level is half the size of the previous one, down to a level fitting in a single tile.
+	 * Tiles are stored as PNG pages of (tileSize + 2 * border)^2 pixels, the border containing
+	 * the neighbouring texels so that pages can be filtered independently once uploaded.
+	 * Texel rows are stored in image order (top row first).
+	 * \ingroup sibr_graphics
+	 */
+	class SIBR_GRAPHICS_EXPORT TiledTexture
+	{
+	public:
+		SIBR_CLASS_PTR(TiledTexture);
+
+		/** Generate a tiled file from an image file.
+		 * \param imagePath the source image
+		 * \param tiledPath the destination file
+		 * \param tileSize the size of a tile, without borders
+		 * \param border the size of the border around each tile
+		 * \return false if the image could not be loaded or the file could not be written
+		 */
+		static bool build(const std::string & imagePath, const std::string & tiledPath, uint tileSize = 128, uint border = 4);
+
+		/** \return true if the tiled file exists and is more recent than the source image
+		 * \param imagePath the source image
+		 * \param tiledPath the tiled file
+		 */
+		static bool upToDate(const std::string & imagePath, const std::string & tiledPath);
+
+		/** Read the header and tile table of a tiled file.
+		 * \param path the tiled file
+		 * \return false if the file is missing or invalid
+		 */
+		bool open(const std::string & path);
+
+		/** Decode a tile. Can be called from several threads at once.
+		 * \param index the tile index, see index()
+		 * \param page will contain the RGB page, borders included
+		 * \return false if the tile could not be read
+		 */
+		bool readTile(uint index, cv::Mat & page) const;
+
+		/** \return the index of a tile
+		 * \param level the level
+		 * \param x the tile column
+		 * \param y the tile row
+		 */
+		uint index(int level, uint x, uint y) const { return _levelOffsets[level] + y * _levelTiles[level][0] + x; }
+
+		/** \return the size in texels of a level
+		 * \param level the level
+		 */
+		Vector2u levelSize(int level) const;
+
+		/** \return the number of tiles of a level along each axis
+		 * \param level the level
+		 */
+		const Vector2u & levelTiles(int level) const { return _levelTiles[level]; }
+
+		/** \return the full resolution width */
+		uint w(void) const { return _size[0]; }
+
+		/** \return the full resolution height */
+		uint h(void) const { return _size[1]; }
+
+		/** \return the number of levels, the last one being a single tile */
+		int levels(void) const { return int(_levelTiles.size()); }
+
+		/** \return the total number of tiles */
+		uint tileCount(void) const { return uint(_offsets.size()); }
+
+		/** \return the size of a tile, without borders */
+		uint tileSize(void) const { return _tileSize; }
+
+		/** \return the size of the border around each tile */
+		uint border(void) const { return _border; }
+
+		/** \return the size of a stored page, borders included */
+		uint pageSize(void) const { return _tileSize + 2 * _border; }
+
+	private:
+
+		/** Compute the per-level tile counts and offsets from the size and tile size. */
+		void setupLevels();
+
+		std::string _path; ///< Tiled file.
+		Vector2u _size = { 0, 0 }; ///< Full resolution size.
+		uint _tileSize = 128; ///< Tile size without borders.
+		uint _border = 4; ///< Border size.
+		std::vector<Vector2u> _levelTiles; ///< Tile count of each level.
+		std::vector<uint> _levelOffsets; ///< Index of the first tile of each level.
+		std::vector<uint64> _offsets; ///< Position of each tile in the file.
+		std::vector<uint32_t> _sizes; ///< Encoded size of each tile.
+	};
+
+} // namespace sibr
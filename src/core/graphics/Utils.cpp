@@ -13,6 +13,13 @@
 
 #include "core/graphics/Utils.hpp"
 
+#include <cstring>
+
+#ifndef GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX
+# define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX 0x9047
+# define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+
 namespace sibr
 {
 
@@ -101,4 +108,30 @@ namespace sibr
 
 	}
 
+	size_t getGPUUsedMem(size_t * total) {
+		static int supported = -1;
+		if (supported < 0) {
+			supported = 0;
+			GLint count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+			for (GLint i = 0; i < count && !supported; ++i) {
+				const char * extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+				supported = extension && std::strcmp(extension, "GL_NVX_gpu_memory_info") == 0;
+			}
+		}
+		if (total) {
+			*total = 0;
+		}
+		if (!supported) {
+			return 0;
+		}
+		GLint dedicated = 0, available = 0;
+		glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &dedicated);
+		glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+		if (total) {
+			*total = size_t(dedicated);
+		}
+		return size_t(std::max(0, dedicated - available));
+	}
+
 } // namespace sibr
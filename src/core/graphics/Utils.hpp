@@ -107,6 +107,12 @@ namespace sibr
 	*/
 	SIBR_GRAPHICS_EXPORT void lin2sRGB(sibr::ImageRGB32F& img);
 
+	/** Query the video memory usage, for all processes, if the driver exposes GL_NVX_gpu_memory_info.
+	\param total if not null, will contain the dedicated video memory in Ko
+	\return the used video memory in Ko, 0 if unknown
+	*/
+	SIBR_GRAPHICS_EXPORT size_t getGPUUsedMem(size_t * total = nullptr);
+
 	/** Debug helper: wrap a rendering task in an openGL debug group (visible in Renderdoc).
 	\param s debug group name
 	\param f the task to wrap
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/graphics/VirtualTexture.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace sibr
+{
+	VirtualTexture::VirtualTexture(const TiledTexture::Ptr & tiles, uint atlasPages)
+		: _tiles(tiles), _atlasPages(atlasPages)
+	{
+		_pages.resize(size_t(_atlasPages) * _atlasPages);
+		_tilePages.assign(_tiles->tileCount(), -1);
+		_requests.assign(_tiles->tileCount(), 0);
+
+		const Vector2u size = atlasSize();
+		glGenTextures(1, &_atlas);
+		glBindTexture(GL_TEXTURE_2D, _atlas);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGB8, size[0], size[1]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		glGenBuffers(1, &_pageTableBuffer);
+		glBindBuffer(GL_TEXTURE_BUFFER, _pageTableBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, size_t(_tiles->tileCount()) * 4 * sizeof(uint16_t), nullptr, GL_DYNAMIC_DRAW);
+		glGenTextures(1, &_pageTable);
+		glBindTexture(GL_TEXTURE_BUFFER, _pageTable);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA16UI, _pageTableBuffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		CHECK_GL_ERROR;
+
+		// The coarsest level is the fallback of all tiles.
+		const int coarsest = _tiles->levels() - 1;
+		if (load({ _tiles->index(coarsest, 0, 0) }, true) == 0) {
+			SIBR_ERR << "[VirtualTexture] Unable to load the coarsest level." << std::endl;
+		}
+	}
+
+	VirtualTexture::~VirtualTexture(void)
+	{
+		glDeleteTextures(1, &_pageTable);
+		glDeleteBuffers(1, &_pageTableBuffer);
+		glDeleteTextures(1, &_atlas);
+	}
+
+	size_t VirtualTexture::update(const ImageRGBA32F & feedback, uint maxUploads)
+	{
+		++_frame;
+		const int levels = _tiles->levels();
+		std::vector<uint> missing;
+		for (uint y = 0; y < feedback.h(); ++y) {
+			for (uint x = 0; x < feedback.w(); ++x) {
+				const ImageRGBA32F::Pixel & request = feedback(x, y);
+				if (request[3] <= 0.0f) {
+					continue;
+				}
+				uint tx = uint(std::max(request[0], 0.0f));
+				uint ty = uint(std::max(request[1], 0.0f));
+				// Request the tile and its ancestors, that are the fallbacks while it is loading.
+				for (int level = std::min(std::max(int(request[2]), 0), levels - 1); level < levels; ++level, tx >>= 1, ty >>= 1) {
+					const Vector2u & levelTiles = _tiles->levelTiles(level);
+					tx = std::min(tx, levelTiles[0] - 1);
+					ty = std::min(ty, levelTiles[1] - 1);
+					const uint tile = _tiles->index(level, tx, ty);
+					if (_requests[tile] == _frame) {
+						break;
+					}
+					_requests[tile] = _frame;
+					if (_tilePages[tile] >= 0) {
+						_pages[_tilePages[tile]].lastUse = _frame;
+					}
+					else {
+						missing.push_back(tile);
+					}
+				}
+			}
+		}
+
+		// Coarser levels have higher indices, load them first so that the view is refined progressively.
+		std::sort(missing.begin(), missing.end(), std::greater<uint>());
+		const size_t requested = missing.size();
+		if (missing.size() > maxUploads) {
+			missing.resize(maxUploads);
+		}
+		return requested - load(missing, false);
+	}
+
+	void VirtualTexture::bind(uint atlasUnit, uint pageTableUnit) const
+	{
+		glActiveTexture(GL_TEXTURE0 + atlasUnit);
+		glBindTexture(GL_TEXTURE_2D, _atlas);
+		glActiveTexture(GL_TEXTURE0 + pageTableUnit);
+		glBindTexture(GL_TEXTURE_BUFFER, _pageTable);
+	}
+
+	size_t VirtualTexture::residentCount(void) const
+	{
+		return size_t(std::count_if(_pages.begin(), _pages.end(), [](const Page & page) { return page.tile >= 0; }));
+	}
+
+	size_t VirtualTexture::load(const std::vector<uint> & tiles, bool pinned)
+	{
+		if (tiles.empty()) {
+			return 0;
+		}
+		std::vector<cv::Mat> data(tiles.size());
+		std::vector<int> valid(tiles.size(), 0);
+#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < int(tiles.size()); ++i) {
+			valid[i] = _tiles->readTile(tiles[i], data[i]) ? 1 : 0;
+		}
+
+		const uint pageSize = _tiles->pageSize();
+		size_t loaded = 0;
+		glBindTexture(GL_TEXTURE_2D, _atlas);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (size_t i = 0; i < tiles.size(); ++i) {
+			if (!valid[i]) {
+				SIBR_WRG << "[VirtualTexture] Unable to read tile " << tiles[i] << "." << std::endl;
+				continue;
+			}
+			const int page = findPage();
+			if (page < 0) {
+				// Every page is needed by the current view.
+				break;
+			}
+			if (_pages[page].tile >= 0) {
+				_tilePages[_pages[page].tile] = -1;
+			}
+			_pages[page].tile = int(tiles[i]);
+			_pages[page].lastUse = _frame;
+			_pages[page].pinned = pinned;
+			_tilePages[tiles[i]] = page;
+
+			const uint x = (uint(page) % _atlasPages) * pageSize;
+			const uint y = (uint(page) / _atlasPages) * pageSize;
+			glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, pageSize, pageSize, GL_RGB, GL_UNSIGNED_BYTE, data[i].data);
+			++loaded;
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		CHECK_GL_ERROR;
+
+		if (loaded > 0) {
+			updatePageTable();
+		}
+		return loaded;
+	}
+
+	int VirtualTexture::findPage(void) const
+	{
+		int best = -1;
+		for (int p = 0; p < int(_pages.size()); ++p) {
+			const Page & page = _pages[p];
+			if (page.tile < 0) {
+				return p;
+			}
+			if (page.pinned || page.lastUse == _frame) {
+				continue;
+			}
+			if (best < 0 || page.lastUse < _pages[best].lastUse) {
+				best = p;
+			}
+		}
+		return best;
+	}
+
+	void VirtualTexture::updatePageTable(void)
+	{
+		std::vector<uint16_t> table(size_t(_tiles->tileCount()) * 4, 0);
+		// From coarse to fine, so that missing tiles can inherit the entry of their parent.
+		for (int level = _tiles->levels() - 1; level >= 0; --level) {
+			const Vector2u & levelTiles = _tiles->levelTiles(level);
+			for (uint y = 0; y < levelTiles[1]; ++y) {
+				for (uint x = 0; x < levelTiles[0]; ++x) {
+					uint16_t * entry = &table[size_t(_tiles->index(level, x, y)) * 4];
+					const int page = _tilePages[_tiles->index(level, x, y)];
+					if (page >= 0) {
+						entry[0] = uint16_t(uint(page) % _atlasPages);
+						entry[1] = uint16_t(uint(page) / _atlasPages);
+						entry[2] = uint16_t(level);
+					}
+					else if (level + 1 < _tiles->levels()) {
+						const Vector2u & parentTiles = _tiles->levelTiles(level + 1);
+						const uint parent = _tiles->index(level + 1, std::min(x >> 1, parentTiles[0] - 1), std::min(y >> 1, parentTiles[1] - 1));
+						std::copy_n(&table[size_t(parent) * 4], 4, entry);
+					}
+				}
+			}
+		}
+		glBindBuffer(GL_TEXTURE_BUFFER, _pageTableBuffer);
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, table.size() * sizeof(uint16_t), table.data());
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		CHECK_GL_ERROR;
+	}
+
+} // namespace sibr
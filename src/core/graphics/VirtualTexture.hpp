@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/graphics/Config.hpp"
+#include "core/graphics/Image.hpp"
+#include "core/graphics/TiledTexture.hpp"
+
+#include <vector>
+
+namespace sibr
+{
+
+	/** Residency manager streaming the tiles of a TiledTexture into a fixed size GPU page atlas.
+	 * Rendering reports the tiles it needs in a small feedback image, from which the missing tiles
+	 * are loaded (coarsest levels first) while the least recently used pages are recycled.
+	 * A page table, stored in a buffer texture, gives for each tile of each level the page to sample:
+	 * the tile itself if resident, else its closest resident ancestor. The coarsest level always stays resident,
+	 * so the texture is always displayed and gets sharper as tiles arrive.
+	 *
+	 * Shader side (see virtual_texture.frag), the atlas is bound as a sampler2D and the page table as a usamplerBuffer,
+	 * each entry containing (page x, page y, level of the page, unused).
+	 * \ingroup sibr_graphics
+	 */
+	class SIBR_GRAPHICS_EXPORT VirtualTexture
+	{
+		SIBR_DISALLOW_COPY(VirtualTexture);
+	public:
+		SIBR_CLASS_PTR(VirtualTexture);
+
+		/** Constructor, the coarsest level is loaded immediately.
+		 * \param tiles the tiled texture to stream
+		 * \param atlasPages number of pages along each side of the atlas
+		 */
+		VirtualTexture(const TiledTexture::Ptr & tiles, uint atlasPages = 24);
+
+		/// Destructor.
+		~VirtualTexture(void);
+
+		/** Load the tiles requested by a feedback pass.
+		 * \param feedback feedback image, each pixel containing (tile x, tile y, level, 1) or 0 where nothing is textured
+		 * \param maxUploads maximum number of tiles loaded by this call
+		 * \return the number of requested tiles still missing
+		 */
+		size_t update(const ImageRGBA32F & feedback, uint maxUploads = 32);
+
+		/** Bind the atlas and page table.
+		 * \param atlasUnit texture unit of the atlas
+		 * \param pageTableUnit texture unit of the page table
+		 */
+		void bind(uint atlasUnit, uint pageTableUnit) const;
+
+		/** \return the streamed tiled texture */
+		const TiledTexture & tiles(void) const { return *_tiles; }
+
+		/** \return the atlas size in texels */
+		Vector2u atlasSize(void) const { return Vector2u(_atlasPages * _tiles->pageSize(), _atlasPages * _tiles->pageSize()); }
+
+		/** \return the number of tiles currently on the GPU */
+		size_t residentCount(void) const;
+
+		/** \return the number of pages in the atlas */
+		size_t pageCount(void) const { return _pages.size(); }
+
+	private:
+
+		/** Atlas page. */
+		struct Page {
+			int tile = -1; ///< Tile stored, -1 if free.
+			uint64 lastUse = 0; ///< Last frame the tile was requested.
+			bool pinned = false; ///< Never recycled.
+		};
+
+		/** Load tiles and store them in free or recycled pages.
+		 * \param tiles the tile indices
+		 * \param pinned should the pages be kept forever
+		 * \return the number of tiles loaded
+		 */
+		size_t load(const std::vector<uint> & tiles, bool pinned);
+
+		/** \return a free page, or the least recently used unpinned page not requested this frame, -1 if none */
+		int findPage(void) const;
+
+		/** Rebuild and upload the page table after residency changes. */
+		void updatePageTable(void);
+
+		TiledTexture::Ptr _tiles; ///< Tiled texture.
+		uint _atlasPages; ///< Pages along each side of the atlas.
+		std::vector<Page> _pages; ///< Atlas pages.
+		std::vector<int> _tilePages; ///< Page of each tile, -1 if not resident.
+		std::vector<uint64> _requests; ///< Last frame each tile was requested.
+		uint64 _frame = 0; ///< Current update count.
+		GLuint _atlas = 0; ///< Atlas texture.
+		GLuint _pageTableBuffer = 0; ///< Page table storage.
+		GLuint _pageTable = 0; ///< Page table buffer texture.
+	};
+
+} // namespace sibr
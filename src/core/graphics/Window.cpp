@@ -20,11 +20,99 @@
 #include "imgui_impl_glfw_gl3.h"
 
 #include <regex>
+#include <cstring>
+#include <map>
+
+#ifndef SIBR_OS_WINDOWS
+// Headless contexts don't need any windowing system headers.
+# define EGL_NO_X11
+# include <EGL/egl.h>
+# include <EGL/eglext.h>
+#endif
 
 namespace sibr
 {
 	int Window::contextId = -1;
 
+	/// Offscreen context: EGL handles and the framebuffer replacing the window backbuffer.
+	struct Window::HeadlessContext
+	{
+#ifndef SIBR_OS_WINDOWS
+		EGLDisplay display = EGL_NO_DISPLAY; ///< EGL display.
+		EGLContext context = EGL_NO_CONTEXT; ///< EGL context.
+#endif
+		GLuint fbo = 0; ///< Framebuffer.
+		GLuint renderbuffers[2] = { 0, 0 }; ///< Color and depth-stencil buffers.
+	};
+
+#ifndef SIBR_OS_WINDOWS
+	/** EGL displays are shared by the whole process and eglInitialize is not reference counted,
+	 * so track the number of headless windows using each display.
+	 * \return the number of headless windows per display
+	 */
+	static std::map<EGLDisplay, int> & headlessDisplayUsers()
+	{
+		static std::map<EGLDisplay, int> users;
+		return users;
+	}
+
+	/** Terminate a display if no headless window uses it anymore.
+	 * \param display the EGL display
+	 */
+	static void releaseHeadlessDisplay(EGLDisplay display)
+	{
+		auto & users = headlessDisplayUsers();
+		const auto user = users.find(display);
+		if (user != users.end() && user->second > 0) {
+			return;
+		}
+		users.erase(display);
+		eglTerminate(display);
+	}
+#endif
+
+	/** \return true if the window should be created with an offscreen EGL context. */
+	static bool useHeadless(const WindowArgs & args)
+	{
+#ifdef SIBR_OS_WINDOWS
+		if (args.headless) {
+			SIBR_WRG << "Headless contexts are not supported on Windows, using a hidden window instead." << std::endl;
+		}
+		return false;
+#else
+		return args.headless;
+#endif
+	}
+
+	/** (Re)allocate the color and depth-stencil buffers of a headless window.
+	 * \param renderbuffers the color and depth-stencil renderbuffers
+	 * \param w width
+	 * \param h height
+	 */
+	static void allocateHeadlessBuffers(const GLuint * renderbuffers, int w, int h)
+	{
+		glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+		glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	}
+
+	/** Start a GUI frame without windowing system: the interface is laid out but never displayed.
+	 * \param size the window size
+	 */
+	static void headlessNewFrame(const Vector2i & size)
+	{
+		ImGuiIO & io = ImGui::GetIO();
+		// Build the font atlas (no-op once built), needed to lay out windows.
+		unsigned char * pixels;
+		int w, h;
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+		io.DisplaySize = ImVec2(float(size.x()), float(size.y()));
+		io.DeltaTime = 1.0f / 60.0f;
+		ImGui::NewFrame();
+	}
+
 	static void glfwErrorCallback(int error, const char* description)
 	{
 		SIBR_ERR << description << std::endl;
@@ -127,25 +215,36 @@ namespace sibr
 	///////////////////////////////////////////////////////////////////////////
 
 	static int windowCounter = 0;
+	static int glfwWindowCounter = 0;
 
 	/*static*/ bool			Window::contextIsRunning( void )
 	{
 		return windowCounter > 0;
 	}
 
-	Window::AutoInitializer::AutoInitializer( void )
+	/*static*/ bool			Window::displayIsRunning( void )
+	{
+		return glfwWindowCounter > 0;
+	}
+
+	Window::AutoInitializer::AutoInitializer( bool useGLFW ) : useGLFW(useGLFW)
 	{
 		if (windowCounter == 0)
+		{
+			sibr::Input::global().key().clearStates();
+		}
+		if (useGLFW && glfwWindowCounter == 0)
 		{
 			SIBR_LOG << "Initialization of GLFW" << std::endl;
 			glfwSetErrorCallback(glfwErrorCallback);
 
 			if (!glfwInit())
 				SIBR_ERR << "cannot init glfw" << std::endl;
-			sibr::Input::global().key().clearStates();
-
 		}
 		++windowCounter;
+		if (useGLFW) {
+			++glfwWindowCounter;
+		}
 	}
 
 	Window::AutoInitializer::~AutoInitializer( void )
@@ -153,21 +252,29 @@ namespace sibr
 		--windowCounter;
 		if (windowCounter == 0)
 		{
-			ImGui_ImplGlfwGL3_Shutdown();	/// \todo TODO: not sure it safe with multi-context
+			if (glfwWindowCounter > 0) {
+				ImGui_ImplGlfwGL3_Shutdown();	/// \todo TODO: not sure it safe with multi-context
+			}
 			ImGui::DestroyContext();
-			glfwSetErrorCallback(nullptr);
-			SIBR_LOG << "Deinitialization of GLFW" << std::endl;
-			glfwTerminate();
+		}
+		if (useGLFW) {
+			--glfwWindowCounter;
+			if (glfwWindowCounter == 0)
+			{
+				glfwSetErrorCallback(nullptr);
+				SIBR_LOG << "Deinitialization of GLFW" << std::endl;
+				glfwTerminate();
+			}
 		}
 	}
 
 	Window::Window(uint w, uint h, const std::string& title, const WindowArgs & args, const std::string& defaultSettingsFilename) 
-		: _useGUI(!args.no_gui), _shouldClose(false) 
+		: _useGUI(!args.no_gui), _shouldClose(false), _hiddenInit(!useHeadless(args))
 	{
 		
 		setup(w, h, title, args, defaultSettingsFilename);
 
-		if (!(args.fullscreen)) {
+		if (_glfwWin && !(args.fullscreen)) {
 			glfwSetWindowPos(_glfwWin.get(), 200, 200);
 		}
 	}
@@ -178,19 +285,29 @@ namespace sibr
 	}
 
 	Window::Window(const std::string& title, const sibr::Vector2i & margins, const WindowArgs & args, const std::string& defaultSettingsFilename)
-		: _useGUI(!args.no_gui), _shouldClose(false)
+		: _useGUI(!args.no_gui), _shouldClose(false), _hiddenInit(!useHeadless(args))
 	{
-		const sibr::Vector2i winSize = desktopSize();
-		// Here autoInitializer is already initialized, thus glfwInit() has been called
-		setup(winSize.x() - 2*margins.x(), winSize.y() - 2*margins.y(), title, args, defaultSettingsFilename);
+		// Here autoInitializer is already initialized, thus glfwInit() has been called if needed.
+		// Without display, the requested size is used as is.
+		const sibr::Vector2i winSize = _hiddenInit.useGLFW ? sibr::Vector2i(desktopSize() - 2 * margins) : sibr::Vector2i(args.win_width, args.win_height);
+		setup(winSize.x(), winSize.y(), title, args, defaultSettingsFilename);
 
-		if (!(args.fullscreen)) {
+		if (_glfwWin && !(args.fullscreen)) {
 			glfwSetWindowPos(_glfwWin.get(), margins.x(), margins.y());
 		}
 
 	}
 
 	void Window::swapBuffer(void) {
+		if (!_glfwWin) {
+			// Nothing is displayed: close the GUI frame, and start the next one on the internal framebuffer.
+			if (_useGUI) {
+				ImGui::Render();
+			}
+			headlessNewFrame(_size);
+			glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+			return;
+		}
 		if (_useGUI) {
 			glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "ImGui interface");
 			ImGui::Render();
@@ -245,41 +362,130 @@ namespace sibr
 		LoadIniSettingsFromDisk(ImGui::GetIO().IniFilename);
 	}
 
-	void Window::setup(int width, int height, const std::string& title, const WindowArgs & args, const std::string& defaultSettingsFilename) {
-		// IMPORTANT NOTE: if you got compatibility problem with old opengl function,
-		// try to load compat 3.2 instead of core 4.2
+	bool Window::setupHeadless(int width, int height) {
+#ifdef SIBR_OS_WINDOWS
+		return false;
+#else
+		const auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		const auto queryDevices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+		if (!getPlatformDisplay) {
+			SIBR_WRG << "EGL platform displays are not supported." << std::endl;
+			return false;
+		}
 
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
-		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
-		// or
-		//glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
-		//glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-		//glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+		// Mesa surfaceless platform first (hardware driver, or llvmpipe without GPU),
+		// then devices, for drivers that don't provide it.
+		std::vector<EGLDisplay> displays = { getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) };
+		EGLDeviceEXT devices[16];
+		EGLint deviceCount = 0;
+		if (queryDevices && queryDevices(16, devices, &deviceCount)) {
+			for (EGLint d = 0; d < deviceCount; ++d) {
+				displays.push_back(getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[d], nullptr));
+			}
+		}
 
-		glfwWindowHint(GLFW_RED_BITS, 8);
-		glfwWindowHint(GLFW_GREEN_BITS, 8);
-		glfwWindowHint(GLFW_BLUE_BITS, 8);
-		glfwWindowHint(GLFW_ALPHA_BITS, 8);
-		glfwWindowHint(GLFW_DEPTH_BITS, 24);
-		glfwWindowHint(GLFW_STENCIL_BITS, 8);
+		// Same version and profile as windowed contexts, core profile as a fallback.
+		const EGLint profiles[] = { EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT };
+		// Surfaceless configs are only listed as supporting pbuffers.
+		const EGLint configAttribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+		for (const EGLDisplay display : displays) {
+			EGLint major, minor;
+			if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+				continue;
+			}
+			const char * extensions = eglQueryString(display, EGL_EXTENSIONS);
+			EGLConfig config;
+			EGLint configCount = 0;
+			if (!extensions || !std::strstr(extensions, "EGL_KHR_surfaceless_context") || !eglBindAPI(EGL_OPENGL_API)
+				|| !eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+				releaseHeadlessDisplay(display);
+				continue;
+			}
+			EGLContext context = EGL_NO_CONTEXT;
+			for (const EGLint profile : profiles) {
+				const EGLint contextAttribs[] = {
+					EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 5,
+					EGL_CONTEXT_OPENGL_PROFILE_MASK, profile, EGL_NONE
+				};
+				context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+				if (context != EGL_NO_CONTEXT) {
+					break;
+				}
+			}
+			if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+				// Release what was created on this display before trying the next one.
+				if (context != EGL_NO_CONTEXT) {
+					eglDestroyContext(display, context);
+				}
+				// Another headless window might still be using this display.
+				releaseHeadlessDisplay(display);
+				continue;
+			}
 
-		if (args.offscreen) {
-			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+			HeadlessContext * headless = new HeadlessContext();
+			headless->display = display;
+			headless->context = context;
+			// The display is terminated with its last headless window.
+			++headlessDisplayUsers()[display];
+			_headless = HeadlessContextPtr(headless, [](HeadlessContext * headless) {
+				eglMakeCurrent(headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, headless->context);
+				if (headless->fbo) {
+					glDeleteFramebuffers(1, &headless->fbo);
+					glDeleteRenderbuffers(2, headless->renderbuffers);
+				}
+				eglMakeCurrent(headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+				eglDestroyContext(headless->display, headless->context);
+				--headlessDisplayUsers()[headless->display];
+				releaseHeadlessDisplay(headless->display);
+				delete headless;
+			});
+			_size = Vector2i(width, height);
+			return true;
 		}
+		return false;
+#endif
+	}
 
-		_glfwWin = GLFWwindowptr(
-			glfwCreateWindow(
-				width, height, title.c_str(),
-				args.fullscreen ? glfwGetPrimaryMonitor() : NULL
-				, NULL ), 
-			glfwDestroyWindow
-		);
+	void Window::setup(int width, int height, const std::string& title, const WindowArgs & args, const std::string& defaultSettingsFilename) {
+		if (!_hiddenInit.useGLFW) {
+			if (!setupHeadless(width, height))
+				SIBR_ERR << "failed to create an offscreen EGL context (is your graphics driver or Mesa installed ?)" << std::endl;
+		} else {
+			// IMPORTANT NOTE: if you got compatibility problem with old opengl function,
+			// try to load compat 3.2 instead of core 4.2
+
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+			glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
+			// or
+			//glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
+			//glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+			//glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+
+			glfwWindowHint(GLFW_RED_BITS, 8);
+			glfwWindowHint(GLFW_GREEN_BITS, 8);
+			glfwWindowHint(GLFW_BLUE_BITS, 8);
+			glfwWindowHint(GLFW_ALPHA_BITS, 8);
+			glfwWindowHint(GLFW_DEPTH_BITS, 24);
+			glfwWindowHint(GLFW_STENCIL_BITS, 8);
+
+			if (args.offscreen || args.headless) {
+				glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+			}
 
-		if (_glfwWin == nullptr)
-			SIBR_ERR << "failed to create a glfw window (is your graphics driver updated ?)" << std::endl;
+			_glfwWin = GLFWwindowptr(
+				glfwCreateWindow(
+					width, height, title.c_str(),
+					args.fullscreen ? glfwGetPrimaryMonitor() : NULL
+					, NULL ), 
+				glfwDestroyWindow
+			);
 
-		makeContextCurrent();
+			if (_glfwWin == nullptr)
+				SIBR_ERR << "failed to create a glfw window (is your graphics driver updated ?)" << std::endl;
+
+			makeContextCurrent();
+		}
 
 		
 
@@ -296,22 +502,42 @@ namespace sibr
 
 		glewExperimental = GL_TRUE;
 		GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+		// GLEW also loads GLX extensions, which fails without display once OpenGL functions are loaded.
+		if (_headless && err == GLEW_ERROR_NO_GLX_DISPLAY)
+			err = GLEW_OK;
+#endif
 		if (err != GLEW_OK)
 			SIBR_ERR << "cannot initialize GLEW (used to load OpenGL function)" << std::endl;
 		(void)glGetError(); // I notice that glew might do wrong things during its init()
 							// some drivers complain about it. So I reset OpenGL's errors to discard this.
 
-		glfwSetWindowUserPointer(_glfwWin.get(), this);
 		/// \todo TODO: fix, width and height might be erroneous. SR
 		viewport(Viewport(0.f, 0.f, (float)width, (float)height));	/// \todo TODO: bind both
 
-		_useVSync = !args.vsync;
-		glfwSwapInterval(args.vsync);
-		glfwSetKeyCallback(_glfwWin.get(), glfwKeyboardCallback);
-		glfwSetScrollCallback(_glfwWin.get(), glfwMouseScrollCallback);
-		glfwSetMouseButtonCallback(_glfwWin.get(), glfwMouseButtonCallback);
-		glfwSetCursorPosCallback(_glfwWin.get(), glfwCursorPosCallback);
-		glfwSetWindowSizeCallback(_glfwWin.get(), glfwResizeCallback);
+		if (_headless) {
+			// Replaces the window backbuffer, there is no swap hence no vsync.
+			glGenFramebuffers(1, &_headless->fbo);
+			glGenRenderbuffers(2, _headless->renderbuffers);
+			allocateHeadlessBuffers(_headless->renderbuffers, width, height);
+			glBindFramebuffer(GL_FRAMEBUFFER, _headless->fbo);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _headless->renderbuffers[0]);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _headless->renderbuffers[1]);
+			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+				SIBR_ERR << "headless window framebuffer is incomplete" << std::endl;
+			_fbo = _headless->fbo;
+			_useVSync = false;
+			SIBR_LOG << "Headless window (" << width << "x" << height << "), rendering offscreen." << std::endl;
+		} else {
+			glfwSetWindowUserPointer(_glfwWin.get(), this);
+			_useVSync = !args.vsync;
+			glfwSwapInterval(args.vsync);
+			glfwSetKeyCallback(_glfwWin.get(), glfwKeyboardCallback);
+			glfwSetScrollCallback(_glfwWin.get(), glfwMouseScrollCallback);
+			glfwSetMouseButtonCallback(_glfwWin.get(), glfwMouseButtonCallback);
+			glfwSetCursorPosCallback(_glfwWin.get(), glfwCursorPosCallback);
+			glfwSetWindowSizeCallback(_glfwWin.get(), glfwResizeCallback);
+		}
 
 		// SR: we don't use it by default because you won't get callstack/file/line info.
 		if(args.gl_debug) {
@@ -324,10 +550,14 @@ namespace sibr
 
 		// Setup ImGui binding
 		ImGui::CreateContext();
-		ImGui_ImplGlfwGL3_Init(_glfwWin.get(), false);
-		glfwSetCharCallback(_glfwWin.get(), ImGui_ImplGlfw_CharCallback);
+		if (_glfwWin) {
+			ImGui_ImplGlfwGL3_Init(_glfwWin.get(), false);
+			glfwSetCharCallback(_glfwWin.get(), ImGui_ImplGlfw_CharCallback);
 
-		ImGui_ImplGlfwGL3_NewFrame();
+			ImGui_ImplGlfwGL3_NewFrame();
+		} else {
+			headlessNewFrame(_size);
+		}
 
 		_windowImguiSettingsFilename = defaultSettingsFilename;
 
@@ -344,12 +574,14 @@ namespace sibr
 
 		// Support for HiDPI on Windows. The default is 96.
 		// Compute the pixel density at the current definition.
-		int widthmm, heightmm;
-		glfwGetMonitorPhysicalSize(glfwGetPrimaryMonitor(), &widthmm, &heightmm);
-		const float defaultDPI = 96.0f;
-		sibr::Vector2i dsize = desktopSize();
-		
-		_scaling = sibr::clamp(std::round(dsize.x() / (widthmm / 25.4f) / defaultDPI), 1.0f, 2.0f);
+		if (_glfwWin) {
+			int widthmm, heightmm;
+			glfwGetMonitorPhysicalSize(glfwGetPrimaryMonitor(), &widthmm, &heightmm);
+			const float defaultDPI = 96.0f;
+			sibr::Vector2i dsize = desktopSize();
+
+			_scaling = sibr::clamp(std::round(dsize.x() / (widthmm / 25.4f) / defaultDPI), 1.0f, 2.0f);
+		}
 
 		if (args.hdpi) {
 			ImGui::GetStyle().ScaleAllSizes(scaling());
@@ -368,12 +600,19 @@ namespace sibr
 
 	/*static*/ Vector2i		Window::desktopSize( void )
 	{
+		// Without display, assume a full HD screen.
+		if (!displayIsRunning()) {
+			return Vector2i(1920, 1080);
+		}
 		const GLFWvidmode * mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
 		return Vector2i(mode->width, mode->height);
 	}
 
 	Vector2i		Window::size( void ) const
 	{
+		if (!_glfwWin) {
+			return _size;
+		}
 		Vector2i s;
 		glfwGetWindowSize(_glfwWin.get(), &s[0], &s[1]);
 		return s;
@@ -381,34 +620,40 @@ namespace sibr
 
 	void Window::position(const unsigned int x, const unsigned int y)
 	{
-		glfwSetWindowPos(_glfwWin.get(), x, y);
+		if (_glfwWin) {
+			glfwSetWindowPos(_glfwWin.get(), x, y);
+		}
 	}
 
 	Vector2i Window::position() const {
-		Vector2i s;
-		glfwGetWindowPos(_glfwWin.get(), &s[0], &s[1]);
+		Vector2i s(0, 0);
+		if (_glfwWin) {
+			glfwGetWindowPos(_glfwWin.get(), &s[0], &s[1]);
+		}
 		return s;
 	}
 
 	bool			Window::isOpened( void ) const
 	{
-		return (!_shouldClose && !glfwWindowShouldClose(_glfwWin.get()));
+		return (!_shouldClose && (!_glfwWin || !glfwWindowShouldClose(_glfwWin.get())));
 	}
 
 	void			Window::close( void )
 	{
 		_shouldClose = true;
-		glfwSetWindowShouldClose(_glfwWin.get(), GL_TRUE);
+		if (_glfwWin) {
+			glfwSetWindowShouldClose(_glfwWin.get(), GL_TRUE);
+		}
 	}
 
 	bool Window::isFullscreen(void) const
 	{
-		return glfwGetWindowMonitor(_glfwWin.get()) != NULL;
+		return _glfwWin && glfwGetWindowMonitor(_glfwWin.get()) != NULL;
 	}
 
 	void Window::setFullscreen(const bool fullscreen) {
 		const bool currentState = isFullscreen();
-		if((fullscreen && currentState) || (!fullscreen && !currentState)) {
+		if(!_glfwWin || (fullscreen && currentState) || (!fullscreen && !currentState)) {
 			// Do nothing.
 			return;
 		}
@@ -428,6 +673,12 @@ namespace sibr
 
 	void			Window::size( int w, int h )
 	{
+		if (!_glfwWin) {
+			_size = Vector2i(w, h);
+			allocateHeadlessBuffers(_headless->renderbuffers, w, h);
+			viewport(Viewport(0.f, 0.f, (float)w, (float)h));
+			return;
+		}
 		glfwSetWindowSize(_glfwWin.get(), w, h);
 		Vector2i s = size();
 
@@ -443,6 +694,9 @@ namespace sibr
 
 	void Window::setFrameRate(int fps)
 	{
+		if (!_glfwWin) {
+			return;
+		}
 		if (fps == 60) {
 			glfwSwapInterval(1);
 		} else if (fps == 30) {
@@ -458,19 +712,55 @@ namespace sibr
 	}
 
 	void Window::setVsynced(const bool vsync) {
-		_useVSync = vsync;
-		glfwSwapInterval(_useVSync ? 1 : 0);
+		if (_glfwWin) {
+			_useVSync = vsync;
+			glfwSwapInterval(_useVSync ? 1 : 0);
+		}
 	}
 
 	void				Window::enableCursor( bool enable )
 	{
-		glfwSetInputMode(_glfwWin.get(), GLFW_CURSOR, enable? GLFW_CURSOR_NORMAL : GLFW_CURSOR_HIDDEN);
+		if (_glfwWin) {
+			glfwSetInputMode(_glfwWin.get(), GLFW_CURSOR, enable? GLFW_CURSOR_NORMAL : GLFW_CURSOR_HIDDEN);
+		}
 	}
 
 	GLFWwindow * Window::GLFW(void) {
 		return _glfwWin.get();
 	}
 
+	void		Window::makeContextCurrent(void) {
+		if (_glfwWin) {
+			glfwMakeContextCurrent(_glfwWin.get());
+			return;
+		}
+#ifndef SIBR_OS_WINDOWS
+		if (_headless) {
+			eglMakeCurrent(_headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, _headless->context);
+		}
+#endif
+	}
+
+	void		Window::makeContextNull(void) {
+		if (_glfwWin) {
+			glfwMakeContextCurrent(0);
+			return;
+		}
+#ifndef SIBR_OS_WINDOWS
+		if (_headless) {
+			eglMakeCurrent(_headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		}
+#endif
+	}
+
+	GLFWwindow *		Window::getContextCurrent(void) {
+		return displayIsRunning() ? glfwGetCurrentContext() : nullptr;
+	}
+
+	bool		Window::isHeadless(void) const {
+		return _headless != nullptr;
+	}
+
 
 
 } // namespace sibr
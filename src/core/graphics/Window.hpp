@@ -22,6 +22,9 @@ namespace sibr
 {
 
 	/** System window backed by an internal framebuffer.
+	* When created with WindowArgs::headless, no window is opened: an offscreen EGL context
+	* is created instead (no display server needed), rendering to the window goes to an internal
+	* framebuffer and swapping buffers only starts a new GUI frame.
 	* \ingroup sibr_graphics
 	*/
 	class SIBR_GRAPHICS_EXPORT Window : public IRenderTarget
@@ -57,19 +60,22 @@ namespace sibr
 		 **/
 		Window(const std::string & title, const sibr::Vector2i & margins, const WindowArgs & args = {}, const std::string& defaultSettingsFilename = "");
 
-		/** \return a pointer to the underlying GLFW window */
+		/** \return a pointer to the underlying GLFW window (nullptr for headless windows) */
 		GLFWwindow *  GLFW(void);
 
 		/** Activate the associated graphics context. */
-		inline void			makeContextCurrent(void);
-		/** \return the context currently in use (represented by a GLFW window) */
-		inline GLFWwindow *		getContextCurrent(void);
+		void				makeContextCurrent(void);
+		/** \return the context currently in use (represented by a GLFW window, nullptr for headless windows) */
+		GLFWwindow *		getContextCurrent(void);
 		/** Deactivate the associated graphics context. */
-		inline void			makeContextNull(void);
+		void				makeContextNull(void);
 
 		/** Flush the graphics pipeline and perform rendering, displaying the result in the abck buffer. */
 		inline void			swapBuffer(void);
 
+		/** \return true if the window was created without display (offscreen EGL context). */
+		bool				isHeadless(void) const;
+
 		/** Reset window settings to default.
 		 */
 		void				resetSettingsToDefault();
@@ -102,6 +108,9 @@ namespace sibr
 		/** \return true if an openGL context is active. */
 		static bool			contextIsRunning(void);
 
+		/** \return true if the windowing system is initialized, ie at least one non-headless window exists. */
+		static bool			displayIsRunning(void);
+
 		/** Set the framerate.
 		 *\param fps one of 60, 30, 15 
 		 */
@@ -147,7 +156,7 @@ namespace sibr
 		/** Get the backbuffer texture ID. unsuported. */
 		inline GLuint	handle(uint t = 0) const;
 
-		/** \return the window buffer ID (0) */
+		/** \return the window buffer ID (0, or the internal framebuffer for headless windows) */
 		inline GLuint	fbo(void) const;
 
 		/** Bind the window buffer. */
@@ -182,18 +191,37 @@ namespace sibr
 		 */
 		void setup(int width, int height, const std::string & title, const WindowArgs & args, const std::string& defaultSettingsFilename = "");
 
+		/** Create the offscreen context and its framebuffer, and make it current.
+		 *\param width framebuffer width
+		 *\param height framebuffer height
+		 *\return false if no EGL context could be created
+		 */
+		bool setupHeadless(int width, int height);
+
 		/// Window pointer for callbacks.
 		typedef std::unique_ptr<GLFWwindow, std::function<void(GLFWwindow*)>> GLFWwindowptr;
 
+		/// Offscreen EGL context and framebuffer, defined in the implementation.
+		struct HeadlessContext;
+		/// Headless context pointer.
+		typedef std::unique_ptr<HeadlessContext, std::function<void(HeadlessContext*)>> HeadlessContextPtr;
+
 		/// Helper to handle window creation/destruction.
 		struct AutoInitializer
 		{
-			AutoInitializer(void);
+			/** Constructor.
+			 *\param useGLFW should the windowing system be initialized (false for headless windows)
+			 */
+			AutoInitializer(bool useGLFW);
 			~AutoInitializer(void);
+
+			const bool useGLFW; ///< Was the windowing system initialized for this window.
 		};
 
 		bool				_shouldClose; ///< Is the window marked as closed.
 		GLFWwindowptr		_glfwWin; ///< Undelrying GLF window.
+		HeadlessContextPtr	_headless; ///< Offscreen context, when no window is used.
+		GLuint				_fbo = 0; ///< Framebuffer of the headless context.
 		Vector2i			_size; ///< Window size.
 		const bool			_useGUI; ///< Should ImGui windows be displayed.
 		bool				_useVSync; ///< is the window using vsync.
@@ -208,18 +236,6 @@ namespace sibr
 	};
 
 	///// INLINES /////
-	void		Window::makeContextCurrent(void) {
-		glfwMakeContextCurrent(_glfwWin.get());
-	}
-
-	void		Window::makeContextNull(void) {
-		glfwMakeContextCurrent(0);
-	}
-
-	GLFWwindow *		Window::getContextCurrent(void) {
-		return glfwGetCurrentContext();
-	}
-
 	inline GLuint	Window::texture(uint /*t*/) const {
 		SIBR_ERR << "You are trying to read the Window's backbuffer (use sibr::blit instead)." << std::endl;
 		return 0;
@@ -229,11 +245,11 @@ namespace sibr
 		return 0;
 	}
 	inline GLuint	Window::fbo(void) const {
-		return 0;
+		return _fbo;
 	}
 
 	inline void		Window::bind(void) {
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
 
 		
 	}
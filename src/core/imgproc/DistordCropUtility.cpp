@@ -11,6 +11,8 @@
 
 
 #include "DistordCropUtility.hpp"
+#include "ImagePipeline.hpp"
+#include "core/graphics/ImageInfo.hpp"
 
 namespace sibr {
 	
@@ -123,41 +125,19 @@ namespace sibr {
 
 	sibr::Vector2i DistordCropUtility::calculateAvgResolution(const std::vector<Path>& imagePaths, std::vector<sibr::Vector2i> & resolutions, const int batch_size)
 	{
-		const int nrBatches = static_cast<int>(ceil((float)(imagePaths.size()) / batch_size));
+		// Only image headers are read, no need to process by batches to limit memory usage.
 		resolutions.resize(imagePaths.size());
-		std::vector<std::pair<std::pair<long, long>, unsigned>> sumAndNrItems(nrBatches);
-
-		for (int batchId = 0; batchId < nrBatches; batchId++) {
-
-			const int nrItems = (batchId != nrBatches - 1) ? batch_size : ((nrBatches * batch_size != int(imagePaths.size())) ? (int(imagePaths.size()) - (batch_size * batchId)) : batch_size);
-			long sumOfWidths = 0;
-			long sumOfHeights = 0;
-
-			std::vector<sibr::ImageRGB> chunkOfInputImages(nrItems);
 
 #pragma omp parallel for
-			for (int localImgIndex = 0; localImgIndex < nrItems; localImgIndex++) {
-				unsigned globalImgIndex = (batchId * batch_size) + localImgIndex;
-				chunkOfInputImages.at(localImgIndex).load(imagePaths.at(globalImgIndex).string(), false);
-
-#pragma omp critical
-				{
-					sumOfWidths += long(chunkOfInputImages[localImgIndex].w());
-					sumOfHeights += long(chunkOfInputImages[localImgIndex].h());
-					resolutions[localImgIndex].x() = chunkOfInputImages[localImgIndex].w();
-					resolutions[localImgIndex].y() = chunkOfInputImages[localImgIndex].h();
-				}
-			}
-			std::pair<long, long> sums(sumOfWidths, sumOfHeights);
-			std::pair<std::pair<long, long>, unsigned> batch(sums, nrItems);
-			sumAndNrItems[batchId] = batch;
+		for (int imgIndex = 0; imgIndex < int(imagePaths.size()); imgIndex++) {
+			resolutions[imgIndex] = sibr::readImageSize(imagePaths[imgIndex].string());
 		}
 
 		long sumOfWidth = 0;
 		long sumOfHeight = 0;
-		for (unsigned i = 0; i < sumAndNrItems.size(); i++) {
-			sumOfWidth += sumAndNrItems[i].first.first;
-			sumOfHeight += sumAndNrItems[i].first.second;
+		for (const sibr::Vector2i & resolution : resolutions) {
+			sumOfWidth += long(resolution.x());
+			sumOfHeight += long(resolution.y());
 		}
 
 		const long globalAvgWidth = sumOfWidth / long(imagePaths.size());
@@ -180,7 +160,7 @@ namespace sibr {
 	{
 		// check if avg resolution needs to be calculated
 		if (avgWidth == 0 || avgHeight == 0) {
-			std::cout << "about to calculate avg resolution. use python get_image_size script if dataset has too many images\n";
+			std::cout << "about to calculate avg resolution from the image headers\n";
 			sibr::Vector2i avgResolution = calculateAvgResolution(imagePaths, resolutions, batch_size);
 			avgWidth = avgResolution.x();
 			avgHeight = avgResolution.y();
@@ -204,29 +184,32 @@ namespace sibr {
 		// compute bounding boxes for all non-discarded images
 		std::vector<Bounds> allBounds(imagePaths.size());
 
-		const int nrBatches = static_cast<int>(ceil((float)(imagePaths.size()) / batch_size));
-
-		// processs batches sequentially (we don't want to run out of memory)
-		for (int batchId = 0; batchId < nrBatches; batchId++) {
-
-			const int nrItems = (batchId != nrBatches - 1) ? batch_size : ((nrBatches * batch_size != int(imagePaths.size())) ? (int(imagePaths.size()) - (batch_size * batchId)) : batch_size);
-
-			std::vector<sibr::ImageRGB> chunkOfInputImages(nrItems);
-
-			// load images in parallel (OpenMP 2.0 doesn't allow unsigned int as index. must be signed integral type)
-#pragma omp parallel for
-			for (int localImgIndex = 0; localImgIndex < nrItems; localImgIndex++) {
-				const uint globalImgIndex = uint((batchId * batch_size) + localImgIndex);
-				// if cam was discarded, do nothing
-				if (std::find(preExcludedCams.begin(), preExcludedCams.end(), globalImgIndex) == preExcludedCams.end()) {
-					// only now load the img
-					chunkOfInputImages.at(localImgIndex).load(imagePaths.at(globalImgIndex).string(), false);
-					allBounds.at(globalImgIndex) = getBounds(chunkOfInputImages.at(localImgIndex), backgroundColor, threshold_black_color, thinest_bounding_box_size, toleranceFactor);
-
-				}
+		// images are decoded and analysed concurrently, with a bounded number of images in memory
+		std::vector<ImagePipeline::Task> tasks;
+		std::vector<size_t> taskImgIndices;
+		for (size_t i = 0; i < imagePaths.size(); i++) {
+			if (std::find(preExcludedCams.begin(), preExcludedCams.end(), uint(i)) == preExcludedCams.end()) {
+				ImagePipeline::Task task;
+				task.path = imagePaths[i].string();
+				tasks.push_back(task);
+				taskImgIndices.push_back(i);
 			}
 		}
 
+		ImagePipeline::Options options;
+		options.queueSize = uint(std::max(1, batch_size));
+		// Bounds are computed in the stored pixel layout, as reported by the image headers.
+		options.readFlags = cv::IMREAD_COLOR | cv::IMREAD_IGNORE_ORIENTATION;
+		const ImagePipeline pipeline(options);
+		const ImagePipeline::Stats stats = pipeline.run(tasks, [&](ImagePipeline::Item & item, std::vector<ImagePipeline::Output> &) {
+			cv::cvtColor(item.image, item.image, cv::COLOR_BGR2RGB);
+			sibr::ImageRGB img;
+			img.fromOpenCV(item.image);
+			allBounds.at(taskImgIndices[item.id]) = getBounds(img, backgroundColor, threshold_black_color, thinest_bounding_box_size, toleranceFactor);
+			return true;
+		});
+		stats.log("[distordCrop]");
+
 		Bounds finalBounds(resolutions.at(0));
 
 		int im_id = 0;
@@ -275,15 +258,13 @@ namespace sibr {
 
 	sibr::Vector2i DistordCropUtility::findMinImageSize(const Path & root, const std::vector<Path>& imagePaths)
 	{
-		std::vector<sibr::ImageRGB> inputImgs(imagePaths.size());
 		std::vector<sibr::Vector2i> imSizes(imagePaths.size());
 
-		std::cout << "[distordCrop] loading input images : " << std::flush;
+		std::cout << "[distordCrop] reading input image sizes : " << std::flush;
 
 #pragma omp parallel for
-		for (int id = 0; id < (int)inputImgs.size(); ++id) {
-			inputImgs.at(id).load(imagePaths.at(id).string(), false);
-			imSizes[id] = inputImgs[id].size().cast<int>();
+		for (int id = 0; id < (int)imSizes.size(); ++id) {
+			imSizes[id] = sibr::readImageSize(imagePaths.at(id).string());
 		}
 
 		sibr::Vector2i minSize = imSizes[0];
@@ -128,10 +128,10 @@ namespace sibr {
 		Bounds getBounds(const sibr::ImageRGB & img, Vector3i backgroundColor, int threshold_black_color, int thinest_bounding_box_size, float toleranceFactor);
 
 		/**
-		 * Estimate the average resolution of a set of images quickly using multithread to speed up the required loading.
+		 * Estimate the average resolution of a set of images quickly, reading only the image headers when possible.
 		 * \param imagePaths list of paths to the images
 		 * \param resolutions will contain each image resolution
-		 * \param batch_size number of images loaded per thread internally
+		 * \param batch_size unused, kept for compatibility (images are not decoded anymore)
 		 * \return the average resolution
 		 */
 		sibr::Vector2i calculateAvgResolution(const std::vector< Path > & imagePaths, std::vector<sibr::Vector2i> & resolutions, const int batch_size = 150);
@@ -141,9 +141,9 @@ namespace sibr {
 		 * \param root the dataset root path (for writing list files)
 		 * \param imagePaths list of image paths
 		 * \param resolutions will contain the image resolutions
-		 * \param avgWidth average image width, if 0 will be recomputed (slow for large datasets)
-		 * \param avgHeight average image height, if 0 will be recomputed (slow for large datasets)
-		 * \param batch_size batch size for multithreaded image loading
+		 * \param avgWidth average image width, if 0 will be recomputed from the image headers
+		 * \param avgHeight average image height, if 0 will be recomputed from the image headers
+		 * \param batch_size maximum number of decoded images waiting to be analysed
 		 * \param resolutionThreshold ratio of the minimum allowed dimensions over the average image dimensions
 		 * \param threshold_ratio_bounding_box_size maximum change in aspect ratio
 		 * \param backgroundColor the reference background color
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "ExrScanlineReader.hpp"
+
+#include <cstring>
+
+namespace sibr {
+
+	namespace {
+
+		/** All EXR values are little endian. */
+		uint32_t readLE32(const uint8_t * p)
+		{
+			return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+		}
+
+		bool readBytes(std::ifstream & file, uint8_t * dst, size_t count)
+		{
+			file.read(reinterpret_cast<char*>(dst), std::streamsize(count));
+			return size_t(file.gcount()) == count;
+		}
+
+		float halfToFloat(uint16_t h)
+		{
+			const uint32_t sign = uint32_t(h & 0x8000) << 16;
+			uint32_t exponent = (h >> 10) & 0x1F;
+			uint32_t mantissa = h & 0x3FF;
+			uint32_t bits;
+			if (exponent == 0x1F) {
+				// Infinity or NaN.
+				bits = sign | 0x7F800000 | (mantissa << 13);
+			}
+			else if (exponent != 0) {
+				bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+			}
+			else if (mantissa == 0) {
+				bits = sign;
+			}
+			else {
+				// Denormal half, normalized as a float.
+				exponent = 113;
+				while ((mantissa & 0x400) == 0) {
+					mantissa <<= 1;
+					--exponent;
+				}
+				bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+			}
+			float value;
+			std::memcpy(&value, &bits, sizeof(float));
+			return value;
+		}
+
+		float readValue(const uint8_t * p, uint pixelType)
+		{
+			if (pixelType == 1) {
+				return halfToFloat(uint16_t(p[0] | (p[1] << 8)));
+			}
+			const uint32_t bits = readLE32(p);
+			if (pixelType == 0) {
+				return float(bits);
+			}
+			float value;
+			std::memcpy(&value, &bits, sizeof(float));
+			return value;
+		}
+	}
+
+	bool ExrScanlineReader::open(const std::string & path)
+	{
+		_file.close();
+		_file.clear();
+		_channels.clear();
+		_offsets.clear();
+		_nextRow = 0;
+		_file.open(path, std::ios::in | std::ios::binary);
+		if (!_file) {
+			return false;
+		}
+
+		uint8_t start[8];
+		if (!readBytes(_file, start, sizeof(start)) || readLE32(start) != 20000630u) {
+			return false;
+		}
+		// Tiled, deep and multi-part files are not supported.
+		const uint32_t version = readLE32(start + 4);
+		if ((version & 0xFF) != 2 || (version & (0x200 | 0x800 | 0x1000)) != 0) {
+			return false;
+		}
+
+		bool hasWindow = false;
+		bool uncompressed = false;
+		while (true) {
+			std::string name, type;
+			if (!std::getline(_file, name, '\0')) {
+				return false;
+			}
+			if (name.empty()) {
+				break;
+			}
+			uint8_t sizeBytes[4];
+			if (!std::getline(_file, type, '\0') || !readBytes(_file, sizeBytes, 4)) {
+				return false;
+			}
+			const uint32_t size = readLE32(sizeBytes);
+			std::vector<uint8_t> value(size);
+			if (!readBytes(_file, value.data(), size)) {
+				return false;
+			}
+			if (name == "dataWindow" && type == "box2i" && size == 16) {
+				const int32_t xMin = int32_t(readLE32(&value[0])), yMin = int32_t(readLE32(&value[4]));
+				const int32_t xMax = int32_t(readLE32(&value[8])), yMax = int32_t(readLE32(&value[12]));
+				_width = xMax - xMin + 1;
+				_height = yMax - yMin + 1;
+				_yMin = yMin;
+				hasWindow = _width > 0 && _height > 0;
+			}
+			else if (name == "compression" && type == "compression" && size == 1) {
+				uncompressed = value[0] == 0;
+			}
+			else if (name == "channels" && type == "chlist") {
+				// Each channel: name, pixel type (4), pLinear + reserved (4), x and y sampling (8).
+				size_t pos = 0;
+				while (pos < value.size() && value[pos] != 0) {
+					Channel channel;
+					while (pos < value.size() && value[pos] != 0) {
+						channel.name += char(value[pos]);
+						++pos;
+					}
+					pos += 1;
+					if (pos + 16 > value.size()) {
+						return false;
+					}
+					channel.pixelType = readLE32(&value[pos]);
+					if (channel.pixelType > 2 || readLE32(&value[pos + 8]) != 1 || readLE32(&value[pos + 12]) != 1) {
+						return false;
+					}
+					_channels.push_back(channel);
+					pos += 16;
+				}
+			}
+		}
+		if (!hasWindow || !uncompressed || _channels.empty()) {
+			return false;
+		}
+
+		// Uncompressed files store one row per chunk, each channel row after the other.
+		_rowBytes = 0;
+		_bgrChannels[0] = _bgrChannels[1] = _bgrChannels[2] = -1;
+		int luminance = -1;
+		for (int c = 0; c < int(_channels.size()); ++c) {
+			_channels[c].offset = _rowBytes;
+			_rowBytes += size_t(_width) * (_channels[c].pixelType == 1 ? 2 : 4);
+			const std::string & name = _channels[c].name;
+			if (name == "B") { _bgrChannels[0] = c; }
+			else if (name == "G") { _bgrChannels[1] = c; }
+			else if (name == "R") { _bgrChannels[2] = c; }
+			else if (name == "Y") { luminance = c; }
+		}
+		for (int & channel : _bgrChannels) {
+			if (channel < 0) {
+				channel = luminance;
+			}
+			if (channel < 0) {
+				return false;
+			}
+		}
+
+		_offsets.resize(_height);
+		std::vector<uint8_t> table(size_t(_height) * 8);
+		if (!readBytes(_file, table.data(), table.size())) {
+			return false;
+		}
+		for (int y = 0; y < _height; ++y) {
+			_offsets[y] = uint64_t(readLE32(&table[8 * y])) | (uint64_t(readLE32(&table[8 * y + 4])) << 32);
+		}
+		return true;
+	}
+
+	int ExrScanlineReader::readRows(cv::Mat & rows, int maxRows)
+	{
+		const int count = std::min(maxRows, _height - _nextRow);
+		if (!_file.is_open() || count <= 0) {
+			return 0;
+		}
+
+		// Read sequentially, then convert in parallel.
+		_buffer.resize(size_t(count) * _rowBytes);
+		for (int r = 0; r < count; ++r) {
+			const int y = _nextRow + r;
+			uint8_t chunkHeader[8];
+			_file.seekg(std::streamoff(_offsets[y]), std::ios::beg);
+			if (!readBytes(_file, chunkHeader, sizeof(chunkHeader))
+				|| int32_t(readLE32(chunkHeader)) != _yMin + y
+				|| readLE32(chunkHeader + 4) != _rowBytes
+				|| !readBytes(_file, &_buffer[r * _rowBytes], _rowBytes)) {
+				SIBR_WRG << "[ExrScanlineReader] Unable to read row " << y << "." << std::endl;
+				_file.close();
+				return 0;
+			}
+		}
+
+		rows.create(count, _width, CV_32FC3);
+#pragma omp parallel for
+		for (int r = 0; r < count; ++r) {
+			const uint8_t * src = &_buffer[r * _rowBytes];
+			float * dst = rows.ptr<float>(r);
+			for (int k = 0; k < 3; ++k) {
+				const Channel & channel = _channels[_bgrChannels[k]];
+				const size_t stride = channel.pixelType == 1 ? 2 : 4;
+				const uint8_t * channelSrc = src + channel.offset;
+				for (int x = 0; x < _width; ++x) {
+					dst[3 * x + k] = readValue(channelSrc + x * stride, channel.pixelType);
+				}
+			}
+		}
+		_nextRow += count;
+		return count;
+	}
+
+}
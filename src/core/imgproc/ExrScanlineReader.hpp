@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "Config.hpp"
+
+#include <opencv2/core/core.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sibr {
+
+	/** \brief Read an OpenEXR image a few rows at a time, to process very large images in bounded memory.
+	 * Only single part, uncompressed scanline files with R,G,B (or Y) channels are supported;
+	 * open() fails for other files, which should be loaded entirely with cv::imread instead.
+	 * \ingroup sibr_imgproc
+	 */
+	class SIBR_IMGPROC_EXPORT ExrScanlineReader
+	{
+	public:
+
+		/** Open a file and parse its header.
+		 * \param path the image path
+		 * \return false if the file can't be streamed
+		 */
+		bool open(const std::string & path);
+
+		/** \return the image width */
+		int width() const { return _width; }
+
+		/** \return the image height */
+		int height() const { return _height; }
+
+		/** \return the index of the next row to read */
+		int nextRow() const { return _nextRow; }
+
+		/** Read the next rows, from top to bottom.
+		 * \param rows will contain the rows as a CV_32FC3 image, in BGR order like cv::imread
+		 * \param maxRows maximum number of rows to read
+		 * \return the number of rows read, 0 at the end of the image or on error
+		 */
+		int readRows(cv::Mat & rows, int maxRows);
+
+	private:
+
+		/** Channel stored in the file. */
+		struct Channel {
+			std::string name; ///< Channel name.
+			uint pixelType; ///< 0: uint, 1: half, 2: float.
+			size_t offset; ///< Offset of the channel in a row, in bytes.
+		};
+
+		std::ifstream _file; ///< Image file.
+		std::vector<Channel> _channels; ///< Channels, in file order.
+		std::vector<uint64_t> _offsets; ///< File offset of each row.
+		int _bgrChannels[3] = { -1, -1, -1 }; ///< Index of the channel used for each output component.
+		size_t _rowBytes = 0; ///< Size of a row, in bytes.
+		int _width = 0; ///< Image width.
+		int _height = 0; ///< Image height.
+		int _yMin = 0; ///< Data window top.
+		int _nextRow = 0; ///< Next row to read.
+		std::vector<uint8_t> _buffer; ///< Raw row data.
+	};
+
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "ImagePipeline.hpp"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace sibr {
+
+	namespace {
+
+		/** Fixed capacity FIFO shared by a group of producers and a group of consumers.
+		 * Producers block when the queue is full, consumers block when it is empty.
+		 * Once all producers are done, the queue is closed and consumers drain it.
+		 */
+		template<typename T>
+		class BoundedQueue
+		{
+		public:
+
+			BoundedQueue(size_t capacity, uint producers) : _capacity(capacity), _producers(producers) {}
+
+			void push(T && value) {
+				std::unique_lock<std::mutex> lock(_mutex);
+				_notFull.wait(lock, [this] { return _items.size() < _capacity; });
+				_items.push_back(std::move(value));
+				_notEmpty.notify_one();
+			}
+
+			/** \return false once the queue is closed and empty. */
+			bool pop(T & value) {
+				std::unique_lock<std::mutex> lock(_mutex);
+				_notEmpty.wait(lock, [this] { return !_items.empty() || _producers == 0; });
+				if (_items.empty()) {
+					return false;
+				}
+				value = std::move(_items.front());
+				_items.pop_front();
+				_notFull.notify_one();
+				return true;
+			}
+
+			/** Signal that one of the producers is done, the last one closes the queue. */
+			void producerDone() {
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (--_producers == 0) {
+					_notEmpty.notify_all();
+				}
+			}
+
+		private:
+			std::deque<T> _items;
+			const size_t _capacity;
+			uint _producers;
+			std::mutex _mutex;
+			std::condition_variable _notFull;
+			std::condition_variable _notEmpty;
+		};
+
+		typedef std::chrono::steady_clock Clock;
+
+		double secondsSince(const Clock::time_point & start) {
+			return std::chrono::duration<double>(Clock::now() - start).count();
+		}
+
+		size_t imageBytes(const cv::Mat & image) {
+			return image.total() * image.elemSize();
+		}
+
+		/** Statistics shared by all workers. */
+		struct SharedStats {
+			std::atomic<size_t> images{ 0 };
+			std::atomic<size_t> outputs{ 0 };
+			std::atomic<size_t> failures{ 0 };
+			std::atomic<size_t> queuedBytes{ 0 };
+			std::atomic<size_t> peakQueuedBytes{ 0 };
+			std::mutex timesMutex;
+			double decodeTime = 0.0;
+			double transformTime = 0.0;
+			double encodeTime = 0.0;
+
+			void addTime(double & dst, double duration) {
+				std::lock_guard<std::mutex> lock(timesMutex);
+				dst += duration;
+			}
+
+			void enqueued(size_t bytes) {
+				const size_t current = queuedBytes += bytes;
+				size_t peak = peakQueuedBytes.load();
+				while (current > peak && !peakQueuedBytes.compare_exchange_weak(peak, current)) {}
+			}
+
+			void dequeued(size_t bytes) {
+				queuedBytes -= bytes;
+			}
+		};
+	}
+
+	ImagePipeline::ImagePipeline() : ImagePipeline(Options())
+	{
+	}
+
+	ImagePipeline::ImagePipeline(const Options & options) : _options(options)
+	{
+		const uint cores = std::max(1u, std::thread::hardware_concurrency());
+		// Decoding and encoding are usually the bottlenecks, processing is often a simple crop or resize.
+		if (_options.decodeThreads == 0) {
+			_options.decodeThreads = std::max(1u, cores / 2);
+		}
+		if (_options.transformThreads == 0) {
+			_options.transformThreads = std::max(1u, cores / 4);
+		}
+		if (_options.encodeThreads == 0) {
+			_options.encodeThreads = std::max(1u, cores / 2);
+		}
+		if (_options.queueSize == 0) {
+			_options.queueSize = 2 * cores;
+		}
+	}
+
+	cv::Mat ImagePipeline::decode(const std::string & path, int flags, float downscale, int & reduction)
+	{
+		reduction = 1;
+		// libjpeg can decode at 1/2, 1/4 or 1/8 of the full resolution for a fraction of the cost,
+		// use the largest reduction that keeps at least the requested resolution.
+		const int orientationFlag = flags & cv::IMREAD_IGNORE_ORIENTATION;
+		const int baseFlags = flags & ~cv::IMREAD_IGNORE_ORIENTATION;
+		const bool reducibleFlags = baseFlags == cv::IMREAD_COLOR || baseFlags == cv::IMREAD_GRAYSCALE;
+		if (reducibleFlags && downscale > 0.0f && downscale <= 0.5f) {
+			const std::string ext = boost::algorithm::to_lower_copy(boost::filesystem::extension(path));
+			if (ext == ".jpg" || ext == ".jpeg") {
+				while (reduction < 8 && downscale * float(2 * reduction) <= 1.0f) {
+					reduction *= 2;
+				}
+			}
+		}
+		int readFlags = flags;
+		if (reduction == 2) {
+			readFlags = orientationFlag | (baseFlags == cv::IMREAD_COLOR ? cv::IMREAD_REDUCED_COLOR_2 : cv::IMREAD_REDUCED_GRAYSCALE_2);
+		}
+		else if (reduction == 4) {
+			readFlags = orientationFlag | (baseFlags == cv::IMREAD_COLOR ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_GRAYSCALE_4);
+		}
+		else if (reduction == 8) {
+			readFlags = orientationFlag | (baseFlags == cv::IMREAD_COLOR ? cv::IMREAD_REDUCED_COLOR_8 : cv::IMREAD_REDUCED_GRAYSCALE_8);
+		}
+		return cv::imread(path, readFlags);
+	}
+
+	ImagePipeline::Stats ImagePipeline::run(const std::vector<Task> & tasks, const Transform & transform) const
+	{
+		const Clock::time_point start = Clock::now();
+		SharedStats shared;
+
+		BoundedQueue<Item> decoded(_options.queueSize, _options.decodeThreads);
+		BoundedQueue<Output> processed(_options.queueSize, _options.transformThreads);
+		std::atomic<size_t> nextTask(0);
+
+		auto decodeWorker = [&]() {
+			for (size_t id = nextTask++; id < tasks.size(); id = nextTask++) {
+				const Clock::time_point t0 = Clock::now();
+				Item item;
+				item.id = id;
+				try {
+					item.image = decode(tasks[id].path, _options.readFlags, tasks[id].downscale, item.reduction);
+				}
+				catch (const cv::Exception & e) {
+					SIBR_WRG << "[ImagePipeline] " << e.what() << std::endl;
+					item.image.release();
+				}
+				shared.addTime(shared.decodeTime, secondsSince(t0));
+				if (item.image.empty()) {
+					SIBR_WRG << "[ImagePipeline] Unable to decode " << tasks[id].path << std::endl;
+					++shared.failures;
+					continue;
+				}
+				const size_t bytes = imageBytes(item.image);
+				shared.enqueued(bytes);
+				decoded.push(std::move(item));
+			}
+			decoded.producerDone();
+		};
+
+		auto transformWorker = [&]() {
+			Item item;
+			std::vector<Output> outputs;
+			while (decoded.pop(item)) {
+				shared.dequeued(imageBytes(item.image));
+				const Clock::time_point t0 = Clock::now();
+				outputs.clear();
+				bool success = false;
+				try {
+					success = transform(item, outputs);
+				}
+				catch (const std::exception & e) {
+					SIBR_WRG << "[ImagePipeline] Processing " << tasks[item.id].path << " failed: " << e.what() << std::endl;
+				}
+				shared.addTime(shared.transformTime, secondsSince(t0));
+				// Release the decoded image before blocking on the next queue.
+				item.image.release();
+				if (!success) {
+					++shared.failures;
+					continue;
+				}
+				++shared.images;
+				for (Output & output : outputs) {
+					shared.enqueued(imageBytes(output.image));
+					processed.push(std::move(output));
+				}
+			}
+			processed.producerDone();
+		};
+
+		auto encodeWorker = [&]() {
+			Output output;
+			while (processed.pop(output)) {
+				shared.dequeued(imageBytes(output.image));
+				const Clock::time_point t0 = Clock::now();
+				bool success = false;
+				try {
+					success = cv::imwrite(output.path, output.image, output.params);
+				}
+				catch (const cv::Exception & e) {
+					SIBR_WRG << "[ImagePipeline] " << e.what() << std::endl;
+				}
+				shared.addTime(shared.encodeTime, secondsSince(t0));
+				if (success) {
+					++shared.outputs;
+				}
+				else {
+					SIBR_WRG << "[ImagePipeline] Unable to write " << output.path << std::endl;
+					++shared.failures;
+				}
+				output.image.release();
+			}
+		};
+
+		std::vector<std::thread> workers;
+		for (uint t = 0; t < _options.decodeThreads; ++t) {
+			workers.emplace_back(decodeWorker);
+		}
+		for (uint t = 0; t < _options.transformThreads; ++t) {
+			workers.emplace_back(transformWorker);
+		}
+		for (uint t = 0; t < _options.encodeThreads; ++t) {
+			workers.emplace_back(encodeWorker);
+		}
+		for (std::thread & worker : workers) {
+			worker.join();
+		}
+
+		Stats stats;
+		stats.images = shared.images;
+		stats.outputs = shared.outputs;
+		stats.failures = shared.failures;
+		stats.decodeTime = shared.decodeTime;
+		stats.transformTime = shared.transformTime;
+		stats.encodeTime = shared.encodeTime;
+		stats.peakQueuedBytes = shared.peakQueuedBytes;
+		stats.wallTime = secondsSince(start);
+		return stats;
+	}
+
+	void ImagePipeline::Stats::log(const std::string & tag) const
+	{
+		const double throughput = wallTime > 0.0 ? double(images) / wallTime : 0.0;
+		SIBR_LOG << tag << " Processed " << images << " images (" << outputs << " written, " << failures << " failures) in "
+			<< wallTime << "s: " << throughput << " images/s." << std::endl;
+		SIBR_LOG << tag << " Thread time: decode " << decodeTime << "s, transform " << transformTime
+			<< "s, encode " << encodeTime << "s. Peak queued memory: " << double(peakQueuedBytes) / (1024.0 * 1024.0) << "MB." << std::endl;
+	}
+
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "Config.hpp"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sibr {
+
+	/** \brief Batch image processing pipeline, overlapping decoding, processing and encoding.
+	 * Images are decoded, transformed and encoded by three separate pools of worker threads,
+	 * connected by bounded queues: when a stage is slower than the previous one, the previous
+	 * stage blocks instead of accumulating images, which bounds memory usage.
+	 *
+	 * Code example:
+	 *
+	 *		ImagePipeline pipeline;
+	 *		std::vector<ImagePipeline::Task> tasks = ...;
+	 *		const ImagePipeline::Stats stats = pipeline.run(tasks, [&](ImagePipeline::Item & item, std::vector<ImagePipeline::Output> & outputs) {
+	 *			outputs.push_back({ outputPaths[item.id], item.image(roi) });
+	 *			return true;
+	 *		});
+	 *		stats.log("[myTool]");
+	 *
+	 * \ingroup sibr_imgproc
+	 */
+	class SIBR_IMGPROC_EXPORT ImagePipeline
+	{
+	public:
+
+		/** An image to process. */
+		struct Task {
+			std::string path; ///< Path of the image to decode.
+			float downscale = 1.0f; ///< Scale that will be applied by the transform, a value below 0.5 allows reduced-size JPEG decoding.
+		};
+
+		/** A decoded image, passed to the transform. */
+		struct Item {
+			size_t id = 0; ///< Index of the task in the task list.
+			cv::Mat image; ///< Decoded image (OpenCV channel order).
+			int reduction = 1; ///< Factor the image was reduced by when decoding (1, 2, 4 or 8).
+		};
+
+		/** An image to encode, produced by the transform. */
+		struct Output {
+			std::string path; ///< Destination path, the extension determines the format.
+			cv::Mat image; ///< Image to encode.
+			std::vector<int> params; ///< Optional cv::imwrite parameters.
+		};
+
+		/** Processing function, called concurrently on transform workers.
+		 * Outputs will be encoded by the encode workers. Return false to signal a failure.
+		 */
+		typedef std::function<bool(Item & item, std::vector<Output> & outputs)> Transform;
+
+		/** Pipeline parameters. Thread counts set to 0 are derived from the number of cores. */
+		struct Options {
+			uint decodeThreads = 0; ///< Number of decoding threads.
+			uint transformThreads = 0; ///< Number of processing threads.
+			uint encodeThreads = 0; ///< Number of encoding threads.
+			uint queueSize = 0; ///< Maximum number of images waiting between two stages.
+			int readFlags = cv::IMREAD_COLOR; ///< cv::imread flags.
+		};
+
+		/** Execution report. */
+		struct Stats {
+			size_t images = 0; ///< Number of processed images.
+			size_t outputs = 0; ///< Number of encoded images.
+			size_t failures = 0; ///< Number of images that couldn't be decoded, processed or encoded.
+			double wallTime = 0.0; ///< Total duration, in seconds.
+			double decodeTime = 0.0; ///< Time spent decoding, summed over threads, in seconds.
+			double transformTime = 0.0; ///< Time spent processing, summed over threads, in seconds.
+			double encodeTime = 0.0; ///< Time spent encoding, summed over threads, in seconds.
+			size_t peakQueuedBytes = 0; ///< Maximum memory used by images waiting in the queues.
+
+			/** Print a throughput report.
+			 * \param tag prefix for the log lines
+			 */
+			void log(const std::string & tag) const;
+		};
+
+		/** Constructor, using default parameters. */
+		ImagePipeline();
+
+		/** Constructor.
+		 * \param options the pipeline parameters
+		 */
+		ImagePipeline(const Options & options);
+
+		/** Process a list of images, returns once all outputs are written.
+		 * \param tasks the images to process
+		 * \param transform the processing function
+		 * \return execution statistics
+		 */
+		Stats run(const std::vector<Task> & tasks, const Transform & transform) const;
+
+		/** Decode an image, using reduced-size JPEG decoding if the image will be downscaled enough.
+		 * \param path the image path
+		 * \param flags cv::imread flags
+		 * \param downscale the scale that will be applied to the image
+		 * \param reduction will contain the reduction factor applied while decoding
+		 * \return the decoded image, empty on failure
+		 */
+		static cv::Mat decode(const std::string & path, int flags, float downscale, int & reduction);
+
+	private:
+
+		Options _options; ///< Parameters, with thread counts resolved.
+	};
+
+}
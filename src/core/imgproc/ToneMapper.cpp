@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "ToneMapper.hpp"
+
+#include <Eigen/Core>
+#include <boost/algorithm/string.hpp>
+
+namespace sibr {
+
+	ToneMapper::ToneMapper(float exposure, float gamma, Curve curve, Encoding encoding) :
+		_exposure(exposure), _gamma(gamma), _curve(curve), _encoding(encoding)
+	{
+	}
+
+	void ToneMapper::processRow(float * values, size_t count) const
+	{
+		// Each expression is evaluated in a single vectorized pass over the row.
+		Eigen::Map<Eigen::ArrayXf> x(values, Eigen::Index(count));
+
+		switch (_curve) {
+		case Curve::EXPONENTIAL:
+			x = (1.0f - (-_exposure * x).exp()).max(0.0f).min(1.0f);
+			break;
+		case Curve::REINHARD:
+			x = (_exposure * x).max(0.0f);
+			x = x / (1.0f + x);
+			break;
+		case Curve::FILMIC:
+			x = (_exposure * x).max(0.0f);
+			x = ((x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f)).min(1.0f);
+			break;
+		}
+
+		// pow(x, y) is computed as exp(y * log(x)), which vectorizes; log(0) = -inf maps back to 0.
+		if (_encoding == Encoding::SRGB) {
+			x = (x <= 0.0031308f).select(12.92f * x, 1.055f * ((1.0f / 2.4f) * x.log()).exp() - 0.055f);
+		}
+		else if (_gamma > 0.0f) {
+			x = ((1.0f / _gamma) * x.log()).exp();
+		}
+	}
+
+	void ToneMapper::process(cv::Mat & img) const
+	{
+		CV_Assert(img.depth() == CV_32F);
+		const size_t rowCount = size_t(img.cols) * img.channels();
+#pragma omp parallel for
+		for (int y = 0; y < img.rows; ++y) {
+			processRow(img.ptr<float>(y), rowCount);
+		}
+	}
+
+	cv::Mat ToneMapper::toLDR(const cv::Mat & hdr) const
+	{
+		cv::Mat values;
+		if (hdr.depth() == CV_32F) {
+			values = hdr.clone();
+		}
+		else {
+			hdr.convertTo(values, CV_32F);
+		}
+		process(values);
+		cv::Mat ldr;
+		values.convertTo(ldr, CV_8U, 255.0f);
+		return ldr;
+	}
+
+	bool ToneMapper::parseCurve(const std::string & name, Curve & curve)
+	{
+		const std::string lowerName = boost::algorithm::to_lower_copy(name);
+		if (lowerName == "exponential") {
+			curve = Curve::EXPONENTIAL;
+		}
+		else if (lowerName == "reinhard") {
+			curve = Curve::REINHARD;
+		}
+		else if (lowerName == "filmic") {
+			curve = Curve::FILMIC;
+		}
+		else {
+			return false;
+		}
+		return true;
+	}
+
+}
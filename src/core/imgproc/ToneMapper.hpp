@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "Config.hpp"
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+
+namespace sibr {
+
+	/** \brief Map HDR values to displayable [0,1] values, then encode them for display.
+	 * Rows of interleaved float values are processed in place, using Eigen vectorized
+	 * array operations; channels are all processed the same way so their order doesn't matter.
+	 * \ingroup sibr_imgproc
+	 */
+	class SIBR_IMGPROC_EXPORT ToneMapper
+	{
+	public:
+
+		/** Tonemapping curve, applied after exposure. */
+		enum class Curve {
+			EXPONENTIAL, ///< 1 - exp(-x)
+			REINHARD, ///< x / (1 + x)
+			FILMIC ///< ACES filmic fit (Narkowicz 2015)
+		};
+
+		/** Display encoding, applied after the curve. */
+		enum class Encoding {
+			GAMMA, ///< x^(1/gamma), skipped if gamma <= 0
+			SRGB ///< sRGB transfer function
+		};
+
+		/** Constructor.
+		 * \param exposure exposure multiplier
+		 * \param gamma gamma value, used with Encoding::GAMMA
+		 * \param curve tonemapping curve
+		 * \param encoding display encoding
+		 */
+		ToneMapper(float exposure = 1.0f, float gamma = 2.2f, Curve curve = Curve::EXPONENTIAL, Encoding encoding = Encoding::GAMMA);
+
+		/** Tonemap a row of values in place, outputs are in [0,1].
+		 * \param values the values to process
+		 * \param count number of values
+		 */
+		void processRow(float * values, size_t count) const;
+
+		/** Tonemap a float image in place, rows are processed in parallel.
+		 * \param img a CV_32F image, with any number of channels
+		 */
+		void process(cv::Mat & img) const;
+
+		/** Tonemap an image and convert it to 8 bits.
+		 * \param hdr the HDR image, converted to float if needed
+		 * \return the CV_8U image, with the same channels as the input
+		 */
+		cv::Mat toLDR(const cv::Mat & hdr) const;
+
+		/** Parse a curve name ("exponential", "reinhard" or "filmic").
+		 * \param name the curve name
+		 * \param curve will contain the curve
+		 * \return false if the name is unknown
+		 */
+		static bool parseCurve(const std::string & name, Curve & curve);
+
+	private:
+
+		float _exposure; ///< Exposure multiplier.
+		float _gamma; ///< Gamma for Encoding::GAMMA.
+		Curve _curve; ///< Tonemapping curve.
+		Encoding _encoding; ///< Display encoding.
+	};
+
+}
@@ -107,6 +107,16 @@ namespace sibr
 		
 	}
 
+	void CameraRaycaster::computeClippingPlanes(const sibr::MeshLOD & lods, std::vector<InputCamera::Ptr>& cams, std::vector<sibr::Vector2f> & nearsFars, float maxPixelError)
+	{
+		uint level = lods.levelCount() - 1;
+		for (const InputCamera::Ptr & cam : cams) {
+			level = std::min(level, lods.selectLevel(*cam, float(cam->h()), maxPixelError));
+		}
+		SIBR_LOG << " [CameraRaycaster] Using proxy level " << level << " (" << lods.level(level).triangles().size() << " triangles)." << std::endl;
+		computeClippingPlanes(lods.level(level), cams, nearsFars);
+	}
+
 
 	sibr::Vector3f CameraRaycaster::computeRayDir( const sibr::InputCamera& cam, const sibr::Vector2f & pixel )
 	{
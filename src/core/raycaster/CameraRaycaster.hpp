@@ -15,6 +15,7 @@
 # include <array>
 # include <core/graphics/Image.hpp>
 # include <core/assets/InputCamera.hpp>
+# include <core/graphics/MeshLOD.hpp>
 # include "core/raycaster/Config.hpp"
 # include "core/raycaster/Raycaster.hpp"
 
@@ -96,6 +97,15 @@ namespace sibr
 		*/
 		static void computeClippingPlanes(const sibr::Mesh & mesh, std::vector<InputCamera::Ptr>& cams, std::vector<sibr::Vector2f> & nearsFars);
 
+		/** Estimate the clipping planes using the coarsest level of detail that all cameras can afford.
+		Rays are cast every 15 pixels, so a few pixels of error barely change the estimated planes.
+		\param lods the simplified meshes
+		\param cams the list of cameras
+		\param nearsFars will contain the near and far plane of each camera
+		\param maxPixelError the maximum screen-space error allowed in each camera
+		*/
+		static void computeClippingPlanes(const sibr::MeshLOD & lods, std::vector<InputCamera::Ptr>& cams, std::vector<sibr::Vector2f> & nearsFars, float maxPixelError);
+
 		/// \return the internal raycaster
 		Raycaster&			raycaster( void )			{ return _raycaster; }
 		/// \return the internal raycaster
@@ -15,9 +15,21 @@
 
 typedef Eigen::Array<bool, Eigen::Dynamic, 1> ArrayXb;
 
+namespace {
+	/// Probability that the best plane has been found when stopping early.
+	const double ransacConfidence = 0.999;
+	/// Number of hypotheses evaluated in parallel between two stopping tests.
+	const int hypothesesPerBlock = 64;
+	/// Number of points used for preemptive scoring of hypotheses.
+	const int preemptiveSubsetSize = 1024;
+	/// Normal validity threshold used when voting.
+	const float voteNormalDot = 0.98f;
+}
+
 PlaneEstimator::PlaneEstimator() {}
 
-PlaneEstimator::PlaneEstimator(const std::vector<sibr::Vector3f> & vertices, bool excludeBB)
+PlaneEstimator::PlaneEstimator(const std::vector<sibr::Vector3f> & vertices, bool excludeBB, int seed)
+	: _generator(seed >= 0 ? (unsigned int)seed : std::random_device()())
 {
 
 	Eigen::AlignedBox<float, 3> boxScaled;
@@ -35,12 +47,10 @@ PlaneEstimator::PlaneEstimator(const std::vector<sibr::Vector3f> & vertices, boo
 	if (vertices.size() > 200000) {
 		std::cout << "Found more than 200000 points reducing point cloud size ..." << std::endl;
 
-		std::random_device rd;
-		std::mt19937 mt(rd());
 		std::uniform_real_distribution<double> dist(0.0, 1.0);
 
 		for (const auto & v : vertices) {
-			double random = dist(mt);
+			double random = dist(_generator);
 			if (random < 200000.0 / double(vertices.size())) {
 				if (!excludeBB || (boxScaled.exteriorDistance(v)==0) )
 					_Points.push_back(v);
@@ -142,29 +152,86 @@ void PlaneEstimator::computePlanes(const int numPlane, const  float delta, const
 
 sibr::Vector4f PlaneEstimator::estimatePlane(const float delta, const int numTry, Eigen::MatrixXi & bestMask, int & bestVote, std::pair<Eigen::MatrixXf, sibr::Vector3f> & bestCovMean) {
 
-	sibr::Vector4f bestPlane;
-
+	sibr::Vector4f bestPlane(0.0f, 0.0f, 0.0f, 0.0f);
 	float bestWVote = 0;
-#pragma omp parallel for
-	for (int i = 0; i < numTry; i++) {
+	bestVote = 0;
 
-		Eigen::MatrixXi mask;
-		sibr::Vector4f plane = plane3Pts();
-		if (plane.xyz().norm() > 0) {
-			std::pair<int, float> votePair = votePlane(plane, delta, mask);
-
-#pragma omp critical
-			{
-				//std::cout << i << " ";
-				if (votePair.second > bestWVote) {
-					bestWVote = votePair.second;
-					bestVote = votePair.first;
-					bestPlane = plane;
-					bestMask = std::move(mask); // move to avoid copy
-				}
+	const int numPoints = int(_remainPoints3D.rows());
+	if (numPoints < 3) {
+		bestMask = Eigen::MatrixXi::Zero(numPoints, 1);
+		return bestPlane;
+	}
+
+	buildBuckets();
+
+	// Random subset of the points used to discard hopeless hypotheses early.
+	std::uniform_int_distribution<> dis(0, numPoints - 1);
+	const int subsetSize = std::min(numPoints, preemptiveSubsetSize);
+	Eigen::MatrixXf subsetPoints(subsetSize, 3);
+	Eigen::MatrixXf subsetNormals(subsetSize, 3);
+	for (int sId = 0; sId < subsetSize; ++sId) {
+		const int pId = dis(_generator);
+		subsetPoints.row(sId) = _remainPoints3D.row(pId);
+		subsetNormals.row(sId) = _remainNormals3D.row(pId);
+	}
+	int bestSubsetVote = 0;
+
+	std::vector<sibr::Vector4f> planes(hypothesesPerBlock);
+	std::vector<std::pair<int, float>> votes(hypothesesPerBlock);
+	std::vector<int> subsetVotes(hypothesesPerBlock);
+
+	int maxTry = numTry;
+	int tried = 0;
+	while (tried < maxTry) {
+		const int blockSize = std::min(hypothesesPerBlock, maxTry - tried);
+
+		// Hypotheses are drawn sequentially so that the result only depends on the seed.
+		for (int h = 0; h < blockSize; ++h) {
+			planes[h] = plane3Pts();
+		}
+
+#pragma omp parallel for schedule(dynamic)
+		for (int h = 0; h < blockSize; ++h) {
+			votes[h] = std::make_pair(0, 0.0f);
+			subsetVotes[h] = 0;
+			const sibr::Vector4f & plane = planes[h];
+			if (!(plane.xyz().norm() > 0)) {
+				continue;
+			}
+			const Eigen::ArrayXf distances = ((subsetPoints * plane.xyz()).array() - plane.w()).cwiseAbs();
+			const Eigen::ArrayXf dots = (subsetNormals * plane.xyz()).array().cwiseAbs();
+			subsetVotes[h] = int((distances < delta && (dots > voteNormalDot || dots == 0)).count());
+			// Unlikely to beat the current best, skip the full evaluation.
+			if (2 * subsetVotes[h] < bestSubsetVote) {
+				continue;
 			}
+			votes[h] = scorePlane(plane, delta, voteNormalDot, nullptr);
 		}
 
+		for (int h = 0; h < blockSize; ++h) {
+			if (votes[h].second > bestWVote) {
+				bestWVote = votes[h].second;
+				bestVote = votes[h].first;
+				bestPlane = planes[h];
+				bestSubsetVote = subsetVotes[h];
+			}
+		}
+		tried += blockSize;
+
+		// Adaptive termination: number of draws needed to pick 3 inliers of the best plane with high confidence.
+		const double inlierRatio = double(bestVote) / double(numPoints);
+		if (inlierRatio > 0.0) {
+			const double allInliers = std::pow(inlierRatio, 3.0);
+			const double needed = allInliers >= 1.0 ? 1.0 : std::log(1.0 - ransacConfidence) / std::log(1.0 - allInliers);
+			maxTry = int(std::min(double(numTry), std::ceil(std::max(needed, 1.0))));
+		}
+	}
+
+	std::cout << "Tried " << tried << " hypotheses out of " << numTry << std::endl;
+	if (bestWVote > 0) {
+		bestVote = scorePlane(bestPlane, delta, voteNormalDot, &bestMask).first;
+	} else {
+		bestMask = Eigen::MatrixXi::Zero(numPoints, 1);
 	}
 
 	std::cout << "Best vote " << bestVote << " Best plane " << bestPlane << std::endl;
@@ -222,13 +289,11 @@ sibr::Vector4f PlaneEstimator::estimatePlane(const float delta, const int numTry
 
 sibr::Vector4f PlaneEstimator::plane3Pts() {
 
-	std::random_device rd;  //Will be used to obtain a seed for the random number engine
-	std::mt19937 gen(rd()); //Standard mersenne_twister_engine seeded with rd()
 	std::uniform_int_distribution<> dis(0, int(_remainPoints3D.rows() - 1));
 
-	sibr::Vector3f pointA = _remainPoints3D.row(dis(gen));
-	sibr::Vector3f pointB = _remainPoints3D.row(dis(gen));
-	sibr::Vector3f pointC = _remainPoints3D.row(dis(gen));
+	sibr::Vector3f pointA = _remainPoints3D.row(dis(_generator));
+	sibr::Vector3f pointB = _remainPoints3D.row(dis(_generator));
+	sibr::Vector3f pointC = _remainPoints3D.row(dis(_generator));
 
 	sibr::Vector3f normal = (pointB - pointA).cross(pointC - pointA);
 	normal.normalize();
@@ -272,6 +337,91 @@ std::pair<int, float> PlaneEstimator::votePlane(const sibr::Vector4f plane, cons
 
 }
 
+void PlaneEstimator::buildBuckets()
+{
+	_buckets.clear();
+	const int numPoints = int(_remainPoints3D.rows());
+	if (numPoints == 0) {
+		return;
+	}
+
+	Eigen::AlignedBox<float, 3> box;
+	for (int pId = 0; pId < numPoints; ++pId) {
+		box.extend(sibr::Vector3f(_remainPoints3D.row(pId)));
+	}
+
+	// Aim for a few dozen points per bucket.
+	const int res = std::max(1, std::min(32, int(std::cbrt(numPoints / 64.0))));
+	const sibr::Vector3f cellSize = (box.sizes() / float(res)).cwiseMax(1e-8f);
+
+	std::vector<int> cellIds(numPoints);
+	std::vector<int> counts(res * res * res + 1, 0);
+	for (int pId = 0; pId < numPoints; ++pId) {
+		const sibr::Vector3f uvw = (sibr::Vector3f(_remainPoints3D.row(pId)) - box.min()).cwiseQuotient(cellSize);
+		const sibr::Vector3i cell = uvw.cast<int>().cwiseMax(0).cwiseMin(res - 1);
+		cellIds[pId] = cell[0] + res * (cell[1] + res * cell[2]);
+		++counts[cellIds[pId] + 1];
+	}
+	for (size_t cId = 1; cId < counts.size(); ++cId) {
+		counts[cId] += counts[cId - 1];
+	}
+
+	// Counting sort of the points so that each bucket is contiguous.
+	Eigen::MatrixXf sortedPoints(numPoints, 3);
+	Eigen::MatrixXf sortedNormals(numPoints, 3);
+	std::vector<int> offsets(counts.begin(), counts.end() - 1);
+	for (int pId = 0; pId < numPoints; ++pId) {
+		const int dst = offsets[cellIds[pId]]++;
+		sortedPoints.row(dst) = _remainPoints3D.row(pId);
+		sortedNormals.row(dst) = _remainNormals3D.row(pId);
+	}
+	_remainPoints3D = std::move(sortedPoints);
+	_remainNormals3D = std::move(sortedNormals);
+
+	for (int cId = 0; cId < res * res * res; ++cId) {
+		if (counts[cId] == counts[cId + 1]) {
+			continue;
+		}
+		Eigen::AlignedBox<float, 3> bucketBox;
+		for (int pId = counts[cId]; pId < counts[cId + 1]; ++pId) {
+			bucketBox.extend(sibr::Vector3f(_remainPoints3D.row(pId)));
+		}
+		_buckets.push_back({ counts[cId], counts[cId + 1], bucketBox.center(), 0.5f * bucketBox.sizes() });
+	}
+}
+
+std::pair<int, float> PlaneEstimator::scorePlane(const sibr::Vector4f & plane, const float delta, const float normalDot, Eigen::MatrixXi * mask) const
+{
+	const sibr::Vector3f normal = plane.xyz();
+	const float d = plane.w();
+
+	if (mask) {
+		*mask = Eigen::MatrixXi::Zero(_remainPoints3D.rows(), 1);
+	}
+
+	int vote = 0;
+	float voteW = 0.0f;
+	for (const Bucket & bucket : _buckets) {
+		// No point of the bucket can be closer to the plane than its bounding box.
+		const float radius = normal.cwiseAbs().dot(bucket.halfSize);
+		if (std::abs(normal.dot(bucket.center) - d) - radius >= delta) {
+			continue;
+		}
+		for (int pId = bucket.start; pId < bucket.end; ++pId) {
+			const float distance = std::abs(_remainPoints3D.row(pId).dot(normal) - d);
+			const float dot = std::abs(_remainNormals3D.row(pId).dot(normal));
+			if (distance < delta && (dot > normalDot || dot == 0)) {
+				++vote;
+				voteW += 1.0f / (distance + 0.1f * delta);
+				if (mask) {
+					(*mask)(pId, 0) = 1;
+				}
+			}
+		}
+	}
+	return std::make_pair(vote, voteW);
+}
+
 sibr::Vector4f PlaneEstimator::estimateGroundPlane(sibr::Vector3f roughUp)
 {
 	if (_planeComputed) {
@@ -21,6 +21,8 @@
 #include <core/graphics/Mesh.hpp>
 #include <core/graphics/Window.hpp>
 
+#include <random>
+
 
 /**
 	Fit a plane to a point cloud using an improved RANSAC approach.
@@ -36,19 +38,24 @@ public:
 	/** Constructor.
 	\param vertices the point cloud
 	\param excludeBB if true, reject points that are close to the vertices bounding box
+	\param seed seed for all random choices (subsampling and RANSAC hypotheses), use a negative value for a non-deterministic seed
 	*/
-	PlaneEstimator(const std::vector<sibr::Vector3f> & vertices, bool excludeBB=false);
+	PlaneEstimator(const std::vector<sibr::Vector3f> & vertices, bool excludeBB=false, int seed=-1);
 
 	/** Compute one or more planes fitting the data using RANSAC. Points that are well fitted by a plan will bre moved from the set.
 	\param numPlane number of planes to fit
 	\param delta fit validity threshold
-	\param numTry number of attempts to perform for each plane
+	\param numTry maximum number of attempts to perform for each plane
 	*/
 	void computePlanes(const int numPlane,const float delta,const int numTry);
 	
 	/** Estimate the best plane in the remaining points set using RANSAC.
+	Hypotheses are generated sequentially and evaluated in parallel blocks; a hypothesis is first scored on a small subset
+	of points and only fully evaluated if it can compete with the current best. The search stops as soon as the number of
+	attempts ensures with high confidence that the best plane has been found, given the current best inlier ratio.
+	Results only depend on the seed, not on the number of threads.
 	\param delta fit validity threshold
-	\param numTry number of attempts to perform for each plane
+	\param numTry maximum number of attempts to perform for each plane
 	\param bestMask for each point, will be set to 1 if the plane explains the point well
 	\param vote will contain the number of points that fit
 	\param bestCovMean unused
@@ -110,9 +117,31 @@ public:
 
 protected:
 
+	/** Group of spatially close remaining points, stored contiguously. */
+	struct Bucket {
+		int start; ///< First point row.
+		int end; ///< One past the last point row.
+		sibr::Vector3f center; ///< Center of the points bounding box.
+		sibr::Vector3f halfSize; ///< Half extent of the points bounding box.
+	};
+
+	/** Sort the remaining points in a regular grid of buckets, so that buckets far from a plane can be skipped when voting. */
+	void buildBuckets();
+
+	/** Bucketed equivalent of votePlane, relying on the buckets being up to date.
+	\param plane the plane parameters
+	\param delta validity threshold
+	\param normalDot normal validity threshold
+	\param mask if non null, for each point, will be set to 1 if the plane explains the point well
+	\return number of points that fit and overall weighted score
+	*/
+	std::pair<int, float> scorePlane(const sibr::Vector4f & plane, const float delta, const float normalDot, Eigen::MatrixXi * mask) const;
+
 	Eigen::MatrixXf _remainPoints3D; ///< Points to consider.
 	Eigen::MatrixXf _remainNormals3D; ///< Associated normals to consider.
 	std::vector<sibr::Vector3u> _Triangles; ///< Triangle list.
 	bool _planeComputed; ///< Has the plane been computed.
+	std::mt19937 _generator; ///< Random generator for subsampling and hypotheses.
+	std::vector<Bucket> _buckets; ///< Spatial buckets of the remaining points.
 };
 
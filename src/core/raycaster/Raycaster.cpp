@@ -12,6 +12,7 @@
 
 
 #include "Raycaster.hpp"
+#include "core/system/MemoryTracker.hpp"
 
 namespace sibr
 {
@@ -38,8 +39,78 @@ namespace sibr
 			<< "[" << err << "]'" << msg << "'" << std::endl;
 	}
 
+	/*static*/ bool Raycaster::rtcMemoryMonitor(void* userPtr, ssize_t bytes, bool post)
+	{
+		// Cancelled allocations are reported again as releases, so the sum stays exact.
+		MemoryTracker::instance().add(MemoryTracker::Category::Raycaster, int64(bytes));
+		return true;
+	}
+
+	namespace
+	{
+		struct Vertex { float x, y, z, a; };
+		struct Triangle { int v0, v1, v2; };
+
+		/// Rough size of the embree data of a mesh: its buffers, and about 64 bytes per triangle for the BVH.
+		size_t estimateGeometryBytes(const sibr::Mesh& mesh)
+		{
+			return mesh.vertices().size() * sizeof(Vertex) + mesh.triangles().size() * (sizeof(Triangle) + 64);
+		}
+
+		/// Check that a mesh fits in the remaining raycaster budget, warn if it doesn't.
+		bool fitsBudget(const sibr::Mesh& mesh)
+		{
+			const size_t bytes = estimateGeometryBytes(mesh);
+			const size_t available = MemoryTracker::instance().available(MemoryTracker::Category::Raycaster);
+			if (bytes <= available) {
+				return true;
+			}
+			SIBR_WRG << "Mesh not added to the raycaster, its " << bytes / (1024 * 1024) << "MB would exceed the raycaster memory budget ("
+				<< available / (1024 * 1024) << "MB left)." << std::endl;
+			return false;
+		}
+
+		/// Create and fill an embree triangle geometry from a mesh. The geometry is committed but not attached.
+		RTCGeometry createTriangleGeometry(RTCDevice device, const sibr::Mesh& mesh, RTCBuildQuality type)
+		{
+			const sibr::Mesh::Vertices& vertices = mesh.vertices();
+			const sibr::Mesh::Triangles& triangles = mesh.triangles();
+
+			RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_TRIANGLE);
+			rtcSetGeometryBuildQuality(geom, type);
+			rtcSetGeometryTimeStepCount(geom, 1);
+
+			{ // Fill vertices of the geometry
+				Vertex* vert = (Vertex*)rtcSetNewGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, 4 * sizeof(float), vertices.size());
+#pragma omp parallel for
+				for (int i = 0; i < (int)vertices.size(); ++i)
+				{
+					vert[i].x = vertices[i][0];
+					vert[i].y = vertices[i][1];
+					vert[i].z = vertices[i][2];
+					vert[i].a = 1.f;
+				}
+			}
+
+			{ // Fill triangle indices of the geometry
+				Triangle* tri = (Triangle*)rtcSetNewGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3, 3 * sizeof(int), triangles.size());
+#pragma omp parallel for
+				for (int i = 0; i < (int)triangles.size(); ++i)
+				{
+					tri[i].v0 = triangles[i][0];
+					tri[i].v1 = triangles[i][1];
+					tri[i].v2 = triangles[i][2];
+				}
+			}
+
+			rtcCommitGeometry(geom);
+			return geom;
+		}
+	}
+
 	Raycaster::~Raycaster(void)
 	{
+		releaseInstanceSources();
 		_scene = nullptr;
 		_devicePtr = nullptr;
 		if (g_device && g_device.use_count() == 1)
@@ -64,6 +135,7 @@ namespace sibr
 			}
 
 			rtcSetDeviceErrorFunction(*g_device.get(), &Raycaster::rtcErrorCallback, nullptr); // Set callback error function
+			rtcSetDeviceMemoryMonitorFunction(*g_device.get(), &Raycaster::rtcMemoryMonitor, nullptr);
 			_devicePtr = g_device; //Moved in the init
 		}
 
@@ -80,6 +152,7 @@ namespace sibr
 		if (_scene == nullptr)
 			SIBR_LOG << "Cannot create an embree scene" << std::endl;
 		else {
+			rtcSetSceneFlags(*_scene.get(), sceneType);
 			//SIBR_LOG << "Embree device and scene created" << std::endl;
 			SIBR_LOG << "Warning Backface culling state : "<< rtcGetDeviceProperty(*g_device, RTC_DEVICE_PROPERTY_BACKFACE_CULLING_ENABLED) << std::endl;
 			return true; // Success
@@ -97,65 +170,107 @@ namespace sibr
 		return addGenericMesh(mesh, RTC_BUILD_QUALITY_LOW);
 	}
 
+	Raycaster::geomId	Raycaster::addDeformableMesh(const sibr::Mesh& mesh)
+	{
+		return addGenericMesh(mesh, RTC_BUILD_QUALITY_REFIT);
+	}
+
 	Raycaster::geomId	Raycaster::addGenericMesh(const sibr::Mesh& mesh, RTCBuildQuality type)
 	{
-		if (init() == false)
+		if (init() == false || !fitsBudget(mesh))
 			return Raycaster::InvalidGeomId;
 
-		const sibr::Mesh::Vertices& vertices = mesh.vertices();
-		const sibr::Mesh::Triangles& triangles = mesh.triangles();
-
-		RTCGeometry geom_0 = rtcNewGeometry(*g_device.get(), RTC_GEOMETRY_TYPE_TRIANGLE); // EMBREE_FIXME: check if geometry gets properly committed
-		rtcSetGeometryBuildQuality(geom_0, type);
-		rtcSetGeometryTimeStepCount(geom_0, 1);
+		RTCGeometry geom_0 = createTriangleGeometry(*g_device.get(), mesh, type);
 		geomId id = rtcAttachGeometry(*_scene.get(), geom_0);
-		//rtcReleaseGeometry(geom_0);
+		// The scene holds its own reference.
+		rtcReleaseGeometry(geom_0);
 
 		if (id == Raycaster::InvalidGeomId) {
-			rtcCommitGeometry(geom_0);
 			return Raycaster::InvalidGeomId;
 		}
+		_vertexCounts[id] = mesh.vertices().size();
 
-		struct Vertex { float x, y, z, a; };
-		struct Triangle { int v0, v1, v2; };
+		// Commit all changes on the scene
+		commitScene();
 
-		{ // Fill vertices of the geometry
-			Vertex* vert = (Vertex*)rtcSetNewGeometryBuffer(geom_0, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, 4 * sizeof(float), vertices.size());
-			for (uint i = 0; i < mesh.vertices().size(); ++i)
-			{
-				vert[i].x = vertices[i][0];
-				vert[i].y = vertices[i][1];
-				vert[i].z = vertices[i][2];
-				vert[i].a = 1.f;
-			}
+		return id;
+	}
 
+	bool	Raycaster::updateDeformableMesh(geomId id, const sibr::Mesh::Vertices& vertices)
+	{
+		// The vertex buffer was allocated for the initial mesh, it can't be resized.
+		const auto count = _vertexCounts.find(id);
+		if (count == _vertexCounts.end() || count->second != vertices.size()) {
+			SIBR_WRG << "Raycaster mesh " << id << " not updated, " << vertices.size() << " vertices given for "
+				<< (count == _vertexCounts.end() ? size_t(0) : count->second) << " expected." << std::endl;
+			return false;
+		}
+		RTCGeometry geom = rtcGetGeometry(*_scene.get(), id);
+		Vertex* vert = (Vertex*)rtcGetGeometryBufferData(geom, RTC_BUFFER_TYPE_VERTEX, 0);
+#pragma omp parallel for
+		for (int i = 0; i < (int)vertices.size(); ++i)
+		{
+			vert[i].x = vertices[i][0];
+			vert[i].y = vertices[i][1];
+			vert[i].z = vertices[i][2];
 		}
+		rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0);
+		rtcCommitGeometry(geom);
+		commitScene();
+		return true;
+	}
 
-		{ // Fill triangle indices of the geometry
-			Triangle* tri = (Triangle*)rtcSetNewGeometryBuffer(geom_0, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3, 3 * sizeof(int), triangles.size());
-			for (uint i = 0; i < triangles.size(); ++i)
-			{
-				tri[i].v0 = triangles[i][0];
-				tri[i].v1 = triangles[i][1];
-				tri[i].v2 = triangles[i][2];
-			}
+	Raycaster::geomId	Raycaster::addInstanceSource(const sibr::Mesh& mesh)
+	{
+		if (init() == false || !fitsBudget(mesh))
+			return Raycaster::InvalidGeomId;
 
-		}
+		RTCScene source = rtcNewScene(*g_device.get());
+		RTCGeometry geom = createTriangleGeometry(*g_device.get(), mesh, RTC_BUILD_QUALITY_HIGH);
+		rtcAttachGeometry(source, geom);
+		rtcReleaseGeometry(geom);
+		// Source BVHs are built once and for all.
+		rtcCommitScene(source);
 
-		rtcCommitGeometry(geom_0);
+		_instanceSources.push_back(source);
+		return geomId(_instanceSources.size() - 1);
+	}
 
-		// Commit all changes on the scene
-		rtcCommitScene(*_scene.get());
+	Raycaster::geomId	Raycaster::addInstance(geomId sourceId, const sibr::Matrix4f& transform)
+	{
+		if (init() == false || sourceId >= _instanceSources.size())
+			return Raycaster::InvalidGeomId;
+
+		RTCGeometry inst = rtcNewGeometry(*g_device.get(), RTC_GEOMETRY_TYPE_INSTANCE);
+		rtcSetGeometryInstancedScene(inst, _instanceSources[sourceId]);
+		rtcSetGeometryTimeStepCount(inst, 1);
+		rtcSetGeometryTransform(inst, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, transform.data());
+		rtcCommitGeometry(inst);
+
+		geomId id = rtcAttachGeometry(*_scene.get(), inst);
+		rtcReleaseGeometry(inst);
 
+		if (id == Raycaster::InvalidGeomId) {
+			return Raycaster::InvalidGeomId;
+		}
+		commitScene();
 		return id;
 	}
 
+	void	Raycaster::setInstanceTransform(geomId id, const sibr::Matrix4f& transform)
+	{
+		RTCGeometry inst = rtcGetGeometry(*_scene.get(), id);
+		rtcSetGeometryTransform(inst, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, transform.data());
+		rtcCommitGeometry(inst);
+		commitScene();
+	}
+
 	// xform a mesh by transformation matrix "mat". Note that the original positions
 	// are always stored in mesh.vertices -- we only xform the vertices in the embree buffer
 	void	Raycaster::xformRtcMeshOnly(sibr::Mesh& mesh, geomId mesh_id, sibr::Matrix4f& mat, sibr::Vector3f& centerPt, float& maxlen)
 	{
-		struct Vertex { float x, y, z, a; };
-		Vertex* vert = (Vertex*)rtcGetGeometryBufferData(rtcGetGeometry(*_scene.get(), mesh_id), RTC_BUFFER_TYPE_VERTEX, 0) /* EMBREE_FIXME: check if this should be rtcSetNewGeometryBuffer */;
+		RTCGeometry geom = rtcGetGeometry(*_scene.get(), mesh_id);
+		Vertex* vert = (Vertex*)rtcGetGeometryBufferData(geom, RTC_BUFFER_TYPE_VERTEX, 0);
 		sibr::Vector4f averagePt = sibr::Vector4f(0, 0, 0, 1);
 		maxlen = 0;
 
@@ -183,9 +298,57 @@ namespace sibr
 		centerPt = sibr::Vector3f(cp[0], cp[1], cp[2]);
 
 		// Update mesh
-		rtcCommitGeometry(rtcGetGeometry(*_scene.get(), mesh_id));
+		rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0);
+		rtcCommitGeometry(geom);
 		// Commit changes to scene
+		commitScene();
+	}
+
+	void	Raycaster::beginUpdate()
+	{
+		++_updateDepth;
+	}
+
+	void	Raycaster::endUpdate()
+	{
+		if (_updateDepth == 0) {
+			SIBR_WRG << "Raycaster::endUpdate called without a matching beginUpdate." << std::endl;
+			return;
+		}
+		--_updateDepth;
+		if (_updateDepth == 0 && _sceneDirty) {
+			commitScene();
+		}
+	}
+
+	void	Raycaster::commitScene()
+	{
+		if (_updateDepth > 0) {
+			_sceneDirty = true;
+			return;
+		}
 		rtcCommitScene(*_scene.get());
+		_sceneDirty = false;
+	}
+
+	void	Raycaster::disableGeom(geomId id)
+	{
+		rtcDisableGeometry(rtcGetGeometry(*_scene.get(), id));
+		commitScene();
+	}
+
+	void	Raycaster::enableGeom(geomId id)
+	{
+		rtcEnableGeometry(rtcGetGeometry(*_scene.get(), id));
+		commitScene();
+	}
+
+	void	Raycaster::deleteGeom(geomId id)
+	{
+		// The scene owns the geometry, detaching it releases it.
+		rtcDetachGeometry(*_scene.get(), id);
+		_vertexCounts.erase(id);
+		commitScene();
 	}
 
 	bool	Raycaster::hitSomething(const Ray& inray, float minDist)
@@ -345,6 +508,18 @@ namespace sibr
 	void Raycaster::clearGeometry()
 	{
 		_scene.reset();
+		_vertexCounts.clear();
+		releaseInstanceSources();
+		_updateDepth = 0;
+		_sceneDirty = false;
+	}
+
+	void Raycaster::releaseInstanceSources()
+	{
+		for (RTCScene & source : _instanceSources) {
+			rtcReleaseScene(source);
+		}
+		_instanceSources.clear();
 	}
 
 	sibr::Vector3f Raycaster::smoothNormal(const sibr::Mesh& mesh, const RayHit& hit)
@@ -19,6 +19,8 @@
 #  include <pmmintrin.h>	// functions for setting the control register
 # pragma warning(pop)
 
+# include <map>
+
 # include <core/graphics/Mesh.hpp>
 # include <core/system/Matrix.hpp>
 # include "core/raycaster/Config.hpp"
@@ -79,8 +81,41 @@ namespace sibr
 		/// \return the mesh ID or Raycaster::InvalidGeomId if it fails.
 		geomId	addGenericMesh( const sibr::Mesh& mesh, RTCBuildQuality type );
 
+		/// Add a triangle mesh to the raycast scene, that will be deformed over time while keeping its topology.
+		/// Its BVH is only refitted (not rebuilt) on each call to updateDeformableMesh.
+		/// \param mesh the mesh to add
+		/// \return the mesh ID or Raycaster::InvalidGeomId if it fails.
+		geomId	addDeformableMesh( const sibr::Mesh& mesh );
+
+		/// Update the vertex positions of a mesh previously added to the scene.
+		/// The topology must be unchanged. Meshes added with addDeformableMesh are refitted, others are rebuilt.
+		/// \param id the raycaster mesh id
+		/// \param vertices the new vertex positions (same count as when the mesh was added)
+		/// \return false if the vertex count doesn't match the mesh (nothing is updated then)
+		bool	updateDeformableMesh( geomId id, const sibr::Mesh::Vertices& vertices );
+
+		/// Register a mesh as an instance source: its BVH is built once in a separate scene,
+		/// and it can then be placed any number of times in the raycast scene using addInstance.
+		/// \param mesh the mesh to register
+		/// \return the source ID or Raycaster::InvalidGeomId if it fails.
+		geomId	addInstanceSource( const sibr::Mesh& mesh );
+
+		/// Place an instance of a registered source in the raycast scene.
+		/// For hits on an instance, RayHit::Primitive::instID contains the id returned here, and
+		/// RayHit::Primitive::geomID the id of the mesh in the source (always 0). The hit normal is expressed in object space.
+		/// \param sourceId the id returned by addInstanceSource
+		/// \param transform the object-to-world transformation of the instance
+		/// \return the instance ID or Raycaster::InvalidGeomId if it fails.
+		geomId	addInstance( geomId sourceId, const sibr::Matrix4f& transform );
+
+		/// Update the transformation of an instance. Only the top-level structure has to be updated, mesh BVHs are kept as-is.
+		/// \param id the instance id
+		/// \param transform the new object-to-world transformation
+		void	setInstanceTransform( geomId id, const sibr::Matrix4f& transform );
+
 		/// Transform the vertices of a mesh by applying a sibr::Matrix4f mat.
 		/// \note The original positions are always stored *unchanged* in mesh.vertices -- we only xform the vertices in the embree buffer
+		/// \note Prefer addInstance/setInstanceTransform for rigid motions, this will update the whole mesh BVH.
 		/// \param mesh the mesh to transform
 		/// \param mesh_id the corresponding raycaster mesh id
 		/// \param mat the transformation to apply
@@ -89,6 +124,14 @@ namespace sibr
 		/// \bug maxlen is computed incrementally and may be incorrect
 		void xformRtcMeshOnly(sibr::Mesh& mesh, geomId mesh_id, sibr::Matrix4f& mat, sibr::Vector3f& centerPt, float& maxlen);
 
+		/// Start a batch of modifications: the scene will not be committed until the matching call to endUpdate.
+		/// Batches can be nested, only the outermost endUpdate commits.
+		/// \warning No ray should be cast while a batch is open.
+		void	beginUpdate();
+
+		/// Close a batch of modifications and commit the scene once if anything changed.
+		void	endUpdate();
+
 		/// Launch a ray into the raycaster scene. Return information about
 		/// this cast in RayHit. To simply know if something has been hit, use RayHit::hitSomething().
 		/// \sa hitSomething
@@ -119,17 +162,15 @@ namespace sibr
 
 		/// Disable geometry to avoid raycasting against it (eg background when only intersecting a foreground object).
 		/// \param id the mesh to disable
-		/// \todo Untested.
-		void	disableGeom(geomId id) { rtcDisableGeometry(rtcGetGeometry((*_scene.get()),id)); rtcCommitGeometry(rtcGetGeometry(*_scene.get(),id)); rtcCommitScene(*_scene.get()); }
+		void	disableGeom(geomId id);
 
 		/// Enable geometry to start raycasting it again.
 		/// \param id the geometry to enable 
-		/// \todo Untested.
-		void	enableGeom(geomId id) { rtcEnableGeometry(rtcGetGeometry((*_scene.get()),id)); rtcCommitGeometry(rtcGetGeometry(*_scene.get(),id)); rtcCommitScene(*_scene.get());}
+		void	enableGeom(geomId id);
 
 		/// Delete geometry
 		/// \param id the geometry to delete
-		void	deleteGeom(geomId id) { rtcReleaseGeometry(rtcGetGeometry((*_scene.get()),id)); rtcCommitGeometry(rtcGetGeometry(*_scene.get(),id)); rtcCommitScene(*_scene.get());} 
+		void	deleteGeom(geomId id);
 
 		/// Clears internal scene..
 		void clearGeometry();
@@ -163,6 +204,14 @@ namespace sibr
 		/// \param msg additional info message.
 		static void rtcErrorCallback(void* userPtr, RTCError code, const char* msg);
 
+		/// Will be called by embree for each allocation, to account for it in the MemoryTracker.
+		/// Allocations are never refused, budgets are checked before adding meshes.
+		/// \param userPtr the user data pointer
+		/// \param bytes size of the allocation, negative for a release
+		/// \param post true if called after the allocation
+		/// \return true to let the allocation happen
+		static bool rtcMemoryMonitor(void* userPtr, ssize_t bytes, bool post);
+
 		
 		static bool g_initRegisterFlag; ///< Used to initialize flag of registers used by SSE
 		static RTCDevicePtr	g_device;	///< embree device (context for a raycaster)
@@ -170,8 +219,18 @@ namespace sibr
 		/// \return the internal scene pointer
 		RTCScenePtr	scene() 	{ return _scene; }
 
+		/// Commit the scene, or postpone it if a batch of modifications is open.
+		void	commitScene();
+
+		/// Release all instance source scenes.
+		void	releaseInstanceSources();
+
 		RTCScenePtr		_scene;		///< scene storing raycastable meshes
 		RTCDevicePtr	_devicePtr;	///< embree device (context for a raycaster)
+		std::vector<RTCScene>	_instanceSources;	///< scenes containing instanced meshes
+		std::map<geomId, size_t>	_vertexCounts;	///< vertex count of each mesh, to validate updates
+		int				_updateDepth = 0;	///< number of currently open modification batches
+		bool			_sceneDirty = false;	///< has the scene been modified during the current batch
 	};
 
 	///// DEFINITION /////
@@ -100,7 +100,7 @@ namespace sibr {
 
 	size_t VoxelGridBase::getNumCells() const
 	{
-		return (size_t)dims.prod();
+		return size_t(dims[0]) * size_t(dims[1]) * size_t(dims[2]);
 	}
 
 	const sibr::Vector3i & VoxelGridBase::getDims() const
@@ -114,15 +114,12 @@ namespace sibr {
 			SIBR_ERR;
 		}
 
-		sibr::Vector3i cell;
-	
-		std::div_t div;
-		for (int i = 0; i < 2; ++i) {
-			div = std::div((int)cellId, dims[i]);
-			cell[i] = div.rem;
-			cellId = div.quot;
-		}
-		cell[2] = (int)cellId;
+		const size_t sliceSize = size_t(dims[0]) * size_t(dims[1]);
+		const size_t z = cellId / sliceSize;
+		const size_t inSlice = cellId - z * sliceSize;
+		const size_t y = inSlice / size_t(dims[0]);
+
+		sibr::Vector3i cell(int(inSlice - y * size_t(dims[0])), int(y), int(z));
 
 		if (outOfBounds(cell)) {
 			SIBR_ERR << cell << " " << dims;
@@ -169,7 +166,7 @@ namespace sibr {
 		return cellCoord;
 	}
 
-	std::vector<size_t> VoxelGridBase::rayMarch(const Ray & ray) const
+	bool VoxelGridBase::initRayMarch(const Ray & ray, RayMarchState & state) const
 	{
 		sibr::Vector3f start = ray.orig();
 
@@ -178,40 +175,50 @@ namespace sibr {
 			if (intersectionWithBox(ray, intersection)) {
 				start = intersection;
 			} else {
-				return {};
+				return false;
 			}
 		}
 		
 		start = start.cwiseMax(box.min()).cwiseMin(box.max() - 0.01f*getCellSize());
 
-		sibr::Vector3i currentVoxel = getCell(start);
-	
-		sibr::Vector3i steps = ray.dir().unaryExpr([](float f) { return f >= 0 ? 1 : -1; }).cast<int>();
+		state.voxel = getCell(start);
+		state.steps = ray.dir().unaryExpr([](float f) { return f >= 0 ? 1 : -1; }).cast<int>();
+		state.deltas = getCellSize().cwiseQuotient(ray.dir().cwiseAbs());
 
-		const sibr::Vector3f deltas = getCellSize().cwiseQuotient(ray.dir().cwiseAbs());
 		const sibr::Vector3f frac = (start - box.min()).cwiseQuotient(getCellSize()).unaryExpr([](float f) { return f - std::floor(f); });
-		sibr::Vector3i finalVoxels; 
-		sibr::Vector3f ts;
+		const long long sizes[3] = { 1, (long long)dims[0], (long long)dims[0] * (long long)dims[1] };
 		for (int c = 0; c < 3; c++) {
-			ts[c] = deltas[c] * (ray.dir()[c] >= 0 ? 1.0f - frac[c] : frac[c]);
-			finalVoxels[c] = (ray.dir()[c] >= 0 ? dims[c] : -1);
+			state.ts[c] = state.deltas[c] * (ray.dir()[c] >= 0 ? 1.0f - frac[c] : frac[c]);
+			state.finalVoxels[c] = (ray.dir()[c] >= 0 ? dims[c] : -1);
+			state.strides[c] = state.steps[c] * sizes[c];
 		}
+		state.cellId = (long long)getCellId(state.voxel);
+		return true;
+	}
 
+	std::vector<size_t> VoxelGridBase::rayMarch(const Ray & ray) const
+	{
 		std::vector<size_t> visitedCellsIds;
-		while (true) {
-			visitedCellsIds.push_back(getCellId(currentVoxel));
-		
-			int c = getMinIndex(ts);
-			currentVoxel[c] += steps[c];
-			if (currentVoxel[c] == finalVoxels[c]) {
-				break;
-			}
-			ts[c] += deltas[c];
-		}
-
+		rayMarch(ray, [&visitedCellsIds](size_t cellId) {
+			visitedCellsIds.push_back(cellId);
+			return true;
+		});
 		return visitedCellsIds;
 	}
 
+	size_t VoxelGridBase::rayMarch(const Ray & ray, size_t * cellIds, size_t maxCells) const
+	{
+		if (maxCells == 0) {
+			return 0;
+		}
+		size_t count = 0;
+		rayMarch(ray, [cellIds, maxCells, &count](size_t cellId) {
+			cellIds[count++] = cellId;
+			return count < maxCells;
+		});
+		return count;
+	}
+
 	sibr::Mesh::Ptr VoxelGridBase::getCellMesh(const sibr::Vector3i & cell) const
 	{
 		return getCellMeshInternal(cell, false);
@@ -232,6 +239,39 @@ namespace sibr {
 		return getAllCellMeshInternal(true);
 	}
 
+	sibr::Mesh::Ptr VoxelGridBase::getAllCellMeshWithIds(bool filled, const std::vector<std::size_t> & cell_ids) const
+	{
+		int numNonZero = (int)cell_ids.size();
+
+		auto out = std::make_shared<sibr::Mesh>();
+
+		sibr::Mesh::Ptr baseMesh = filled ? baseCellMeshFilled : baseCellMesh;
+
+		const int numT = (int)baseMesh->triangles().size();
+		const int numTtotal = numNonZero * numT;
+		const int numV = (int)baseMesh->vertices().size();
+		const int numVtotal = numNonZero * numV;
+		const sibr::Vector3u offsetT = sibr::Vector3u(numV, numV, numV);
+
+		sibr::Mesh::Vertices vs(numVtotal);
+		sibr::Mesh::Triangles ts(numTtotal);
+		for (int i = 0; i < numNonZero; ++i) {
+			const auto cell = getCell(cell_ids[i]);
+			const sibr::Vector3f offsetV = cell.cast<float>().array() * getCellSize().array();
+
+			for (int v = 0; v < numV; ++v) {
+				vs[i * numV + v] = baseMesh->vertices()[v] + offsetV;
+			}
+			for (int t = 0; t < numT; ++t) {
+				ts[i * numT + t] = baseMesh->triangles()[t] + i * offsetT;
+			}
+		}
+
+		out->vertices(vs);
+		out->triangles(ts);
+		return out;
+	}
+
 	Eigen::AlignedBox3f VoxelGridBase::getCellBox(size_t cellId) const
 	{
 		sibr::Vector3i cell = getCell(cellId);
@@ -368,7 +408,7 @@ namespace sibr {
 		if (outOfBounds(v)) {
 			SIBR_ERR << v << " " << dims;
 		}
-		return v[0] + dims[0] * (v[1] + dims[1] * v[2]); //v[2] + dims[2] * (v[1] + dims[1] * v[0]);
+		return size_t(v[0]) + size_t(dims[0]) * (size_t(v[1]) + size_t(dims[1]) * size_t(v[2])); //v[2] + dims[2] * (v[1] + dims[1] * v[0]);
 	}
 
 	size_t VoxelGridBase::getCellId(const sibr::Vector3f & world_pos) const
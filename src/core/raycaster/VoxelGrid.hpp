@@ -14,6 +14,8 @@
 
 
 # include <vector>
+# include <unordered_map>
+# include <algorithm>
 #include <random>
 
 # include <core/raycaster/Config.hpp>
@@ -122,6 +124,31 @@ namespace sibr
 		*/
 		std::vector<size_t> rayMarch(const Ray & ray) const;
 
+		/** Intersect a ray with the voxel grid, writing intersected voxels in a caller-provided buffer.
+		Traversal stops when the buffer is full.
+		\param ray the ray to cast
+		\param cellIds the output buffer, will contain the linear IDs of the intersected voxels, in order
+		\param maxCells the buffer capacity
+		\return the number of voxels written
+		*/
+		size_t rayMarch(const Ray & ray, size_t * cellIds, size_t maxCells) const;
+
+		/** Intersect a ray with the voxel grid, calling a visitor on each intersected voxel, in order. No allocation is performed.
+		\param ray the ray to cast
+		\param visitor will receive the linear ID of each voxel, should return false to stop the traversal
+		\return the number of visited voxels
+		*/
+		template<typename FuncType>
+		size_t rayMarch(const Ray & ray, const FuncType & visitor) const;
+
+		/** Intersect a set of rays with the voxel grid, in parallel.
+		\param rays the rays to cast
+		\param visitor will receive the ray index and the linear ID of each voxel intersected by this ray, should return false to stop this ray traversal
+		\warning The visitor is called concurrently from multiple threads, but calls for a given ray are sequential and in order.
+		*/
+		template<typename FuncType>
+		void rayMarchBatch(const std::vector<Ray> & rays, const FuncType & visitor) const;
+
 		/** Generate a wireframe mesh representing a voxel.
 		\param cell the voxel integer coordinates
 		\return the generated wireframe cube mesh
@@ -144,6 +171,13 @@ namespace sibr
 		*/
 		sibr::Mesh::Ptr getAllCellMeshFilled() const;
 
+		/** Get cell meshes from their ids.
+		\param filled should the mesh be wireframe (false) or faceted (true)
+		\param cell_ids ids of cell meshes.
+		\return the generated mesh
+		*/
+		sibr::Mesh::Ptr getAllCellMeshWithIds(bool filled, const std::vector<std::size_t> & cell_ids) const;
+
 		/** Get a voxel bounding box.
 		\param cellId the voxel linear index
 		\return the bounding box.
@@ -208,6 +242,24 @@ namespace sibr
 
 	protected:
 
+		/** Digital differential analyzer state for ray marching. */
+		struct RayMarchState {
+			sibr::Vector3i voxel; ///< Current voxel.
+			sibr::Vector3i steps; ///< Step direction along each axis.
+			sibr::Vector3i finalVoxels; ///< Out of grid coordinate reached along each axis.
+			sibr::Vector3f ts; ///< Ray parameter of the next boundary along each axis.
+			sibr::Vector3f deltas; ///< Ray parameter increment to cross a voxel along each axis.
+			long long cellId; ///< Current voxel linear ID.
+			long long strides[3]; ///< Linear ID increment for a step along each axis.
+		};
+
+		/** Setup the traversal of the grid by a ray.
+		\param ray the ray to cast
+		\param state will contain the traversal state, positioned on the first voxel
+		\return false if the ray misses the grid
+		*/
+		bool initRayMarch(const Ray & ray, RayMarchState & state) const;
+
 		/** Helper to generate a voxel mesh.
 		\param cell the coordinates of the voxel to generate
 		\param filled should the mesh be wireframe (false) or faceted (true)
@@ -322,13 +374,6 @@ namespace sibr
 		template<typename FuncType>
 		sibr::Mesh::Ptr getAllCellMeshWithCond(bool filled, const FuncType & func) const;
 
-		/** Get cell meshes from their ids.
-		\param filled should the mesh be wireframe (false) or faceted (true)
-		\param cell_ids ids of cell meshes.
-		\return the generated mesh
-		*/
-		sibr::Mesh::Ptr getAllCellMeshWithIds(bool filled, std::vector<std::size_t> cell_ids) const;
-
 		/** List the voxels that statisfy a condition (for instance fullness)
 		\param func the predicate to evaluate, will receive as unique argument a voxel (CellType).
 		\return a list of linear indices of all voxels such that func(voxel) is true.
@@ -366,40 +411,274 @@ namespace sibr
 		return getAllCellMeshWithIds(filled, cell_ids);
 	}
 
+	/** Voxel grid with sparse data storage.
+	Voxels are stored in bricks of BrickSize^3 cells, allocated on first write access.
+	Voxels in unallocated bricks have the background value.
+	\warning Non-const accessors may allocate and are thus not thread safe.
+	*/
+	template<typename CellType = BasicVoxelType> class SparseVoxelGrid : public VoxelGridBase {
+
+		SIBR_CLASS_PTR(SparseVoxelGrid);
+	public:
+		using VoxelType = CellType;
+
+		/** Number of cells along each dimension of a brick. */
+		static const int BrickSize = 8;
+
+	public:
+
+		/** Constructor.
+		\param boundingBox bounding box delimiting the voxellized region
+		\param numPerDim number of voxels along each dimension
+		\param forceCube if true, the largest dimension will be split in numPerDim voxels and the other such that the voxels are cubes in world space
+		\param background the value of voxels that have never been written
+		*/
+		SparseVoxelGrid(const Box & boundingBox, int numPerDim, bool forceCube = true, const CellType & background = CellType())
+			: SparseVoxelGrid(boundingBox, sibr::Vector3i(numPerDim, numPerDim, numPerDim), forceCube, background)
+		{
+		}
+
+		/** Constructor.
+		\param boundingBox bounding box delimiting the voxellized region
+		\param numsPerDim number of voxels along each dimension
+		\param forceCube if true, the largest dimension will be split in numPerDim voxels and the other such that the voxels are cubes in world space
+		\param background the value of voxels that have never been written
+		*/
+		SparseVoxelGrid(const Box & boundingBox, const sibr::Vector3i & numsPerDim, bool forceCube = true, const CellType & background = CellType())
+			: VoxelGridBase(boundingBox, numsPerDim, forceCube), _background(background) {
+			_brickDims = (dims.array() + BrickSize - 1) / BrickSize;
+		}
+
+		/** Get voxel at a given linear index, allocating its brick if needed.
+		\param cell_id the linear index
+		\return a reference to the voxel
+		*/
+		CellType & operator[](size_t cell_id) {
+			return at(getCell(cell_id));
+		}
+
+		/** Get voxel at a given linear index.
+		\param cell_id the linear index
+		\return a reference to the voxel, or to the background value
+		*/
+		const CellType & operator[](size_t cell_id) const {
+			return at(getCell(cell_id));
+		}
+
+		/** Get voxel at given integer 3D coordinates, allocating its brick if needed.
+		\param x x integer coordinate
+		\param y y integer coordinate
+		\param z z integer coordinate
+		\return a reference to the voxel
+		*/
+		CellType & operator()(int x, int y, int z) {
+			return at({ x,y,z });
+		}
+
+		/** Get voxel at given integer 3D coordinates.
+		\param x x integer coordinate
+		\param y y integer coordinate
+		\param z z integer coordinate
+		\return a reference to the voxel, or to the background value
+		*/
+		const CellType & operator()(int x, int y, int z) const {
+			return at({ x,y,z });
+		}
+
+		/** Get voxel at given integer 3D coordinates, allocating its brick if needed.
+		\param v integer coordinates
+		\return a reference to the voxel
+		*/
+		CellType & operator[](const sibr::Vector3i & v) {
+			return at(v);
+		}
+
+		/** Get voxel at given integer 3D coordinates.
+		\param v integer coordinates
+		\return a reference to the voxel, or to the background value
+		*/
+		const CellType & operator[](const sibr::Vector3i & v) const {
+			return at(v);
+		}
+
+		/** Check if a voxel belongs to an allocated brick.
+		\param v integer coordinates
+		\return true if the voxel storage exists
+		*/
+		bool isAllocated(const sibr::Vector3i & v) const {
+			int local;
+			return _bricks.count(brickId(v, local)) > 0;
+		}
+
+		/** Call a function on all voxels of the allocated bricks.
+		\param func will receive the linear voxel ID and the voxel (CellType)
+		*/
+		template<typename FuncType>
+		void forEachAllocated(const FuncType & func) const;
+
+		/** List the voxels that statisfy a condition (for instance fullness)
+		Only allocated voxels are tested, the predicate is assumed to be false for the background value.
+		\param func the predicate to evaluate, will receive as unique argument a voxel (CellType).
+		\return a sorted list of linear indices of all voxels such that func(voxel) is true.
+		*/
+		template<typename FuncType>
+		std::vector<std::size_t> detect_non_empty_cells(const FuncType & func) const;
+
+		/** Generate a mesh from all voxels satisfying a condition.
+		\param filled should the mesh be wireframe (false) or faceted (true)
+		\param func the predicate to evaluate, will receive as unique argument a voxel (CellType).
+		\return the generated mesh
+		*/
+		template<typename FuncType>
+		sibr::Mesh::Ptr getAllCellMeshWithCond(bool filled, const FuncType & func) const {
+			return getAllCellMeshWithIds(filled, detect_non_empty_cells(func));
+		}
+
+		/** \return the number of allocated bricks. */
+		size_t getNumAllocatedBricks() const {
+			return _bricks.size();
+		}
+
+		/** \return the approximate memory used by voxel storage, in bytes. */
+		size_t getAllocatedBytes() const {
+			return _bricks.size() * (sizeof(Brick) + BrickSize * BrickSize * BrickSize * sizeof(CellType));
+		}
+
+		/** Release all bricks, resetting all voxels to the background value. */
+		void clear() {
+			_bricks.clear();
+		}
+
+		/** \return the value of voxels that have never been written. */
+		const CellType & getBackground() const {
+			return _background;
+		}
+
+	protected:
+
+		typedef std::vector<CellType> Brick;
+
+		/** Get the brick containing a voxel.
+		\param v integer coordinates
+		\param local will contain the voxel linear index in the brick
+		\return the brick linear ID
+		*/
+		size_t brickId(const sibr::Vector3i & v, int & local) const {
+			const sibr::Vector3i b = v / BrickSize;
+			const sibr::Vector3i l = v - b * BrickSize;
+			local = l[0] + BrickSize * (l[1] + BrickSize * l[2]);
+			return size_t(b[0]) + size_t(_brickDims[0]) * (size_t(b[1]) + size_t(_brickDims[1]) * size_t(b[2]));
+		}
+
+		/** Get a voxel, allocating its brick if needed.
+		\param v integer coordinates
+		\return a reference to the voxel
+		*/
+		CellType & at(const sibr::Vector3i & v) {
+			if (outOfBounds(v)) {
+				SIBR_ERR << v << " " << dims;
+			}
+			int local;
+			Brick & brick = _bricks[brickId(v, local)];
+			if (brick.empty()) {
+				brick.resize(BrickSize * BrickSize * BrickSize, _background);
+			}
+			return brick[local];
+		}
+
+		/** Get a voxel.
+		\param v integer coordinates
+		\return a reference to the voxel, or to the background value
+		*/
+		const CellType & at(const sibr::Vector3i & v) const {
+			if (outOfBounds(v)) {
+				SIBR_ERR << v << " " << dims;
+			}
+			int local;
+			const auto brick = _bricks.find(brickId(v, local));
+			return brick == _bricks.end() ? _background : brick->second[local];
+		}
+
+		sibr::Vector3i _brickDims; ///< Number of bricks along each axis.
+		CellType _background; ///< Value of unallocated voxels.
+		std::unordered_map<size_t, Brick> _bricks; ///< Allocated bricks, indexed by brick linear ID.
+	};
+
 	/** }@ */
 
 	template<typename CellType>
-	inline sibr::Mesh::Ptr VoxelGrid<CellType>::getAllCellMeshWithIds(bool filled, std::vector<std::size_t> cell_ids) const
-	{
-		int numNonZero = (int)cell_ids.size();
+	const int SparseVoxelGrid<CellType>::BrickSize;
 
-		auto out = std::make_shared<sibr::Mesh>();
+	template<typename FuncType>
+	inline size_t VoxelGridBase::rayMarch(const Ray & ray, const FuncType & visitor) const
+	{
+		RayMarchState state;
+		if (!initRayMarch(ray, state)) {
+			return 0;
+		}
 
-		sibr::Mesh::Ptr baseMesh = filled ? baseCellMeshFilled : baseCellMesh;
+		size_t count = 0;
+		while (true) {
+			++count;
+			if (!visitor(size_t(state.cellId))) {
+				break;
+			}
 
-		const int numT = (int)baseMesh->triangles().size();
-		const int numTtotal = numNonZero * numT;
-		const int numV = (int)baseMesh->vertices().size();
-		const int numVtotal = numNonZero * numV;
-		const sibr::Vector3u offsetT = sibr::Vector3u(numV, numV, numV);
+			const int c = getMinIndex(state.ts);
+			state.voxel[c] += state.steps[c];
+			if (state.voxel[c] == state.finalVoxels[c]) {
+				break;
+			}
+			state.cellId += state.strides[c];
+			state.ts[c] += state.deltas[c];
+		}
+		return count;
+	}
 
-		sibr::Mesh::Vertices vs(numVtotal);
-		sibr::Mesh::Triangles ts(numTtotal);
-		for (int i = 0; i < numNonZero; ++i) {
-			const auto cell = getCell(cell_ids[i]);
-			const sibr::Vector3f offsetV = cell.cast<float>().array() * getCellSize().array();
+	template<typename FuncType>
+	inline void VoxelGridBase::rayMarchBatch(const std::vector<Ray> & rays, const FuncType & visitor) const
+	{
+		const int numRays = int(rays.size());
+#pragma omp parallel for schedule(dynamic, 64)
+		for (int r = 0; r < numRays; ++r) {
+			rayMarch(rays[r], [&visitor, r](size_t cellId) { return visitor(size_t(r), cellId); });
+		}
+	}
 
-			for (int v = 0; v < numV; ++v) {
-				vs[i * numV + v] = baseMesh->vertices()[v] + offsetV;
-			}
-			for (int t = 0; t < numT; ++t) {
-				ts[i * numT + t] = baseMesh->triangles()[t] + i * offsetT;
+	template<typename CellType> template<typename FuncType>
+	inline void SparseVoxelGrid<CellType>::forEachAllocated(const FuncType & func) const {
+		for (const auto & brick : _bricks) {
+			const size_t bId = brick.first;
+			const sibr::Vector3i b(
+				int(bId % size_t(_brickDims[0])),
+				int((bId / size_t(_brickDims[0])) % size_t(_brickDims[1])),
+				int(bId / (size_t(_brickDims[0]) * size_t(_brickDims[1])))
+			);
+			for (int z = 0; z < BrickSize; ++z) {
+				for (int y = 0; y < BrickSize; ++y) {
+					for (int x = 0; x < BrickSize; ++x) {
+						const sibr::Vector3i v = b * BrickSize + sibr::Vector3i(x, y, z);
+						// Bricks on the grid border can be partially outside.
+						if (outOfBounds(v)) {
+							continue;
+						}
+						func(getCellId(v), brick.second[x + BrickSize * (y + BrickSize * z)]);
+					}
+				}
 			}
 		}
+	}
 
-		out->vertices(vs);
-		out->triangles(ts);
-		return out;
+	template<typename CellType> template<typename FuncType>
+	inline std::vector<std::size_t> SparseVoxelGrid<CellType>::detect_non_empty_cells(const FuncType & func) const {
+		std::vector<std::size_t> out_ids;
+		forEachAllocated([&out_ids, &func](size_t cellId, const CellType & cell) {
+			if (func(cell)) {
+				out_ids.push_back(cellId);
+			}
+		});
+		std::sort(out_ids.begin(), out_ids.end());
+		return out_ids;
 	}
 
 } // namespace sibr
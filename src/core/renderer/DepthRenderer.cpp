@@ -26,6 +26,7 @@ namespace sibr
 			sibr::loadFile(sibr::Resources::Instance()->getResourceFilePathName("depthRenderer.fp")));
 
 		_depthShader_MVP.init(_depthShader,"MVP");
+		_depthShader_positionDecode.init(_depthShader,"position_decode");
 		_depth_RT.reset(new sibr::RenderTargetLum32F(w,h));
 
 	}
@@ -43,6 +44,7 @@ namespace sibr
 
 		_depthShader.begin();
 		_depthShader_MVP.set(cam.viewproj());
+		_depthShader_positionDecode.set(mesh.positionDecodeMatrix());
 
 		mesh.render(true, backFaceCulling, sibr::Mesh::FillRenderMode, frontFaceCulling);
 
@@ -50,4 +52,4 @@ namespace sibr
 
 	}
 
-} // namespace
\ No newline at end of file
+} // namespace
\ No newline at end of file
@@ -58,6 +58,7 @@ namespace sibr
 
 		sibr::GLShader				_depthShader; ///< Depth shader.
 		sibr::GLParameter			_depthShader_MVP; ///< Shader MVP.
+		sibr::GLuniform<Matrix4f>	_depthShader_positionDecode; ///< Compact vertex format position decoding.
 
 	};
 
@@ -25,6 +25,7 @@ namespace sibr {
 			sibr::loadFile(sibr::getShadersDirectory("core") + "/textured_mesh.vert"),
 			sibr::loadFile(sibr::getShadersDirectory("core") + "/textured_mesh.frag"));
 		_paramMVP.init(_shader,"MVP");
+		_positionDecode.init(_shader, "position_decode");
 	}
 
 	void	TexturedMeshRenderer::process(const Mesh& mesh, const Camera& eye, uint textureID, IRenderTarget& dst, bool backfaceCull)
@@ -32,6 +33,7 @@ namespace sibr {
 		dst.bind();
 		_shader.begin();
 		_paramMVP.set(eye.viewproj());
+		_positionDecode.set(mesh.positionDecodeMatrix());
 		glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, textureID);
 		mesh.render(true, backfaceCull);
 		_shader.end();
@@ -44,6 +46,7 @@ namespace sibr {
 		dst.bind();
 		_shader.begin();
 		_paramMVP.set(sibr::Matrix4f(eye.viewproj() * model));
+		_positionDecode.set(mesh.positionDecodeMatrix());
 		glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, textureID);
 		mesh.render(true, backfaceCull);
 		_shader.end();
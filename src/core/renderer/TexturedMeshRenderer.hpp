@@ -59,6 +59,7 @@ namespace sibr {
 
 		GLShader			_shader; ///< The texture mesh shader.
 		GLParameter			_paramMVP; ///< MVP uniform.
+		GLuniform<Matrix4f>	_positionDecode; ///< Compact vertex format position decoding.
 	};
 
 } /*namespace sibr*/ 
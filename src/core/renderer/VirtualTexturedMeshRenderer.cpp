@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include <core/renderer/VirtualTexturedMeshRenderer.hpp>
+
+namespace sibr { 
+
+	void VirtualTexturedMeshRenderer::Uniforms::init(GLShader & shader)
+	{
+		mvp.init(shader, "MVP");
+		positionDecode.init(shader, "position_decode");
+		textureSize.init(shader, "textureSize");
+		numLevels.init(shader, "numLevels");
+		tileSize.init(shader, "tileSize");
+		border.init(shader, "border");
+		atlasSize.init(shader, "atlasSize");
+		lodBias.init(shader, "lodBias");
+	}
+
+	void VirtualTexturedMeshRenderer::Uniforms::set(const Mesh & mesh, const Camera & eye, const VirtualTexture & texture, float bias)
+	{
+		const TiledTexture & tiles = texture.tiles();
+		mvp.set(eye.viewproj());
+		positionDecode.set(mesh.positionDecodeMatrix());
+		textureSize.set(Vector2f(float(tiles.w()), float(tiles.h())));
+		numLevels.set(tiles.levels());
+		tileSize.set(float(tiles.tileSize()));
+		border.set(float(tiles.border()));
+		atlasSize.set(texture.atlasSize().cast<float>());
+		lodBias.set(bias);
+	}
+
+	VirtualTexturedMeshRenderer::VirtualTexturedMeshRenderer(uint feedbackScale)
+		: _feedbackScale(std::max(feedbackScale, 1u))
+	{
+		GLShader::Define::List defines;
+		defines.emplace_back("FEEDBACK_PASS", 1);
+
+		_shader.init("VirtualTexturedMesh",
+			sibr::loadFile(sibr::getShadersDirectory("core") + "/textured_mesh.vert"),
+			sibr::loadFile(sibr::getShadersDirectory("core") + "/virtual_texture.frag"));
+		_feedbackShader.init("VirtualTexturedMeshFeedback",
+			sibr::loadFile(sibr::getShadersDirectory("core") + "/textured_mesh.vert"),
+			sibr::loadFile(sibr::getShadersDirectory("core") + "/virtual_texture.frag", defines));
+		_uniforms.init(_shader);
+		_feedbackUniforms.init(_feedbackShader);
+	}
+
+	void	VirtualTexturedMeshRenderer::process(const Mesh& mesh, const Camera& eye, VirtualTexture & texture, IRenderTarget& dst, bool backfaceCull)
+	{
+		// Feedback pass: texel derivatives are larger in the smaller target, compensated by the bias.
+		const uint fw = std::max(dst.w() / _feedbackScale, 1u);
+		const uint fh = std::max(dst.h() / _feedbackScale, 1u);
+		if (!_feedbackRT || _feedbackRT->w() != fw || _feedbackRT->h() != fh) {
+			_feedbackRT.reset(new RenderTargetRGBA32F(fw, fh));
+		}
+		_feedbackRT->bind();
+		glViewport(0, 0, fw, fh);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		_feedbackShader.begin();
+		_feedbackUniforms.set(mesh, eye, texture, -std::log2(float(_feedbackScale)));
+		mesh.render(true, backfaceCull);
+		_feedbackShader.end();
+		_feedbackRT->unbind();
+
+		_feedbackRT->readBack(_feedback);
+		_pending = texture.update(_feedback, _maxUploads);
+
+		dst.bind();
+		glViewport(0, 0, dst.w(), dst.h());
+		_shader.begin();
+		_uniforms.set(mesh, eye, texture, 0.0f);
+		texture.bind(0, 1);
+		mesh.render(true, backfaceCull);
+		_shader.end();
+		dst.unbind();
+	}
+
+} /*namespace sibr*/
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+# include <core/graphics/Shader.hpp>
+# include <core/graphics/Mesh.hpp>
+# include <core/graphics/RenderTarget.hpp>
+# include <core/graphics/VirtualTexture.hpp>
+# include <core/graphics/Camera.hpp>
+
+# include <core/renderer/Config.hpp>
+
+namespace sibr { 
+
+	/** Render a mesh textured with a VirtualTexture, using per-vertex texture coordinates.
+	Each frame, a feedback pass renders the tiles needed by the view in a low resolution target,
+	that is read back on the CPU to update the texture residency before the final pass.
+	\ingroup sibr_renderer
+	*/
+	class SIBR_EXP_RENDERER_EXPORT VirtualTexturedMeshRenderer
+	{
+	public:
+		typedef std::shared_ptr<VirtualTexturedMeshRenderer>	Ptr;
+
+	public:
+
+		/** Constructor.
+		\param feedbackScale ratio between the destination size and the feedback target size
+		*/
+		VirtualTexturedMeshRenderer(uint feedbackScale = 8);
+
+		/** Render the textured mesh, loading the missing tiles first.
+		\param mesh the mesh to render (should have UV attribute)
+		\param eye the viewpoint to use
+		\param texture the virtual texture to use
+		\param dst destination rendertarget
+		\param backfaceCull should backface culling be performed
+		*/
+		void	process(const Mesh& mesh, const Camera& eye, VirtualTexture & texture, IRenderTarget& dst, bool backfaceCull = true);
+
+		/** \return the maximum number of tiles loaded per frame */
+		uint &	maxUploads() { return _maxUploads; }
+
+		/** \return the number of tiles that were requested but not loaded at the last frame */
+		size_t	pendingTiles() const { return _pending; }
+
+	protected:
+
+		/** Uniforms shared by the feedback and rendering shaders. */
+		struct Uniforms {
+			/** Link the uniforms to a shader.
+			\param shader the shader
+			*/
+			void init(GLShader & shader);
+
+			/** Set the uniforms, the shader should be active.
+			\param mesh the rendered mesh
+			\param eye the viewpoint
+			\param texture the virtual texture
+			\param lodBias level offset, for lower resolution targets
+			*/
+			void set(const Mesh & mesh, const Camera & eye, const VirtualTexture & texture, float lodBias);
+
+			GLuniform<Matrix4f>	mvp; ///< MVP uniform.
+			GLuniform<Matrix4f>	positionDecode; ///< Compact vertex format position decoding.
+			GLuniform<Vector2f>	textureSize; ///< Full resolution texture size.
+			GLuniform<int>		numLevels; ///< Number of levels.
+			GLuniform<float>	tileSize; ///< Tile size without border.
+			GLuniform<float>	border; ///< Tile border size.
+			GLuniform<Vector2f>	atlasSize; ///< Atlas size.
+			GLuniform<float>	lodBias; ///< Level offset.
+		};
+
+		GLShader			_shader; ///< The virtual texture shader.
+		GLShader			_feedbackShader; ///< The tile request shader.
+		Uniforms			_uniforms; ///< Uniforms of the virtual texture shader.
+		Uniforms			_feedbackUniforms; ///< Uniforms of the tile request shader.
+		RenderTargetRGBA32F::Ptr	_feedbackRT; ///< Tile requests.
+		ImageRGBA32F		_feedback; ///< Tile requests read back.
+		uint				_feedbackScale; ///< Destination to feedback size ratio.
+		uint				_maxUploads = 32; ///< Tiles loaded per frame.
+		size_t				_pending = 0; ///< Tiles missing at the last frame.
+	};
+
+} /*namespace sibr*/ 
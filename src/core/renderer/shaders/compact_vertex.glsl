@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use 
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+// Decoding of the MeshBufferGL compact vertex format, included by vertex shaders.
+// Uniforms keep their full precision defaults when the mesh is not compact.
+
+uniform mat4 position_decode = mat4(1.0); // See Mesh::positionDecodeMatrix.
+uniform bool oct_normals = false; // Are normals stored on the unfolded octahedron.
+
+/** Decode a normal stored on the unfolded octahedron. */
+vec3 octDecode(vec2 e) {
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return normalize(n);
+}
+
+/** \return the mesh space position of a stored vertex position. */
+vec4 decodePosition(vec3 p) {
+	return position_decode * vec4(p, 1.0);
+}
+
+/** \return the normal of a stored vertex normal. */
+vec3 decodeNormal(vec3 n) {
+	return oct_normals ? octDecode(n.xy) : n;
+}
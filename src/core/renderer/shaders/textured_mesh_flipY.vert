@@ -19,8 +19,10 @@ layout(location = 2) in vec2 in_uv;
 
 out vec2 vertUV;
 
+#include "compact_vertex.glsl"
+
 void main(void) {
-	gl_Position = MVP * vec4(in_vertex,1.0);
+	gl_Position = MVP * decodePosition(in_vertex);
 	vec2 uv = in_uv;
 	uv.y = 1.0 - uv.y ;
 	vertUV = uv;
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use 
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#version 420
+
+// Set to 1 to output the requested tiles instead of the color.
+#define FEEDBACK_PASS (0)
+
+layout(binding = 0) uniform sampler2D atlas;
+layout(binding = 1) uniform usamplerBuffer pageTable;
+
+uniform vec2 textureSize; // Full resolution size, in texels.
+uniform int numLevels;
+uniform float tileSize;
+uniform float border;
+uniform vec2 atlasSize;
+uniform float lodBias;
+
+in vec2 vertUV;
+
+out vec4 out_color;
+
+vec2 levelSize(int level) {
+	return max(vec2(1.0), ceil(textureSize / exp2(float(level))));
+}
+
+ivec2 levelTiles(int level) {
+	return ivec2(ceil(levelSize(level) / tileSize));
+}
+
+ivec2 tileAt(vec2 uv, int level) {
+	return clamp(ivec2(uv * levelSize(level) / tileSize), ivec2(0), levelTiles(level) - 1);
+}
+
+int tileIndex(ivec2 tile, int level) {
+	int offset = 0;
+	for (int l = 0; l < level; ++l) {
+		ivec2 tiles = levelTiles(l);
+		offset += tiles.x * tiles.y;
+	}
+	return offset + tile.y * levelTiles(level).x + tile.x;
+}
+
+void main(void) {
+	// Level where a texel covers about a pixel, derivatives are computed before any branch.
+	vec2 texel = vertUV * textureSize;
+	vec2 dx = dFdx(texel);
+	vec2 dy = dFdy(texel);
+	float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8)) + lodBias;
+
+	vec2 uv = vertUV;
+	if (uv.x == 0.0 && uv.y == 0.0) {
+#if FEEDBACK_PASS
+		discard;
+#else
+		out_color = vec4(1.0, 1.0, 1.0, 1.0);
+		return;
+#endif
+	}
+	// Same orientation as textured_mesh.frag, tiles are in image order.
+	uv.y = 1.0 - uv.y;
+	uv = clamp(uv, 0.0, 1.0);
+
+	int level = clamp(int(floor(lod)), 0, numLevels - 1);
+	ivec2 tile = tileAt(uv, level);
+
+#if FEEDBACK_PASS
+	out_color = vec4(vec2(tile), float(level), 1.0);
+#else
+	// The entry is the tile itself or its closest resident ancestor.
+	uvec4 entry = texelFetch(pageTable, tileIndex(tile, level));
+	int pageLevel = int(entry.z);
+	vec2 inTile = uv * levelSize(pageLevel) - vec2(tileAt(uv, pageLevel)) * tileSize;
+	vec2 atlasTexel = vec2(entry.xy) * (tileSize + 2.0 * border) + border + inTile;
+	out_color = vec4(textureLod(atlas, atlasTexel / atlasSize, 0.0).rgb, 1.0);
+#endif
+}
@@ -18,6 +18,9 @@
 #include "core/scene/ParseData.hpp"
 #include "core/scene/ProxyMesh.hpp"
 #include "core/scene/InputImages.hpp"
+#include "core/graphics/ImageInfo.hpp"
+#include "core/system/MemoryTracker.hpp"
+#include "core/system/TaskGraph.hpp"
 
 namespace sibr
 {
@@ -45,6 +48,14 @@ namespace sibr
 		if (_data->imgInfos().size() != _data->numCameras())
 			SIBR_ERR << "List Image file size do not match number of input cameras in Bundle file!" << std::endl;
 
+		_proxyLODError = myArgs.proxy_lod_error;
+		_optimizeProxy = myArgs.optimize_proxy;
+		_compactProxy = myArgs.compact_proxy;
+		_virtualTexture = myArgs.virtual_texture;
+		if (!RGBDInputTextures::parseRGBDFormat(myArgs.rgbd_format.get(), _rgbdFormat)) {
+			SIBR_WRG << "Unknown RGBD format \"" << myArgs.rgbd_format.get() << "\", using rgba32f." << std::endl;
+		}
+		MemoryTracker::instance().budgets(myArgs);
 		if (_data->datasetType() != IParseData::Type::EMPTY) {
 			createFromData(myArgs.texture_width);
 		}
@@ -65,6 +76,14 @@ namespace sibr
 		if (_data->imgInfos().size() != _data->numCameras())
 			SIBR_ERR << "List Image file size do not match number of input cameras in Bundle file!" << std::endl;
 
+		_proxyLODError = myArgs.proxy_lod_error;
+		_optimizeProxy = myArgs.optimize_proxy;
+		_compactProxy = myArgs.compact_proxy;
+		_virtualTexture = myArgs.virtual_texture;
+		if (!RGBDInputTextures::parseRGBDFormat(myArgs.rgbd_format.get(), _rgbdFormat)) {
+			SIBR_WRG << "Unknown RGBD format \"" << myArgs.rgbd_format.get() << "\", using rgba32f." << std::endl;
+		}
+		MemoryTracker::instance().budgets(myArgs);
 		if (_data->datasetType() != IParseData::Type::EMPTY) {
 			createFromData(myArgs.texture_width);
 		}
@@ -98,76 +117,146 @@ namespace sibr
 		_imgs.reset(new InputImages());
 		_proxies.reset(new ProxyMesh());
 
+		uint mwidth = width;
+		if (width == 0 && !_data->imgInfos().empty()) {// default
+			// Use the size of the first active image file, its header is enough (images might not be loaded).
+			int firstActive = 0;
+			const std::vector<bool> & activeImages = _data->activeImages();
+			while (firstActive + 1 < int(_data->imgInfos().size()) && firstActive < int(activeImages.size()) && !activeImages[firstActive]) {
+				++firstActive;
+			}
+			const Vector2i imageSize = readImageSize(_data->imgPath() + "/" + _data->imgInfos()[firstActive].filename);
+			if (imageSize.x() > 1920) {
+				SIBR_LOG << "Limiting width to 1920 for performance; use --texture_width to override" << std::endl;
+				mwidth = 1920;
+			}
+		}
+		_renderTargets.reset(new RenderTargetTextures(mwidth));
+		_renderTargets->proxyLODError(_proxyLODError);
+		_renderTargets->rgbdFormat(_rgbdFormat);
+
+		// Independent loading steps run concurrently, OpenGL resources are created on this thread.
+		TaskGraph graph;
+		std::vector<TaskGraph::TaskId> renderTargetsDeps;
+
 		// setup calibrated cameras
+		TaskGraph::TaskId camerasTask = 0;
 		if (_currentOpts.cameras) {
-			
-			_cams->setupFromData(_data);
-
-			std::cout << "Number of Cameras set up: " << _cams->inputCameras().size() << std::endl;
+			camerasTask = graph.add("cameras", [this]() {
+				_cams->setupFromData(_data);
+				std::cout << "Number of Cameras set up: " << _cams->inputCameras().size() << std::endl;
+			});
+			renderTargetsDeps.push_back(camerasTask);
 		}
 
 		// load input images
-
-		uint mwidth = width;
 		if (_currentOpts.images) {
-			_imgs->loadFromData(_data);
-			std::cout << "Number of Images loaded: " << _imgs->inputImages().size() << std::endl;
-
-			if (width == 0) {// default
-				if (_imgs->inputImages()[0]->w() > 1920) {
-					SIBR_LOG << "Limiting width to 1920 for performance; use --texture_width to override" << std::endl;
-					mwidth = 1920;
-				}
-			}
+			renderTargetsDeps.push_back(graph.add("images", [this]() {
+				_imgs->loadFromData(_data);
+				std::cout << "Number of Images loaded: " << _imgs->inputImages().size() << std::endl;
+			}));
 		}
-		_renderTargets.reset(new RenderTargetTextures(mwidth));
 
+		sibr::ImageRGB inputTextureImg;
+		std::string tiledTexturePath;
+		bool hasTexture = false;
 		if (_currentOpts.mesh) {
 			// load proxy
-			_proxies->loadFromData(_data);
-
+			const TaskGraph::TaskId proxyTask = graph.add("proxy", [this]() {
+				_proxies->loadFromData(_data);
+				if (_optimizeProxy && _proxies->hasProxy()) {
+					_proxies->proxyPtr()->optimizeForRendering();
+				}
+				if (_compactProxy && _proxies->hasProxy()) {
+					const MeshBufferGL::CompactError error = MeshBufferGL::compactError(_proxies->proxy());
+					SIBR_LOG << "[BasicIBRScene] Compact proxy, max error: position " << error.position << ", normal "
+						<< error.normal << " deg, color " << error.color << ", uv " << error.texCoord << "." << std::endl;
+					_proxies->proxyPtr()->vertexFormat(MeshBufferGL::VertexFormat::COMPACT);
+				}
+			});
+			renderTargetsDeps.push_back(proxyTask);
 
-			std::vector<InputCamera::Ptr> inCams = _cams->inputCameras();
-			float eps = 0.1f;
-			if (inCams.size() > 0 && (abs(inCams[0]->znear() - 0.1) < eps || abs(inCams[0]->zfar() - 1000.0) < eps || abs(inCams[0]->zfar() - 100.0) < eps)) {
-				std::vector<sibr::Vector2f>    nearsFars;
-				CameraRaycaster::computeClippingPlanes(_proxies->proxy(), inCams, nearsFars);
-				_cams->updateNearsFars(nearsFars);
+			std::vector<TaskGraph::TaskId> clippingDeps = { proxyTask };
+			if (_currentOpts.cameras) {
+				clippingDeps.push_back(camerasTask);
 			}
+			renderTargetsDeps.push_back(graph.add("clipping planes", [this]() {
+				std::vector<InputCamera::Ptr> inCams = _cams->inputCameras();
+				float eps = 0.1f;
+				if (inCams.size() > 0 && (abs(inCams[0]->znear() - 0.1) < eps || abs(inCams[0]->zfar() - 1000.0) < eps || abs(inCams[0]->zfar() - 100.0) < eps)) {
+					std::vector<sibr::Vector2f>    nearsFars;
+					const MeshLOD::Ptr lods = _proxyLODError > 0.0f ? _proxies->proxyLODs() : nullptr;
+					if (lods) {
+						CameraRaycaster::computeClippingPlanes(*lods, inCams, nearsFars, _proxyLODError);
+					}
+					else {
+						CameraRaycaster::computeClippingPlanes(_proxies->proxy(), inCams, nearsFars);
+					}
+					_cams->updateNearsFars(nearsFars);
+				}
+			}, clippingDeps));
 
 			//// Load the texture.
-			sibr::ImageRGB inputTextureImg;
-
-			std::string texturePath, textureImageFileName;
-
-			// Assumes that the texture is stored next to the mesh in the same directory
-			// This information comes from Assimp and the mtl file if available
-			if ((textureImageFileName = _proxies->proxy().getTextureImageFileName()) != "") {
-				texturePath = sibr::parentDirectory(_data->meshPath()) + "/" + textureImageFileName;
-				// check if full path given 
-				if (!sibr::fileExists(texturePath) && sibr::fileExists(textureImageFileName)) 
-					texturePath = textureImageFileName;
-			}
-			else {
-				texturePath = sibr::parentDirectory(_data->meshPath()) + "/mesh_u1_v1.png";
-				if (sibr::fileExists(texturePath)) {
-					texturePath = sibr::parentDirectory(_data->meshPath()) + "/textured_u1_v1.png";
-					if (!sibr::fileExists(texturePath)) 
-						texturePath = sibr::parentDirectory(_data->meshPath()) + "/texture.png";
+			const TaskGraph::TaskId textureTask = graph.add("texture", [this, &inputTextureImg, &tiledTexturePath, &hasTexture]() {
+				std::string texturePath, textureImageFileName;
+
+				// Assumes that the texture is stored next to the mesh in the same directory
+				// This information comes from Assimp and the mtl file if available
+				if ((textureImageFileName = _proxies->proxy().getTextureImageFileName()) != "") {
+					texturePath = sibr::parentDirectory(_data->meshPath()) + "/" + textureImageFileName;
+					// check if full path given 
+					if (!sibr::fileExists(texturePath) && sibr::fileExists(textureImageFileName)) 
+						texturePath = textureImageFileName;
+				}
+				else {
+					texturePath = sibr::parentDirectory(_data->meshPath()) + "/mesh_u1_v1.png";
+					if (sibr::fileExists(texturePath)) {
+						texturePath = sibr::parentDirectory(_data->meshPath()) + "/textured_u1_v1.png";
+						if (!sibr::fileExists(texturePath)) 
+							texturePath = sibr::parentDirectory(_data->meshPath()) + "/texture.png";
+					}
 				}
-			}
-
-
-			if (_currentOpts.texture && sibr::fileExists(texturePath)) {
-				inputTextureImg.load(texturePath);
-				_inputMeshTexture.reset(new sibr::Texture2DRGB(inputTextureImg, SIBR_GPU_LINEAR_SAMPLING));
-			}
 
+				if (_currentOpts.texture && sibr::fileExists(texturePath)) {
+					if (_virtualTexture) {
+						// The tiled version is generated once, only the requested tiles will be read afterwards.
+						const std::string tiledPath = texturePath + ".tiles";
+						if (TiledTexture::upToDate(texturePath, tiledPath) || TiledTexture::build(texturePath, tiledPath)) {
+							tiledTexturePath = tiledPath;
+							hasTexture = true;
+							return;
+						}
+						SIBR_WRG << "Unable to tile the texture " << texturePath << ", loading it at once." << std::endl;
+					}
+					inputTextureImg.load(texturePath);
+					hasTexture = true;
+				}
+			}, { proxyTask });
+
+			graph.add("texture upload", [this, &inputTextureImg, &tiledTexturePath, &hasTexture]() {
+				if (hasTexture && !tiledTexturePath.empty()) {
+					TiledTexture::Ptr tiles(new TiledTexture());
+					if (tiles->open(tiledTexturePath)) {
+						_inputMeshVirtualTexture.reset(new VirtualTexture(tiles));
+					}
+					else {
+						SIBR_WRG << "Unable to open the tiled texture " << tiledTexturePath << "." << std::endl;
+					}
+				}
+				else if (hasTexture) {
+					_inputMeshTexture.reset(new sibr::Texture2DRGB(inputTextureImg, SIBR_GPU_LINEAR_SAMPLING));
+				}
+			}, { textureTask }, TaskGraph::Queue::MAIN);
 		}
 
 		if (_currentOpts.renderTargets) {
-			createRenderTargets();
+			graph.add("render targets", [this]() {
+				createRenderTargets();
+			}, renderTargetsDeps, TaskGraph::Queue::MAIN);
 		}
+
+		graph.run();
+		graph.logTimings("[BasicIBRScene]");
 	}
 	
 }
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <core/scene/IIBRScene.hpp>
+#include <core/graphics/VirtualTexture.hpp>
 
 namespace sibr {
 
@@ -126,6 +127,12 @@ namespace sibr {
 		 */
 		Texture2DRGB::Ptr &						inputMeshTextures(void) override;
 
+		/**
+		 * \brief Getter for the streamed version of the mesh texture, only loaded when requested on the command line (in that case inputMeshTextures() is empty).
+		 *
+		 */
+		const VirtualTexture::Ptr &				inputMeshVirtualTexture(void) const { return _inputMeshVirtualTexture; }
+
 	protected:
 		BasicIBRScene(BasicIBRScene & scene);
 		BasicIBRScene& operator =(const BasicIBRScene&) = delete;
@@ -135,8 +142,14 @@ namespace sibr {
 		IInputImages::Ptr			_imgs;
 		IProxyMesh::Ptr				_proxies;
 		Texture2DRGB::Ptr			_inputMeshTexture;
+		VirtualTexture::Ptr			_inputMeshVirtualTexture; ///< Streamed mesh texture.
 		RenderTargetTextures::Ptr	_renderTargets;
 		SceneOptions				_currentOpts;
+		float						_proxyLODError = 0.0f; ///< Allowed proxy simplification error in input views, in pixels.
+		bool						_optimizeProxy = false; ///< Reorder the proxy for the vertex cache at load.
+		bool						_compactProxy = false; ///< Store the proxy vertices in the compact GPU format.
+		bool						_virtualTexture = false; ///< Stream the mesh texture by tiles.
+		RGBDInputTextures::RGBDFormat _rgbdFormat = RGBDInputTextures::RGBDFormat::RGBA32F; ///< Storage of the input RGBD render targets.
 
 		/**
 		* \brief Creates a BasicIBRScene from the internal stored data component in the scene.
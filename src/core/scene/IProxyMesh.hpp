@@ -15,6 +15,7 @@
 #include "core/scene/Config.hpp"
 #include "core/scene/IParseData.hpp"
 #include "core/graphics/Mesh.hpp"
+#include "core/graphics/MeshLOD.hpp"
 
 namespace sibr {
 	/**
@@ -31,6 +32,8 @@ namespace sibr {
 		virtual bool												hasProxy(void) const = 0;
 		virtual const Mesh&											proxy(void) const = 0;
 		virtual const Mesh::Ptr										proxyPtr(void) const = 0;
+		/** \return simplified versions of the proxy, built on first use */
+		virtual MeshLOD::Ptr										proxyLODs(void) const = 0;
 
 	protected:
 		IProxyMesh() {};
@@ -11,10 +11,45 @@
 
 
 #include "InputImages.hpp"
+#include "core/graphics/ImageInfo.hpp"
+#include "core/system/MemoryTracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 
 namespace sibr
 {
+	namespace {
+		/** Compute the scale to apply to the active input images so that they fit in the images budget.
+		 * Sizes are read from the file headers, before loading.
+		 * \param data the dataset
+		 * \return the scale, 1 if the images already fit
+		 */
+		float budgetScale(const IParseData::Ptr & data)
+		{
+			const size_t available = MemoryTracker::instance().available(MemoryTracker::Category::Images);
+			if (available == std::numeric_limits<size_t>::max()) {
+				return 1.0f;
+			}
+			size_t required = 0;
+			for (size_t i = 0; i < data->imgInfos().size(); ++i) {
+				if (data->activeImages()[i]) {
+					const Vector2i size = readImageSize(data->imgPath() + "/" + data->imgInfos()[i].filename);
+					required += size_t(std::max(size.x(), 0)) * size_t(std::max(size.y(), 0)) * 3;
+				}
+			}
+			if (required <= available) {
+				return 1.0f;
+			}
+			const float scale = std::sqrt(float(available) / float(required));
+			SIBR_WRG << "Input images need " << (required >> 20) << "MB, above the images budget (" << (available >> 20)
+				<< "MB left), they are downscaled by " << scale << "." << std::endl;
+			return scale;
+		}
+	}
+
 	void InputImages::loadFromData(const IParseData::Ptr & data)
 	{
 		//InputImages out;
@@ -22,11 +57,18 @@ namespace sibr
 
 		if (data->imgInfos().empty() == false)
 		{
+			const float scale = budgetScale(data);
+
 			#pragma omp parallel for
 			for (int i = 0; i < data->imgInfos().size(); ++i) {
 				if (data->activeImages()[i]) {
 					_inputImages[i] = std::make_shared<ImageRGB>();
 					_inputImages[i]->load(data->imgPath() + "/" + data->imgInfos().at(i).filename, false);
+					if (scale < 1.0f && _inputImages[i]->w() > 0) {
+						const int w = std::max(1, int(float(_inputImages[i]->w()) * scale));
+						const int h = std::max(1, int(float(_inputImages[i]->h()) * scale));
+						*_inputImages[i] = _inputImages[i]->resized(w, h, cv::INTER_AREA);
+					}
 				}
 				else {
 					_inputImages[i] = std::make_shared<ImageRGB>(16,16, 0);
@@ -23,6 +23,7 @@
 #include <map>
 #include "core/system/String.hpp"
 #include "core/graphics/Mesh.hpp"
+#include "core/graphics/ImageInfo.hpp"
 
 using namespace boost::algorithm;
 namespace sibr {
@@ -101,10 +102,11 @@ namespace sibr {
 					//std::cout << line << std::endl;
 					split(splitS, line, is_any_of(" "));
 					//std::cout << splitS.size() << std::endl;
-					if (splitS.size() > 1) {
+					if (!splitS.empty() && !splitS[0].empty()) {
 						infos.filename = splitS[0];
-						infos.width = stoi(splitS[1]);
-						infos.height = stoi(splitS[2]);
+						// Missing sizes will be read from the image headers.
+						infos.width = splitS.size() > 2 ? stoi(splitS[1]) : 0;
+						infos.height = splitS.size() > 2 ? stoi(splitS[2]) : 0;
 						infos.camId = camId;
 
 						//infos.filename.erase(infos.filename.find_last_of("."), std::string::npos);
@@ -202,12 +204,22 @@ namespace sibr {
 			SIBR_ERR << "Scene Metadata file does not exist at /" + _basePathName + "/." << std::endl;
 		}
 
+		_imgPath = _basePathName + "/images/";
+
+		// Complete image sizes that are not listed in the metadata, only reading the image headers.
+#pragma omp parallel for
+		for (int i = 0; i < int(_imgInfos.size()); ++i) {
+			if (_imgInfos[i].width == 0 || _imgInfos[i].height == 0) {
+				const Vector2i size = readImageSize(_imgPath + _imgInfos[i].filename);
+				_imgInfos[i].width = uint(size.x());
+				_imgInfos[i].height = uint(size.y());
+			}
+		}
+
 		if (!parseBundlerFile(_basePathName + "/cameras/bundle.out")) {
 			SIBR_ERR << "Bundle file does not exist at /" + _basePathName + "/cameras/." << std::endl;
 		}
 
-		_imgPath = _basePathName + "/images/";
-
 		// Default mesh path if none found in the metadata file.
 		if (_meshPath.empty()) {
 			_meshPath = _basePathName + "/meshes/recon.obj";
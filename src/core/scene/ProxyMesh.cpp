@@ -18,6 +18,7 @@ namespace sibr {
 	void ProxyMesh::loadFromData(const IParseData::Ptr & data)
 	{
 		_proxy.reset(new Mesh());
+		_lods.reset();
 		if (!_proxy->load(data->meshPath(), data->basePathName()  ) && !_proxy->load(removeExtension(data->meshPath()) + ".ply") && !_proxy->load(removeExtension(data->meshPath()) + ".obj")) {
 			SIBR_WRG << "proxy model not found at " << data->meshPath() << std::endl;
 		}
@@ -30,6 +31,7 @@ namespace sibr {
 	void ProxyMesh::replaceProxy(Mesh::Ptr newProxy)
 	{
 		_proxy.reset(new Mesh());
+		_lods.reset();
 		_proxy->vertices(newProxy->vertices());
 		_proxy->normals(newProxy->normals());
 		_proxy->colors(newProxy->colors());
@@ -48,6 +50,15 @@ namespace sibr {
 	void ProxyMesh::replaceProxyPtr(Mesh::Ptr newProxy)
 	{
 		_proxy = newProxy;
+		_lods.reset();
+	}
+
+	MeshLOD::Ptr ProxyMesh::proxyLODs(void) const
+	{
+		if (!_lods && hasProxy()) {
+			_lods.reset(new MeshLOD(_proxy));
+		}
+		return _lods;
 	}
 
 
@@ -31,10 +31,12 @@ namespace sibr {
 		bool												hasProxy(void) const;
 		const Mesh&											proxy(void) const;
 		const Mesh::Ptr										proxyPtr(void) const;
+		MeshLOD::Ptr										proxyLODs(void) const override;
 
 	protected:
 
 		Mesh::Ptr											_proxy;
+		mutable MeshLOD::Ptr								_lods; ///< Simplified proxies, reset when the proxy changes.
 
 	};
 
@@ -12,6 +12,9 @@
 
 #include "RenderTargetTextures.hpp"
 
+#include <boost/algorithm/string.hpp>
+#include <cmath>
+
 namespace sibr {
 
 	void RTTextureSize::initSize(uint w, uint h)
@@ -38,54 +41,134 @@ namespace sibr {
 		_isInit = true;
 	}
 
+	void RTTextureSize::fitToBudget(MemoryTracker::Category category, size_t views, size_t bytesPerPixel)
+	{
+		const size_t available = MemoryTracker::instance().available(category);
+		const size_t required = views * size_t(_width) * _height * bytesPerPixel;
+		if (required <= available) {
+			return;
+		}
+		const float scale = std::sqrt(float(available) / float(required));
+		const uint width = std::max(1u, uint(float(_width) * scale));
+		const uint height = std::max(1u, uint(float(_height) * scale));
+		SIBR_WRG << MemoryTracker::name(category) << ": input views need " << (required >> 20) << "MB, above the budget (" << (available >> 20)
+			<< "MB left), resolution reduced to (" << width << "," << height << ")." << std::endl;
+		_width = width;
+		_height = height;
+	}
+
 	bool RTTextureSize::isInit() const
 	{
 		return _isInit;
 	}
 
+	const Mesh & RTTextureSize::proxyForView(const IProxyMesh::Ptr & proxies, const InputCamera & cam, uint height) const
+	{
+		const MeshLOD::Ptr lods = _proxyLODError > 0.0f ? proxies->proxyLODs() : nullptr;
+		if (!lods) {
+			return proxies->proxy();
+		}
+		return lods->level(lods->selectLevel(cam, float(height), _proxyLODError));
+	}
+
+	bool RGBDInputTextures::parseRGBDFormat(const std::string & name, RGBDFormat & format)
+	{
+		const std::string lowerName = boost::algorithm::to_lower_copy(name);
+		if (lowerName == "rgba32f") {
+			format = RGBDFormat::RGBA32F;
+		}
+		else if (lowerName == "rgba16") {
+			format = RGBDFormat::RGBA16;
+		}
+		else if (lowerName == "rgba8_depth32f") {
+			format = RGBDFormat::RGBA8_DEPTH32F;
+		}
+		else if (lowerName == "rgba8_depth16") {
+			format = RGBDFormat::RGBA8_DEPTH16;
+		}
+		else {
+			return false;
+		}
+		return true;
+	}
+
 	const std::vector<RenderTargetRGBA32F::Ptr>& RGBDInputTextures::inputImagesRT() const
 	{
 		return _inputRGBARenderTextures;
 	}
 
+	const std::vector<IRenderTarget::Ptr>& RGBDInputTextures::inputColorRTs() const
+	{
+		return _inputColorRenderTextures;
+	}
+
+	const ITexture2DArray::Ptr & RGBDInputTextures::inputDepthsRT() const
+	{
+		return _inputDepthsArrayPtr;
+	}
+
 	void RGBDInputTextures::initializeImageRenderTargets(ICalibratedCameras::Ptr cams, IInputImages::Ptr imgs)
 	{
 		SIBR_LOG << "Initializing input image RTs " << std::endl;
 
 		if (!isInit()) {
 			initSize(cams->inputCameras()[_initActiveCam]->w(), cams->inputCameras()[_initActiveCam]->h());
+			// Color and depth buffer of each target.
+			const size_t colorBytes = _rgbdFormat == RGBDFormat::RGBA32F ? 16 : (_rgbdFormat == RGBDFormat::RGBA16 ? 8 : 4);
+			fitToBudget(MemoryTracker::Category::RenderTargets, imgs->inputImages().size(), colorBytes + 4);
 		}
 		
+		_inputRGBARenderTextures.clear();
 		_inputRGBARenderTextures.resize(imgs->inputImages().size());
+		_inputColorRenderTextures.clear();
+		_inputColorRenderTextures.resize(imgs->inputImages().size());
 
 		GLShader textureShader;
 		textureShader.init("Texture",
 			loadFile(Resources::Instance()->getResourceFilePathName("texture.vp")),
 			loadFile(Resources::Instance()->getResourceFilePathName("texture.fp")));
+		GLParameter flip;
+		flip.init(textureShader, "flip");
 		uint interpFlag = (SIBR_SCENE_LINEAR_SAMPLING & SIBR_SCENE_LINEAR_SAMPLING) ? SIBR_GPU_LINEAR_SAMPLING : 0; // LINEAR_SAMPLING Set to default
 
+		size_t colorBytes = 0;
 		for (uint i = 0; i < imgs->inputImages().size(); i++) {
 			if (cams->inputCameras()[i]->isActive()) {
-				ImageRGB img = std::move(imgs->inputImages()[i]->clone());
-				img.flipH();
-
-				std::shared_ptr<Texture2DRGB> rawInputImage(new Texture2DRGB(img, interpFlag));
+				// Images are flipped when copied to the render target.
+				std::shared_ptr<Texture2DRGB> rawInputImage(new Texture2DRGB(*imgs->inputImages()[i], interpFlag));
 
 				glViewport(0, 0, _width, _height);
-				_inputRGBARenderTextures[i].reset(new RenderTargetRGBA32F(_width, _height, interpFlag));
-				_inputRGBARenderTextures[i]->clear();
-				_inputRGBARenderTextures[i]->bind();
+				IRenderTarget::Ptr & rt = _inputColorRenderTextures[i];
+				switch (_rgbdFormat) {
+				case RGBDFormat::RGBA32F:
+					_inputRGBARenderTextures[i].reset(new RenderTargetRGBA32F(_width, _height, interpFlag));
+					rt = _inputRGBARenderTextures[i];
+					colorBytes += size_t(_width) * _height * 4 * sizeof(float);
+					break;
+				case RGBDFormat::RGBA16:
+					rt.reset(new RenderTargetRGBA16(_width, _height, interpFlag));
+					colorBytes += size_t(_width) * _height * 4 * sizeof(unsigned short);
+					break;
+				default:
+					rt.reset(new RenderTargetRGBA(_width, _height, interpFlag));
+					colorBytes += size_t(_width) * _height * 4;
+					break;
+				}
+				rt->clear();
+				rt->bind();
 
 				glActiveTexture(GL_TEXTURE0);
 				glBindTexture(GL_TEXTURE_2D, rawInputImage->handle());
 
 				glDisable(GL_DEPTH_TEST);
 				textureShader.begin();
+				flip.set(true);
 				RenderUtility::renderScreenQuad();
 				textureShader.end();
-				_inputRGBARenderTextures[i]->unbind();
+				rt->unbind();
 			}
 		}
+		SIBR_LOG << "Input color RTs: " << float(colorBytes) / (1024.0f * 1024.0f) << "MB." << std::endl;
 	}
 
 	void RGBDInputTextures::initializeDepthRenderTargets(ICalibratedCameras::Ptr cams, IProxyMesh::Ptr proxies, bool facecull)
@@ -94,8 +177,15 @@ namespace sibr {
 			initSize(cams->inputCameras()[_initActiveCam]->w(), cams->inputCameras()[_initActiveCam]->h());
 		}
 
+		_inputDepthsArrayPtr.reset();
+		if (_rgbdFormat == RGBDFormat::RGBA8_DEPTH32F || _rgbdFormat == RGBDFormat::RGBA8_DEPTH16) {
+			initializeSeparateDepths(cams, proxies, facecull);
+			return;
+		}
+
 		GLParameter size;
 		GLParameter proj;
+		GLParameter positionDecode;
 
 		GLShader depthShader;
 		depthShader.init("Depth",
@@ -104,9 +194,10 @@ namespace sibr {
 
 		proj.init(depthShader, "proj"); // [SP]: ??
 		size.init(depthShader, "size"); // [SP]: ??
+		positionDecode.init(depthShader, "position_decode");
 		for (uint i = 0; i < cams->inputCameras().size(); i++) {
 			if (cams->inputCameras()[i]->isActive()) {
-				_inputRGBARenderTextures[i]->bind();
+				_inputColorRenderTextures[i]->bind();
 				glEnable(GL_DEPTH_TEST);
 				glClear(GL_DEPTH_BUFFER_BIT);
 				glDepthMask(GL_TRUE);
@@ -115,27 +206,92 @@ namespace sibr {
 				if (!proxies->proxy().triangles().empty())
 				{
 
-					const uint w = _inputRGBARenderTextures[i]->w();
-					const uint h = _inputRGBARenderTextures[i]->h();
+					const uint w = _inputColorRenderTextures[i]->w();
+					const uint h = _inputColorRenderTextures[i]->h();
 
 					depthShader.begin();
 					size.set((float)w, (float)h);
 					proj.set(cams->inputCameras()[i]->viewproj());
-					proxies->proxy().render(true, facecull);
+					const Mesh & proxy = proxyForView(proxies, *cams->inputCameras()[i], h);
+					positionDecode.set(proxy.positionDecodeMatrix());
+					proxy.render(true, facecull);
 
 					depthShader.end();
 				}
-				_inputRGBARenderTextures[i]->unbind();
+				_inputColorRenderTextures[i]->unbind();
 			}
 		}
 		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 	}
 
+	void RGBDInputTextures::initializeSeparateDepths(ICalibratedCameras::Ptr cams, IProxyMesh::Ptr proxies, bool facecull)
+	{
+		GLShader depthOnlyShader;
+		depthOnlyShader.init("DepthOnly",
+			loadFile(Resources::Instance()->getResourceFilePathName("depthonly.vp")),
+			loadFile(Resources::Instance()->getResourceFilePathName("depthonly.fp")));
+
+		GLParameter proj;
+		proj.init(depthOnlyShader, "proj");
+		GLParameter positionDecode;
+		positionDecode.init(depthOnlyShader, "position_decode");
+
+		// Render each view in the same target, then copy it to its layer.
+		const uint numCams = (uint)cams->inputCameras().size();
+		IRenderTarget::Ptr depthRT;
+		size_t depthBytes;
+		if (_rgbdFormat == RGBDFormat::RGBA8_DEPTH16) {
+			depthRT.reset(new RenderTargetLum16(_width, _height));
+			_inputDepthsArrayPtr.reset(new Texture2DArrayLum16(_width, _height, numCams, SIBR_GPU_LINEAR_SAMPLING));
+			depthBytes = sizeof(unsigned short);
+		}
+		else {
+			depthRT.reset(new RenderTargetLum32F(_width, _height));
+			_inputDepthsArrayPtr.reset(new Texture2DArrayLum32F(_width, _height, numCams, SIBR_GPU_LINEAR_SAMPLING));
+			depthBytes = sizeof(float);
+		}
+
+		for (uint i = 0; i < numCams; i++) {
+			if (!cams->inputCameras()[i]->isActive()) {
+				continue;
+			}
+			glViewport(0, 0, _width, _height);
+
+			// Background depth of 1.0, as in the alpha channel of the RGBA targets where no geometry is drawn.
+			// The target only has a red channel, which stores the depth.
+			// Clear the bound target directly, to leave the global clear color untouched.
+			depthRT->bind();
+			glEnable(GL_DEPTH_TEST);
+			const GLfloat background[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			glClearBufferfv(GL_COLOR, 0, background);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			glDepthMask(GL_TRUE);
+
+			if (!proxies->proxy().triangles().empty()) {
+				depthOnlyShader.begin();
+				proj.set(cams->inputCameras()[i]->viewproj());
+				const Mesh & proxy = proxyForView(proxies, *cams->inputCameras()[i], _height);
+				positionDecode.set(proxy.positionDecodeMatrix());
+				proxy.render(true, facecull);
+				depthOnlyShader.end();
+			}
+			depthRT->unbind();
+
+			glCopyImageSubData(
+				depthRT->handle(), GL_TEXTURE_2D, 0, 0, 0, 0,
+				_inputDepthsArrayPtr->handle(), GL_TEXTURE_2D_ARRAY, 0, 0, 0, i,
+				_width, _height, 1);
+			CHECK_GL_ERROR;
+		}
+		SIBR_LOG << "Input depth maps: " << float(size_t(_width) * _height * numCams * depthBytes) / (1024.0f * 1024.0f) << "MB." << std::endl;
+	}
+
 	void DepthInputTextureArray::initDepthTextureArrays(ICalibratedCameras::Ptr cams, IProxyMesh::Ptr proxies, bool facecull, int flags)
 	{
 
 		if (!isInit()) {
 			initSize(cams->inputCameras()[_initActiveCam]->w(), cams->inputCameras()[_initActiveCam]->h());
+			fitToBudget(MemoryTracker::Category::TextureArrays, cams->inputCameras().size(), sizeof(float));
 		}
 
 		if (!proxies->hasProxy()) {
@@ -157,6 +313,8 @@ namespace sibr {
 
 		GLParameter proj;
 		proj.init(depthOnlyShader, "proj");
+		GLParameter positionDecode;
+		positionDecode.init(depthOnlyShader, "position_decode");
 
 
 		const uint numCams = (uint)cams->inputCameras().size();
@@ -172,7 +330,9 @@ namespace sibr {
 
 			depthOnlyShader.begin();
 			proj.set(cams->inputCameras()[i]->viewproj());
-			proxies->proxy().render(true, facecull);
+			const Mesh & proxy = proxyForView(proxies, *cams->inputCameras()[i], _height);
+			positionDecode.set(proxy.positionDecodeMatrix());
+			proxy.render(true, facecull);
 			depthOnlyShader.end();
 
 			depthRT.unbind();
@@ -195,8 +355,10 @@ namespace sibr {
 	{
 		if (!isInit()) {
 			initSize(imgs->inputImages()[_initActiveCam]->w(), imgs->inputImages()[_initActiveCam]->h());
+			fitToBudget(MemoryTracker::Category::TextureArrays, imgs->inputImages().size(), 3);
 		}
 
+		// Images are streamed as is, flipping and resizing happen during the upload.
 		_inputRGBArrayPtr.reset(new Texture2DArrayRGB(imgs->inputImages(), _width, _height, flags));
 	}
 
@@ -237,6 +399,9 @@ namespace sibr {
 	{
 		if (!isInit()) {
 			initRenderTargetRes(cams);
+			// Both arrays share the resolution, fit them together: RGB colors and float depths.
+			initSize(imgs->inputImages()[_initActiveCam]->w(), imgs->inputImages()[_initActiveCam]->h());
+			fitToBudget(MemoryTracker::Category::TextureArrays, imgs->inputImages().size(), 3 + sizeof(float));
 		}
 		initRGBTextureArrays(imgs, textureFlags);
 		initDepthTextureArrays(cams, proxies, faceCull);
@@ -20,6 +20,7 @@
 # include "core/graphics/Shader.hpp"
 #include "core/graphics/Utils.hpp"
 #include "core/scene/Config.hpp"
+#include "core/system/MemoryTracker.hpp"
 
 
 # define SIBR_SCENE_LINEAR_SAMPLING			4
@@ -39,11 +40,27 @@ namespace sibr{
 
 		bool isInit() const;
 
+		/** Allow simplified proxies when rendering input depth maps.
+		\param error maximum screen-space error in pixels, 0 always uses the full resolution proxy
+		*/
+		void proxyLODError(float error) { _proxyLODError = error; }
+
 	protected:
+		/** Reduce the resolution chosen by initSize so that the input views fit in the remaining budget of a memory category.
+		\param category the category the views are accounted in
+		\param views the number of views
+		\param bytesPerPixel the storage of a pixel, over all the resources of a view
+		*/
+		void fitToBudget(MemoryTracker::Category category, size_t views, size_t bytesPerPixel);
+
+		/** \return the proxy level to render in an input view of the given height. */
+		const Mesh & proxyForView(const IProxyMesh::Ptr & proxies, const InputCamera & cam, uint height) const;
+
 		uint		_width = 0; //constrained width provided by the command line args, defaults to 0
 		uint		_height = 0; //associated height, computed in initSize
 		bool		_isInit = false;
 		int			_initActiveCam = 0;
+		float		_proxyLODError = 0.0f; //allowed proxy error in pixels, 0 to disable levels of detail
 
 	};
 
@@ -53,13 +70,52 @@ namespace sibr{
 	class SIBR_SCENE_EXPORT RGBDInputTextures : public virtual RTTextureSize {
 		SIBR_CLASS_PTR(RGBDInputTextures)
 	public:
+
+		/** Storage of the input RGBD render targets. */
+		enum class RGBDFormat {
+			RGBA32F, ///< RGB and depth in alpha, 32-bit floats (default).
+			RGBA16, ///< RGB and depth in alpha, 16-bit normalized.
+			RGBA8_DEPTH32F, ///< RGBA8 color, depth in a separate 32-bit float texture array.
+			RGBA8_DEPTH16 ///< RGBA8 color, depth in a separate 16-bit normalized texture array.
+		};
+
+		/** Parse a RGBD format name (rgba32f, rgba16, rgba8_depth32f, rgba8_depth16), case insensitive.
+		\param name the format name
+		\param format will contain the format
+		\return false if the name is unknown
+		*/
+		static bool parseRGBDFormat(const std::string & name, RGBDFormat & format);
+
+		/** Select the storage of the render targets, before initializing them.
+		\param format the new format
+		*/
+		void rgbdFormat(RGBDFormat format) { _rgbdFormat = format; }
+
+		/** \return the storage of the render targets */
+		RGBDFormat rgbdFormat() const { return _rgbdFormat; }
+
+		/** \return the RGBD render targets, only available with the RGBA32F format
+		\sa inputColorRTs
+		*/
 		const std::vector<RenderTargetRGBA32F::Ptr> & inputImagesRT() const;
 
+		/** \return the color render targets, with depth in alpha unless inputDepthsRT() is available */
+		const std::vector<IRenderTarget::Ptr> & inputColorRTs() const;
+
+		/** \return the depth maps, one layer per camera, or nullptr if they are stored in the alpha of the color render targets */
+		const ITexture2DArray::Ptr & inputDepthsRT() const;
+
 		virtual void initializeImageRenderTargets(ICalibratedCameras::Ptr cams, IInputImages::Ptr imgs);
 		virtual void initializeDepthRenderTargets(ICalibratedCameras::Ptr cams, IProxyMesh::Ptr proxies, bool facecull);
 
 	protected:
+		/** Render the depth maps in a texture array, for formats storing them separately. */
+		void initializeSeparateDepths(ICalibratedCameras::Ptr cams, IProxyMesh::Ptr proxies, bool facecull);
+
 		std::vector<RenderTargetRGBA32F::Ptr> _inputRGBARenderTextures;
+		std::vector<IRenderTarget::Ptr> _inputColorRenderTextures; // same targets as _inputRGBARenderTextures for RGBA32F
+		ITexture2DArray::Ptr _inputDepthsArrayPtr; // separate depth maps, null if stored in alpha
+		RGBDFormat _rgbdFormat = RGBDFormat::RGBA32F;
 
 	};
 
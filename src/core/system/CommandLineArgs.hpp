@@ -356,6 +356,9 @@ namespace sibr
 		Arg<bool> noExit = {"noExit", "dont exit after rendering path "};
 		Arg<std::string> pathFile = { "pathFile", "", "filename of path to render offline; app renders path and exits" }; // app needs to handle this; if it does default behavior is to render the path and exit
 		Arg<std::string> outPath = { "outPath", "pathOutput", "Path of directory to store path output default relative the input path directory " }; // app needs to handle this; if it does default behavior is to render the path and exit
+		Arg<std::string> benchmark = { "benchmark", "", "replay pathFile and save frame timings to this JSON file, instead of saving images" };
+		Arg<int> benchmark_warmup = { "benchmark-warmup", 10, "number of frames rendered before measuring" };
+		Arg<int> benchmark_repeat = { "benchmark-repeat", 1, "number of times the path is replayed while measuring" };
 
 	};
 
@@ -370,6 +373,7 @@ namespace sibr
 		Arg<bool> no_gui = { "nogui", "do not use ImGui" };
 		Arg<bool> gl_debug = { "gldebug", "enable OpenGL error callback" };
 		Arg<bool> offscreen = { "offscreen", "do not open window" };
+		Arg<bool> headless = { "headless", "render through an offscreen EGL context, no display needed (Linux only)" };
 	};
 
 	/// Combination of window and application arguments.
@@ -388,6 +392,11 @@ namespace sibr
 		Arg<int> rendering_mode = { "rendering-mode", RENDERMODE_MONO, "select mono (0) or stereo (1) rendering mode" };
 		Arg<sibr::Vector3f> focal_pt = { "focal-pt", {0.0f, 0.0f, 0.0f} };
 		Arg<Switch> colmap_fovXfovY_flag = { "colmap_fovXfovY_flag", false };
+		Arg<bool> optimize_proxy = { "optimize-proxy", "reorder the proxy triangles and vertices for faster rendering at load" };
+		Arg<bool> compact_proxy = { "compact-proxy", "store the proxy vertices in a compact quantized format on the GPU" };
+		Arg<std::string> rgbd_format = { "rgbd-format", "rgba32f", "storage of the per-camera RGBD render targets: rgba32f, rgba16, rgba8_depth32f or rgba8_depth16" };
+		Arg<float> proxy_lod_error = { "proxy-lod-error", 0.0f, "maximum screen-space error (in pixels) of the simplified proxy used for depth maps and clipping planes, 0 to disable" };
+		Arg<bool> virtual_texture = { "virtual-texture", "stream the proxy texture tile by tile instead of loading it at once, the tiled file is generated next to it on first use" };
 	};
 
 	/// Dataset related arguments.
@@ -397,10 +406,19 @@ namespace sibr
 		Arg<std::string> dataset_type = { "dataset_type", "", "type of dataset" };
 	};
 
+	/// Memory budgets in MB, loaders reduce or skip data to stay below them (0 means unlimited).
+	/// \ingroup sibr_system
+	struct SIBR_SYSTEM_EXPORT MemoryBudgetArgs {
+		Arg<int> images_budget = { "images-budget", 0, "RAM budget in MB for the input images, downscaled at load to fit" };
+		Arg<int> textures_budget = { "textures-budget", 0, "GPU budget in MB for the input texture arrays, their resolution is reduced to fit" };
+		Arg<int> render_targets_budget = { "render-targets-budget", 0, "GPU budget in MB for the render targets, the input ones are reduced to fit" };
+		Arg<int> raycaster_budget = { "raycaster-budget", 0, "RAM budget in MB for the raycaster, meshes that don't fit are not added" };
+	};
+
 	/// "Default" set of arguments.
 	/// \ingroup sibr_system
 	struct SIBR_SYSTEM_EXPORT BasicIBRAppArgs :
-		virtual WindowAppArgs, virtual BasicDatasetArgs, virtual RenderingArgs {
+		virtual WindowAppArgs, virtual BasicDatasetArgs, virtual RenderingArgs, virtual MemoryBudgetArgs {
 	};
 
 	/// Specialization of value getter for strings.
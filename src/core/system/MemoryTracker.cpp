@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/system/MemoryTracker.hpp"
+#include "core/system/CommandLineArgs.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+namespace sibr
+{
+	MemoryTracker::Allocation::Allocation(Category category)
+		: _category(category)
+	{
+	}
+
+	MemoryTracker::Allocation::Allocation(const Allocation & other)
+		: _category(other._category)
+	{
+		resize(other._bytes);
+	}
+
+	MemoryTracker::Allocation::Allocation(Allocation && other) noexcept
+		: _category(other._category), _bytes(other._bytes)
+	{
+		other._bytes = 0;
+	}
+
+	MemoryTracker::Allocation & MemoryTracker::Allocation::operator=(const Allocation & other)
+	{
+		if (this != &other) {
+			resize(0);
+			_category = other._category;
+			resize(other._bytes);
+		}
+		return *this;
+	}
+
+	MemoryTracker::Allocation & MemoryTracker::Allocation::operator=(Allocation && other) noexcept
+	{
+		if (this != &other) {
+			resize(0);
+			_category = other._category;
+			_bytes = other._bytes;
+			other._bytes = 0;
+		}
+		return *this;
+	}
+
+	MemoryTracker::Allocation::~Allocation(void)
+	{
+		resize(0);
+	}
+
+	void MemoryTracker::Allocation::resize(size_t bytes)
+	{
+		if (bytes == _bytes) {
+			return;
+		}
+		MemoryTracker::instance().add(_category, int64(bytes) - int64(_bytes));
+		_bytes = bytes;
+	}
+
+	MemoryTracker::MemoryTracker(void)
+	{
+		for (size_t c = 0; c < categoryCount; ++c) {
+			_used[c] = 0;
+			_peaks[c] = 0;
+			_budgets[c] = 0;
+		}
+	}
+
+	MemoryTracker & MemoryTracker::instance()
+	{
+		static MemoryTracker tracker;
+		return tracker;
+	}
+
+	const char * MemoryTracker::name(Category category)
+	{
+		switch (category) {
+		case Category::Images: return "Images";
+		case Category::TextureArrays: return "Texture arrays";
+		case Category::RenderTargets: return "Render targets";
+		case Category::MeshBuffers: return "Mesh buffers";
+		case Category::VideoVolumes: return "Video volumes";
+		case Category::Raycaster: return "Raycaster";
+		default: return "Unknown";
+		}
+	}
+
+	bool MemoryTracker::enforced(Category category)
+	{
+		switch (category) {
+		case Category::Images:
+		case Category::TextureArrays:
+		case Category::RenderTargets:
+		case Category::Raycaster:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	void MemoryTracker::add(Category category, int64 bytes)
+	{
+		const size_t c = size_t(category);
+		const int64 used = _used[c].fetch_add(bytes) + bytes;
+		int64 peak = _peaks[c].load();
+		while (used > peak && !_peaks[c].compare_exchange_weak(peak, used)) {
+		}
+	}
+
+	size_t MemoryTracker::used(Category category) const
+	{
+		return size_t(std::max(int64(0), _used[size_t(category)].load()));
+	}
+
+	size_t MemoryTracker::used(void) const
+	{
+		size_t total = 0;
+		for (size_t c = 0; c < categoryCount; ++c) {
+			total += used(Category(c));
+		}
+		return total;
+	}
+
+	size_t MemoryTracker::peak(Category category) const
+	{
+		return size_t(std::max(int64(0), _peaks[size_t(category)].load()));
+	}
+
+	void MemoryTracker::budget(Category category, size_t bytes)
+	{
+		_budgets[size_t(category)] = bytes;
+	}
+
+	size_t MemoryTracker::budget(Category category) const
+	{
+		return _budgets[size_t(category)];
+	}
+
+	size_t MemoryTracker::available(Category category) const
+	{
+		const size_t limit = budget(category);
+		if (limit == 0) {
+			return std::numeric_limits<size_t>::max();
+		}
+		const size_t current = used(category);
+		return current < limit ? limit - current : 0;
+	}
+
+	void MemoryTracker::budgets(const MemoryBudgetArgs & args)
+	{
+		const auto toBytes = [](int megabytes) { return size_t(std::max(megabytes, 0)) << 20; };
+		budget(Category::Images, toBytes(args.images_budget));
+		budget(Category::TextureArrays, toBytes(args.textures_budget));
+		budget(Category::RenderTargets, toBytes(args.render_targets_budget));
+		budget(Category::Raycaster, toBytes(args.raycaster_budget));
+	}
+
+	void MemoryTracker::dump(std::ostream & stream) const
+	{
+		const double toMB = 1.0 / (1024.0 * 1024.0);
+		const std::ios::fmtflags flags = stream.flags();
+		const std::streamsize precision = stream.precision();
+		stream << std::fixed << std::setprecision(1);
+		for (size_t c = 0; c < categoryCount; ++c) {
+			const Category category = Category(c);
+			stream << name(category) << ": " << double(used(category)) * toMB << "MB (peak " << double(peak(category)) * toMB << "MB";
+			if (budget(category) > 0) {
+				stream << ", budget " << double(budget(category)) * toMB << "MB";
+			}
+			stream << ")" << std::endl;
+		}
+		stream << "Total: " << double(used()) * toMB << "MB" << std::endl;
+		stream.flags(flags);
+		stream.precision(precision);
+	}
+
+	void MemoryTracker::dump(void) const
+	{
+		SIBR_LOG << "[MemoryTracker] Tracked memory:" << std::endl;
+		dump(std::cout);
+	}
+
+} // namespace sibr
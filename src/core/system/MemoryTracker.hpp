@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/system/Config.hpp"
+
+#include <array>
+#include <atomic>
+#include <iosfwd>
+
+namespace sibr
+{
+	struct MemoryBudgetArgs;
+
+	/** Account for the memory held by the main CPU and GPU resources, by category.
+	 * Resources register their size through an Allocation member, released when they are destroyed.
+	 * Each category can be given a budget: the tracker never refuses an allocation, but loaders
+	 * check available() beforehand and downscale or skip data instead of running out of memory.
+	 * Sizes are estimated from the resource dimensions, driver padding and alignment are ignored.
+	 *
+	 * Code example:
+	 *
+	 *		MemoryTracker::instance().budget(MemoryTracker::Category::TextureArrays, size_t(2) << 30);
+	 *		...
+	 *		MemoryTracker::Allocation _allocation { MemoryTracker::Category::TextureArrays };
+	 *		_allocation.resize(size_t(w) * h * depth * 3);
+	 *
+	 * \ingroup sibr_system
+	 */
+	class SIBR_SYSTEM_EXPORT MemoryTracker
+	{
+	public:
+
+		/** Kind of resource. */
+		enum class Category {
+			Images, ///< CPU images (input images and other sibr::Image).
+			TextureArrays, ///< GPU 2D texture arrays (input images and depth maps).
+			RenderTargets, ///< GPU render targets, including the per-view input targets.
+			MeshBuffers, ///< GPU mesh vertex and index buffers.
+			VideoVolumes, ///< CPU video volumes.
+			Raycaster, ///< Embree geometries and BVHs.
+			Count ///< Number of categories.
+		};
+
+		/** Size of a resource, registered in a category for the lifetime of the object.
+		 * Copying an allocation registers its size again, as copying the resource duplicates its data.
+		 */
+		class SIBR_SYSTEM_EXPORT Allocation
+		{
+		public:
+			/** Constructor.
+			 * \param category the category the resource belongs to
+			 */
+			explicit Allocation(Category category);
+
+			/** Copy constructor.
+			 * \param other the allocation to duplicate
+			 */
+			Allocation(const Allocation & other);
+
+			/** Move constructor.
+			 * \param other the allocation to take over, left empty
+			 */
+			Allocation(Allocation && other) noexcept;
+
+			/** Copy operator.
+			 * \param other the allocation to duplicate
+			 * \return itself
+			 */
+			Allocation & operator=(const Allocation & other);
+
+			/** Move operator.
+			 * \param other the allocation to take over, left empty
+			 * \return itself
+			 */
+			Allocation & operator=(Allocation && other) noexcept;
+
+			/** Release the registered size. */
+			~Allocation(void);
+
+			/** Update the size of the resource.
+			 * \param bytes the new size
+			 */
+			void resize(size_t bytes);
+
+			/** \return the registered size in bytes */
+			size_t size(void) const { return _bytes; }
+
+		private:
+			Category _category; ///< Category of the resource.
+			size_t _bytes = 0; ///< Registered size.
+		};
+
+		/** \return the tracker shared by all resources */
+		static MemoryTracker & instance();
+
+		/** \return a readable name for a category
+		 * \param category the category
+		 */
+		static const char * name(Category category);
+
+		/** \return true if loaders of a category reduce or skip data to fit its budget, the others are only tracked
+		 * \param category the category
+		 */
+		static bool enforced(Category category);
+
+		/** Register an allocation or a release.
+		 * \param category the category
+		 * \param bytes the allocated size, negative for a release
+		 */
+		void add(Category category, int64 bytes);
+
+		/** \return the size currently allocated in a category, in bytes
+		 * \param category the category
+		 */
+		size_t used(Category category) const;
+
+		/** \return the size currently allocated over all categories, in bytes */
+		size_t used(void) const;
+
+		/** \return the highest size allocated at once in a category since the start, in bytes
+		 * \param category the category
+		 */
+		size_t peak(Category category) const;
+
+		/** Set the budget of a category.
+		 * \param category the category
+		 * \param bytes the budget, 0 for no limit
+		 */
+		void budget(Category category, size_t bytes);
+
+		/** \return the budget of a category in bytes, 0 if there is no limit
+		 * \param category the category
+		 */
+		size_t budget(Category category) const;
+
+		/** \return the size that can still be allocated in a category, in bytes
+		 * \param category the category
+		 */
+		size_t available(Category category) const;
+
+		/** Set the budgets given on the command line.
+		 * \param args the budgets in MB, 0 for no limit
+		 */
+		void budgets(const MemoryBudgetArgs & args);
+
+		/** Write the state of all categories, one per line.
+		 * \param stream the destination
+		 */
+		void dump(std::ostream & stream) const;
+
+		/** Log the state of all categories. */
+		void dump(void) const;
+
+	private:
+
+		/// Constructor.
+		MemoryTracker(void);
+
+		static const size_t categoryCount = size_t(Category::Count); ///< Number of categories.
+
+		std::array<std::atomic<int64>, categoryCount> _used; ///< Allocated sizes.
+		std::array<std::atomic<int64>, categoryCount> _peaks; ///< Peak allocated sizes.
+		std::array<std::atomic<size_t>, categoryCount> _budgets; ///< Budgets, 0 if unlimited.
+	};
+
+} // namespace sibr
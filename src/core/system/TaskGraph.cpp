@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/system/TaskGraph.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace sibr
+{
+	TaskGraph::TaskId TaskGraph::add(const std::string & name, const std::function<void()> & func,
+		const std::vector<TaskId> & dependencies, Queue queue)
+	{
+		const TaskId id = _tasks.size();
+		for (const TaskId dependency : dependencies) {
+			if (dependency >= id) {
+				SIBR_ERR << "[TaskGraph] Task " << name << " depends on a task added after it." << std::endl;
+			}
+			_tasks[dependency].dependents.push_back(id);
+		}
+		_tasks.push_back({ name, func, {}, uint(dependencies.size()), queue });
+		return id;
+	}
+
+	double TaskGraph::run(uint threads)
+	{
+		typedef std::chrono::steady_clock clock;
+		const clock::time_point start = clock::now();
+		const auto secondsSince = [&start](const clock::time_point & time) {
+			return std::chrono::duration<double>(time - start).count();
+		};
+
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::deque<TaskId> workerReady, mainReady;
+		std::vector<uint> remaining(_tasks.size());
+		size_t completed = 0;
+		size_t workerTasks = 0;
+		std::exception_ptr failure;
+
+		_timings.assign(_tasks.size(), Timing());
+		for (TaskId id = 0; id < _tasks.size(); ++id) {
+			_timings[id].name = _tasks[id].name;
+			_timings[id].queue = _tasks[id].queue;
+			remaining[id] = _tasks[id].dependencyCount;
+			if (_tasks[id].queue == Queue::WORKER) {
+				++workerTasks;
+			}
+			if (remaining[id] == 0) {
+				(_tasks[id].queue == Queue::WORKER ? workerReady : mainReady).push_back(id);
+			}
+		}
+
+		// Execute a task, then release its dependents. Called without holding the lock.
+		const auto execute = [&](TaskId id) {
+			const clock::time_point taskStart = clock::now();
+			std::exception_ptr error;
+			try {
+				_tasks[id].func();
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+			const clock::time_point taskEnd = clock::now();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			_timings[id].start = secondsSince(taskStart);
+			_timings[id].duration = std::chrono::duration<double>(taskEnd - taskStart).count();
+			++completed;
+			if (error && !failure) {
+				failure = error;
+			}
+			for (const TaskId dependent : _tasks[id].dependents) {
+				if (--remaining[dependent] == 0) {
+					(_tasks[dependent].queue == Queue::WORKER ? workerReady : mainReady).push_back(dependent);
+				}
+			}
+			changed.notify_all();
+		};
+
+		const auto done = [&]() {
+			return completed == _tasks.size() || failure;
+		};
+
+		const auto worker = [&]() {
+			while (true) {
+				TaskId id;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					changed.wait(lock, [&]() { return done() || !workerReady.empty(); });
+					if (done()) {
+						return;
+					}
+					id = workerReady.front();
+					workerReady.pop_front();
+				}
+				execute(id);
+			}
+		};
+
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		threads = uint(std::min(size_t(threads), workerTasks));
+		std::vector<std::thread> workers;
+		for (uint t = 0; t < threads; ++t) {
+			workers.emplace_back(worker);
+		}
+
+		// Main tasks run here, as soon as they are ready.
+		while (true) {
+			TaskId id;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&]() { return done() || !mainReady.empty(); });
+				if (done()) {
+					break;
+				}
+				id = mainReady.front();
+				mainReady.pop_front();
+			}
+			execute(id);
+		}
+		for (std::thread & thread : workers) {
+			thread.join();
+		}
+
+		_wallTime = secondsSince(clock::now());
+		if (failure) {
+			std::rethrow_exception(failure);
+		}
+		return _wallTime;
+	}
+
+	void TaskGraph::logTimings(const std::string & prefix) const
+	{
+		double taskTime = 0.0;
+		for (const Timing & timing : _timings) {
+			std::stringstream line;
+			line << std::left << std::setw(20) << timing.name << std::right << std::fixed << std::setprecision(3)
+				<< " start " << std::setw(8) << timing.start << "s, duration " << std::setw(8) << timing.duration << "s"
+				<< (timing.queue == Queue::MAIN ? " (main thread)" : "");
+			SIBR_LOG << prefix << " " << line.str() << std::endl;
+			taskTime += timing.duration;
+		}
+		std::stringstream total;
+		total << std::fixed << std::setprecision(3) << _wallTime << "s (" << taskTime << "s of tasks)";
+		SIBR_LOG << prefix << " Total: " << total.str() << "." << std::endl;
+	}
+
+} // namespace sibr
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/system/Config.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sibr
+{
+	/** Run a set of tasks with dependencies, as soon as their dependencies are done.
+	 * Worker tasks run on a pool of threads, main tasks run on the thread calling run(),
+	 * which usually owns the OpenGL context. A task can only depend on tasks added before it.
+	 *
+	 * Code example:
+	 *
+	 *		TaskGraph graph;
+	 *		const TaskGraph::TaskId decode = graph.add("decode", [&]() { img.load(path); });
+	 *		graph.add("upload", [&]() { tex.reset(new Texture2DRGB(img)); }, { decode }, TaskGraph::Queue::MAIN);
+	 *		graph.run();
+	 *		graph.logTimings("[Loading]");
+	 *
+	 * \ingroup sibr_system
+	 */
+	class SIBR_SYSTEM_EXPORT TaskGraph
+	{
+	public:
+
+		typedef size_t TaskId;
+
+		/** Where a task is executed. */
+		enum class Queue {
+			WORKER, ///< On any thread of the pool.
+			MAIN ///< On the thread calling run().
+		};
+
+		/** Execution time of a task, in seconds since the beginning of run(). */
+		struct Timing {
+			std::string name; ///< Task name.
+			Queue queue; ///< Where the task was executed.
+			double start; ///< Start time.
+			double duration; ///< Execution time.
+		};
+
+		/** Add a task.
+		 * \param name task name, for reporting
+		 * \param func the work to perform
+		 * \param dependencies tasks that must be done before this one starts
+		 * \param queue where the task should be executed
+		 * \return the task identifier
+		 */
+		TaskId add(const std::string & name, const std::function<void()> & func,
+			const std::vector<TaskId> & dependencies = {}, Queue queue = Queue::WORKER);
+
+		/** Execute all tasks and wait for them to complete. If a task throws, the tasks not yet
+		 * started are skipped and the exception is rethrown once running tasks are done.
+		 * \param threads number of worker threads, 0 to use the hardware concurrency
+		 * \return the total execution time, in seconds
+		 */
+		double run(uint threads = 0);
+
+		/** \return the timings of the last run, in task order */
+		const std::vector<Timing> & timings() const { return _timings; }
+
+		/** Log the timings of the last run.
+		 * \param prefix inserted before each line
+		 */
+		void logTimings(const std::string & prefix) const;
+
+	private:
+
+		/** Task description. */
+		struct Task {
+			std::string name; ///< Task name.
+			std::function<void()> func; ///< Work to perform.
+			std::vector<TaskId> dependents; ///< Tasks waiting for this one.
+			uint dependencyCount; ///< Number of dependencies.
+			Queue queue; ///< Where to execute the task.
+		};
+
+		std::vector<Task> _tasks; ///< All tasks, in insertion order.
+		std::vector<Timing> _timings; ///< Timings of the last run.
+		double _wallTime = 0.0; ///< Duration of the last run.
+	};
+
+} // namespace sibr
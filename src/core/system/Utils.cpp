@@ -20,6 +20,7 @@
 
 #ifdef SIBR_OS_WINDOWS 
 	#include <Windows.h>
+	#include <psapi.h>
 	#include <shlobj.h>
 	#include <stdio.h>
 	// Some old MinGW/CYGWIN distributions don't define this:
@@ -29,6 +30,7 @@
 #else
 	#include <unistd.h>
 	#include <sys/types.h>
+	#include <sys/resource.h>
 	#include <pwd.h>
 #endif
 
@@ -318,6 +320,45 @@ namespace sibr
 #endif
 	}
 
+	size_t getUsedMem() {
+#ifdef SIBR_OS_WINDOWS 
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return 0;
+		}
+		return static_cast<size_t>(counters.WorkingSetSize) / DIV;
+#else
+		// Second field is the resident set size, in pages.
+		std::ifstream statm("/proc/self/statm");
+		size_t size = 0, resident = 0;
+		if (!(statm >> size >> resident)) {
+			return 0;
+		}
+		return resident * static_cast<size_t>(sysconf(_SC_PAGE_SIZE)) / DIV;
+#endif
+	}
+
+	size_t getPeakUsedMem() {
+#ifdef SIBR_OS_WINDOWS 
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return 0;
+		}
+		return static_cast<size_t>(counters.PeakWorkingSetSize) / DIV;
+#else
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0) {
+			return 0;
+		}
+#ifdef SIBR_OS_MAC
+		return static_cast<size_t>(usage.ru_maxrss) / DIV;
+#else
+		// Already in Ko on Linux.
+		return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+	}
+
 	SIBR_SYSTEM_EXPORT std::string getInstallDirectory()
 	{
 		char exePath[4095];
@@ -96,6 +96,12 @@ namespace sibr
 	/** \return the available memory on windows system in Ko*/
 	SIBR_SYSTEM_EXPORT size_t		getAvailableMem();
 
+	/** \return the physical memory currently used by the process in Ko (0 if unknown) */
+	SIBR_SYSTEM_EXPORT size_t		getUsedMem();
+
+	/** \return the peak physical memory used by the process since its start in Ko (0 if unknown) */
+	SIBR_SYSTEM_EXPORT size_t		getPeakUsedMem();
+
 	/** \return the binary directory on windows system*/
 	SIBR_SYSTEM_EXPORT std::string	getInstallDirectory();
 
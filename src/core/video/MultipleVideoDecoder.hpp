@@ -88,6 +88,7 @@ namespace sibr
 		}
 
 		/** Upload the next frame to the GPU for a set of video players.
+		Frames are streamed to the texture array through pixel buffers, see TextureStreamer.
 		\param videos the video players to udpate
 		*/
 		void updateGPU(const std::vector<sibr::VideoPlayer::Ptr> & videos) {
@@ -97,10 +98,8 @@ namespace sibr
 				if (std::is_same_v<T, uchar> && N == 3) {
 					frames[i] = videos[i]->getCurrentFrame();
 				} else {
-					std::vector<cv::Mat> cs;
-					cv::split(videos[i]->getCurrentFrame(), cs);
-					frames[i] = cs[0];
-				}			
+					cv::extractChannel(videos[i]->getCurrentFrame(), frames[i], 0);
+				}
 			}
 
 			if (getLoadingTexArray().get()) {
@@ -173,9 +172,7 @@ namespace sibr
 				if (std::is_same_v<T, uchar> && N == 3) {
 					frames[slices[s]] = videos[slices[s]]->getCurrentFrame();
 				} else {
-					std::vector<cv::Mat> cs;
-					cv::split(videos[slices[s]]->getCurrentFrame(), cs);
-					frames[slices[s]] = cs[0];
+					cv::extractChannel(videos[slices[s]]->getCurrentFrame(), frames[slices[s]], 0);
 				}
 			} 
 
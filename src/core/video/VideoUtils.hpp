@@ -13,6 +13,7 @@
 #pragma once
 
 #include "Config.hpp"
+#include "core/system/MemoryTracker.hpp"
 #include <opencv2/opencv.hpp>
 #include <functional>
 #include "FFmpegVideoEncoder.hpp"
@@ -79,15 +80,20 @@ namespace sibr {
 		int w = 0, h = 0, l = 0;
 		cv::Mat_<T> mat;
 
+		// memory accounting, shared by the volumes sharing the same data
+		std::shared_ptr<MemoryTracker::Allocation> allocation;
+
 		// medthods
 		VideoVolume() {}
 
 		VideoVolume(int _l, int _w, int _h) : l(_l), w(_w), h(_h) {
 			mat = cv::Mat_<T>(l, w*h*N);
+			track();
 		}
 
 		VideoVolume(int _l, int _w, int _h, double value) : l(_l), w(_w), h(_h) {
 			mat = cv::Mat_<T>(l, w*h*N, static_cast<T>(value));
+			track();
 		}
 
 		VideoVolume(cv::Mat other_volume, int _w, int _h) : w(_w), h(_h), l(other_volume.rows) {
@@ -96,10 +102,17 @@ namespace sibr {
 					other_volume.channels()  << " " << other_volume.rows << " " << other_volume.cols << std::endl;
 			}
 			mat = other_volume;
+			track();
 		}
 
 		VideoVolume(const VideoVolume & other) : l(other.l) , w(other.w), h(other.h) {
 			mat = other.mat;
+			allocation = other.allocation;
+		}
+
+		void track() {
+			allocation = std::make_shared<MemoryTracker::Allocation>(MemoryTracker::Category::VideoVolumes);
+			allocation->resize(mat.total() * mat.elemSize());
 		}
 
 		template<typename U, uint M>
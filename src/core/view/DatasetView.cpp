@@ -34,7 +34,7 @@ namespace sibr {
 
 		const std::string grid_str = "grid";
 		ImagesGrid::Ptr grid(new ImagesGrid());
-		grid->addImageLayer("input images", input_images);
+		grid->addImageLayer("input images", std::make_shared<ImagePyramid<uchar, 3>>(input_images));
 
 		addSubView(meshSubViewStr, mmm, defaultRenderingRes);
 		addSubView(gridSubViewStr, grid, defaultRenderingRes);
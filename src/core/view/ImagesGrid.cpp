@@ -18,15 +18,87 @@
 
 namespace sibr
 {
+	ImageGridStreamer::~ImageGridStreamer()
+	{
+		if (_slotTable) {
+			glDeleteTextures(1, &_slotTable);
+			glDeleteBuffers(1, &_slotTableBuffer);
+		}
+	}
+
+	void ImageGridStreamer::resetSlots(int capacity, int count)
+	{
+		_slotImages.assign(capacity, -1);
+		_imageSlots.assign(count, -1);
+		if (!_slotTable) {
+			glGenBuffers(1, &_slotTableBuffer);
+			glGenTextures(1, &_slotTable);
+		}
+		glBindBuffer(GL_TEXTURE_BUFFER, _slotTableBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, _imageSlots.size() * sizeof(int), _imageSlots.data(), GL_DYNAMIC_DRAW);
+		glBindTexture(GL_TEXTURE_BUFFER, _slotTable);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, _slotTableBuffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+
+	void ImageGridStreamer::assignSlots(const std::vector<int> & visible, std::vector<int> & missing, std::vector<int> & missingSlots)
+	{
+		missing.clear();
+		missingSlots.clear();
+
+		// Layers of the images that are not visible anymore can be reused.
+		std::vector<bool> kept(_slotImages.size(), false);
+		for (int im : visible) {
+			const int s = slot(im);
+			if (s >= 0) {
+				kept[s] = true;
+			} else {
+				missing.push_back(im);
+			}
+		}
+		if (missing.empty()) {
+			return;
+		}
+
+		size_t nextFree = 0;
+		for (int im : missing) {
+			while (nextFree < kept.size() && kept[nextFree]) {
+				++nextFree;
+			}
+			if (nextFree == kept.size()) {
+				SIBR_WRG << "[ImagesGrid] More visible images than texture layers." << std::endl;
+				missing.resize(missingSlots.size());
+				break;
+			}
+			const int s = int(nextFree);
+			kept[s] = true;
+			if (_slotImages[s] >= 0) {
+				_imageSlots[_slotImages[s]] = -1;
+			}
+			_slotImages[s] = im;
+			_imageSlots[im] = s;
+			missingSlots.push_back(s);
+		}
+
+		glBindBuffer(GL_TEXTURE_BUFFER, _slotTableBuffer);
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, _imageSlots.size() * sizeof(int), _imageSlots.data());
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	}
+
 	void ImagesGrid::onUpdate(Input & input, const Viewport & vp)
 	{
 		const Vector2f size = vp.finalSize();
 
-		if (current_level_tex) {
-			imSizePixels = { current_level_tex->w(), current_level_tex->h() };
-			imSizePixels = imSizePixels.cwiseQuotient(pow(2.0, current_lod)*Vector2f(1, 1)).unaryExpr([](float f) { return std::floor(f); });
-
+		// Pixel positions are always expressed at full resolution, whatever the displayed level.
+		if (!images_layers.empty() && current_layer->streamer) {
+			num_imgs = current_layer->streamer->pyramid().count();
+			imSizePixels = layerSize(0).cast<float>();
+			updateLod(vp);
+		} else if (current_level_tex) {
 			num_imgs = (int)current_layer->imgs_texture_array->depth();
+			imSizePixels = layerSize(0).cast<float>();
+			updateLod(vp);
 		}
 
 		currentActivePix = pixFromScreenPos(input.mousePosition(), size);
@@ -38,6 +110,8 @@ namespace sibr
 		updateZoomScroll(input);
 		updateDrag(input, size);
 
+		streamVisibleImages();
+
 		if (currentActivePix && input.key().isActivated(Key::LeftControl) && input.mouseButton().isReleased(Mouse::Code::Left) ) {
 			if (selectionMode == IMAGE_SELECTION) {
 				current_layer->image_selection.switchSelection(currentActivePix.im);
@@ -74,7 +148,12 @@ namespace sibr
 			return;
 		}
 
-		draw_utils.image_grid(num_imgs, current_level_tex->handle(), grid_adjusted, viewRectangle.tl(), viewRectangle.br(), current_lod, current_layer->flip_texture);
+		if (current_layer->streamer) {
+			// Streamed textures only contain the current level.
+			draw_utils.image_grid(num_imgs, current_level_tex->handle(), grid_adjusted, viewRectangle.tl(), viewRectangle.br(), 0, current_layer->flip_texture, current_layer->streamer->slotTable());
+		} else {
+			draw_utils.image_grid(num_imgs, current_level_tex->handle(), grid_adjusted, viewRectangle.tl(), viewRectangle.br(), current_lod, current_layer->flip_texture);
+		}
 
 		for (const auto & ims_highlight : images_to_highlight) {
 			const auto & imgs = ims_highlight.second;
@@ -115,7 +194,16 @@ namespace sibr
 			if (currentActivePix) {
 				GUI_TEXT("current pix : " << currentActivePix.im << ", " << currentActivePix.pos.transpose());
 
-				Vector4f value = current_layer->imgs_texture_array->readBackPixel(currentActivePix.im, currentActivePix.pos[0], currentActivePix.pos[1], current_lod);
+				const Vector2i lod_pos(currentActivePix.pos[0] >> current_lod, currentActivePix.pos[1] >> current_lod);
+				Vector4f value(0, 0, 0, 0);
+				if (current_layer->streamer) {
+					const int slot = current_layer->streamer->slot(currentActivePix.im);
+					if (slot >= 0) {
+						value = current_level_tex->readBackPixel(slot, lod_pos[0], lod_pos[1], 0);
+					}
+				} else {
+					value = current_layer->imgs_texture_array->readBackPixel(currentActivePix.im, lod_pos[0], lod_pos[1], current_lod);
+				}
 				if (integer_pixel_values) {
 					Vector4i value_i = (255 * value).cast<int>();
 					GUI_TEXT(" \t value : " << value_i.transpose());
@@ -181,8 +269,13 @@ namespace sibr
 
 				ImGui::NextColumn();
 
-				auto & tex_arr = imgs_it->imgs_texture_array;
-				GUI_TEXT(tex_arr->depth() << " x " << tex_arr->w() << " x " << tex_arr->h());
+				if (imgs_it->streamer) {
+					auto & pyramid = imgs_it->streamer->pyramid();
+					GUI_TEXT(pyramid.count() << " x " << pyramid.levelSize(0)[0] << " x " << pyramid.levelSize(0)[1] << " (" << pyramid.levels() << " levels)");
+				} else {
+					auto & tex_arr = imgs_it->imgs_texture_array;
+					GUI_TEXT(tex_arr->depth() << " x " << tex_arr->w() << " x " << tex_arr->h());
+				}
 				ImGui::NextColumn();
 
 				ImGui::Checkbox(("flip##" + imgs_it->name).c_str(), &imgs_it->flip_texture);
@@ -206,8 +299,9 @@ namespace sibr
 				viewRectangle.center = { 0.5f, 0.5f };
 				viewRectangle.diagonal = { 0.5f, 0.5f };
 			}
-			if (ImGui::SliderInt("pyramid level", &current_lod, 0, 10)) {
-				currentActivePix.isDefined = false;
+			ImGui::Checkbox("automatic pyramid level", &auto_lod);
+			if (ImGui::SliderInt("pyramid level", &current_lod, 0, std::max(layerLevels() - 1, 0))) {
+				auto_lod = false;
 			}
 
 			static const std::vector<const char*> selection_mode_str = { "no selection", "image" ,"pixel" };
@@ -242,6 +336,71 @@ namespace sibr
 		}
 	}
 
+	Vector2u ImagesGrid::layerSize(int lod) const
+	{
+		if (current_layer->streamer) {
+			return current_layer->streamer->pyramid().levelSize(lod);
+		}
+		const auto & tex_arr = current_layer->imgs_texture_array;
+		return Vector2u(tex_arr->w() >> lod, tex_arr->h() >> lod);
+	}
+
+	int ImagesGrid::layerLevels() const
+	{
+		if (images_layers.empty()) {
+			return 1;
+		}
+		if (current_layer->streamer) {
+			return current_layer->streamer->pyramid().levels();
+		}
+		return std::max((int)current_layer->imgs_texture_array->numLODs(), 1);
+	}
+
+	void ImagesGrid::updateLod(const Viewport & vp)
+	{
+		if (!auto_lod || grid_adjusted.x() <= 0 || viewRectangle.diagonal.x() <= 0) {
+			return;
+		}
+		// Width of a grid cell on screen, compared to the full resolution width.
+		const float cellPixels = vp.finalWidth() / (2.0f * viewRectangle.diagonal.x() * grid_adjusted.x());
+		const float texelsPerPixel = (float)layerSize(0).x() / std::max(cellPixels, 1.0f);
+		const int lod = std::min((int)std::floor(std::log2(std::max(texelsPerPixel, 1.0f))), layerLevels() - 1);
+		current_lod = lod;
+	}
+
+	std::vector<int> ImagesGrid::visibleImages() const
+	{
+		std::vector<int> visible;
+		if (num_imgs <= 0 || grid_adjusted.x() <= 0) {
+			return visible;
+		}
+		const Vector2f tl = viewRectangle.tl().cwiseProduct(grid_adjusted);
+		const Vector2f br = viewRectangle.br().cwiseProduct(grid_adjusted);
+		const int num_rows = (num_imgs + num_per_row - 1) / num_per_row;
+		const int col_min = std::max(0, (int)std::floor(tl.x()));
+		const int col_max = std::min(num_per_row - 1, (int)std::ceil(br.x()) - 1);
+		const int row_min = std::max(0, (int)std::floor(tl.y()));
+		const int row_max = std::min(num_rows - 1, (int)std::ceil(br.y()) - 1);
+		for (int row = row_min; row <= row_max; ++row) {
+			for (int col = col_min; col <= col_max; ++col) {
+				const int n = col + num_per_row * row;
+				if (n < num_imgs) {
+					visible.push_back(n);
+				}
+			}
+		}
+		return visible;
+	}
+
+	void ImagesGrid::streamVisibleImages()
+	{
+		if (images_layers.empty() || !current_layer->streamer) {
+			return;
+		}
+		current_layer->imgs_texture_array = current_layer->streamer->update(current_lod, visibleImages());
+		current_level_tex = current_layer->imgs_texture_array;
+	}
+
 	DrawUtilities::DrawUtilities()
 	{
 		initBaseShader();
@@ -374,6 +533,11 @@ namespace sibr
 	}
 
 	void DrawUtilities::image_grid(int num_imgs, uint texture, const Vector2f & grid, const Vector2f & tl, const Vector2f & br, int lod, bool flip_texture)
+	{
+		image_grid(num_imgs, texture, grid, tl, br, lod, flip_texture, 0u);
+	}
+
+	void DrawUtilities::image_grid(int num_imgs, uint texture, const Vector2f & grid, const Vector2f & tl, const Vector2f & br, int lod, bool flip_texture, uint slot_table)
 	{
 		gridShader.begin();
 
@@ -385,10 +549,19 @@ namespace sibr
 		gridBottomRightGL.set(br);
 
 		flip_textureGL.set(flip_texture);
+		useSlotTableGL.set(slot_table != 0);
 
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		if (slot_table) {
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_BUFFER, slot_table);
+		}
 		RenderUtility::renderScreenQuad();
+		if (slot_table) {
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+			glActiveTexture(GL_TEXTURE0);
+		}
 
 		gridShader.end();
 	}
@@ -445,6 +618,8 @@ namespace sibr
 			"uniform vec2 grid;													\n"
 			"uniform float lod;													\n"
 			"uniform bool flip_texture;											\n"
+			"layout(binding = 1) uniform isamplerBuffer slotTable;				\n"
+			"uniform bool useSlotTable;											\n"
 			"in vec2 uv_coord;													\n"
 			"out vec4 out_color;												\n"
 			"void main(void) {													\n"
@@ -454,8 +629,10 @@ namespace sibr
 			"   vec2 fracs = fract(uvs); 										\n"
 			"   vec2 mods = uvs - fracs; 										\n"
 			"   int n = int(mods.x + grid.x*mods.y); 							\n"
-			" if ( n< 0 || n > numImgs || mods.x >= grid.x || mods.y >= (float(numImgs)/grid.x) ) { discard; } else { \n"
-			"	out_color = textureLod(texArray,vec3(fracs.x, flip_texture ? 1.0 -fracs.y : fracs.y,n), lod);	}		\n"
+			" if ( n< 0 || n >= numImgs || mods.x >= grid.x || mods.y >= (float(numImgs)/grid.x) ) { discard; } \n"
+			"   int layer = useSlotTable ? texelFetch(slotTable, n).r : n;		\n"
+			"   if ( layer < 0 ) { discard; } else {							\n"
+			"	out_color = textureLod(texArray,vec3(fracs.x, flip_texture ? 1.0 -fracs.y : fracs.y,layer), lod);	}		\n"
 			"	//out_color = vec4(n/64.0,0.0,0.0,1.0); }						\n"
 			"	//out_color = vec4(uv_coord.x,uv_coord.y,0.0,1.0);	}			\n"
 			"}																	\n";
@@ -468,6 +645,7 @@ namespace sibr
 		gridGL.init(gridShader, "grid");
 		lodGL.init(gridShader, "lod");
 		flip_textureGL.init(gridShader, "flip_texture");
+		useSlotTableGL.init(gridShader, "useSlotTable");
 	}
 
 	MVpixel GridMapping::pixFromScreenPos(const Vector2i & pos, const Vector2f & size)
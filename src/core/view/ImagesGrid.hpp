@@ -14,6 +14,7 @@
 # include "Config.hpp"
 #include <core/graphics/Shader.hpp>
 # include <core/graphics/Texture.hpp>
+#include <core/graphics/ImagePyramid.hpp>
 #include <core/view/ViewBase.hpp>
 #include <list>
 #include <map>
@@ -43,6 +44,7 @@ namespace sibr
 		GLuniform <float> lodGL;
 		GLuniform <int> numImgsGL; 
 		GLuniform<bool> flip_textureGL;
+		GLuniform<bool> useSlotTableGL;
 
 		void baseRendering(const Mesh & mesh, Mesh::RenderMode mode, const Vector3f & color, const Vector2f & translation, const Vector2f & scaling, float alpha, const Viewport & vp);
 
@@ -54,6 +56,12 @@ namespace sibr
 		
 		void image_grid(int num_imgs, uint texture, const Vector2f & grid, const Vector2f & tl, const Vector2f & br, int lod, bool flip_texture);
 
+		/** Render a grid of images stored in arbitrary texture layers.
+		 * Only images with a layer in the slot table are displayed.
+		 * \param slot_table buffer texture giving the layer of each image, -1 if it is not on the GPU
+		 */
+		void image_grid(int num_imgs, uint texture, const Vector2f & grid, const Vector2f & tl, const Vector2f & br, int lod, bool flip_texture, uint slot_table);
+
 	private:
 
 		void initBaseShader();
@@ -153,8 +161,120 @@ namespace sibr
 		std::list<T> _selected;
 	};
 
+	/** Keep the visible images of a pyramid in a texture array, at the level currently displayed.
+	 * The array has one layer per visible image. Layers are given to newly visible images explicitly,
+	 * and a slot table (a buffer texture) tells the grid shader which layer stores each image.
+	 * \ingroup sibr_view
+	 */
+	class SIBR_VIEW_EXPORT ImageGridStreamer {
+	public:
+		SIBR_CLASS_PTR(ImageGridStreamer);
+
+		/** Destructor, releases the slot table. */
+		virtual ~ImageGridStreamer();
+
+		/** \return the streamed pyramid */
+		virtual IImagePyramid & pyramid() = 0;
+
+		/** Upload the visible images that are not on the GPU yet, and release the CPU copies of the others.
+		 * The texture array is recreated when the level changes or when the visible range does not fit anymore.
+		 * \param level the pyramid level to display
+		 * \param visible the visible image indices, sorted
+		 * \return the texture array
+		 */
+		virtual ITexture2DArray::Ptr update(int level, const std::vector<int> & visible) = 0;
+
+		/** \return the layer storing an image, or -1 if it is not on the GPU
+		 * \param im the image index
+		 */
+		int slot(int im) const {
+			return im >= 0 && im < int(_imageSlots.size()) ? _imageSlots[im] : -1;
+		}
+
+		/** \return the number of layers of the texture array */
+		int slots() const { return int(_slotImages.size()); }
+
+		/** \return the buffer texture (one signed integer per image) giving the layer of each image, -1 if it is not on the GPU */
+		uint slotTable() const { return _slotTable; }
+
+	protected:
+
+		/** Forget all stored images, for a new texture array.
+		 * \param capacity the number of layers
+		 * \param count the number of images of the pyramid
+		 */
+		void resetSlots(int capacity, int count);
+
+		/** Give a layer to each visible image not on the GPU yet, reusing the layers of the images that are not visible anymore.
+		 * The slot table is updated accordingly.
+		 * \param visible the visible image indices, at most slots()
+		 * \param missing will contain the images to upload
+		 * \param missingSlots will contain the layer of each image to upload
+		 */
+		void assignSlots(const std::vector<int> & visible, std::vector<int> & missing, std::vector<int> & missingSlots);
+
+		std::vector<int> _slotImages; ///< Image stored in each layer, -1 if none.
+		std::vector<int> _imageSlots; ///< Layer storing each image, -1 if none.
+		int _level = -1; ///< Level currently stored.
+		uint _slotTable = 0; ///< Buffer texture view of the layer of each image.
+		uint _slotTableBuffer = 0; ///< Storage of the slot table.
+	};
+
+	/** Stream the images of a typed pyramid.
+	 * \ingroup sibr_view
+	 */
+	template<typename T, uint N>
+	class ImageGridPyramidStreamer : public ImageGridStreamer {
+	public:
+		/** Constructor.
+		 * \param pyramid the pyramid to stream
+		 */
+		ImageGridPyramidStreamer(const typename ImagePyramid<T, N>::Ptr & pyramid) : _pyramid(pyramid) {}
+
+		IImagePyramid & pyramid() override { return *_pyramid; }
+
+		ITexture2DArray::Ptr update(int level, const std::vector<int> & visible) override {
+			const int needed = std::max(int(visible.size()), 1);
+			if (!_texture || level != _level || needed > slots()) {
+				const int capacity = std::min(_pyramid->count(), needed);
+				const Vector2u size = _pyramid->levelSize(level);
+				_texture.reset(new Texture2DArray<T, N>(size[0], size[1], uint(capacity)));
+				resetSlots(capacity, _pyramid->count());
+				_pyramid->evictOthers(level);
+				_level = level;
+			}
+
+			std::vector<int> missing, slices;
+			assignSlots(visible, missing, slices);
+			if (!missing.empty()) {
+				_pyramid->load(missing, level);
+				const Vector2u size = _pyramid->levelSize(level);
+				// Images are shared with the pyramid, only those with a different size are copied.
+				std::vector<typename Image<T, N>::Ptr> layers(_slotImages.size());
+				for (int i = 0; i < int(missing.size()); ++i) {
+					const int im = missing[i];
+					const int s = slices[i];
+					const auto & img = _pyramid->loaded(level)[im];
+					if (img->w() == size[0] && img->h() == size[1]) {
+						layers[s] = img;
+					} else {
+						layers[s] = typename Image<T, N>::Ptr(new Image<T, N>(img->resized(int(size[0]), int(size[1]))));
+					}
+				}
+				_texture->updateSlices(layers, slices);
+			}
+			_pyramid->evict(level, visible);
+			return _texture;
+		}
+
+	private:
+		typename ImagePyramid<T, N>::Ptr _pyramid; ///< Streamed pyramid.
+		typename Texture2DArray<T, N>::Ptr _texture; ///< Visible images at the current level.
+	};
+
 	struct ImageGridLayer {	
 		ITexture2DArray::Ptr imgs_texture_array;
+		ImageGridStreamer::Ptr streamer; ///< Set for layers streamed from an image pyramid.
 
 		ObjectSelection<MVpixel> pixel_selection;
 		ObjectSelection<int> image_selection;
@@ -199,10 +319,30 @@ namespace sibr
 		bool name_collision(const std::string & name) const;
 		void setupFirstLayer();
 
+		/** \return the size of the images of the current layer at a given level
+		 * \param lod the level
+		 */
+		Vector2u layerSize(int lod) const;
+
+		/** \return the number of levels available in the current layer */
+		int layerLevels() const;
+
+		/** Select the coarsest level that still has one texel per screen pixel for the displayed cells.
+		 * \param vp the grid viewport
+		 */
+		void updateLod(const Viewport & vp);
+
+		/** \return the indices of the images at least partially visible, sorted */
+		std::vector<int> visibleImages() const;
+
+		/** Upload the visible images of a streamed layer at the current level. */
+		void streamVisibleImages();
+
 		std::list<ImageGridLayer> images_layers;
 		std::list<ImageGridLayer>::iterator current_layer;
 		ITexture2DArray::Ptr current_level_tex;
 		int current_lod = 0;
+		bool auto_lod = true;
 		bool integer_pixel_values = true;
 
 		std::map< std::string, HighlightData<MVpixel> > pixels_to_highlight;
@@ -256,6 +396,27 @@ namespace sibr
 			setupFirstLayer();
 		}
 
+		/** Add a layer streamed from an image pyramid: only the visible images are loaded, at the displayed level.
+		 * \param layer_name the layer name
+		 * \param pyramid the images
+		 */
+		template<typename T, uint N>
+		void addImageLayer(
+			const std::string & layer_name,
+			const std::shared_ptr<ImagePyramid<T, N>> & pyramid
+		) {
+			if (!pyramid || pyramid->count() == 0 || name_collision(layer_name)) {
+				return;
+			}
+
+			ImageGridLayer layer;
+			layer.name = layer_name;
+			layer.streamer = std::make_shared<ImageGridPyramidStreamer<T, N>>(pyramid);
+			images_layers.push_back(layer);
+
+			setupFirstLayer();
+		}
+
 		template<typename T, uint N>
 		void addImageLayer(
 			const std::string & layer_name,
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/view/MemoryPanel.hpp"
+#include "core/graphics/Utils.hpp"
+#include "core/system/MemoryTracker.hpp"
+#include "core/system/Utils.hpp"
+
+#include <imgui/imgui.h>
+
+#include <algorithm>
+
+namespace sibr
+{
+
+	int MemoryPanel::_count = 0;
+
+	MemoryPanel::MemoryPanel(void)
+	{
+		_name = "Memory##" + std::to_string(_count);
+		++_count;
+	}
+
+	void MemoryPanel::render(void)
+	{
+		if (_hidden) {
+			return;
+		}
+
+		const float toMB = 1.0f / (1024.0f * 1024.0f);
+		MemoryTracker & tracker = MemoryTracker::instance();
+
+		ImGui::SetNextWindowSize(ImVec2(520, 0), ImGuiCond_FirstUseEver);
+		bool open = true;
+		if (ImGui::Begin(_name.c_str(), &open))
+		{
+			ImGui::Text("Process: %.1f MB (peak %.1f MB)", float(getUsedMem()) / 1024.0f, float(getPeakUsedMem()) / 1024.0f);
+			size_t gpuTotal = 0;
+			const size_t gpuUsed = getGPUUsedMem(&gpuTotal);
+			if (gpuTotal > 0) {
+				ImGui::Text("GPU (all processes): %.1f / %.1f MB", float(gpuUsed) / 1024.0f, float(gpuTotal) / 1024.0f);
+			}
+			else {
+				ImGui::TextDisabled("GPU usage not reported by the driver.");
+			}
+			ImGui::Separator();
+
+			ImGui::Columns(4, "memory_categories");
+			ImGui::Text("Category"); ImGui::NextColumn();
+			ImGui::Text("Used (MB)"); ImGui::NextColumn();
+			ImGui::Text("Peak (MB)"); ImGui::NextColumn();
+			ImGui::Text("Budget (MB, 0: none)"); ImGui::NextColumn();
+			ImGui::Separator();
+			for (int c = 0; c < int(MemoryTracker::Category::Count); ++c) {
+				const MemoryTracker::Category category = MemoryTracker::Category(c);
+				const size_t used = tracker.used(category);
+				const size_t budget = tracker.budget(category);
+
+				ImGui::Text("%s", MemoryTracker::name(category)); ImGui::NextColumn();
+				if (budget > 0) {
+					const float ratio = float(used) / float(budget);
+					const std::string label = std::to_string(int(float(used) * toMB + 0.5f));
+					ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ratio > 1.0f ? ImVec4(0.9f, 0.2f, 0.2f, 1.0f) : ImVec4(0.2f, 0.7f, 0.3f, 1.0f));
+					ImGui::ProgressBar(std::min(ratio, 1.0f), ImVec2(-1, 0), label.c_str());
+					ImGui::PopStyleColor();
+				}
+				else {
+					ImGui::Text("%.1f", float(used) * toMB);
+				}
+				ImGui::NextColumn();
+				ImGui::Text("%.1f", float(tracker.peak(category)) * toMB); ImGui::NextColumn();
+
+				// Budgets are only editable for the categories whose loaders respect them.
+				if (MemoryTracker::enforced(category)) {
+					int budgetMB = int(budget >> 20);
+					ImGui::PushItemWidth(-1);
+					if (ImGui::InputInt(("##budget" + std::to_string(c)).c_str(), &budgetMB, 64, 1024)) {
+						tracker.budget(category, size_t(std::max(budgetMB, 0)) << 20);
+					}
+					ImGui::PopItemWidth();
+				}
+				else {
+					ImGui::TextDisabled("tracked only");
+				}
+				ImGui::NextColumn();
+			}
+			ImGui::Columns(1);
+			ImGui::Separator();
+			ImGui::Text("Tracked total: %.1f MB", float(tracker.used()) * toMB);
+			ImGui::SameLine();
+			if (ImGui::Button("Dump to log")) {
+				tracker.dump();
+			}
+			ImGui::TextDisabled("Budgets apply to the next loads, resources already allocated are kept.");
+		}
+		ImGui::End();
+		if (!open) {
+			_hidden = true;
+		}
+	}
+
+} // namespace sibr
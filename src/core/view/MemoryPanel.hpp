@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+# include "core/view/Config.hpp"
+
+# include <string>
+
+namespace sibr
+{
+
+	/** Provide a GUI panel displaying the memory used by the process, the GPU and each MemoryTracker category,
+	* and allowing to edit the category budgets.
+	* \ingroup sibr_view
+	*/
+	class SIBR_VIEW_EXPORT MemoryPanel
+	{
+	public:
+
+		/// Constructor, the panel is hidden by default.
+		MemoryPanel(void);
+
+		/** Generate the ImGui panel, if visible. */
+		void render(void);
+
+		/** Toggle the panel visibility. */
+		void toggleVisibility() {
+			_hidden = !_hidden;
+		}
+
+		/** \return true if the panel visible. */
+		bool active() const {
+			return !_hidden;
+		}
+
+	private:
+		bool								_hidden = true; ///< Visibility status.
+		std::string							_name; ///< Panel name.
+		static int							_count; ///< Internal counter to avoid collision when multiple panels are displayed.
+	};
+
+} // namespace sibr
@@ -11,9 +11,13 @@
 
 
 #include "MultiMeshManager.hpp"
+#include "core/graphics/Frustum.hpp"
+#include "core/system/SimpleTimer.hpp"
 
 #include <imgui/imgui.h>
 
+#include <algorithm>
+
 namespace sibr {
 
 	MeshData MeshData::dummy = MeshData("dummy", Mesh::Ptr(), DUMMY, Mesh::FillRenderMode);
@@ -251,12 +255,14 @@ namespace sibr {
 	{
 		ShaderAlphaMVP::initShader(name, vert, frag, geom);
 		user_color.init(shader, "user_color");
+		position_decode.init(shader, "position_decode");
 	}
 
 	void ColorMeshShader::setUniforms(const Camera & eye, const MeshData & data)
 	{
 		ShaderAlphaMVP::setUniforms(eye, data);
 		user_color.set(data.userColor);
+		position_decode.set(data.meshPtr ? data.meshPtr->positionDecodeMatrix() : Matrix4f::Identity());
 	}
 
 	void PointShader::initShader(const std::string & name, const std::string & vert, const std::string & frag, const std::string & geom)
@@ -290,12 +296,25 @@ namespace sibr {
 		normals_size.set(data.normalsLength);
 	}
 
+	void VertexNormalRenderingShader::initShader(const std::string & name, const std::string & vert, const std::string & frag, const std::string & geom)
+	{
+		NormalRenderingShader::initShader(name, vert, frag, geom);
+		oct_normals.init(shader, "oct_normals");
+	}
+
+	void VertexNormalRenderingShader::setUniforms(const Camera & eye, const MeshData & data)
+	{
+		NormalRenderingShader::setUniforms(eye, data);
+		oct_normals.set(data.meshPtr && data.meshPtr->vertexFormat() == MeshBufferGL::VertexFormat::COMPACT);
+	}
+
 	void MeshShadingShader::initShader(const std::string & name, const std::string & vert, const std::string & frag, const std::string & geom)
 	{
 		ColorMeshShader::initShader(name, vert, frag, geom);
 		light_position.init(shader, "light_position");
 		phong_shading.init(shader, "phong_shading");
 		use_mesh_color.init(shader, "use_mesh_color");
+		oct_normals.init(shader, "oct_normals");
 	}
 
 	void MeshShadingShader::setUniforms(const Camera & eye, const MeshData & data)
@@ -304,6 +323,7 @@ namespace sibr {
 		light_position.set(eye.position());
 		phong_shading.set(data.phongShading);
 		use_mesh_color.set(data.colorMode == MeshData::ColorMode::VERTEX);
+		oct_normals.set(data.meshPtr && data.meshPtr->vertexFormat() == MeshBufferGL::VertexFormat::COMPACT);
 	}
 
 	MultiMeshManager::MultiMeshManager(const std::string & _name) : name(_name)
@@ -316,6 +336,20 @@ namespace sibr {
 		camera_handler.fromCamera(tb.getCamera());
 
 		camera_handler.switchMode(InteractiveCameraHandler::InteractionMode::TRACKBALL);
+
+		// Unit cube, scaled to each object box for occlusion queries.
+		Mesh::Ptr box = std::make_shared<Mesh>();
+		const Mesh::Vertices boxVertices = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} };
+		const Mesh::Triangles boxTriangles = { {0,2,1}, {0,3,2}, {4,5,6}, {4,6,7}, {0,1,5}, {0,5,4}, {3,7,6}, {3,6,2}, {0,4,7}, {0,7,3}, {1,2,6}, {1,6,5} };
+		box->vertices(boxVertices);
+		box->triangles(boxTriangles);
+		occlusion_box = MeshData("occlusion_box", box, MeshData::TRIANGLES, Mesh::FillRenderMode);
+		occlusion_box.backFaceCulling = false;
+	}
+
+	MultiMeshManager::~MultiMeshManager()
+	{
+		invalidateCulling();
 	}
 
 	void MultiMeshManager::onUpdate(Input & input, const Viewport & vp)
@@ -381,6 +415,18 @@ namespace sibr {
 		if (ImGui::Begin(name.c_str())) {
 			ImGui::Separator();
 
+			if (ImGui::CollapsingHeader(("Culling##" + name).c_str())) {
+				ImGui::Checkbox(("Frustum culling##" + name).c_str(), &frustum_culling);
+				ImGui::SameLine();
+				ImGui::Checkbox(("Occlusion culling##" + name).c_str(), &occlusion_culling);
+				if (occlusion_culling && !culling_stats.occlusionActive) {
+					ImGui::SameLine();
+					ImGui::TextDisabled("(paused, transparent objects)");
+				}
+				ImGui::Text("Objects: %zu, outside frustum: %zu, occluded: %zu", culling_stats.objects, culling_stats.frustumCulled, culling_stats.occluded);
+				ImGui::Text("Draw calls: %zu, box tests: %zu, culling: %.3f ms", culling_stats.drawCalls, culling_stats.boxTests, culling_stats.cullingTime);
+			}
+
 			list_mesh_onGUI();
 	
 		}
@@ -444,30 +490,193 @@ namespace sibr {
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		glBlendEquation(GL_FUNC_ADD);
 
+		const Camera & eye = camera_handler.getCamera();
+		updateCulling(eye);
+
+		uint id = 0;
 		for (const auto & mesh_data : list_meshes) {
-			if (!mesh_data.active) {
+			const CullingObject & object = *culling_order[id++];
+			if (!mesh_data.active || !object.visible) {
 				continue;
 			}
 
 			if (mesh_data.renderMode == Mesh::PointRenderMode) {
-				points_shader.render(camera_handler.getCamera(), mesh_data);
+				points_shader.render(eye, mesh_data);
 			} else {
-				colored_mesh_shader.render(camera_handler.getCamera(), mesh_data);
+				colored_mesh_shader.render(eye, mesh_data);
 			}
+			++culling_stats.drawCalls;
 
 			if (mesh_data.showNormals) {
 				if (mesh_data.normalMode == MeshData::PER_VERTEX ) {
-					per_vertex_normals_shader.render(camera_handler.getCamera(), mesh_data.getNormalsMeshData());
+					per_vertex_normals_shader.render(eye, mesh_data.getNormalsMeshData());
 				} else {
-					per_triangle_normals_shader.render(camera_handler.getCamera(), mesh_data.getNormalsMeshData());
+					per_triangle_normals_shader.render(eye, mesh_data.getNormalsMeshData());
 				}
-				
+				++culling_stats.drawCalls;
 			}
 		}
 
+		if (culling_stats.occlusionActive) {
+			issueOcclusionQueries(eye);
+		}
+
 		glDisable(GL_BLEND);
 	}
 
+	void MultiMeshManager::updateCulling(const Camera & eye)
+	{
+		Timer timer(true);
+		CullingStats stats;
+
+		// The state follows each object by name, objects can be removed or reordered in the list.
+		std::vector<CullingObject *> order;
+		order.reserve(list_meshes.size());
+		for (const auto & mesh_data : list_meshes) {
+			order.push_back(&culling_objects[mesh_data.name]);
+		}
+		if (culling_objects.size() != order.size()) {
+			std::vector<CullingObject *> listed(order);
+			std::sort(listed.begin(), listed.end());
+			for (auto it = culling_objects.begin(); it != culling_objects.end();) {
+				if (std::binary_search(listed.begin(), listed.end(), &it->second)) {
+					++it;
+					continue;
+				}
+				if (it->second.query) {
+					glDeleteQueries(1, &it->second.query);
+				}
+				it = culling_objects.erase(it);
+			}
+		}
+		bool rebuild = order != culling_order;
+		culling_order = order;
+
+		// Update the world boxes of the objects that changed since the last frame.
+		bool transparent = false;
+		uint id = 0;
+		for (const auto & mesh_data : list_meshes) {
+			CullingObject & object = *culling_order[id++];
+			if (object.mesh != mesh_data.meshPtr) {
+				object.mesh = mesh_data.meshPtr;
+				object.localBox = object.mesh ? object.mesh->getBoundingBox() : Eigen::AlignedBox3f();
+				object.normalsLength = -1.0f;
+			}
+			const float normalsLength = mesh_data.showNormals ? std::abs(mesh_data.normalsLength) : 0.0f;
+			if (object.normalsLength != normalsLength || object.transformation != mesh_data.transformation) {
+				object.normalsLength = normalsLength;
+				object.transformation = mesh_data.transformation;
+				object.box.setEmpty();
+				if (!object.localBox.isEmpty()) {
+					const Eigen::AlignedBox3f localBox(Vector3f(object.localBox.min().array() - normalsLength), Vector3f(object.localBox.max().array() + normalsLength));
+					for (int c = 0; c < 8; ++c) {
+						const Vector3f corner = localBox.corner(Eigen::AlignedBox3f::CornerType(c));
+						object.box.extend(Vector3f((object.transformation * corner.homogeneous()).hnormalized()));
+					}
+				}
+				rebuild = true;
+			}
+			if (mesh_data.active) {
+				++stats.objects;
+				transparent = transparent || mesh_data.alpha < 1.0f;
+			}
+		}
+
+		if (rebuild) {
+			std::vector<Eigen::AlignedBox3f> boxes(culling_order.size());
+			for (size_t i = 0; i < culling_order.size(); ++i) {
+				boxes[i] = culling_order[i]->box;
+			}
+			culling_bvh.build(boxes);
+		}
+
+		for (CullingObject * object : culling_order) {
+			object->inFrustum = !frustum_culling;
+		}
+		if (frustum_culling) {
+			stats.boxTests = culling_bvh.cull(Frustum(eye.viewproj()), culling_visible);
+			for (const uint i : culling_visible) {
+				culling_order[i]->inFrustum = true;
+			}
+		}
+
+		// Collect the occlusion results that are ready, without waiting for the GPU.
+		// Transparent objects would hide the objects behind them from the queries.
+		stats.occlusionActive = occlusion_culling && !transparent;
+		id = 0;
+		for (const auto & mesh_data : list_meshes) {
+			CullingObject & object = *culling_order[id++];
+			if (object.queryPending) {
+				GLuint available = 0;
+				glGetQueryObjectuiv(object.query, GL_QUERY_RESULT_AVAILABLE, &available);
+				if (available) {
+					GLuint anySamples = 0;
+					glGetQueryObjectuiv(object.query, GL_QUERY_RESULT, &anySamples);
+					object.occluded = anySamples == 0;
+					object.queryPending = false;
+				}
+			}
+			// Boxes close to the camera can be clipped by the near plane.
+			if (!stats.occlusionActive || !object.inFrustum || !mesh_data.depthTest || mesh_data.invertDepthTest
+				|| object.box.exteriorDistance(eye.position()) <= 2.0f * eye.znear()) {
+				object.occluded = false;
+			}
+			object.visible = object.inFrustum && !object.occluded;
+
+			if (mesh_data.active) {
+				stats.frustumCulled += object.inFrustum ? 0 : 1;
+				stats.occluded += object.occluded ? 1 : 0;
+			}
+		}
+
+		stats.cullingTime = timer.deltaTimeFromLastTic<Timer::nano>() * 1e-6;
+		culling_stats = stats;
+	}
+
+	void MultiMeshManager::issueOcclusionQueries(const Camera & eye)
+	{
+		// Boxes are slightly enlarged so that flat objects are not hidden by their own depth.
+		const float margin = 1e-3f * culling_bvh.bounds().diagonal().norm();
+
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		glDepthMask(GL_FALSE);
+
+		uint id = 0;
+		for (const auto & mesh_data : list_meshes) {
+			CullingObject & object = *culling_order[id++];
+			if (!mesh_data.active || !object.inFrustum || object.queryPending || object.box.isEmpty()
+				|| !mesh_data.depthTest || mesh_data.invertDepthTest) {
+				continue;
+			}
+			if (object.query == 0) {
+				glGenQueries(1, &object.query);
+			}
+
+			const Vector3f boxMin = object.box.min().array() - margin;
+			const Vector3f boxSize = object.box.sizes().array() + 2.0f * margin;
+			occlusion_box.transformation = (Eigen::Translation3f(boxMin) * Eigen::Scaling(boxSize)).matrix();
+
+			glBeginQuery(GL_ANY_SAMPLES_PASSED, object.query);
+			colored_mesh_shader.render(eye, occlusion_box);
+			glEndQuery(GL_ANY_SAMPLES_PASSED);
+			object.queryPending = true;
+		}
+
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		glDepthMask(GL_TRUE);
+	}
+
+	void MultiMeshManager::invalidateCulling()
+	{
+		for (auto & object : culling_objects) {
+			if (object.second.query) {
+				glDeleteQueries(1, &object.second.query);
+			}
+		}
+		culling_objects.clear();
+		culling_order.clear();
+	}
+
 	void MultiMeshManager::list_mesh_onGUI()
 	{
 		Iterator swap_it_src, swap_it_dst;
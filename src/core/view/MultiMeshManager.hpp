@@ -17,8 +17,10 @@
 #include <core/view/ViewBase.hpp>
 #include <core/view/InteractiveCameraHandler.hpp>
 #include <core/raycaster/CameraRaycaster.hpp>
+#include <core/graphics/SceneBVH.hpp>
 
 #include <list>
+#include <map>
 
 namespace sibr {
 
@@ -82,6 +84,7 @@ namespace sibr {
 
 	protected:
 		GLuniform<Vector3f>	user_color; ///< user-defined constant color.
+		GLuniform<Matrix4f>	position_decode; ///< Compact vertex format position decoding.
 	};
 
 	/** Shader wrapper for sending mesh display options to the GPU (while avoiding duplicated uniforms) .
@@ -137,6 +140,7 @@ namespace sibr {
 	protected:
 		GLuniform<Vector3f>		light_position; ///< Light position for shading.
 		GLuniform<bool>			phong_shading, use_mesh_color; ///< Should the mesh be shaded, which color should be used.
+		GLuniform<bool>			oct_normals; ///< Are normals stored in the compact vertex format.
 	};
 
 	/** Shader wrapper for sending mesh display options to the GPU (while avoiding duplicated uniforms) .
@@ -163,6 +167,30 @@ namespace sibr {
 		GLuniform<float> normals_size; ///< Normal line length.
 	};
 
+	/** Shader wrapper for sending mesh display options to the GPU (while avoiding duplicated uniforms) .
+	 * Adds normals decoding for per-vertex normals. \sa NormalRenderingShader
+	  \ingroup sibr_view
+	 */
+	class SIBR_VIEW_EXPORT VertexNormalRenderingShader : public NormalRenderingShader {
+	public:
+		/** Initialize the shader.
+		 *\param name the shader name
+		 *\param vert the vertex shader content
+		 *\param frag the fragment shader ocntent
+		 *\param geom the geometry shader content
+		 */
+		void initShader(const std::string & name, const std::string & vert, const std::string & frag, const std::string & geom = "") override;
+
+		/* Set uniforms based on the camera position and mesh options.
+		 * \param eye the current viewpoint
+		 * \param data the mesh display options
+		 */
+		virtual void setUniforms(const Camera & eye, const MeshData & data) override;
+
+	protected:
+		GLuniform<bool> oct_normals; ///< Are normals stored in the compact vertex format.
+	};
+
 
 	/** Helper class containing all information relative to how to render a mesh for debugging purpose in a MultiMeshManager.
 	 * You can chain setters to modify multiple properties sequentially (chaining).
@@ -293,6 +321,8 @@ namespace sibr {
 	 * useful for debugging purposes for instance.
 	 * The API supports chaining when setting mesh display options. You can for instance do:
 	 * manager.addMesh("my mesh", mesh).setDepthtest(true).setAlpha(0.5f); 
+	 * Only the objects intersecting the view frustum are drawn, using a bounding volume hierarchy over the objects boxes.
+	 * Objects hidden by others can also be skipped, based on occlusion queries issued at the previous frame.
 	  \ingroup sibr_view
 	*/
 	class SIBR_VIEW_EXPORT MultiMeshManager : public ViewBase {
@@ -305,6 +335,9 @@ namespace sibr {
 		\note Requires an OpenGL context setup
 		*/
 		MultiMeshManager(const std::string & _name = "MultiMeshManager");
+
+		/** Destructor. */
+		virtual ~MultiMeshManager();
 	
 		/** Add a mesh to the visualization.
 		\param name name used for the object, if it already exist it will update the geometry and preserve display options
@@ -388,8 +421,47 @@ namespace sibr {
 		/** \return the colored mesh shader */
 		MeshShadingShader & getMeshShadingShader() { return colored_mesh_shader; }
 
+		/** Visibility culling statistics of a frame. */
+		struct CullingStats {
+			size_t objects = 0; ///< Active objects.
+			size_t frustumCulled = 0; ///< Active objects outside the view frustum.
+			size_t occluded = 0; ///< Active objects hidden at the last occlusion test.
+			size_t drawCalls = 0; ///< Draw calls submitted, normals included.
+			size_t boxTests = 0; ///< Frustum tests performed in the hierarchy.
+			bool occlusionActive = false; ///< Was occlusion culling applied.
+			double cullingTime = 0.0; ///< CPU time spent culling, in milliseconds.
+		};
+
+		/** \return true if the objects outside the view frustum are skipped, can be modified */
+		bool & frustumCulling() { return frustum_culling; }
+
+		/** \return true if the objects hidden by others at the previous frame are skipped, can be modified
+		 * \note Objects appear one frame late when they get disoccluded. No object is skipped while transparent objects are displayed.
+		 */
+		bool & occlusionCulling() { return occlusion_culling; }
+
+		/** \return the culling statistics of the last frame */
+		const CullingStats & cullingStats() const { return culling_stats; }
+
+		/** Recompute all object boxes, to call after modifying the vertices of a displayed mesh in place. */
+		void invalidateCulling();
+
 	protected:
 
+		/** Culling state of a displayed object. */
+		struct CullingObject {
+			Mesh::Ptr			mesh; ///< Geometry the boxes were computed for.
+			Matrix4f			transformation = Matrix4f::Identity(); ///< Transformation the world box was computed for.
+			float				normalsLength = -1.0f; ///< Normal lines length the world box was extended by.
+			Eigen::AlignedBox3f	localBox; ///< Geometry box.
+			Eigen::AlignedBox3f	box; ///< World box.
+			bool				inFrustum = true; ///< Does the world box intersect the frustum.
+			bool				visible = true; ///< Should the object be drawn this frame.
+			bool				occluded = false; ///< Result of the last occlusion test.
+			GLuint				query = 0; ///< Occlusion query of the world box.
+			bool				queryPending = false; ///< Has the query been issued without its result being read.
+		};
+
 		/** Helper to add some geometry to the view. 
 		\param data the object to add
 		\param update_raycaster should the associated raycaster be updated with the new geometry
@@ -403,6 +475,16 @@ namespace sibr {
 		/** Render all the registered meshes. */
 		void renderMeshes();
 
+		/** Update the object boxes and hierarchy, and decide which objects should be drawn.
+		 * \param eye the current viewpoint
+		 */
+		void updateCulling(const Camera & eye);
+
+		/** Test the world boxes of the objects in the frustum against the current depth buffer, results are used at the next frame.
+		 * \param eye the current viewpoint
+		 */
+		void issueOcclusionQueries(const Camera & eye);
+
 		/** Generate the list of objects in the GUI panel of the view. */
 		void list_mesh_onGUI();
 
@@ -418,9 +500,19 @@ namespace sibr {
 
 		PointShader							points_shader; ///< Shader for points.
 		MeshShadingShader					colored_mesh_shader; ///< Shader for meshes.
-		NormalRenderingShader				per_vertex_normals_shader, per_triangle_normals_shader; ///< Shaders for visualizing an object normals.
+		VertexNormalRenderingShader			per_vertex_normals_shader; ///< Shader for visualizing an object vertex normals.
+		NormalRenderingShader				per_triangle_normals_shader; ///< Shader for visualizing an object face normals.
 
 		Vector3f							backgroundColor = { 0.7f, 0.7f, 0.7f }; ///< Background clear color.
+
+		bool								frustum_culling = true; ///< Skip objects outside the frustum.
+		bool								occlusion_culling = false; ///< Skip objects hidden at the previous frame.
+		std::map<std::string, CullingObject>	culling_objects; ///< Culling state of each object, by name.
+		std::vector<CullingObject *>		culling_order; ///< Culling state of the objects in the order of list_meshes, indexed by the hierarchy.
+		SceneBVH							culling_bvh; ///< Hierarchy over the object world boxes.
+		std::vector<uint>					culling_visible; ///< Objects in the frustum.
+		CullingStats						culling_stats; ///< Last frame statistics.
+		MeshData							occlusion_box; ///< Unit cube rendered for occlusion queries.
 	};
 
-}
\ No newline at end of file
+}
@@ -467,6 +467,9 @@ namespace sibr
 		MultiViewBase::onRender(win);
 
 		_fpsCounter.update(_showGUI);
+		if (_showGUI) {
+			_memoryPanel.render();
+		}
 	}
 
 	void MultiViewManager::onGui(Window & win)
@@ -551,6 +554,9 @@ namespace sibr
 				if (ImGui::MenuItem("Metrics", "", _fpsCounter.active())) {
 					_fpsCounter.toggleVisibility();
 				}
+				if (ImGui::MenuItem("Memory", "", _memoryPanel.active())) {
+					_memoryPanel.toggleVisibility();
+				}
 				if (ImGui::BeginMenu("Front when focus"))
 				{
 					for (auto & subview : _subViews) {
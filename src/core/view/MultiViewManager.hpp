@@ -29,6 +29,7 @@
 # include "core/view/ViewBase.hpp"
 # include "core/graphics/Shader.hpp"
 # include "core/view/FPSCounter.hpp"
+# include "core/view/MemoryPanel.hpp"
 #include "core/video/FFmpegVideoEncoder.hpp"
 #include "InteractiveCameraHandler.hpp"
 #include <random>
@@ -423,6 +424,7 @@ namespace sibr
 
 		Window& _window; ///< The OS window.
 		FPSCounter _fpsCounter; ///< A FPS counter.
+		MemoryPanel _memoryPanel; ///< Memory usage and budgets panel.
 		bool _showGUI = true; ///< Should the GUI be displayed.
 
 	};
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#include "core/view/PathBenchmark.hpp"
+#include "core/graphics/PassProfiler.hpp"
+#include "core/graphics/RenderTarget.hpp"
+#include "core/graphics/Utils.hpp"
+#include "core/system/SimpleTimer.hpp"
+#include "core/system/Utils.hpp"
+
+#include "picojson/picojson.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+
+namespace sibr
+{
+	namespace {
+		picojson::value toJson(const PathBenchmark::Stats & stats)
+		{
+			picojson::object obj;
+			obj["min"] = picojson::value(stats.min);
+			obj["mean"] = picojson::value(stats.mean);
+			obj["p50"] = picojson::value(stats.p50);
+			obj["p95"] = picojson::value(stats.p95);
+			obj["p99"] = picojson::value(stats.p99);
+			obj["max"] = picojson::value(stats.max);
+			return picojson::value(obj);
+		}
+
+		picojson::value toJson(const std::vector<double> & samples)
+		{
+			picojson::array arr;
+			arr.reserve(samples.size());
+			for (const double sample : samples) {
+				arr.emplace_back(sample);
+			}
+			return picojson::value(arr);
+		}
+	}
+
+	PathBenchmark::PathBenchmark(const std::vector<Camera> & path, const Vector2u & resolution, uint warmupFrames, uint repetitions)
+		: _path(path), _resolution(resolution), _warmupFrames(warmupFrames), _repetitions(std::max(repetitions, 1u))
+	{
+	}
+
+	void PathBenchmark::run(ViewBase & view)
+	{
+		_frameTimes.clear();
+		_cpuTimes.clear();
+		_gpuTimes.clear();
+		_passTimes.clear();
+		if (_path.empty()) {
+			SIBR_WRG << "[PathBenchmark] Empty camera path, nothing to measure." << std::endl;
+			return;
+		}
+
+		RenderTargetRGBA32F frame(_resolution.x(), _resolution.y());
+		// Frames are timed with timestamps, elapsed time queries can't contain the pass queries.
+		std::array<GLuint, 2> frameQueries;
+		glGenQueries(2, frameQueries.data());
+		PassProfiler & profiler = PassProfiler::instance();
+
+		// Let the renderer and driver allocate their resources and fill caches.
+		// The profiler is enabled so that its queries are created before measuring.
+		profiler.enabled(true);
+		for (uint i = 0; i < _warmupFrames; ++i) {
+			frame.clear();
+			view.onRenderIBR(frame, _path[i % _path.size()]);
+			profiler.collect();
+		}
+		glFinish();
+
+		SIBR_LOG << "[PathBenchmark] Measuring " << _repetitions << "x" << _path.size() << " frames at "
+			<< _resolution.x() << "x" << _resolution.y() << "." << std::endl;
+		sibr::Timer timer;
+		for (uint r = 0; r < _repetitions; ++r) {
+			for (const Camera & camera : _path) {
+				timer.tic();
+				glQueryCounter(frameQueries[0], GL_TIMESTAMP);
+				frame.clear();
+				view.onRenderIBR(frame, camera);
+				glQueryCounter(frameQueries[1], GL_TIMESTAMP);
+				_cpuTimes.push_back(timer.deltaTimeFromLastTic<Timer::nano>() * 1e-6);
+				glFinish();
+				_frameTimes.push_back(timer.deltaTimeFromLastTic<Timer::nano>() * 1e-6);
+				GLuint64 frameStart = 0, frameEnd = 0;
+				glGetQueryObjectui64v(frameQueries[0], GL_QUERY_RESULT, &frameStart);
+				glGetQueryObjectui64v(frameQueries[1], GL_QUERY_RESULT, &frameEnd);
+				_gpuTimes.push_back(double(frameEnd - frameStart) * 1e-6);
+
+				// A pass executed several times in a frame is accumulated.
+				std::map<std::string, Vector2d> framePasses;
+				for (const PassProfiler::Pass & pass : profiler.collect()) {
+					auto it = framePasses.find(pass.name);
+					if (it == framePasses.end()) {
+						it = framePasses.emplace(pass.name, Vector2d(0.0, 0.0)).first;
+					}
+					it->second += Vector2d(pass.cpu, pass.gpu);
+				}
+				for (const auto & pass : framePasses) {
+					_passTimes[pass.first].cpu.push_back(pass.second.x());
+					_passTimes[pass.first].gpu.push_back(pass.second.y());
+				}
+			}
+		}
+		profiler.enabled(false);
+		glDeleteQueries(2, frameQueries.data());
+
+		_usedMem = getUsedMem();
+		_peakUsedMem = getPeakUsedMem();
+		_gpuUsedMem = getGPUUsedMem();
+
+		const Stats frameStats = statistics(_frameTimes);
+		const Stats gpuStats = statistics(_gpuTimes);
+		SIBR_LOG << "[PathBenchmark] Frame time p50/p95/p99: " << frameStats.p50 << "/" << frameStats.p95 << "/" << frameStats.p99
+			<< " ms, GPU time p50/p95/p99: " << gpuStats.p50 << "/" << gpuStats.p95 << "/" << gpuStats.p99 << " ms." << std::endl;
+	}
+
+	bool PathBenchmark::save(const std::string & filename, const std::map<std::string, std::string> & metadata) const
+	{
+		picojson::object root;
+		for (const auto & entry : metadata) {
+			root[entry.first] = picojson::value(entry.second);
+		}
+#ifdef SIBR_COMMIT_HASH
+		if (root.find("commit") == root.end()) {
+			root["commit"] = picojson::value(std::string(SIBR_COMMIT_HASH));
+		}
+#endif
+		picojson::array resolution;
+		resolution.emplace_back(double(_resolution.x()));
+		resolution.emplace_back(double(_resolution.y()));
+		root["resolution"] = picojson::value(resolution);
+		root["path_cameras"] = picojson::value(double(_path.size()));
+		root["warmup_frames"] = picojson::value(double(_warmupFrames));
+		root["repetitions"] = picojson::value(double(_repetitions));
+		root["frames"] = picojson::value(double(_frameTimes.size()));
+
+		root["frame_ms"] = toJson(statistics(_frameTimes));
+		root["cpu_ms"] = toJson(statistics(_cpuTimes));
+		root["gpu_ms"] = toJson(statistics(_gpuTimes));
+
+		picojson::object passes;
+		for (const auto & pass : _passTimes) {
+			picojson::object passObj;
+			passObj["frames"] = picojson::value(double(pass.second.cpu.size()));
+			passObj["cpu_ms"] = toJson(statistics(pass.second.cpu));
+			passObj["gpu_ms"] = toJson(statistics(pass.second.gpu));
+			passes[pass.first] = picojson::value(passObj);
+		}
+		root["passes"] = picojson::value(passes);
+
+		picojson::object memory;
+		memory["ram_mb"] = picojson::value(double(_usedMem) / 1024.0);
+		memory["ram_peak_mb"] = picojson::value(double(_peakUsedMem) / 1024.0);
+		if (_gpuUsedMem > 0) {
+			memory["gpu_mb"] = picojson::value(double(_gpuUsedMem) / 1024.0);
+		}
+		root["memory"] = picojson::value(memory);
+
+		picojson::object samples;
+		samples["frame_ms"] = toJson(_frameTimes);
+		samples["cpu_ms"] = toJson(_cpuTimes);
+		samples["gpu_ms"] = toJson(_gpuTimes);
+		root["samples"] = picojson::value(samples);
+
+		std::ofstream file(filename);
+		if (!file.is_open()) {
+			SIBR_WRG << "[PathBenchmark] Unable to write " << filename << "." << std::endl;
+			return false;
+		}
+		file << picojson::value(root).serialize(true);
+		SIBR_LOG << "[PathBenchmark] Results saved to " << filename << "." << std::endl;
+		return true;
+	}
+
+	PathBenchmark::Stats PathBenchmark::statistics(std::vector<double> samples)
+	{
+		Stats stats;
+		if (samples.empty()) {
+			return stats;
+		}
+		std::sort(samples.begin(), samples.end());
+		const size_t count = samples.size();
+		const auto percentile = [&samples, count](double p) {
+			const size_t rank = size_t(std::ceil(p / 100.0 * double(count)));
+			return samples[std::min(count, std::max(rank, size_t(1))) - 1];
+		};
+		stats.min = samples.front();
+		stats.max = samples.back();
+		double sum = 0.0;
+		for (const double sample : samples) {
+			sum += sample;
+		}
+		stats.mean = sum / double(count);
+		stats.p50 = percentile(50.0);
+		stats.p95 = percentile(95.0);
+		stats.p99 = percentile(99.0);
+		return stats;
+	}
+
+} // namespace sibr
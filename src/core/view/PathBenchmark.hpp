@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+
+#pragma once
+
+#include "core/view/Config.hpp"
+#include "core/view/ViewBase.hpp"
+#include "core/graphics/Camera.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sibr
+{
+	/** Replay a camera path through a view and measure frame times, to compare renderers
+	 * across commits and datasets. Each frame is rendered with ViewBase::onRenderIBR in an offscreen
+	 * target at a fixed resolution, after a few warm-up frames. The CPU submission time, the frame time
+	 * (until the GPU is done) and the GPU time are recorded, along with the passes reported by
+	 * renderers through PassProfiler. Results are saved to JSON.
+	 *
+	 * Code example:
+	 *
+	 *		camRecorder.loadPath(pathFile, w, h);
+	 *		PathBenchmark benchmark(camRecorder.cams(), Vector2u(w, h));
+	 *		benchmark.run(*ulrView);
+	 *		benchmark.save("ulr.json", { { "renderer", "ulr" } });
+	 *
+	 * \ingroup sibr_view
+	 */
+	class SIBR_VIEW_EXPORT PathBenchmark
+	{
+	public:
+
+		/** Statistics over frames, in milliseconds. Percentiles use the nearest rank. */
+		struct Stats {
+			double min = 0.0; ///< Minimum.
+			double mean = 0.0; ///< Average.
+			double p50 = 0.0; ///< Median.
+			double p95 = 0.0; ///< 95th percentile.
+			double p99 = 0.0; ///< 99th percentile.
+			double max = 0.0; ///< Maximum.
+		};
+
+		/** Timings of a pass, for the frames where it was executed. */
+		struct PassTimes {
+			std::vector<double> cpu; ///< CPU submission time, per frame.
+			std::vector<double> gpu; ///< GPU time, per frame.
+		};
+
+		/** Constructor.
+		 * \param path the cameras to replay
+		 * \param resolution the rendering resolution
+		 * \param warmupFrames number of frames rendered before measuring
+		 * \param repetitions number of times the path is replayed while measuring
+		 */
+		PathBenchmark(const std::vector<Camera> & path, const Vector2u & resolution, uint warmupFrames = 10, uint repetitions = 1);
+
+		/** Replay the path through a view, measuring each frame. Previous results are discarded.
+		 * \param view the view to benchmark
+		 */
+		void run(ViewBase & view);
+
+		/** Write the settings, statistics, per-frame timings and memory usage to a JSON file.
+		 * \param filename the output file
+		 * \param metadata additional entries (renderer, dataset,...)
+		 * \return false if the file couldn't be written
+		 */
+		bool save(const std::string & filename, const std::map<std::string, std::string> & metadata = {}) const;
+
+		/** Compute statistics over samples.
+		 * \param samples the samples
+		 * \return the statistics (all zeros if there are no samples)
+		 */
+		static Stats statistics(std::vector<double> samples);
+
+		/** \return the frame times, until the GPU is done, in ms */
+		const std::vector<double> & frameTimes() const { return _frameTimes; }
+
+		/** \return the CPU submission times, in ms */
+		const std::vector<double> & cpuTimes() const { return _cpuTimes; }
+
+		/** \return the GPU times, in ms */
+		const std::vector<double> & gpuTimes() const { return _gpuTimes; }
+
+		/** \return the timings of the passes reported by the renderers, by name */
+		const std::map<std::string, PassTimes> & passTimes() const { return _passTimes; }
+
+	private:
+
+		std::vector<Camera> _path; ///< Cameras to replay.
+		Vector2u _resolution; ///< Rendering resolution.
+		uint _warmupFrames; ///< Frames rendered before measuring.
+		uint _repetitions; ///< Number of replays of the path.
+
+		std::vector<double> _frameTimes; ///< Frame times.
+		std::vector<double> _cpuTimes; ///< CPU submission times.
+		std::vector<double> _gpuTimes; ///< GPU times.
+		std::map<std::string, PassTimes> _passTimes; ///< Pass timings.
+		size_t _usedMem = 0; ///< Process memory after the run, in Ko.
+		size_t _peakUsedMem = 0; ///< Process peak memory after the run, in Ko.
+		size_t _gpuUsedMem = 0; ///< GPU memory used after the run, in Ko (0 if unknown).
+	};
+
+} // namespace sibr
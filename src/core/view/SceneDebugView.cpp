@@ -159,10 +159,166 @@ namespace sibr
 		_mvpArray.init(_shaderArray, "mvp");
 		_alphaArray.init(_shaderArray, "alpha");
 		_sliceArray.init(_shaderArray, "slice");
+
+		const std::string instances_str = loadFile(Resources::Instance()->getResourceFilePathName("camera_instances.vert"));
+
+		_shaderInstanced2D.init("cameraImagesInstanced", instances_str, loadFile(Resources::Instance()->getResourceFilePathName("alpha_uv_tex.frag")));
+		_mvpInstanced2D.init(_shaderInstanced2D, "mvp");
+		_scaleInstanced2D.init(_shaderInstanced2D, "scale");
+		_alphaInstanced2D.init(_shaderInstanced2D, "alpha");
+
+		_shaderInstancedArray.init("cameraImagesInstancedArray", instances_str, loadFile(Resources::Instance()->getResourceFilePathName("alpha_uv_tex_array_instanced.frag")));
+		_mvpInstancedArray.init(_shaderInstancedArray, "mvp");
+		_scaleInstancedArray.init(_shaderInstancedArray, "scale");
+		_alphaInstancedArray.init(_shaderInstancedArray, "alpha");
+
+		_shaderFrustums.init("cameraFrustums",
+			loadFile(Resources::Instance()->getResourceFilePathName("camera_frustums.vert")),
+			loadFile(Resources::Instance()->getResourceFilePathName("camera_frustums.frag")));
+		_mvpFrustums.init(_shaderFrustums, "mvp");
+		_scaleFrustums.init(_shaderFrustums, "scale");
+		_usedColorFrustums.init(_shaderFrustums, "used_color");
+		_unusedColorFrustums.init(_shaderFrustums, "unused_color");
+	}
+
+	ImageCamViewer::~ImageCamViewer()
+	{
+		if (_camInstancesBuffer) {
+			glDeleteBuffers(1, &_camInstancesBuffer);
+			glDeleteBuffers(1, &_camStatesBuffer);
+			glDeleteVertexArrays(1, &_camInstancesVAO);
+		}
+	}
+
+	void ImageCamViewer::setupCamInstances(const std::vector<InputCamera::Ptr> & cams)
+	{
+		// Camera center followed by the four image corner directions, the frustum and
+		// image plane vertices are generated from them in the shaders.
+		const size_t floatsPerCam = 5 * 3;
+		std::vector<float> instances(cams.size() * floatsPerCam);
+
+#pragma omp parallel for
+		for (int i = 0; i < int(cams.size()); ++i) {
+			const InputCamera & cam = *cams[i];
+			float * dst = &instances[i * floatsPerCam];
+			Eigen::Map<Vector3f>(dst) = cam.position();
+			int k = 1;
+			for (const auto & c : cam.getImageCorners()) {
+				Eigen::Map<Vector3f>(dst + 3 * k) = CameraRaycaster::computeRayDir(cam, c.cast<float>() + 0.5f*Vector2f(1, 1));
+				++k;
+			}
+		}
+
+		if (!_camInstancesBuffer) {
+			glGenVertexArrays(1, &_camInstancesVAO);
+			glGenBuffers(1, &_camInstancesBuffer);
+			glGenBuffers(1, &_camStatesBuffer);
+
+			glBindVertexArray(_camInstancesVAO);
+			glBindBuffer(GL_ARRAY_BUFFER, _camInstancesBuffer);
+			for (GLuint a = 0; a < 5; ++a) {
+				glEnableVertexAttribArray(a);
+				glVertexAttribPointer(a, 3, GL_FLOAT, GL_FALSE, GLsizei(floatsPerCam * sizeof(float)), (void*)(a * 3 * sizeof(float)));
+				glVertexAttribDivisor(a, 1);
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, _camStatesBuffer);
+			glEnableVertexAttribArray(5);
+			glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, 0, (void*)0);
+			glVertexAttribDivisor(5, 1);
+			glBindVertexArray(0);
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, _camInstancesBuffer);
+		glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(float), instances.data(), GL_STATIC_DRAW);
+
+		// All cameras start hidden until their state is set.
+		_camStates.assign(cams.size(), 0);
+		glBindBuffer(GL_ARRAY_BUFFER, _camStatesBuffer);
+		glBufferData(GL_ARRAY_BUFFER, _camStates.size() * sizeof(uint), _camStates.data(), GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		_camInstancesCount = cams.size();
+		CHECK_GL_ERROR;
+	}
+
+	void ImageCamViewer::updateCamInstancesState(const std::vector<uint> & states)
+	{
+		if (!_camStatesBuffer || states.size() != _camInstancesCount || states == _camStates) {
+			return;
+		}
+		_camStates = states;
+		glBindBuffer(GL_ARRAY_BUFFER, _camStatesBuffer);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, _camStates.size() * sizeof(uint), _camStates.data());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void ImageCamViewer::renderFrustums(const Camera & eye, const Vector3f & usedColor, const Vector3f & unusedColor)
+	{
+		if (_camInstancesCount == 0) {
+			return;
+		}
+		_shaderFrustums.begin();
+		_mvpFrustums.set(eye.viewproj());
+		_scaleFrustums.set(_cameraScaling);
+		_usedColorFrustums.set(usedColor);
+		_unusedColorFrustums.set(unusedColor);
+		glEnable(GL_DEPTH_TEST);
+		glBindVertexArray(_camInstancesVAO);
+		// 8 edges per frustum.
+		glDrawArraysInstanced(GL_LINES, 0, 16, GLsizei(_camInstancesCount));
+		glBindVertexArray(0);
+		glDisable(GL_DEPTH_TEST);
+		_shaderFrustums.end();
+	}
+
+	void ImageCamViewer::renderImages(const Camera & eye, const std::vector<IRenderTarget::Ptr> & rts)
+	{
+		if (_camInstancesCount == 0) {
+			return;
+		}
+		_shaderInstanced2D.begin();
+		_mvpInstanced2D.set(eye.viewproj());
+		_scaleInstanced2D.set(_cameraScaling);
+		_alphaInstanced2D.set(_alphaImage);
+		glEnable(GL_DEPTH_TEST);
+		glActiveTexture(GL_TEXTURE0);
+		glBindVertexArray(_camInstancesVAO);
+		// One texture per camera: draw each instance separately, still without rebuilding any geometry.
+		const size_t count = std::min(_camInstancesCount, rts.size());
+		for (size_t i = 0; i < count; ++i) {
+			if (!rts[i] || !(_camStates[i] & CAM_ACTIVE)) {
+				continue;
+			}
+			glBindTexture(GL_TEXTURE_2D, rts[i]->handle());
+			glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 6, 1, GLuint(i));
+		}
+		glBindVertexArray(0);
+		glDisable(GL_DEPTH_TEST);
+		_shaderInstanced2D.end();
+	}
+
+	void ImageCamViewer::renderImages(const Camera & eye, uint tex2Darray_handle)
+	{
+		if (_camInstancesCount == 0) {
+			return;
+		}
+		_shaderInstancedArray.begin();
+		_mvpInstancedArray.set(eye.viewproj());
+		_scaleInstancedArray.set(_cameraScaling);
+		_alphaInstancedArray.set(_alphaImage);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, tex2Darray_handle);
+		glEnable(GL_DEPTH_TEST);
+		glBindVertexArray(_camInstancesVAO);
+		// Two triangles per camera, the array slice is the instance index.
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, GLsizei(_camInstancesCount));
+		glBindVertexArray(0);
+		glDisable(GL_DEPTH_TEST);
+		_shaderInstancedArray.end();
 	}
 
 	void ImageCamViewer::renderImage(const Camera & eye, const InputCamera & cam,
-		const std::vector<RenderTargetRGBA32F::Ptr> & rts, int cam_id)
+		const std::vector<IRenderTarget::Ptr> & rts, int cam_id)
 	{
 		const auto quad = generateCamQuadWithUvs(cam, _cameraScaling);
 		if (cam_id < rts.size() && rts[cam_id]) {
@@ -283,31 +439,25 @@ namespace sibr
 			}
 		}	
 
-		auto used_cams = std::make_shared<Mesh>(), non_used_cams = std::make_shared<Mesh>();
-		for (const auto & camInfos : _cameras) {
-			if (!camInfos.cam.isActive()) { continue; }
-			(camInfos.highlight ? used_cams : non_used_cams)->merge(*generateCamFrustum(camInfos.cam, 0.0f, _cameraScaling));
+		// Only the per-camera state flags can change from frame to frame.
+		std::vector<uint> camStates(_cameras.size(), 0);
+		for (size_t i = 0; i < _cameras.size(); ++i) {
+			camStates[i] = (_cameras[i].cam.isActive() ? CAM_ACTIVE : 0) | (_cameras[i].highlight ? CAM_HIGHLIGHT : 0);
 		}
-
-		addMeshAsLines("used cams", used_cams).setColor({ 0,1,0 });
-		addMeshAsLines("non used cams", non_used_cams).setColor({ 0,0,1 });
+		updateCamInstancesState(camStates);
 
 		renderMeshes();
 
+		renderFrustums(camera_handler.getCamera(), { 0,1,0 }, { 0,0,1 });
+
 		if (_scene && _showImages) {
 			glEnable(GL_BLEND);
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			int cam_id = 0;
-			for (const auto & camInfos : _cameras) {
-				if (camInfos.cam.isActive()) {
-					const auto & scene_rts = _scene->renderTargets();
-					if (scene_rts->getInputRGBTextureArrayPtr()) {
-						renderImage(camera_handler.getCamera(), camInfos.cam, scene_rts->getInputRGBTextureArrayPtr()->handle(), cam_id);
-					} else {
-						renderImage(camera_handler.getCamera(), camInfos.cam, scene_rts->inputImagesRT(), cam_id);
-					}
-				}
-				++cam_id;
+			const auto & scene_rts = _scene->renderTargets();
+			if (scene_rts->getInputRGBTextureArrayPtr()) {
+				renderImages(camera_handler.getCamera(), scene_rts->getInputRGBTextureArrayPtr()->handle());
+			} else {
+				renderImages(camera_handler.getCamera(), scene_rts->inputColorRTs());
 			}
 			glDisable(GL_BLEND);
 		}
@@ -479,6 +629,7 @@ namespace sibr
 			for (const auto & inputCam : _scene->cameras()->inputCameras()) {
 				_cameras.push_back(CameraInfos(*inputCam, inputCam->id(), _scene->cameras()->isCameraUsedForRendering(inputCam->id())));
 			}
+			setupCamInstances(_scene->cameras()->inputCameras());
 		}
 
 		_snapToImage = 0;
@@ -116,18 +116,58 @@ namespace sibr
 	 */
 	struct SIBR_VIEW_EXPORT ImageCamViewer {
 
+		/** Per-camera display state flags used for instanced rendering. */
+		enum CamInstanceState : uint {
+			CAM_ACTIVE = 1, ///< The camera is displayed.
+			CAM_HIGHLIGHT = 2 ///< The camera is used for rendering.
+		};
+
+		/** Destructor, release the per-camera instance buffers. */
+		~ImageCamViewer();
+
 	protected:
 
 		/** Initialize the shaders. */
 		void initImageCamShaders();
 
+		/** Upload the per-camera data (center and image corner directions) used to draw
+		 * all frusta and image planes in a single instanced draw call.
+		 * Only needed when the camera set changes, as the camera scaling is applied in the shaders.
+		 *\param cams the cameras
+		 */
+		void setupCamInstances(const std::vector<InputCamera::Ptr> & cams);
+
+		/** Update the display state of each camera, uploaded only if it changed.
+		 *\param states a combination of CamInstanceState flags for each camera
+		 */
+		void updateCamInstancesState(const std::vector<uint> & states);
+
+		/** Render the frusta of all active cameras.
+		 *\param eye the current viewpoint
+		 *\param usedColor color of highlighted cameras
+		 *\param unusedColor color of the other cameras
+		 */
+		void renderFrustums(const Camera & eye, const Vector3f & usedColor, const Vector3f & unusedColor);
+
+		/** Render the input images of all active cameras on their image planes.
+		 *\param eye the current viewpoint
+		 *\param rts input 2D textures list
+		 */
+		void renderImages(const Camera & eye, const std::vector<IRenderTarget::Ptr> & rts);
+
+		/** Render the input images of all active cameras on their image planes.
+		 *\param eye the current viewpoint
+		 *\param tex2Darray_handle input images texture array
+		 */
+		void renderImages(const Camera & eye, uint tex2Darray_handle);
+
 		/** Render one specific input image on a camera image plane.
 		 *\param eye the current viewpoint
 		 *\param cam the camera to show the image plane of
 		 *\param rts input 2D textures list
 		 *\param cam_id the list index associated to the camera
 		 */
-		void renderImage(const Camera & eye, const InputCamera & cam, const std::vector<RenderTargetRGBA32F::Ptr> & rts, int cam_id);
+		void renderImage(const Camera & eye, const InputCamera & cam, const std::vector<IRenderTarget::Ptr> & rts, int cam_id);
 
 		/** Render one specific input image on a camera image plane.
 		 *\param eye the current viewpoint
@@ -145,6 +185,19 @@ namespace sibr
 		GLuniform<int>				_sliceArray = 1; ///< Slice location (for the texture array case).
 		float						_alphaImage = 0.5f; ///< Opacity shared value.
 		float						_cameraScaling = 0.8f; ///< Camera scaling.
+
+		GLShader					_shaderFrustums; ///< Shader for instanced frusta.
+		GLShader					_shaderInstanced2D; ///< Shader for instanced image planes, 2D separate case.
+		GLShader					_shaderInstancedArray; ///< Shader for instanced image planes, texture array case.
+		GLuniform<sibr::Matrix4f>	_mvpFrustums, _mvpInstanced2D, _mvpInstancedArray; ///< MVP matrix.
+		GLuniform<float>			_scaleFrustums, _scaleInstanced2D, _scaleInstancedArray; ///< Camera scaling.
+		GLuniform<float>			_alphaInstanced2D = 1.0f, _alphaInstancedArray = 1.0f; ///< Opacity.
+		GLuniform<Vector3f>			_usedColorFrustums, _unusedColorFrustums; ///< Frusta colors.
+		GLuint						_camInstancesVAO = 0; ///< Per-camera attributes layout.
+		GLuint						_camInstancesBuffer = 0; ///< Per-camera center and corner directions.
+		GLuint						_camStatesBuffer = 0; ///< Per-camera state flags.
+		std::vector<uint>			_camStates; ///< Last uploaded state flags.
+		size_t						_camInstancesCount = 0; ///< Number of uploaded cameras.
 	};
 
 	/** Scene viewer for IBR scenes with a proxy, cameras and input images. 
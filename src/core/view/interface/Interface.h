@@ -14,10 +14,12 @@
 
 #include "../Config.hpp"
 #include <core/graphics/Texture.hpp>
+#include <core/graphics/ImagePyramid.hpp>
 #include <core/graphics/Input.hpp>
 #include <core/graphics/Window.hpp>
 #include <core/assets/InputCamera.hpp>
 #include <map>
+#include <numeric>
 #include "InterfaceUtils.h"
 #include "MeshViewer.h"
 #include <core/view/ViewBase.hpp>
@@ -207,31 +209,59 @@ namespace sibr {
 
 		template<typename T_Type, unsigned int T_NumComp>
 		bool checkNewLayer(const std::vector<sibr::Image<T_Type, T_NumComp> > & images) 
+		{
+			if (images.size() == 0) {
+				SIBR_ERR << "empty image vector" << std::endl;
+			}
+			return checkNewLayer(sibr::Vector2u(images[0].w(), images[0].h()), images.size());
+		}
+
+		bool checkNewLayer(const sibr::Vector2u & firstImageSize, size_t count)
 		{
 			if (imagesLayers.size() == 0) {
 				imagesLayers.resize(scalingOptions.numScale);
 				for (int scale = 0; scale < scalingOptions.numScale; ++scale) {
-					int w_s = static_cast<int>(std::ceil(images[0].w()*pow(2.0f, -scale)));
-					int h_s = static_cast<int>(std::ceil(images[0].h()*pow(2.0f, -scale)));
+					int w_s = (int)IImagePyramid::levelDimension(firstImageSize[0], scale);
+					int h_s = (int)IImagePyramid::levelDimension(firstImageSize[1], scale);
 					scalesData.push_back(ScaleData(sibr::Vector2i(w_s, h_s)));
 				}
-				numImgs = (int)images.size();
+				numImgs = (int)count;
 			}
 
 			const auto & baseScaleImageLayer = imagesLayers[0];
 			if (baseScaleImageLayer.size() > 0) {
-				if ((uint)images.size() != baseScaleImageLayer[0]->depth()) {
+				if ((uint)count != baseScaleImageLayer[0]->depth()) {
 					SIBR_ERR << "not enough images" << std::endl;
 				}
 			}
 
-			if (images.size() == 0) {
+			if (count == 0) {
 				SIBR_ERR << "empty image vector" << std::endl;
 			}
 
 			return true;
 		}
 
+		/** Downscale images to each scale, each scale being computed from the previous one.
+		 * \param images the full resolution images
+		 * \return the images for each scale above 0
+		 */
+		template<typename T_Type, unsigned int T_NumComp>
+		std::vector<std::vector<sibr::Image<T_Type, T_NumComp> > > downscaleImages(const std::vector<sibr::Image<T_Type, T_NumComp> > & images)
+		{
+			std::vector<std::vector<sibr::Image<T_Type, T_NumComp> > > scales(scalingOptions.numScale);
+			for (int scale = 1; scale < scalingOptions.numScale; ++scale) {
+				const std::vector<sibr::Image<T_Type, T_NumComp> > & previous = (scale == 1 ? images : scales[scale - 1]);
+				const sibr::Vector2i scaleSize = scalesData[scale].imSize.cast<int>();
+				scales[scale].resize(images.size());
+#pragma omp parallel for
+				for (int im = 0; im < (int)images.size(); ++im) {
+					scales[scale][im] = previous[im].resized(scaleSize[0], scaleSize[1], scalingOptions.interpolation_method_cv);
+				}
+			}
+			return scales;
+		}
+
 	public:
 
 		template<typename T_Type, unsigned int T_NumComp>
@@ -249,22 +279,16 @@ namespace sibr {
 			
 			checkNewLayer(images);
 
+			const auto resized_imgs = downscaleImages(images);
 			for (int scale = 0; scale < scalingOptions.numScale; ++scale) {
-				std::vector<sibr::Image<T_Type, T_NumComp> > resized_imgs(images.size());
-				if (scale != 0) {
-#pragma omp parallel for
-					for (int im = 0; im < (int)images.size(); ++im) {
-						const sibr::Vector2i scaleSize = scalesData[scale].imSize.cast<int>();
-						resized_imgs[im] = images[im].resized(scaleSize[0], scaleSize[1], scalingOptions.interpolation_method_cv);
-					}
-				} else {
+				if (scale == 0) {
 					std::vector<const sibr::IImage*> layerPtrs(images.size()); 
 					for (int im = 0; im < (int)images.size(); ++im) {
 						layerPtrs[im] = &images[im];
 					}
 					imagesPtr.push_back(layerPtrs);
 				}
-				const std::vector<sibr::Image<T_Type, T_NumComp> > & imgs = (scale == 0 ?  images : resized_imgs);
+				const std::vector<sibr::Image<T_Type, T_NumComp> > & imgs = (scale == 0 ?  images : resized_imgs[scale]);
 
 				sibr::Texture2DArray<T_Type, T_NumComp>::Ptr layer = std::make_shared<sibr::Texture2DArray<T_Type, T_NumComp>>();
 
@@ -280,6 +304,55 @@ namespace sibr {
 			
 		}
 
+		/** Add a layer from an image pyramid, that can be shared with other views.
+		 * Each scale is read from the corresponding pyramid level, only scales beyond the pyramid levels are resized.
+		 */
+		template<typename T_Type, unsigned int T_NumComp>
+		void addImageLayer(const std::shared_ptr<sibr::ImagePyramid<T_Type, T_NumComp> > & pyramid, const std::string & name = "")
+		{
+			checkNewLayer(pyramid->size(0, 0), (size_t)pyramid->count());
+
+			std::vector<int> all_imgs(pyramid->count());
+			std::iota(all_imgs.begin(), all_imgs.end(), 0);
+
+			for (int scale = 0; scale < scalingOptions.numScale; ++scale) {
+				const int level = std::min(scale, pyramid->levels() - 1);
+				pyramid->load(all_imgs, level);
+				std::vector<typename sibr::Image<T_Type, T_NumComp>::Ptr> imgs = pyramid->loaded(level);
+
+				if (scale == 0) {
+					// Keep the full resolution images alive even if the pyramid releases them.
+					std::vector<sibr::IImage::Ptr> firstLayerPtrs(imgs.size());
+					std::vector<const sibr::IImage*> layerPtrs(imgs.size());
+					for (int im = 0; im < (int)imgs.size(); ++im) {
+						firstLayerPtrs[im] = std::static_pointer_cast<IImage>(imgs[im].imPtr);
+						layerPtrs[im] = firstLayerPtrs[im].get();
+					}
+					imagesFromLambdasPtr.push_back(firstLayerPtrs);
+					imagesPtr.push_back(layerPtrs);
+				}
+
+				if (level != scale) {
+					const sibr::Vector2i scaleSize = scalesData[scale].imSize.cast<int>();
+#pragma omp parallel for
+					for (int im = 0; im < (int)imgs.size(); ++im) {
+						imgs[im] = typename sibr::Image<T_Type, T_NumComp>::Ptr(new sibr::Image<T_Type, T_NumComp>(imgs[im]->resized(scaleSize[0], scaleSize[1], scalingOptions.interpolation_method_cv)));
+					}
+				}
+
+				typename sibr::Texture2DArray<T_Type, T_NumComp>::Ptr layer = std::make_shared<sibr::Texture2DArray<T_Type, T_NumComp>>();
+				layer->createFromImages(imgs);
+				imagesLayers[scale].push_back(sibr::ITexture2DArray::Ptr(layer));
+				if (scale != 0) {
+					pyramid->evict(level);
+				}
+			}
+
+			std::string layerName = (name == "" ? "Layer" + std::to_string(layersData.size()) : name);
+			name_to_layer_map[layerName] = (int)layersData.size();
+			layersData.push_back(LayerData(layerName));
+		}
+
 		template<typename T_Type, unsigned int T_NumComp, typename LambdaType>
 		void addImageLayerWithLambda(const std::vector<sibr::Image<T_Type, T_NumComp> > & images, LambdaType lambda, const std::string & name = "") {
 			
@@ -289,16 +362,9 @@ namespace sibr {
 			using Lambda_Out_Type = Lambda_Out_Image_Type::Type;
 			const int Lambda_Out_N = Lambda_Out_Image_Type::e_NumComp;
 
+			const auto resized_imgs = downscaleImages(images);
 			for (int scale = 0; scale < scalingOptions.numScale; ++scale) {
-				std::vector<sibr::Image<T_Type, T_NumComp> > resized_imgs(images.size());
-				if (scale != 0) {
-#pragma omp parallel for
-					for (int im = 0; im < (int)images.size(); ++im) {
-						const sibr::Vector2i scaleSize = scalesData[scale].imSize.cast<int>();
-						resized_imgs[im] = images[im].resized(scaleSize[0], scaleSize[1], scalingOptions.interpolation_method_cv);
-					}
-				} 
-				const std::vector<sibr::Image<T_Type, T_NumComp> > & imgs = (scale == 0 ? images : resized_imgs);
+				const std::vector<sibr::Image<T_Type, T_NumComp> > & imgs = (scale == 0 ? images : resized_imgs[scale]);
 
 				std::vector<Lambda_Out_Image_Type> lambdaImgs(images.size());
 #pragma omp parallel for
@@ -22,9 +22,12 @@ out vec3 color;
 out vec3 normal;
 out vec3 position;                      
 
+#include "compact_vertex.glsl"
+
 void main(void) {
-    gl_Position = mvp * vec4(in_vertex, 1.0);
+    vec4 decoded = decodePosition(in_vertex);
+    gl_Position = mvp * decoded;
     color = in_color;
-    normal = in_normal;
-    position = in_vertex;
+    normal = decodeNormal(in_normal);
+    position = decoded.xyz;
 }
@@ -14,6 +14,8 @@
 
 layout(location = 0) in vec3 in_vertex;   
 
+#include "compact_vertex.glsl"
+
 void main(void) {
-    gl_Position = vec4(in_vertex, 1.0);
+    gl_Position = decodePosition(in_vertex);
 }
@@ -17,7 +17,9 @@ layout(location = 3) in vec3 in_normal;
 
 out vec3 normals;
 
+#include "compact_vertex.glsl"
+
 void main(void) {
-    gl_Position = vec4(in_vertex, 1.0);
-	normals = in_normal;
+    gl_Position = decodePosition(in_vertex);
+	normals = decodeNormal(in_normal);
 }
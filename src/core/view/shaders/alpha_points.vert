@@ -17,7 +17,9 @@ layout(location = 0) in vec3 in_vertex;
 uniform mat4 mvp;    
 uniform int radius;
 
+#include "compact_vertex.glsl"
+
 void main(void) {
-    gl_Position = mvp * vec4(in_vertex, 1.0);
+    gl_Position = mvp * decodePosition(in_vertex);
     gl_PointSize = radius;
 }
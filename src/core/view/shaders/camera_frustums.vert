@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use 
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+#version 420
+
+// Per-camera attributes (one instance per camera).
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec3 in_dir0;
+layout(location = 2) in vec3 in_dir1;
+layout(location = 3) in vec3 in_dir2;
+layout(location = 4) in vec3 in_dir3;
+layout(location = 5) in uint in_state;
+
+uniform mat4 mvp;
+uniform float scale;
+uniform vec3 used_color;
+uniform vec3 unused_color;
+
+out vec3 color;
+
+// Frustum edges, as line endpoints indexed by gl_VertexID: 0 is the camera center,
+// 1 to 4 the image corners at the scaling distance.
+const int corners[16] = int[16](1, 2, 2, 3, 3, 4, 4, 1, 0, 1, 0, 2, 0, 3, 0, 4);
+
+void main() {
+    color = (in_state & 2u) != 0u ? used_color : unused_color;
+    // Inactive cameras are moved outside of the clip volume.
+    if ((in_state & 1u) == 0u) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+    int corner = corners[gl_VertexID];
+    vec3 position = in_position;
+    if (corner > 0) {
+        vec3 dirs[4] = vec3[4](in_dir0, in_dir1, in_dir2, in_dir3);
+        position += scale * dirs[corner - 1];
+    }
+    gl_Position = mvp * vec4(position, 1.0);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2020, Inria
+ * GRAPHDECO research group, https://team.inria.fr/graphdeco
+ * All rights reserved.
+ *
+ * This software is free for non-commercial, research and evaluation use 
+ * under the terms of the LICENSE.md file.
+ *
+ * For inquiries contact sibr@inria.fr and/or George.Drettakis@inria.fr
+ */
+
+#version 420
+
+// Per-camera attributes (one instance per camera).
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec3 in_dir0;
+layout(location = 2) in vec3 in_dir1;
+layout(location = 3) in vec3 in_dir2;
+layout(location = 4) in vec3 in_dir3;
+layout(location = 5) in uint in_state;
+
+uniform mat4 mvp;
+uniform float scale;
+
+out vec2 out_uv;
+flat out int out_slice;
+
+// Image plane quad, as two triangles indexed by gl_VertexID.
+const int corners[6] = int[6](0, 1, 2, 0, 2, 3);
+const vec2 uvs[4] = vec2[4](vec2(0, 1), vec2(1, 1), vec2(1, 0), vec2(0, 0));
+
+void main() {
+    out_slice = gl_InstanceID;
+    int corner = corners[gl_VertexID];
+    out_uv = uvs[corner];
+    // Inactive cameras are moved outside of the clip volume.
+    if ((in_state & 1u) == 0u) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+    vec3 dirs[4] = vec3[4](in_dir0, in_dir1, in_dir2, in_dir3);
+    gl_Position = mvp * vec4(in_position + scale * dirs[corner], 1.0);
+}
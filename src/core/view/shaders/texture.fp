@@ -15,9 +15,11 @@
 layout(binding = 0) uniform sampler2D tex;
 layout(location= 0) out vec4 out_color;
 
+uniform bool flip = false;
+
 in vec2 tex_coord;
 
 void main(void) {
-    vec2 texcoord = tex_coord ;
+    vec2 texcoord = flip ? vec2(tex_coord.x, 1.0 - tex_coord.y) : tex_coord;
     out_color = texture(tex,texcoord);
 }
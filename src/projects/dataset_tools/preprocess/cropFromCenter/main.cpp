@@ -11,6 +11,7 @@
 
 
 #include <core/imgproc/CropScaleImageUtility.hpp>
+#include <core/imgproc/ImagePipeline.hpp>
 #include <core/system/CommandLineArgs.hpp>
 
 
@@ -22,7 +23,6 @@ if scale down factor is also passed, after the image has been cropped, it will b
 const char* USAGE = "Usage: cropFromCenter --inputFile <path_to_input_file> --outputPath <path_to_output_folder> --avgResolution <width x height> --cropResolution <width x height> [--scaleDownFactor <alpha> --targetResolution <width x height>] \n";
 //const char* USAGE						= "Usage: cropFromCenter --inputFile <path_to_input_file> --outputPath <path_to_output_folder> --avgResolution <width x height> --cropResolution <widht x height> [--scaleDownFactor <alpha> --targetResolution <width x height>] \n";
 const char* TAG = "[cropFromCenter]";
-const unsigned PROCESSING_BATCH_SIZE = 150;
 const char* LOG_FILE_NAME = "cropFromCenter.log";
 const char* SCALED_DOWN_SUBFOLDER = "scaled";
 const char* SCALED_DOWN_FILENAME = "scale_factor.txt";
@@ -118,60 +118,52 @@ int main(const int argc, const char** argv)
 	std::vector<sibr::CropScaleImageUtility::Image> listOfImages(pathToImgs.size());
 	std::vector<sibr::CropScaleImageUtility::Image> listOfImagesScaledDown(scaleDown ? pathToImgs.size() : 0);
 
-	// calculate nr batches
-	const int nrBatches = static_cast<int>(ceil((float)(pathToImgs.size()) / PROCESSING_BATCH_SIZE));
-
-	std::chrono::time_point <std::chrono::system_clock> start, end;
-	start = std::chrono::system_clock::now();
-
-	const int batchSize = int(PROCESSING_BATCH_SIZE);
-	// run batches sequentially
-	for (int batchId = 0; batchId < nrBatches; batchId++) {
-
-		const int nrItems = (batchId != nrBatches - 1) ? batchSize : ((nrBatches * batchSize != int(pathToImgs.size())) ? (int(pathToImgs.size()) - (batchSize * batchId)) : batchSize);
-
-		#pragma omp parallel for
-		for (int localImgIndex = 0; localImgIndex < nrItems; localImgIndex++) {
-
-			const int globalImgIndex = (batchId * batchSize) + localImgIndex;
+	// Decoding, cropping/resizing and encoding run concurrently, with a bounded number of images in flight.
+	std::vector<sibr::ImagePipeline::Task> tasks(pathToImgs.size());
+	for (size_t i = 0; i < pathToImgs.size(); ++i) {
+		tasks[i].path = pathToImgs[i];
+	}
 
-			// using next code will keep filename in output directory
-			boost::filesystem::path boostPath(pathToImgs[globalImgIndex]);
-			//std::string outputFileName = (outputFolder / boostPath.filename()).string();
+	const sibr::ImagePipeline pipeline;
+	const sibr::ImagePipeline::Stats stats = pipeline.run(tasks, [&](sibr::ImagePipeline::Item & item, std::vector<sibr::ImagePipeline::Output> & outputs) {
+		const cv::Mat & img = item.image;
+		const size_t globalImgIndex = item.id;
 
-			std::stringstream ss;
-			ss << std::setfill('0') << std::setw(8) << globalImgIndex << boostPath.extension().string();
-			std::string outputFileName = (outputFolder / ss.str()).string();
-			std::string scaledDownOutputFileName = (scaledDownOutputFolder / ss.str()).string();
+		// using next code will keep filename in output directory
+		boost::filesystem::path boostPath(pathToImgs[globalImgIndex]);
+		//std::string outputFileName = (outputFolder / boostPath.filename()).string();
 
-			cv::Mat img = cv::imread(pathToImgs[globalImgIndex], 1);
+		std::stringstream ss;
+		ss << std::setfill('0') << std::setw(8) << globalImgIndex << boostPath.extension().string();
+		std::string outputFileName = (outputFolder / ss.str()).string();
+		std::string scaledDownOutputFileName = (scaledDownOutputFolder / ss.str()).string();
 
-			cv::Rect areOfIntererst = cv::Rect((img.cols - cropResolution[0]) / 2, (img.rows - cropResolution[1]) / 2, cropResolution[0], cropResolution[1]);
+		cv::Rect areOfIntererst = cv::Rect((img.cols - cropResolution[0]) / 2, (img.rows - cropResolution[1]) / 2, cropResolution[0], cropResolution[1]);
 
-			cv::Mat croppedImg = img(areOfIntererst);
+		cv::Mat croppedImg = img(areOfIntererst);
 
-			cv::imwrite(outputFileName, croppedImg);
+		outputs.push_back({ outputFileName, croppedImg });
 
-			listOfImages[globalImgIndex].filename = ss.str();
-			listOfImages[globalImgIndex].width = croppedImg.cols;
-			listOfImages[globalImgIndex].height = croppedImg.rows;
+		listOfImages[globalImgIndex].filename = ss.str();
+		listOfImages[globalImgIndex].width = croppedImg.cols;
+		listOfImages[globalImgIndex].height = croppedImg.rows;
 
-			if (scaleDown) {
-				cv::Mat resizedImg;
-				cv::resize(croppedImg, resizedImg, resizedSize, 0, 0, cv::INTER_LINEAR);
+		if (scaleDown) {
+			cv::Mat resizedImg;
+			cv::resize(croppedImg, resizedImg, resizedSize, 0, 0, cv::INTER_LINEAR);
 
-				cv::imwrite(scaledDownOutputFileName, resizedImg);
+			outputs.push_back({ scaledDownOutputFileName, resizedImg });
 
-				listOfImagesScaledDown[globalImgIndex].filename	= ss.str();
-				listOfImagesScaledDown[globalImgIndex].width	= resizedImg.cols;
-				listOfImagesScaledDown[globalImgIndex].height	= resizedImg.rows;
-			}
+			listOfImagesScaledDown[globalImgIndex].filename	= ss.str();
+			listOfImagesScaledDown[globalImgIndex].width	= resizedImg.cols;
+			listOfImagesScaledDown[globalImgIndex].height	= resizedImg.rows;
 		}
-	}
+		return true;
+	});
 
-	end = std::chrono::system_clock::now();
-	auto elapsedTime = std::chrono::duration_cast<std::chrono::seconds>(end - start).count();
+	const long long elapsedTime = static_cast<long long>(stats.wallTime);
 
+	stats.log(TAG);
 	std::cout << TAG << " elapsed time=" << elapsedTime << "s.\n";
 
 	appUtility.logExecution(avgInitialResolution, int(pathToImgs.size()), elapsedTime, scaleDown, LOG_FILE_NAME);
@@ -17,6 +17,8 @@
 #include <core/raycaster/CameraRaycaster.hpp>
 #include <core/assets/ImageListFile.hpp>
 #include <core/system/Utils.hpp>
+#include <core/system/SimpleTimer.hpp>
+#include <core/graphics/ImageInfo.hpp>
 
 
 #define PROGRAM_NAME "prepareColmap4Sibr"
@@ -64,6 +66,15 @@ int main(const int argc, const char** argv)
 
 		outputSceneMetadata << "[list_images]\n<filename> <image_width> <image_height> <near_clipping_plane> <far_clipping_plane>" << std::endl;
 
+		// only the image sizes are needed, read them from the headers in parallel
+		sibr::Timer timer(true);
+		std::vector<sibr::Vector2i> sizes(cams.size());
+		#pragma omp parallel for
+		for (int c = 0; c < int(cams.size()); c++) {
+			sizes[c] = sibr::readImageSize(cm_path + "/images/" + cams[c]->name());
+		}
+		SIBR_LOG << "Read " << cams.size() << " image sizes in " << timer.deltaTimeFromLastTic<>() << "ms." << std::endl;
+
 		for (int c = 0; c < cams.size(); c++) {
 			InputCamera & camIm = *cams[c];
 
@@ -71,14 +82,12 @@ int main(const int argc, const char** argv)
 			std::ostringstream ssZeroPad;
 			ssZeroPad << std::setw(8) << std::setfill('0') << camIm.id();
 			std::string newFileName = ssZeroPad.str() + extensionFile;
-			// load image
 			std::string imgpath = cm_path + "/images/" + camIm.name();
-			sibr::ImageRGB im;
-			if (!im.load(imgpath, false))
+			if (sizes[c].x() == 0 || sizes[c].y() == 0)
 				SIBR_ERR << "Cant open image " << imgpath << std::endl;
 
-			std::cerr << newFileName << " " << im.w() << " " << im.h() << " " << camIm.znear() << " " << camIm.zfar() << std::endl;
-			outputSceneMetadata << newFileName << " " << im.w() << " " << im.h() << " " << camIm.znear() << " " << camIm.zfar() << std::endl;
+			std::cerr << newFileName << " " << sizes[c].x() << " " << sizes[c].y() << " " << camIm.znear() << " " << camIm.zfar() << std::endl;
+			outputSceneMetadata << newFileName << " " << sizes[c].x() << " " << sizes[c].y() << " " << camIm.znear() << " " << camIm.zfar() << std::endl;
 		}
 
 		outputSceneMetadata << "\n// Always specify active/exclude images after list images\n\n[exclude_images]\n<image1_idx> <image2_idx> ... <image3_idx>" << std::endl;
@@ -129,15 +138,27 @@ int main(const int argc, const char** argv)
 		return a->id() < b->id();
 	});
 
+	std::vector<std::string> newFileNames(cams.size());
 	for (int c = minCam; c < maxCam; c++) {
-		InputCamera & camIm = *cams[c];
-
-		std::string extensionFile = boost::filesystem::extension(camIm.name());
 		std::ostringstream ssZeroPad;
-		ssZeroPad << std::setw(8) << std::setfill('0') << camIm.id();
-		std::string newFileName = ssZeroPad.str() + extensionFile;
+		ssZeroPad << std::setw(8) << std::setfill('0') << cams[c]->id();
+		newFileNames[c] = ssZeroPad.str() + boost::filesystem::extension(cams[c]->name());
+	}
+
+	// images are copied as is, no need to decode them
+	sibr::Timer timer(true);
+	#pragma omp parallel for
+	for (int c = minCam; c < maxCam; c++) {
+		boost::filesystem::copy_file(pathScene + "/colmap/stereo/images/" + cams[c]->name(), pathScene + "/sfm_mvs_cm/" + newFileNames[c], boost::filesystem::copy_option::overwrite_if_exists);
+	}
+	const double copyTime = timer.deltaTimeFromLastTic<sibr::Timer::milli>() / 1000.0;
+	const int copiedCams = maxCam - minCam;
+	SIBR_LOG << "Copied " << copiedCams << " images in " << copyTime << "s (" << (copyTime > 0.0 ? copiedCams / copyTime : 0.0) << " images/s)." << std::endl;
+
+	for (int c = minCam; c < maxCam; c++) {
+		InputCamera & camIm = *cams[c];
+		const std::string & newFileName = newFileNames[c];
 
-		boost::filesystem::copy_file(pathScene + "/colmap/stereo/images/" + camIm.name(), pathScene + "/sfm_mvs_cm/" + newFileName, boost::filesystem::copy_option::overwrite_if_exists);
 		// keep focal
 		outputBundleCam << camIm.toBundleString(false, true);
 		outputListIm << newFileName << " " << camIm.w() << " " << camIm.h() << std::endl;
@@ -15,6 +15,10 @@
 #include "core/graphics/Image.hpp"
 #include "core/graphics/Mesh.hpp"
 #include "core/imgproc/MeshTexturing.hpp"
+#include "core/imgproc/ImagePipeline.hpp"
+#include "core/imgproc/ToneMapper.hpp"
+#include "core/imgproc/ExrScanlineReader.hpp"
+#include "core/system/SimpleTimer.hpp"
 #include "core/scene/BasicIBRScene.hpp"
 
 using namespace sibr;
@@ -26,20 +30,37 @@ struct TonemapperAppArgs : virtual AppArgs {
 	Arg<std::string> outputExtension = { "ext", "png", "output files extension" };
 	Arg<float> exposure = { "exposure", 1.0f, "exposure value" };
 	Arg<float> gamma = { "gamma", 2.2f, "gamma value" };
+	Arg<std::string> curve = { "curve", "exponential", "tonemapping curve (exponential, reinhard or filmic)" };
+	Arg<bool> srgb = { "srgb", "apply the sRGB transfer function instead of gamma" };
+	Arg<int> streamRows = { "streamRows", 0, "process uncompressed EXR images this many rows at a time to bound memory usage (0 to load whole images)" };
 };
 
-void tonemap(const sibr::ImageRGB32F& hdrImg, sibr::ImageRGB& ldrImg, float exposure, float gamma) {
-	const cv::Mat & tonemaped = hdrImg.toOpenCV();
-	const cv::Mat exposed = -exposure * tonemaped;
-	cv::Mat tonemaped2;
-	cv::exp(exposed, tonemaped2);
-	tonemaped2 = cv::Scalar(1.0f, 1.0f, 1.0f) - tonemaped2;
-	if (gamma > 0.0f) {
-		cv::pow(tonemaped2, 1.0f / gamma, tonemaped2);
+/** Tonemap an EXR image a few rows at a time, only the 8 bits result is stored entirely.
+ * \return false if the image couldn't be streamed.
+ */
+bool tonemapStreaming(const std::string & src, const std::string & dst, const ToneMapper & toneMapper, int rowsPerBlock) {
+	ExrScanlineReader reader;
+	if (!reader.open(src)) {
+		return false;
+	}
+	cv::Mat ldrImg(reader.height(), reader.width(), CV_8UC3);
+	cv::Mat rows;
+	int y = 0;
+	int count;
+	while ((count = reader.readRows(rows, rowsPerBlock)) > 0) {
+		toneMapper.process(rows);
+		cv::Mat ldrRows = ldrImg.rowRange(y, y + count);
+		rows.convertTo(ldrRows, CV_8UC3, 255.0f);
+		y += count;
+	}
+	if (y != reader.height()) {
+		SIBR_WRG << "[Tonemapper] Unable to stream " << src << ", loading the whole image instead." << std::endl;
+		return false;
 	}
-	cv::Mat tonemapedRGB;
-	tonemaped2.convertTo(tonemapedRGB, CV_8UC3, 255.0f);
-	ldrImg.fromOpenCV(tonemapedRGB);
+	if (!cv::imwrite(dst, ldrImg)) {
+		SIBR_WRG << "[Tonemapper] Unable to write " << dst << std::endl;
+	}
+	return true;
 }
 
 int main(int ac, char** av) {
@@ -68,16 +89,44 @@ int main(int ac, char** av) {
 
 	const auto files = sibr::listFiles(inputPath, false, false, { "exr" });
 
-	for (const auto& file : files) {
+	ToneMapper::Curve curve = ToneMapper::Curve::EXPONENTIAL;
+	if (!ToneMapper::parseCurve(args.curve, curve)) {
+		SIBR_ERR << "Unknown tonemapping curve " << args.curve.get() << std::endl;
+	}
+	const ToneMapper toneMapper(args.exposure, args.gamma, curve, args.srgb ? ToneMapper::Encoding::SRGB : ToneMapper::Encoding::GAMMA);
+
+	std::vector<ImagePipeline::Task> tasks;
+	std::vector<std::string> dsts;
+	const int streamRows = args.streamRows;
+	sibr::Timer timer(true);
+	size_t streamedCount = 0;
+	for (const auto & file : files) {
 		const std::string src = inputPath + "/" + file;
 		const std::string dst = outputPath + "/" + sibr::removeExtension(file) + extension;
-
-		sibr::ImageRGB32F hdrImg;
-		sibr::ImageRGB ldrImg;
-		hdrImg.load(src);
-		tonemap(hdrImg, ldrImg, args.exposure, args.gamma);
-		ldrImg.save(dst);
+		// Large images are streamed one after the other, rows being processed in parallel.
+		if (streamRows > 0 && tonemapStreaming(src, dst, toneMapper, streamRows)) {
+			++streamedCount;
+			continue;
+		}
+		ImagePipeline::Task task;
+		task.path = src;
+		tasks.push_back(task);
+		dsts.push_back(dst);
 	}
+	if (streamRows > 0) {
+		SIBR_LOG << "[Tonemapper] Streamed " << streamedCount << " images in " << timer.deltaTimeFromLastTic<>() / 1000.0 << "s." << std::endl;
+	}
+
+	// Other images are decoded, tonemapped and encoded concurrently.
+	// Load as 3-channels float images, as ImageRGB32F does.
+	ImagePipeline::Options options;
+	options.readFlags = cv::IMREAD_ANYDEPTH | cv::IMREAD_COLOR;
+	const ImagePipeline pipeline(options);
+	const ImagePipeline::Stats stats = pipeline.run(tasks, [&](ImagePipeline::Item & item, std::vector<ImagePipeline::Output> & outputs) {
+		outputs.push_back({ dsts[item.id], toneMapper.toLDR(item.image) });
+		return true;
+	});
+	stats.log("[Tonemapper]");
 
 	return 0;
 }
@@ -26,6 +26,7 @@ struct UVMapperArgs : public AppArgs {
 	Arg<std::string> output = { "output", "", "path to the output mesh" };
 	Arg<int> size = { "size", 4096, "target UV map width (approx.)" };
 	Arg<bool> visu = { "visu", "save visualisation" };
+	Arg<int> threads = { "threads", 0, "number of threads (0 for all cores, 1 to unwrap the mesh as a whole)" };
 	Arg<std::string> textureName = { "texture-name", "TEXTURE_NAME_TO_PUT_IN_THE_FILE", "name of the texture to reference in the output mesh (Meshlab compatible)" };
 };
 
@@ -47,7 +48,7 @@ int main(int ac, char ** av){
 		mesh.load(args.path);
 	}
 
-	UVUnwrapper unwrapper(mesh, uint32_t(args.size));
+	UVUnwrapper unwrapper(mesh, uint32_t(args.size), uint32_t(std::max(0, args.threads.get())));
 	auto finalMesh = unwrapper.unwrap();
 	finalMesh->save(outputFile, true, args.textureName);
 	
@@ -17,6 +17,7 @@
 #include <core/scene/BasicIBRScene.hpp>
 #include <core/raycaster/Raycaster.hpp>
 #include <core/view/SceneDebugView.hpp>
+#include <core/view/PathBenchmark.hpp>
 
 #define PROGRAM_NAME "sibr_texturedMesh_app"
 using namespace sibr;
@@ -31,6 +32,7 @@ struct TexturedMeshAppArgs :
 	Arg<std::string> textureImagePath = { "texture", "" ,"texture path"};
 	Arg<std::string> meshPath = { "mesh", "", "mesh path" };
 	Arg<bool> noScene = { "noScene" };
+	Arg<int> uploadBudget = { "upload-budget", 0, "with noScene, upload the mesh progressively, at most this many MB each time it is drawn" };
 };
 
 // order textured, mesh {obj} then mesh.ply
@@ -137,6 +139,9 @@ int main( int ac, char** av )
 		if (myArgs.noScene) {
 			Mesh::Ptr newMesh(new Mesh(true));
 			newMesh->load(meshPath);
+			if (myArgs.uploadBudget > 0) {
+				newMesh->uploadBudget(size_t(myArgs.uploadBudget) * 1024 * 1024);
+			}
 			scene->proxies()->replaceProxyPtr(newMesh);
 		}
 
@@ -175,7 +180,13 @@ int main( int ac, char** av )
 
 		if (myArgs.pathFile.get() !=  "" ) {
 			generalCamera->getCameraRecorder().loadPath(myArgs.pathFile.get(), usedResolution.x(), usedResolution.y());
-			generalCamera->getCameraRecorder().recordOfflinePath(myArgs.outPath, multiViewManager.getIBRSubView("TM view"), "texturedmesh");
+			if (myArgs.benchmark.get() != "") {
+				PathBenchmark benchmark(generalCamera->getCameraRecorder().cams(), usedResolution, myArgs.benchmark_warmup, myArgs.benchmark_repeat);
+				benchmark.run(*multiViewManager.getIBRSubView("TM view"));
+				benchmark.save(myArgs.benchmark, { { "renderer", "texturedmesh" }, { "dataset", myArgs.dataset_path.get() }, { "path", myArgs.pathFile.get() } });
+			} else {
+				generalCamera->getCameraRecorder().recordOfflinePath(myArgs.outPath, multiViewManager.getIBRSubView("TM view"), "texturedmesh");
+			}
 			if( !myArgs.noExit )
 				exit(0);
 		}
@@ -17,6 +17,7 @@
 #include <core/scene/BasicIBRScene.hpp>
 #include <core/raycaster/Raycaster.hpp>
 #include <core/view/SceneDebugView.hpp>
+#include <core/view/PathBenchmark.hpp>
 
 #define PROGRAM_NAME "sibr_ulr_app"
 using namespace sibr;
@@ -81,7 +82,13 @@ int main( int ac, char** av )
 
 		if (myArgs.pathFile.get() !=  "" ) {
 			generalCamera->getCameraRecorder().loadPath(myArgs.pathFile.get(), usedResolution.x(), usedResolution.y());
-			generalCamera->getCameraRecorder().recordOfflinePath(myArgs.outPath, multiViewManager.getIBRSubView("ULR view"), "ulr");
+			if (myArgs.benchmark.get() != "") {
+				PathBenchmark benchmark(generalCamera->getCameraRecorder().cams(), usedResolution, myArgs.benchmark_warmup, myArgs.benchmark_repeat);
+				benchmark.run(*multiViewManager.getIBRSubView("ULR view"));
+				benchmark.save(myArgs.benchmark, { { "renderer", "ulr" }, { "dataset", myArgs.dataset_path.get() }, { "path", myArgs.pathFile.get() } });
+			} else {
+				generalCamera->getCameraRecorder().recordOfflinePath(myArgs.outPath, multiViewManager.getIBRSubView("ULR view"), "ulr");
+			}
 			if( !myArgs.noExit )
 				exit(0);
 		}
@@ -22,6 +22,9 @@ sibr::TexturedMeshView::TexturedMeshView(const sibr::BasicIBRScene::Ptr & ibrSce
 
 	//  Renderers.
 	_textureRenderer.reset(new TexturedMeshRenderer());
+	if (_scene->inputMeshVirtualTexture()) {
+		_virtualTextureRenderer.reset(new VirtualTexturedMeshRenderer());
+	}
 	_poissonRenderer.reset(new PoissonRenderer(w, h));
 	_poissonRenderer->enableFix() = true;
 
@@ -36,6 +39,9 @@ void sibr::TexturedMeshView::setScene(const sibr::BasicIBRScene::Ptr & newScene)
 	const uint h = getResolution().y();
 
 	_textureRenderer.reset(new TexturedMeshRenderer());
+	if (_scene->inputMeshVirtualTexture() && !_virtualTextureRenderer) {
+		_virtualTextureRenderer.reset(new VirtualTexturedMeshRenderer());
+	}
 }
 
 void sibr::TexturedMeshView::onRenderIBR(sibr::IRenderTarget & dst, const sibr::Camera & eye)
@@ -43,10 +49,18 @@ void sibr::TexturedMeshView::onRenderIBR(sibr::IRenderTarget & dst, const sibr::
 	// Perform ULR rendering, either directly to the destination RT, or to the intermediate RT when poisson blending is enabled.
 	glViewport(0, 0, dst.w(), dst.h());
 	dst.clear();
-	_textureRenderer->process(
+	if (_scene->inputMeshVirtualTexture()) {
+		_virtualTextureRenderer->process(
+			_scene->proxies()->proxy(),
+			eye, *_scene->inputMeshVirtualTexture(),
+			_poissonBlend ? *_blendRT : dst, false);
+	}
+	else if (_scene->inputMeshTextures()) {
+		_textureRenderer->process(
 			_scene->proxies()->proxy(),
 			eye, _scene->inputMeshTextures()->handle(), 
-		_poissonBlend ? *_blendRT : dst, false);
+			_poissonBlend ? *_blendRT : dst, false);
+	}
 
 	// Perform Poisson blending if enabled and copy to the destination RT.
 	if (_poissonBlend) {
@@ -68,6 +82,12 @@ void sibr::TexturedMeshView::onGUI()
 		ImGui::Checkbox("Poisson ", &_poissonBlend); ImGui::SameLine();
 		ImGui::Checkbox("Poisson fix", &_poissonRenderer->enableFix());
 
+		// Virtual texture state.
+		if (_scene->inputMeshVirtualTexture()) {
+			const VirtualTexture & texture = *_scene->inputMeshVirtualTexture();
+			ImGui::Text("Texture tiles: %zu / %zu pages, %zu pending", texture.residentCount(), texture.pageCount(), _virtualTextureRenderer->pendingTiles());
+		}
+
 	}
 	ImGui::End();
 }
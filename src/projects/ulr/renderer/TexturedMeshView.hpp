@@ -18,6 +18,7 @@
 # include <core/view/ViewBase.hpp>
 # include <core/renderer/CopyRenderer.hpp>
 # include <core/renderer/TexturedMeshRenderer.hpp>
+# include <core/renderer/VirtualTexturedMeshRenderer.hpp>
 # include <core/scene/BasicIBRScene.hpp>
 # include <core/renderer/PoissonRenderer.hpp>
 
@@ -76,6 +77,7 @@ namespace sibr {
 		
 		std::shared_ptr<sibr::BasicIBRScene> _scene;
 		TexturedMeshRenderer::Ptr			 _textureRenderer;
+		VirtualTexturedMeshRenderer::Ptr	 _virtualTextureRenderer; ///< Used when the scene streams its texture.
 		PoissonRenderer::Ptr				 _poissonRenderer;
 											 
 		RenderTargetRGBA::Ptr				 _blendRT;
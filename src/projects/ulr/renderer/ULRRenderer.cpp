@@ -13,6 +13,7 @@
 # include "Config.hpp"
 # include <core/assets/Resources.hpp>
 # include <projects/ulr/renderer/ULRRenderer.hpp>
+# include <core/graphics/PassProfiler.hpp>
 
 namespace sibr { 
 ULRRenderer::ULRRenderer(const uint w, const uint h)
@@ -36,7 +37,10 @@ ULRRenderer::ULRRenderer(const uint w, const uint h)
     _ulrShaderPass1_iCamProj.init(_ulrShaderPass1, "iCamProj");
     _ulrShaderPass1_occlTest .init(_ulrShaderPass1, "occlTest");
 	_ulrShaderPass1_masking .init(_ulrShaderPass1, "doMasking");
+	_ulrShaderPass1_separateDepth.init(_ulrShaderPass1, "separate_depth");
+	_ulrShaderPass1_iCamId.init(_ulrShaderPass1, "iCamId");
     _depthShader_proj.init(_depthShader,"proj");
+    _depthShader_positionDecode.init(_depthShader,"position_decode");
 
     std::cerr << "\n[ULRenderer] creating render targets" << std::endl;
 
@@ -51,7 +55,7 @@ void
 ULRRenderer::process(std::vector<uint>& imgs_ulr, const sibr::Camera& eye,
 		const sibr::BasicIBRScene::Ptr scene,
 		std::shared_ptr<sibr::Mesh>& altMesh,
-		const std::vector<std::shared_ptr<RenderTargetRGBA32F> >& inputRTs,
+		const std::vector<IRenderTarget::Ptr>& inputRTs,
 		IRenderTarget& dst)
 {
 	// Get a new camera with z_near ~ 0
@@ -59,6 +63,7 @@ ULRRenderer::process(std::vector<uint>& imgs_ulr, const sibr::Camera& eye,
 	new_cam.znear( 0.001f );
 
     // render geometry to depth map
+	PassProfiler::Scope depthPass("ULR depth");
 
 	glViewport(0,0, _depth_RT->w(), _depth_RT->h());
     _depth_RT->clear();
@@ -69,15 +74,17 @@ ULRRenderer::process(std::vector<uint>& imgs_ulr, const sibr::Camera& eye,
 
 	glClear(GL_DEPTH_BUFFER_BIT);
 
-	if( altMesh != nullptr )
-		altMesh->render( true, true); // enable depth test - disable back culling
-	else
-		scene->proxies()->proxy().render( true, true); // enable depth test - disable back culling
+	const sibr::Mesh & depthMesh = altMesh != nullptr ? *altMesh : scene->proxies()->proxy();
+	_depthShader_positionDecode.set(depthMesh.positionDecodeMatrix());
+	depthMesh.render( true, true); // enable depth test - disable back culling
 
     _depthShader.end();
     _depth_RT->unbind();
+	depthPass.end();
 
     // ULR pass 1
+	PassProfiler::Scope accumulationPass("ULR accumulation");
+	const ITexture2DArray::Ptr & inputDepths = scene->renderTargets()->inputDepthsRT();
     _ulr0_RT->clear(sibr::Vector4f(0,0,0,1e5));
     _ulr1_RT->clear(sibr::Vector4f(0,0,0,1e5));
     for (uint i=0; i<imgs_ulr.size(); i++) {
@@ -97,7 +104,13 @@ ULRRenderer::process(std::vector<uint>& imgs_ulr, const sibr::Camera& eye,
 					glActiveTexture(GL_TEXTURE6);
 					glBindTexture(GL_TEXTURE_2D, getMasks()[imgs_ulr[i]]->texture());
 			}
+			if (inputDepths) {
+				glActiveTexture(GL_TEXTURE7);
+				glBindTexture(GL_TEXTURE_2D_ARRAY, inputDepths->handle());
+			}
 			_ulrShaderPass1_masking.set(useMasks());
+			_ulrShaderPass1_separateDepth.set(inputDepths != nullptr);
+			_ulrShaderPass1_iCamId.set(int(imgs_ulr[i]));
 			_ulrShaderPass1_nCamPos.set(eye.position());
             _ulrShaderPass1_iCamPos.set(cam.position());
             _ulrShaderPass1_iCamDir.set(cam.dir());
@@ -117,9 +130,12 @@ ULRRenderer::process(std::vector<uint>& imgs_ulr, const sibr::Camera& eye,
         }
     }
 
+	accumulationPass.end();
+
     // ULR pass 2
     // enable depth test to ensure depth of proxy is written to
     // depth buffer by the shader
+	PassProfiler::Scope blendingPass("ULR blending");
 //    glEnable(GL_DEPTH_TEST); /// \todo TODO -- breaks with fences -- check
     _ulrShaderPass2.begin();
     dst.clear();
@@ -39,13 +39,13 @@ namespace sibr {
 		 *\param eye novel viewpoint
 		 *\param scene the scene to render
 		 *\param altMesh optional alternative mesh
-		 *\param inputRTs the RGBD input images
+		 *\param inputRTs the RGBD input images, depth is read from the scene input depths if they are stored separately
 		 *\param output destination target
 		 */
 		void process(std::vector<uint>& imgs_ulr, const sibr::Camera& eye,
 			const sibr::BasicIBRScene::Ptr scene,
 			std::shared_ptr<sibr::Mesh>& altMesh,
-			const std::vector<std::shared_ptr<RenderTargetRGBA32F> >& inputRTs,
+			const std::vector<IRenderTarget::Ptr>& inputRTs,
 			IRenderTarget& output);
 
 		/** Toggle occlusion testing.
@@ -68,7 +68,10 @@ namespace sibr {
 		sibr::GLParameter _ulrShaderPass1_iCamProj;
 		sibr::GLParameter _ulrShaderPass1_occlTest;
 		sibr::GLParameter _ulrShaderPass1_masking;
+		sibr::GLParameter _ulrShaderPass1_separateDepth;
+		sibr::GLParameter _ulrShaderPass1_iCamId;
 		sibr::GLParameter _depthShader_proj;
+		sibr::GLuniform<sibr::Matrix4f> _depthShader_positionDecode;
 
 		bool	_doOccl;
 
@@ -14,6 +14,7 @@
 # include <core/assets/Resources.hpp>
 # include <map>
 # include "ULRV2Renderer.hpp"
+# include <core/graphics/PassProfiler.hpp>
 #include "core/system/String.hpp"
 
 namespace sibr {
@@ -61,12 +62,15 @@ namespace sibr {
 				sibr::loadFile(sibr::getShadersDirectory("ulr") + "/ulr_intersect.frag", defines));
 
 			_proj.init(_depthShader, "proj");
+			_positionDecode.init(_depthShader, "position_decode");
 			_ncamPos.init(_ulrShader, "ncam_pos");
 			_occTest.init(_ulrShader, "occ_test");
 			_areMasksBinaryGL.init(_ulrShader, "is_binary_mask");
 			_doInvertMasksGL.init(_ulrShader, "invert_mask");
 			_discardBlackPixelsGL.init(_ulrShader, "discard_black_pixels");
 			_doMask.init(_ulrShader, "doMasking");
+			_inputDepths.init(_ulrShader, "input_depths");
+			_separateDepth.init(_ulrShader, "separate_depth");
 			_camCount.init(_ulrShader, "camsCount");
 			_use_soft_visibility.init(_ulrShader, "useSoftVisibility");
 			_soft_visibility_threshold.init(_ulrShader, "softVisibilityThreshold");
@@ -92,6 +96,7 @@ namespace sibr {
 				_masks[i].set(GLuint(_numCams + i + 2));
 
 			}
+			_inputDepths.set(GLuint(2 * _numCams + 2));
 			_ulrShader.end();
 
 		}
@@ -100,7 +105,7 @@ namespace sibr {
 			ULRV2Renderer::process(const std::vector<uint>& imgs_ulr, const sibr::Camera& eye,
 				const sibr::BasicIBRScene::Ptr& scene,
 				std::shared_ptr<sibr::Mesh>& altMesh,
-				const std::vector<std::shared_ptr<RenderTargetRGBA32F> >& inputRTs,
+				const std::vector<IRenderTarget::Ptr>& inputRTs,
 				IRenderTarget& dst)
 		{
 			// Get a new camera with z_near ~ 0
@@ -108,6 +113,7 @@ namespace sibr {
 			//new_cam.znear(0.001f);
 
 
+			PassProfiler::Scope depthPass("ULRV2 depth");
 			glViewport(0, 0, _depthRT->w(), _depthRT->h());
 			_depthRT->bind();
 			glClearColor(0, 0, 0, 1);
@@ -115,14 +121,14 @@ namespace sibr {
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 			_depthShader.begin();
 			_proj.set(new_cam.viewproj());
-			if (altMesh != nullptr) {
-				altMesh->render(true, _shouldCull); // enable depth test - disable back culling
-			} else {
-				scene->proxies()->proxy().render(true, _shouldCull);
-			}
+			const sibr::Mesh & depthMesh = altMesh != nullptr ? *altMesh : scene->proxies()->proxy();
+			_positionDecode.set(depthMesh.positionDecodeMatrix());
+			depthMesh.render(true, _shouldCull);
 			_depthShader.end();
 			_depthRT->unbind();
+			depthPass.end();
 			
+			PassProfiler::Scope blendingPass("ULRV2 blending");
 			glViewport(0, 0, dst.w(), dst.h());
 			dst.clear();
 			dst.bind();
@@ -135,6 +141,14 @@ namespace sibr {
 			_doInvertMasksGL.set(_doInvertMasks);
 			_discardBlackPixelsGL.set(_discardBlackPixels);
 			_doMask.set(useMasks());
+
+			// Input depths stored apart from the colors.
+			const ITexture2DArray::Ptr & inputDepths = scene->renderTargets()->inputDepthsRT();
+			_separateDepth.set(inputDepths != nullptr);
+			if (inputDepths) {
+				glActiveTexture(GL_TEXTURE0 + 2 * (int)_numCams + 2);
+				glBindTexture(GL_TEXTURE_2D_ARRAY, inputDepths->handle());
+			}
 			_epsilonOcclusion.send();
 
 			CHECK_GL_ERROR
@@ -49,13 +49,13 @@ namespace sibr {
 		 *\param eye novel viewpoint
 		 *\param scene the scene to render
 		 *\param altMesh optional alternative mesh
-		 *\param inputRTs the RGBD input images
+		 *\param inputRTs the RGBD input images, depth is read from the scene input depths if they are stored separately
 		 *\param dst destination target
 		 */
 		void process(const std::vector<uint>& imgs_ulr, const sibr::Camera& eye,
 			const sibr::BasicIBRScene::Ptr& scene,
 			std::shared_ptr<sibr::Mesh>& altMesh,
-			const std::vector<std::shared_ptr<RenderTargetRGBA32F> >& inputRTs,
+			const std::vector<IRenderTarget::Ptr>& inputRTs,
 			IRenderTarget& dst);
 
 		/** Should occlusion testing be performed.
@@ -122,9 +122,12 @@ namespace sibr {
 		sibr::GLParameter _doInvertMasksGL;
 		sibr::GLParameter _discardBlackPixelsGL;
 		sibr::GLParameter _doMask;
+		sibr::GLParameter _inputDepths;
+		sibr::GLParameter _separateDepth;
 		sibr::GLParameter _ncamPos;
 		sibr::GLParameter _camCount;
 		sibr::GLParameter _proj;
+		sibr::GLuniform<sibr::Matrix4f> _positionDecode;
 		sibr::GLuniform<float> _epsilonOcclusion;
 
 		bool	_doOccl;
@@ -42,7 +42,7 @@ ULRV2View::ULRV2View( const sibr::BasicIBRScene::Ptr& ibrScene, uint render_w, u
 	_blendRT.reset(new RenderTargetRGBA(w, h, SIBR_CLAMP_UVS));
 	_poisson.reset(new PoissonRenderer(w,h));
 	_poisson->enableFix() = true;
-	_inputRTs = ibrScene->renderTargets()->inputImagesRT();
+	_inputRTs = ibrScene->renderTargets()->inputColorRTs();
 
 	testAltlULRShader = false;
 }
@@ -11,6 +11,7 @@
 
 
 #include <projects/ulr/renderer/ULRV3Renderer.hpp>
+#include <core/graphics/PassProfiler.hpp>
 
 
 
@@ -76,6 +77,7 @@ void sibr::ULRV3Renderer::setupShaders(const std::string & fShader, const std::s
 
 	// Setup uniforms.
 	_nCamProj.init(_depthShader, "proj");
+	_positionDecode.init(_depthShader, "position_decode");
 	_nCamPos.init(_ulrShader, "ncam_pos");
 	_occTest.init(_ulrShader, "occ_test");
 	_useMasks.init(_ulrShader, "doMasking");
@@ -116,7 +118,9 @@ void sibr::ULRV3Renderer::process(
 		_depthPassTimer.tic();
 	}
 	// Render the proxy positions in world space.
+	PassProfiler::Scope depthPass("ULRV3 depth");
 	renderProxyDepth(mesh, eye);
+	depthPass.end();
 	if (_profiling) {
 		glFinish();
 		//std::cout << "\nDepth Pass: " << _depthPassTimer.deltaTimeFromLastTic() << " ms" << std::endl;
@@ -126,7 +130,9 @@ void sibr::ULRV3Renderer::process(
 		_blendPassTimer.tic();
 	}
 	// Perform ULR blending.
+	PassProfiler::Scope blendingPass("ULRV3 blending");
 	renderBlending(eye, dst, inputRGBHandle, inputDepths, passthroughDepth);
+	blendingPass.end();
 	if (_profiling) {
 		glFinish();
 		//std::cout << "\nBlend Pass: " << _blendPassTimer.deltaTimeFromLastTic() << " ms" << std::endl;
@@ -197,6 +203,7 @@ void sibr::ULRV3Renderer::renderProxyDepth(const sibr::Mesh & mesh, const sibr::
 	// Render the mesh from the current viewpoint, output positions.
 	_depthShader.begin();
 	_nCamProj.set(eye.viewproj());
+	_positionDecode.set(mesh.positionDecodeMatrix());
 
 	mesh.render(true, _backFaceCulling);
 	
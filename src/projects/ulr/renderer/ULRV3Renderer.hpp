@@ -179,6 +179,7 @@ namespace sibr {
 
 		sibr::RenderTargetRGBA32F::Ptr		_depthRT;
 		GLuniform<Matrix4f>					_nCamProj;
+		GLuniform<Matrix4f>					_positionDecode;
 		GLuniform<Vector3f>					_nCamPos;
 
 		GLuniform<bool>
@@ -81,9 +81,19 @@ void sibr::ULRV3View::setMode(const WeightsMode mode) {
 
 void sibr::ULRV3View::onRenderIBR(sibr::IRenderTarget & dst, const sibr::Camera & eye)
 {
+	// Use the coarsest proxy level that stays within the allowed error in the current view.
+	const sibr::Mesh * proxy = &_scene->proxies()->proxy();
+	if (_proxyLODError > 0.0f) {
+		// No LOD chain is available without proxy, keep the single proxy then.
+		const sibr::MeshLOD::Ptr lods = _scene->proxies()->proxyLODs();
+		if (lods) {
+			proxy = &lods->level(lods->selectLevel(eye, float(dst.h()), _proxyLODError));
+		}
+	}
+
 	// Perform ULR rendering, either directly to the destination RT, or to the intermediate RT when poisson blending is enabled.
 	_ulrRenderer->process(
-			_scene->proxies()->proxy(),
+			*proxy,
 			eye, 
 			_poissonBlend ? *_blendRT : dst,
 			_scene->renderTargets()->getInputRGBTextureArrayPtr(),
@@ -115,6 +125,7 @@ void sibr::ULRV3View::onGUI()
 		ImGui::Checkbox("Flip RGB ", &getULRrenderer()->flipRGBs());
 		ImGui::PushScaledItemWidth(150);
 		ImGui::InputFloat("Epsilon occlusion", &_ulrRenderer->epsilonOcclusion(), 0.001f, 0.01f);
+		ImGui::InputFloat("Proxy LOD error (px)", &_proxyLODError, 0.5f, 2.0f);
 
 		ImGui::Separator();
 		// Rendering mode selection.
@@ -101,6 +101,7 @@ namespace sibr {
 		WeightsMode				_weightsMode = ULR_W; ///< Current blend weights mode.
 		int						_singleCamId = 0; ///< Selected camera for the single view mode.
 		int						_everyNCamStep = 1; ///< Camera step size for the every other N mode.
+		float					_proxyLODError = 0.0f; ///< Allowed proxy simplification error in pixels, 0 to always render the full proxy.
 	};
 
 } /*namespace sibr*/ 
@@ -37,7 +37,7 @@ ULRView::ULRView( const sibr::BasicIBRScene::Ptr& ibrScene, uint render_w, uint
 
 	_ulr.reset(new ULRRenderer(render_w, render_h));
 	
-	_inputRTs = ibrScene->renderTargets()->inputImagesRT();
+	_inputRTs = ibrScene->renderTargets()->inputColorRTs();
 }
 
 void ULRView::onRenderIBR( sibr::IRenderTarget& dst, const sibr::Camera& eye ) {
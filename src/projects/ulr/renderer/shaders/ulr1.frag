@@ -24,6 +24,7 @@ layout(binding=3) uniform sampler2D texture1; // second best candidate for each
 layout(binding=4) uniform sampler2D texture2; // third best candidate for each pixel
 layout(binding=5) uniform sampler2D texture3; // fourth best candidate for each pixel
 layout(binding=6) uniform sampler2D mask; // masking texture.
+layout(binding=7) uniform sampler2DArray input_depths; // input depths, when not stored in the image alpha.
 
 uniform mat4 iCamProj;     // input camera projection
 uniform vec3 iCamPos;      // input camera position
@@ -31,6 +32,8 @@ uniform vec3 iCamDir;      // novel camera projection
 uniform vec3 nCamPos;      // novel camera position
 uniform bool occlTest;	// do occlusion test
 uniform bool doMasking;	// do masking
+uniform bool separate_depth = false; // read depth from input_depths
+uniform int iCamId;        // input camera index
 
 // vertex coordinates of the 2D screen size quad,
 // used for computing texture coordinates
@@ -69,6 +72,9 @@ void main(void) {
   vec2 uv = uvd.xy;
 
   vec4 color = texture(image, uv);
+  if (separate_depth) {
+    color.w = texture(input_depths, vec3(uv, iCamId)).r;
+  }
 
   out_color0 = color0;
   out_color1 = color1;
@@ -18,7 +18,10 @@ layout(location = 0) in vec3 in_vertex;
 
 out vec3 vertex_coord;
 
+#include "compact_vertex.glsl"
+
 void main(void) {
-	gl_Position = proj * vec4(in_vertex,1.0);
-    vertex_coord  = in_vertex;
+	vec4 position = decodePosition(in_vertex);
+	gl_Position = proj * position;
+    vertex_coord  = position.xyz;
 }
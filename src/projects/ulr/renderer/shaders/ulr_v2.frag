@@ -22,6 +22,8 @@ layout(binding=1) uniform sampler2DArray soft_visibility_maps;
 uniform vec3 ncam_pos;
 uniform sampler2D input_rgb[NUM_CAMS];
 uniform sampler2D masks[NUM_CAMS];
+uniform sampler2DArray input_depths; // input depths, when not stored in the input_rgb alpha.
+uniform bool separate_depth = false;
 uniform vec3 icam_pos[NUM_CAMS];
 uniform vec3 icam_dir[NUM_CAMS];
 uniform mat4 icam_proj[NUM_CAMS];
@@ -88,6 +90,9 @@ void main(void){
 	if (frustumTest(point.xyz, ndc, cam_id))
 	{
         vec4 color = texture(input_rgb[cam_id], uvd.xy);
+        if (separate_depth) {
+            color.w = texture(input_depths, vec3(uvd.xy, selected_cams[cam_id])).r;
+        }
 		
 		
 		if(doMasking){
@@ -240,6 +245,9 @@ void main(void) {
 		{
    
 			vec4 inputColor = texture(input_rgb[cam_id], uv);
+			if (separate_depth) {
+				inputColor.w = texture(input_depths, vec3(uv, selected_cams[cam_id])).r;
+			}
 			
 			if ( !all(equal(inputColor.xyz, vec3(0,0,0))) && 
 				abs(uvd.z-inputColor.w) < epsilonOcclusion) {		
@@ -22,6 +22,8 @@ layout(binding=1) uniform sampler2DArray soft_visibility_maps;
 uniform vec3 ncam_pos;
 uniform sampler2D input_rgb[NUM_CAMS];
 uniform sampler2D masks[NUM_CAMS];
+uniform sampler2DArray input_depths; // input depths, when not stored in the input_rgb alpha.
+uniform bool separate_depth = false;
 uniform vec3 icam_pos[NUM_CAMS];
 uniform vec3 icam_dir[NUM_CAMS];
 uniform mat4 icam_proj[NUM_CAMS];
@@ -86,6 +88,9 @@ void main(void){
 		}
 		
 		vec4 color = texture(input_rgb[cam_id], uvd.xy);
+		if (separate_depth) {
+			color.w = texture(input_depths, vec3(uvd.xy, selected_cams[cam_id])).r;
+		}
 				
 		if(doMasking){	
 			float masked = texture(masks[cam_id], uvd.xy).r;